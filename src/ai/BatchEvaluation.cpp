@@ -0,0 +1,257 @@
+#include "ai/BatchEvaluation.h"
+#include "ai/EvaluationEngine.h"
+#include "core/AttackMap.h"
+#include <cstring> // For std::memset
+
+#if defined(__AVX2__)
+#define BATCH_USE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Squares of each center-control ring, derived from CENTER_CONTROL_MAP
+struct CenterRingMasks {
+    Bitboard masks[CENTER_RING_COUNT];
+
+    CenterRingMasks() {
+        for (int k = 0; k < CENTER_RING_COUNT; ++k) {
+            masks[k] = 0;
+        }
+        for (int r = 0; r < 8; ++r) {
+            for (int c = 0; c < 8; ++c) {
+                for (int k = 0; k < CENTER_RING_COUNT; ++k) {
+                    if (CENTER_CONTROL_MAP[r][c] == CENTER_RING_VALUES[k]) {
+                        masks[k] |= squareBB((7 - r) * 8 + c);
+                    }
+                }
+            }
+        }
+    }
+};
+
+const CenterRingMasks CENTER_RINGS;
+
+// The pawn structure term looks one rank towards White's side of the board for
+// every pawn (the staticEvaluate convention with White's perspective) and counts
+// diagonal neighbours that hold a pawn of either color. These shifts move each
+// neighbour's bit onto the square of the pawn it supports.
+inline Bitboard supportFromLeft(Bitboard allPawns) {
+    return (allPawns << 9) & ~FILE_A_BB;
+}
+
+inline Bitboard supportFromRight(Bitboard allPawns) {
+    return (allPawns << 7) & ~FILE_H_BB;
+}
+
+#if defined(BATCH_USE_AVX2)
+
+// Per-lane popcount of four 64-bit lanes (nibble lookup, then byte sums)
+inline __m256i popCount4(__m256i v) {
+    const __m256i lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+    __m256i lo = _mm256_and_si256(v, lowMask);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+}
+
+inline __m256i maskLanes(Bitboard mask) {
+    return _mm256_set1_epi64x(static_cast<long long>(mask));
+}
+
+// Stores four (small, possibly negative) 64-bit lane values as floats
+inline void storeLanes(float* out, __m256i v) {
+    const __m256i lowHalves = _mm256_setr_epi32(0, 2, 4, 6, 0, 0, 0, 0);
+    __m128i packed = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, lowHalves));
+    _mm_storeu_ps(out, _mm_cvtepi32_ps(packed));
+}
+
+void computeCheapFeatures(const PositionBlock& block, FeatureBlock& features) {
+    const int pawn = static_cast<int>(PieceType::PAWN);
+
+    for (int i = 0; i < block.count; i += 4) {
+        __m256i white[6];
+        __m256i black[6];
+        __m256i whiteCount[6];
+        __m256i blackCount[6];
+        __m256i whiteOccupied = _mm256_setzero_si256();
+        __m256i blackOccupied = _mm256_setzero_si256();
+
+        for (int t = 0; t < 6; ++t) {
+            white[t] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.pieces[0][t][i]));
+            black[t] = _mm256_load_si256(reinterpret_cast<const __m256i*>(&block.pieces[1][t][i]));
+            whiteCount[t] = popCount4(white[t]);
+            blackCount[t] = popCount4(black[t]);
+            whiteOccupied = _mm256_or_si256(whiteOccupied, white[t]);
+            blackOccupied = _mm256_or_si256(blackOccupied, black[t]);
+            storeLanes(&features.values[EVAL_PAWNS + t][i], _mm256_sub_epi64(whiteCount[t], blackCount[t]));
+        }
+
+        for (int k = 0; k < CENTER_RING_COUNT; ++k) {
+            __m256i ring = maskLanes(CENTER_RINGS.masks[k]);
+            __m256i diff = _mm256_sub_epi64(popCount4(_mm256_and_si256(whiteOccupied, ring)),
+                                            popCount4(_mm256_and_si256(blackOccupied, ring)));
+            storeLanes(&features.values[EVAL_CENTER_RING + k][i], diff);
+        }
+
+        // Supported pawns: shift every pawn onto the squares it supports
+        __m256i allPawns = _mm256_or_si256(white[pawn], black[pawn]);
+        __m256i fromLeft = _mm256_andnot_si256(maskLanes(FILE_A_BB), _mm256_slli_epi64(allPawns, 9));
+        __m256i fromRight = _mm256_andnot_si256(maskLanes(FILE_H_BB), _mm256_slli_epi64(allPawns, 7));
+        __m256i whiteSupport = _mm256_add_epi64(popCount4(_mm256_and_si256(white[pawn], fromLeft)),
+                                                popCount4(_mm256_and_si256(white[pawn], fromRight)));
+        __m256i blackSupport = _mm256_add_epi64(popCount4(_mm256_and_si256(black[pawn], fromLeft)),
+                                                popCount4(_mm256_and_si256(black[pawn], fromRight)));
+        __m256i supported = _mm256_sub_epi64(whiteSupport, blackSupport);
+        // Every pawn has two neighbour checks, so unsupported = 2 * pawns - supported
+        __m256i pawnDiff = _mm256_sub_epi64(whiteCount[pawn], blackCount[pawn]);
+        __m256i unsupported = _mm256_sub_epi64(_mm256_add_epi64(pawnDiff, pawnDiff), supported);
+        storeLanes(&features.values[EVAL_PAWN_SUPPORTED][i], supported);
+        storeLanes(&features.values[EVAL_PAWN_UNSUPPORTED][i], unsupported);
+
+        // cmpeq yields -1 per matching lane, so subtracting counts the files
+        const __m256i two = _mm256_set1_epi64x(2);
+        const __m256i three = _mm256_set1_epi64x(3);
+        __m256i doubled = _mm256_setzero_si256();
+        __m256i tripled = _mm256_setzero_si256();
+        for (int f = 0; f < 8; ++f) {
+            __m256i file = maskLanes(FILE_A_BB << f);
+            __m256i whiteOnFile = popCount4(_mm256_and_si256(white[pawn], file));
+            __m256i blackOnFile = popCount4(_mm256_and_si256(black[pawn], file));
+            doubled = _mm256_sub_epi64(doubled, _mm256_cmpeq_epi64(whiteOnFile, two));
+            doubled = _mm256_add_epi64(doubled, _mm256_cmpeq_epi64(blackOnFile, two));
+            tripled = _mm256_sub_epi64(tripled, _mm256_cmpeq_epi64(whiteOnFile, three));
+            tripled = _mm256_add_epi64(tripled, _mm256_cmpeq_epi64(blackOnFile, three));
+        }
+        storeLanes(&features.values[EVAL_DOUBLED_PAWNS][i], doubled);
+        storeLanes(&features.values[EVAL_TRIPLED_PAWNS][i], tripled);
+    }
+}
+
+#else
+
+void computeCheapFeatures(const PositionBlock& block, FeatureBlock& features) {
+    const int pawn = static_cast<int>(PieceType::PAWN);
+
+    for (int i = 0; i < block.count; ++i) {
+        Bitboard whiteOccupied = 0;
+        Bitboard blackOccupied = 0;
+        for (int t = 0; t < 6; ++t) {
+            whiteOccupied |= block.pieces[0][t][i];
+            blackOccupied |= block.pieces[1][t][i];
+            features.values[EVAL_PAWNS + t][i] =
+                static_cast<float>(popCount(block.pieces[0][t][i]) - popCount(block.pieces[1][t][i]));
+        }
+
+        for (int k = 0; k < CENTER_RING_COUNT; ++k) {
+            Bitboard ring = CENTER_RINGS.masks[k];
+            features.values[EVAL_CENTER_RING + k][i] =
+                static_cast<float>(popCount(whiteOccupied & ring) - popCount(blackOccupied & ring));
+        }
+
+        Bitboard whitePawns = block.pieces[0][pawn][i];
+        Bitboard blackPawns = block.pieces[1][pawn][i];
+        Bitboard fromLeft = supportFromLeft(whitePawns | blackPawns);
+        Bitboard fromRight = supportFromRight(whitePawns | blackPawns);
+        int supported = popCount(whitePawns & fromLeft) + popCount(whitePawns & fromRight) -
+                        popCount(blackPawns & fromLeft) - popCount(blackPawns & fromRight);
+        int pawnDiff = popCount(whitePawns) - popCount(blackPawns);
+        features.values[EVAL_PAWN_SUPPORTED][i] = static_cast<float>(supported);
+        features.values[EVAL_PAWN_UNSUPPORTED][i] = static_cast<float>(2 * pawnDiff - supported);
+
+        int doubled = 0;
+        int tripled = 0;
+        for (int f = 0; f < 8; ++f) {
+            int whiteOnFile = popCount(whitePawns & (FILE_A_BB << f));
+            int blackOnFile = popCount(blackPawns & (FILE_A_BB << f));
+            doubled += (whiteOnFile == 2) - (blackOnFile == 2);
+            tripled += (whiteOnFile == 3) - (blackOnFile == 3);
+        }
+        features.values[EVAL_DOUBLED_PAWNS][i] = static_cast<float>(doubled);
+        features.values[EVAL_TRIPLED_PAWNS][i] = static_cast<float>(tripled);
+    }
+}
+
+#endif
+
+} // namespace
+
+const char* batchEvalSimdName() {
+#if defined(BATCH_USE_AVX2)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+
+void unpackPositionBlock(const PackedPosition* positions, int count, PositionBlock& block) {
+    // Lanes past 'count' are zeroed so vector kernels may read whole groups
+    std::memset(block.pieces, 0, sizeof(block.pieces));
+    block.count = count;
+
+    for (int i = 0; i < count; ++i) {
+        const PackedPosition& packed = positions[i];
+        Bitboard occupied = packed.occupancy;
+        int n = 0;
+        bool valid = true;
+        while (occupied) {
+            int square = popLsb(occupied);
+            int code = packed.pieceCode(n++);
+            if (code >= 12) {
+                valid = false;
+                break;
+            }
+            block.pieces[code / 6][code % 6][i] |= squareBB(square);
+        }
+        if (!valid) {
+            for (int c = 0; c < 2; ++c) {
+                for (int t = 0; t < 6; ++t) {
+                    block.pieces[c][t][i] = 0;
+                }
+            }
+        }
+    }
+}
+
+void computeEvalFeatures(const PositionBlock& block, FeatureBlock& features) {
+    computeCheapFeatures(block, features);
+
+    // Mobility and king safety depend on slider attacks, which do not vectorise
+    // across positions; they reuse the search's attack-map terms one position at a time
+    for (int i = 0; i < block.count; ++i) {
+        Bitboard pieces[2][6];
+        for (int c = 0; c < 2; ++c) {
+            for (int t = 0; t < 6; ++t) {
+                pieces[c][t] = block.pieces[c][t][i];
+            }
+        }
+        AttackMap attackMap(pieces);
+        features.values[EVAL_MOBILITY][i] = static_cast<float>(
+            EvaluationEngine::mobility(attackMap, Color::WHITE) - EvaluationEngine::mobility(attackMap, Color::BLACK));
+        features.values[EVAL_KING_DANGER][i] =
+            EvaluationEngine::kingDanger(attackMap, Color::WHITE) - EvaluationEngine::kingDanger(attackMap, Color::BLACK);
+    }
+}
+
+void scoreFeatureBlock(const FeatureBlock& features, const float weights[EVAL_FEATURE_COUNT], int count, float* scores) {
+    int i = 0;
+#if defined(BATCH_USE_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        __m256 sum = _mm256_setzero_ps();
+        for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) {
+            __m256 column = _mm256_load_ps(&features.values[f][i]);
+            sum = _mm256_add_ps(sum, _mm256_mul_ps(_mm256_set1_ps(weights[f]), column));
+        }
+        _mm256_storeu_ps(scores + i, sum);
+    }
+#endif
+    for (; i < count; ++i) {
+        float sum = 0.0f;
+        for (int f = 0; f < EVAL_FEATURE_COUNT; ++f) {
+            sum += weights[f] * features.values[f][i];
+        }
+        scores[i] = sum;
+    }
+}
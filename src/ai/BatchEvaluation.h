@@ -0,0 +1,59 @@
+#ifndef BATCH_EVALUATION_H
+#define BATCH_EVALUATION_H
+
+#include "core/PackedPosition.h"
+#include "core/Bitboard.h"
+#include "ai/EvalTerms.h"
+#include <cstdint>
+
+// Kernels behind EvaluationEngine::evaluateBatch.
+//
+// Positions are processed in blocks of BATCH_BLOCK_SIZE. Each block is unpacked
+// into structure-of-arrays bitboards (one array per color and piece type), so the
+// cheap terms (material, center control, pawn structure) can be computed for
+// several positions per instruction. The classical evaluation is linear in the
+// raw terms below, so a score is just the dot product of a feature column with
+// the engine's feature weights (EvaluationEngine::getFeatureWeights).
+
+// Raw evaluation terms of one position, always White minus Black
+enum EvalFeature {
+    EVAL_PAWNS,            // Piece count differences, in PieceType order
+    EVAL_ROOKS,
+    EVAL_KNIGHTS,
+    EVAL_BISHOPS,
+    EVAL_QUEENS,
+    EVAL_KINGS,
+    EVAL_CENTER_RING,      // Pieces per CENTER_RING_VALUES entry (CENTER_RING_COUNT features)
+    EVAL_PAWN_SUPPORTED = EVAL_CENTER_RING + CENTER_RING_COUNT,
+    EVAL_PAWN_UNSUPPORTED,
+    EVAL_DOUBLED_PAWNS,
+    EVAL_TRIPLED_PAWNS,
+    EVAL_MOBILITY,
+    EVAL_KING_DANGER,
+    EVAL_FEATURE_COUNT
+};
+
+constexpr int BATCH_BLOCK_SIZE = 64;
+
+struct PositionBlock {
+    alignas(32) Bitboard pieces[2][6][BATCH_BLOCK_SIZE]; // [Color][PieceType][position]
+    int count = 0;
+};
+
+struct FeatureBlock {
+    alignas(32) float values[EVAL_FEATURE_COUNT][BATCH_BLOCK_SIZE]; // [feature][position]
+};
+
+const char* batchEvalSimdName();
+
+// Unpacks up to BATCH_BLOCK_SIZE positions. Records with invalid piece codes
+// are unpacked as empty boards (and score 0).
+void unpackPositionBlock(const PackedPosition* positions, int count, PositionBlock& block);
+
+// Fills the feature columns of the block's positions
+void computeEvalFeatures(const PositionBlock& block, FeatureBlock& features);
+
+// scores[i] = sum_f weights[f] * features[f][i], in pawns from White's point of view
+void scoreFeatureBlock(const FeatureBlock& features, const float weights[EVAL_FEATURE_COUNT], int count, float* scores);
+
+#endif // BATCH_EVALUATION_H
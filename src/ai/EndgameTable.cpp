@@ -0,0 +1,461 @@
+#include "ai/EndgameTable.h"
+#include "core/Board.h"
+#include "core/Piece.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+namespace {
+
+const char PIECE_LETTERS[] = "QRBNP"; // Strongest first, as in table names
+
+// Position of a piece type in PIECE_LETTERS, -1 for kings
+int strengthRank(PieceType type) {
+    switch (type) {
+        case PieceType::QUEEN:  return 0;
+        case PieceType::ROOK:   return 1;
+        case PieceType::BISHOP: return 2;
+        case PieceType::KNIGHT: return 3;
+        case PieceType::PAWN:   return 4;
+        default:                return -1;
+    }
+}
+
+const PieceType PIECES_BY_STRENGTH[] = {PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT, PieceType::PAWN};
+
+int materialValue(PieceType type) {
+    switch (type) {
+        case PieceType::QUEEN:  return 9;
+        case PieceType::ROOK:   return 5;
+        case PieceType::BISHOP: return 3;
+        case PieceType::KNIGHT: return 3;
+        default:                return 1;
+    }
+}
+
+bool strongerFirst(PieceType a, PieceType b) {
+    return strengthRank(a) < strengthRank(b);
+}
+
+Color otherColor(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+// Symmetries of a board as square maps: left-right always; up-down and the
+// diagonal only without pawns (and the diagonal only on square boards)
+std::vector<std::vector<int>> boardSymmetries(BoardDimensions dims, bool pawns) {
+    std::vector<std::vector<int>> maps;
+    int transposeOptions = (!pawns && dims.rows == dims.cols) ? 2 : 1;
+    int rankOptions = pawns ? 1 : 2;
+    for (int transpose = 0; transpose < transposeOptions; ++transpose) {
+        for (int flipRanks = 0; flipRanks < rankOptions; ++flipRanks) {
+            for (int flipFiles = 0; flipFiles < 2; ++flipFiles) {
+                std::vector<int> map(dims.rows * dims.cols);
+                for (int rank = 0; rank < dims.rows; ++rank) {
+                    for (int file = 0; file < dims.cols; ++file) {
+                        int r = flipRanks ? dims.rows - 1 - rank : rank;
+                        int f = flipFiles ? dims.cols - 1 - file : file;
+                        if (transpose) std::swap(r, f);
+                        map[rank * dims.cols + file] = r * dims.cols + f;
+                    }
+                }
+                maps.push_back(std::move(map));
+            }
+        }
+    }
+    return maps;
+}
+
+// Castling is only possible while a rook stands on its corner, so a right
+// without one does not stop a lookup (custom boards start with all rights set)
+bool canStillCastle(const Board& board, Color color) {
+    BoardDimensions dims = board.getDimensions();
+    int row = color == Color::WHITE ? dims.rows - 1 : 0;
+    auto rookOn = [&](int col) {
+        const Piece* piece = board.getPieceAt(Position(row, col));
+        return piece && piece->getType() == PieceType::ROOK && piece->getColor() == color;
+    };
+    return (board.canCastleKingside(color) && rookOn(dims.cols - 1)) || (board.canCastleQueenside(color) && rookOn(0));
+}
+
+} // namespace
+
+// --- EndgamePosition ---
+
+bool EndgamePosition::fromBoard(const Board& board, Color sideToMove, EndgamePosition& out) {
+    BoardDimensions dims = board.getDimensions();
+    if (dims.rows * dims.cols > 64) return false;
+    if (board.hasBitboards() && popCount(board.getOccupied()) > ENDGAME_MAX_PIECES) return false;
+    if (board.getEnPassantTargetSquare().isValid(dims.rows, dims.cols)) return false;
+
+    out.dimensions = dims;
+    out.sideToMove = sideToMove;
+    out.pieces.clear();
+    int kings[2] = {0, 0};
+    for (int row = 0; row < dims.rows; ++row) {
+        for (int col = 0; col < dims.cols; ++col) {
+            const Piece* piece = board.getPieceAt(Position(row, col));
+            if (!piece) continue;
+            if (out.pieces.size() == ENDGAME_MAX_PIECES) return false;
+            if (piece->getType() == PieceType::KING) ++kings[static_cast<int>(piece->getColor())];
+            out.pieces.push_back({piece->getType(), piece->getColor(), (dims.rows - 1 - row) * dims.cols + col});
+        }
+    }
+    if (kings[0] != 1 || kings[1] != 1) return false;
+    return !canStillCastle(board, Color::WHITE) && !canStillCastle(board, Color::BLACK);
+}
+
+// --- EndgameMaterial ---
+
+EndgameMaterial EndgameMaterial::parse(const std::string& name) {
+    std::size_t separator = name.find('v');
+    if (name.empty() || name[0] != 'K' || separator == std::string::npos || separator + 1 >= name.size() || name[separator + 1] != 'K') {
+        throw std::invalid_argument("Bad material '" + name + "', expected e.g. KQvKR");
+    }
+    EndgameMaterial material;
+    auto readSide = [&](std::size_t first, std::size_t last, Color color) {
+        for (std::size_t i = first; i < last; ++i) {
+            const char* letter = std::strchr(PIECE_LETTERS, name[i]);
+            if (!letter || name[i] == '\0') throw std::invalid_argument("Bad piece '" + std::string(1, name[i]) + "' in material " + name);
+            material.pieces[static_cast<int>(color)].push_back(PIECES_BY_STRENGTH[letter - PIECE_LETTERS]);
+        }
+        std::sort(material.pieces[static_cast<int>(color)].begin(), material.pieces[static_cast<int>(color)].end(), strongerFirst);
+    };
+    readSide(1, separator, Color::WHITE);
+    readSide(separator + 2, name.size(), Color::BLACK);
+    if (material.getPieceCount() > ENDGAME_MAX_PIECES) {
+        throw std::invalid_argument("Material " + name + " has more than " + std::to_string(ENDGAME_MAX_PIECES) + " pieces");
+    }
+    return material;
+}
+
+EndgameMaterial EndgameMaterial::of(const EndgamePosition& position) {
+    EndgameMaterial material;
+    for (const EndgamePiece& piece : position.pieces) {
+        if (piece.type != PieceType::KING) material.pieces[static_cast<int>(piece.color)].push_back(piece.type);
+    }
+    for (auto& side : material.pieces) std::sort(side.begin(), side.end(), strongerFirst);
+    return material;
+}
+
+std::string EndgameMaterial::getName() const {
+    std::string name = "K";
+    for (PieceType type : pieces[0]) name += PIECE_LETTERS[strengthRank(type)];
+    name += "vK";
+    for (PieceType type : pieces[1]) name += PIECE_LETTERS[strengthRank(type)];
+    return name;
+}
+
+const std::vector<PieceType>& EndgameMaterial::getPieces(Color color) const {
+    return pieces[static_cast<int>(color)];
+}
+
+int EndgameMaterial::getPieceCount() const {
+    return 2 + static_cast<int>(pieces[0].size() + pieces[1].size());
+}
+
+bool EndgameMaterial::hasPawns() const {
+    for (const auto& side : pieces) {
+        if (std::find(side.begin(), side.end(), PieceType::PAWN) != side.end()) return true;
+    }
+    return false;
+}
+
+std::uint64_t EndgameMaterial::getKey() const {
+    std::uint64_t key = 0;
+    for (int color = 0; color < 2; ++color) {
+        for (PieceType type : pieces[color]) key += 1ULL << (4 * (color * 5 + strengthRank(type)));
+    }
+    return key;
+}
+
+bool EndgameMaterial::isCanonical() const {
+    auto value = [](const std::vector<PieceType>& side) {
+        int total = 0;
+        for (PieceType type : side) total += materialValue(type);
+        return total;
+    };
+    if (value(pieces[0]) != value(pieces[1])) return value(pieces[0]) > value(pieces[1]);
+    if (pieces[0].size() != pieces[1].size()) return pieces[0].size() > pieces[1].size();
+    // Same value and count: the side whose strongest differing piece is stronger
+    for (std::size_t i = 0; i < pieces[0].size(); ++i) {
+        if (pieces[0][i] != pieces[1][i]) return strongerFirst(pieces[0][i], pieces[1][i]);
+    }
+    return true;
+}
+
+EndgameMaterial EndgameMaterial::swapped() const {
+    EndgameMaterial material;
+    material.pieces[0] = pieces[1];
+    material.pieces[1] = pieces[0];
+    return material;
+}
+
+// --- EndgameIndex ---
+
+EndgameIndex::EndgameIndex(const EndgameMaterial& material, BoardDimensions dimensions)
+    : squareCount(dimensions.rows * dimensions.cols), slotCount(material.getPieceCount()), placements(1) {
+    if (squareCount <= 0 || squareCount > 64) throw std::invalid_argument("Endgame tables need boards of 1 to 64 squares");
+
+    // Runs of identical pieces, which encode() sorts
+    slotRuns.assign(slotCount, 0);
+    std::vector<int> slotKinds(slotCount, -1);
+    int slot = 2;
+    for (Color color : {Color::WHITE, Color::BLACK}) {
+        for (PieceType type : material.getPieces(color)) {
+            slotKinds[slot++] = static_cast<int>(color) * 8 + strengthRank(type);
+        }
+    }
+    for (int i = 2; i < slotCount;) {
+        int run = 1;
+        while (i + run < slotCount && slotKinds[i + run] == slotKinds[i]) ++run;
+        slotRuns[i] = run;
+        i += run;
+    }
+    for (int i = 2; i < slotCount; ++i) placements *= static_cast<std::uint64_t>(squareCount);
+
+    // The white king is reduced to the smallest square of its symmetry orbit
+    transforms = boardSymmetries(dimensions, material.hasPawns());
+    std::vector<bool> reduced(squareCount, false);
+    for (int square = 0; square < squareCount; ++square) {
+        int smallest = square;
+        for (const auto& map : transforms) smallest = std::min(smallest, map[square]);
+        reduced[smallest] = true;
+    }
+    transformsByKing.resize(squareCount);
+    for (int square = 0; square < squareCount; ++square) {
+        for (std::size_t t = 0; t < transforms.size(); ++t) {
+            if (reduced[transforms[t][square]]) transformsByKing[square].push_back(static_cast<int>(t));
+        }
+    }
+
+    kingPairIndex.assign(static_cast<std::size_t>(squareCount) * squareCount, -1);
+    for (int whiteKing = 0; whiteKing < squareCount; ++whiteKing) {
+        if (!reduced[whiteKing]) continue;
+        for (int blackKing = 0; blackKing < squareCount; ++blackKing) {
+            int rankDistance = std::abs(whiteKing / dimensions.cols - blackKing / dimensions.cols);
+            int fileDistance = std::abs(whiteKing % dimensions.cols - blackKing % dimensions.cols);
+            if (std::max(rankDistance, fileDistance) <= 1) continue; // Touching or the same square
+            kingPairIndex[static_cast<std::size_t>(whiteKing) * squareCount + blackKing] = static_cast<int>(kingPairs.size());
+            kingPairs.emplace_back(whiteKing, blackKing);
+        }
+    }
+}
+
+std::uint64_t EndgameIndex::size() const {
+    return kingPairs.size() * placements;
+}
+
+int EndgameIndex::getSlotCount() const {
+    return slotCount;
+}
+
+std::uint64_t EndgameIndex::encode(const int* squares) const {
+    std::uint64_t best = INVALID;
+    int mapped[ENDGAME_MAX_PIECES];
+    // Usually one symmetry reduces the white king; on an axis of the board
+    // several do, and the smallest index among them is the position's index
+    for (int t : transformsByKing[squares[0]]) {
+        const std::vector<int>& map = transforms[t];
+        int pair = kingPairIndex[static_cast<std::size_t>(map[squares[0]]) * squareCount + map[squares[1]]];
+        if (pair < 0) return INVALID;
+        for (int i = 2; i < slotCount; ++i) mapped[i] = map[squares[i]];
+        for (int i = 2; i < slotCount; ++i) {
+            if (slotRuns[i] > 1) std::sort(mapped + i, mapped + i + slotRuns[i]);
+        }
+        std::uint64_t index = static_cast<std::uint64_t>(pair);
+        for (int i = 2; i < slotCount; ++i) index = index * squareCount + mapped[i];
+        best = std::min(best, index);
+    }
+    return best;
+}
+
+bool EndgameIndex::decode(std::uint64_t index, int* squares) const {
+    std::uint64_t pair = index / placements;
+    if (pair >= kingPairs.size()) return false;
+    squares[0] = kingPairs[pair].first;
+    squares[1] = kingPairs[pair].second;
+    std::uint64_t rest = index % placements;
+    for (int i = slotCount - 1; i >= 2; --i) {
+        squares[i] = static_cast<int>(rest % squareCount);
+        rest /= squareCount;
+    }
+    return true;
+}
+
+// --- Table files ---
+
+std::string endgameTableFileName(const EndgameMaterial& material, BoardDimensions dimensions) {
+    std::string name = material.getName();
+    if (dimensions.rows != 8 || dimensions.cols != 8) {
+        name += "." + std::to_string(dimensions.rows) + "x" + std::to_string(dimensions.cols);
+    }
+    return name + ".egt";
+}
+
+std::size_t endgameTableSideBytes(std::uint64_t entries, int bitsPerEntry) {
+    // The spare word lets entry() read two words for any entry
+    return static_cast<std::size_t>(((entries * bitsPerEntry + 63) / 64 + 1) * 8);
+}
+
+EndgameTable::EndgameTable(const std::string& path) : file(path), sideData{nullptr, nullptr} {
+    EndgameTableHeader header;
+    if (file.size() < sizeof(header)) throw std::runtime_error("Not an endgame table: " + path);
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (std::memcmp(header.magic, ENDGAME_TABLE_MAGIC, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not an endgame table: " + path);
+    }
+    if (header.version != ENDGAME_TABLE_VERSION) {
+        throw std::runtime_error("Unsupported endgame table version " + std::to_string(header.version) + " in " + path);
+    }
+    if (header.format > static_cast<std::uint8_t>(EndgameTableFormat::DTM) || header.bitsPerEntry == 0 || header.bitsPerEntry > 32
+        || header.material[sizeof(header.material) - 1] != '\0') {
+        throw std::runtime_error("Corrupt endgame table header in " + path);
+    }
+
+    try {
+        material = EndgameMaterial::parse(header.material);
+        dimensions.rows = header.rows;
+        dimensions.cols = header.cols;
+        index = std::make_unique<EndgameIndex>(material, dimensions);
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("Corrupt endgame table " + path + ": " + e.what());
+    }
+    format = static_cast<EndgameTableFormat>(header.format);
+    bitsPerEntry = header.bitsPerEntry;
+
+    std::size_t sideBytes = endgameTableSideBytes(index->size(), bitsPerEntry);
+    if (header.entriesPerSide != index->size() || file.size() != sizeof(header) + 2 * sideBytes) {
+        throw std::runtime_error("Endgame table " + path + " does not match its header (truncated?)");
+    }
+    sideData[0] = file.data() + sizeof(header);
+    sideData[1] = sideData[0] + sideBytes;
+}
+
+const EndgameMaterial& EndgameTable::getMaterial() const {
+    return material;
+}
+
+BoardDimensions EndgameTable::getDimensions() const {
+    return dimensions;
+}
+
+EndgameTableFormat EndgameTable::getFormat() const {
+    return format;
+}
+
+const EndgameIndex& EndgameTable::getIndex() const {
+    return *index;
+}
+
+std::uint32_t EndgameTable::entry(Color sideToMove, std::uint64_t position) const {
+    std::uint64_t bit = position * bitsPerEntry;
+    const std::uint8_t* word = sideData[static_cast<int>(sideToMove)] + (bit / 64) * 8;
+    int shift = static_cast<int>(bit % 64);
+    std::uint64_t low;
+    std::memcpy(&low, word, sizeof(low));
+    std::uint64_t value = low >> shift;
+    if (shift + bitsPerEntry > 64) {
+        std::uint64_t high;
+        std::memcpy(&high, word + 8, sizeof(high));
+        value |= high << (64 - shift);
+    }
+    return static_cast<std::uint32_t>(value & ((1ULL << bitsPerEntry) - 1));
+}
+
+bool EndgameTable::probe(const EndgamePosition& position, EndgameResult& result) const {
+    if (position.dimensions.rows != dimensions.rows || position.dimensions.cols != dimensions.cols) return false;
+    if (static_cast<int>(position.pieces.size()) != index->getSlotCount()) return false;
+
+    // Black stronger: swap the colours and mirror the ranks
+    EndgameMaterial positionMaterial = EndgameMaterial::of(position);
+    bool swap = positionMaterial.getKey() != material.getKey();
+    if (swap && positionMaterial.swapped().getKey() != material.getKey()) return false;
+
+    // Slots: kings, then each side's pieces strongest first (the order within
+    // identical pieces does not matter)
+    EndgamePiece ordered[ENDGAME_MAX_PIECES];
+    int count = 0;
+    for (const EndgamePiece& piece : position.pieces) {
+        EndgamePiece mapped = piece;
+        if (swap) {
+            mapped.color = otherColor(piece.color);
+            mapped.square = (dimensions.rows - 1 - piece.square / dimensions.cols) * dimensions.cols + piece.square % dimensions.cols;
+        }
+        ordered[count++] = mapped;
+    }
+    std::sort(ordered, ordered + count, [](const EndgamePiece& a, const EndgamePiece& b) {
+        bool aKing = a.type == PieceType::KING;
+        bool bKing = b.type == PieceType::KING;
+        if (aKing != bKing) return aKing;
+        if (a.color != b.color) return a.color == Color::WHITE;
+        return strongerFirst(a.type, b.type);
+    });
+    int squares[ENDGAME_MAX_PIECES];
+    for (int i = 0; i < count; ++i) squares[i] = ordered[i].square;
+
+    std::uint64_t positionIndex = index->encode(squares);
+    if (positionIndex == EndgameIndex::INVALID) return false;
+    std::uint32_t value = entry(swap ? otherColor(position.sideToMove) : position.sideToMove, positionIndex);
+
+    result.matePlies = -1;
+    if (format == EndgameTableFormat::WDL) {
+        result.wdl = value == 1 ? Wdl::WIN : value == 2 ? Wdl::LOSS : Wdl::DRAW;
+    } else if (value == 0) {
+        result.wdl = Wdl::DRAW;
+    } else {
+        result.matePlies = static_cast<int>(value) - 1;
+        result.wdl = (result.matePlies % 2 == 1) ? Wdl::WIN : Wdl::LOSS;
+    }
+    return true;
+}
+
+// --- EndgameTablebase ---
+
+EndgameTablebase::EndgameTablebase(const std::string& directory) : directory(directory) {}
+
+const EndgameTable* EndgameTablebase::findTable(const EndgameMaterial& material, BoardDimensions dimensions) const {
+    std::string name = endgameTableFileName(material, dimensions);
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = tables.find(name);
+        if (it != tables.end()) return it->second.get();
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto it = tables.find(name);
+    if (it != tables.end()) return it->second.get();
+    std::unique_ptr<EndgameTable> table;
+    std::string path = directory + "/" + name;
+    if (std::ifstream(path).good()) {
+        try {
+            table = std::make_unique<EndgameTable>(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl; // Probed as missing from now on
+        }
+    }
+    const EndgameTable* found = table.get();
+    tables.emplace(name, std::move(table));
+    return found;
+}
+
+bool EndgameTablebase::probe(const EndgamePosition& position, EndgameResult& result) const {
+    if (position.pieces.size() == 2) { // Bare kings
+        result.wdl = Wdl::DRAW;
+        result.matePlies = -1;
+        return true;
+    }
+    if (position.pieces.size() > ENDGAME_MAX_PIECES) return false;
+    EndgameMaterial material = EndgameMaterial::of(position);
+    if (!material.isCanonical()) material = material.swapped();
+    const EndgameTable* table = findTable(material, position.dimensions);
+    return table && table->probe(position, result);
+}
+
+bool EndgameTablebase::probe(const Board& board, Color sideToMove, EndgameResult& result) const {
+    EndgamePosition position;
+    return EndgamePosition::fromBoard(board, sideToMove, position) && probe(position, result);
+}
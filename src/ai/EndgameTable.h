@@ -0,0 +1,203 @@
+#ifndef ENDGAME_TABLE_H
+#define ENDGAME_TABLE_H
+
+#include "core/ChessTypes.h"
+#include "ai/Syzygy.h" // For Wdl
+#include "util/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Board;
+
+// Endgame tables of our own format, written by the tbgen tool. Unlike Syzygy
+// tables they can be generated for any board size (up to 64 squares), which is
+// what the variant boards need. Each file holds one material signature on one
+// board size, with the result of every position for both sides to move.
+
+// Most pieces (kings included) a table may have
+constexpr int ENDGAME_MAX_PIECES = 5;
+
+// One piece of an endgame position. Squares are numbered rank * cols + file,
+// counted from White's side (a1 = 0 on a standard board).
+struct EndgamePiece {
+    PieceType type;
+    Color color;
+    int square;
+};
+
+// A position in the form the tables are indexed by. Castling and en passant
+// are not part of it: the tables assume neither is possible.
+struct EndgamePosition {
+    BoardDimensions dimensions;
+    std::vector<EndgamePiece> pieces;
+    Color sideToMove = Color::WHITE;
+
+    // False if the board cannot be looked up: more than ENDGAME_MAX_PIECES
+    // pieces, an en passant square, or a castling right with the rook still
+    // on its corner
+    static bool fromBoard(const Board& board, Color sideToMove, EndgamePosition& out);
+};
+
+// The pieces of a table besides the two kings, strongest first (Q R B N P).
+// Tables are named like "KQvKR" and always list the stronger side first as
+// White; positions where Black is stronger are looked up colour-swapped.
+class EndgameMaterial {
+public:
+    EndgameMaterial() = default;
+    // Throws std::invalid_argument for anything but "K...vK..."
+    static EndgameMaterial parse(const std::string& name);
+    static EndgameMaterial of(const EndgamePosition& position);
+
+    std::string getName() const;
+    const std::vector<PieceType>& getPieces(Color color) const;
+    int getPieceCount() const; // Kings included
+    bool hasPawns() const;
+
+    // Packed piece counts; equal for equal material of the same orientation
+    std::uint64_t getKey() const;
+
+    // Whether White is the side a table lists first; swapped() exchanges the colours
+    bool isCanonical() const;
+    EndgameMaterial swapped() const;
+
+private:
+    std::vector<PieceType> pieces[2]; // By Color
+};
+
+// Index of a position within its table: the pair of kings (with the white king
+// reduced by the board's symmetries: 8-fold on square boards without pawns,
+// left-right only with pawns) times one board square per remaining piece.
+// Identical pieces are sorted, so every position has exactly one index.
+// Sizes for the standard board: 564 × 64^k without pawns, 1806 × 64^k with.
+//
+// This is collision-free but not a perfect (minimal) index: the king pairs
+// include touching and shared squares, every other piece gets all 64 squares
+// (kings' squares included), and sorted identical pieces still take 64^n
+// slots instead of C(62, n). Against a minimal index (462 legal pawnless king
+// pairs × 62 × 61 × ...) a table of distinct pieces is about 1.25-1.35x larger
+// (KQvK 36096 vs 28644 entries, KQvKR 2.31M vs 1.75M), and one with a
+// pair of identical pieces about 2.6x (KRRvK 2.31M vs 0.87M). Unused entries
+// are written as draws and cost disk and mapping space only.
+class EndgameIndex {
+public:
+    EndgameIndex(const EndgameMaterial& material, BoardDimensions dimensions);
+
+    static constexpr std::uint64_t INVALID = ~0ULL;
+
+    std::uint64_t size() const; // Entries per side to move
+    int getSlotCount() const;   // Squares per position, see encode
+
+    // 'squares' lists the white king, the black king, then the white and the
+    // black pieces in the order of EndgameMaterial::getPieces. Returns INVALID
+    // if the kings touch or share a square.
+    std::uint64_t encode(const int* squares) const;
+
+    // Squares of some position with this index (not necessarily one that
+    // encodes back to it, and possibly with pieces sharing a square). False
+    // for indices of unused king pairs.
+    bool decode(std::uint64_t index, int* squares) const;
+
+private:
+    int squareCount;
+    int slotCount;
+    std::vector<int> slotRuns;             // Per slot: length of the run of identical pieces it starts, 0 inside one
+    std::vector<std::vector<int>> transforms; // Square maps of the board's symmetries
+    std::vector<std::vector<int>> transformsByKing; // Per white king square: transforms that take it into the reduced set
+    std::vector<int> kingPairIndex;         // [white king * squares + black king], -1 if unused
+    std::vector<std::pair<int, int>> kingPairs;
+    std::uint64_t placements;               // squares^(slots - 2)
+};
+
+// Result of a table lookup, from the side to move's point of view
+struct EndgameResult {
+    Wdl wdl = Wdl::DRAW;
+    int matePlies = -1; // Plies to mate with best play (0: checkmated); -1 for draws and WDL-only tables
+};
+
+enum class EndgameTableFormat : std::uint8_t {
+    WDL = 0, // 2 bits per position: 0 draw, 1 win, 2 loss
+    DTM = 1  // Plies to mate + 1 (0 draw): odd plies are wins, even plies losses
+};
+
+// File layout: this 64-byte header, then one bit-packed array of entries per
+// side to move (White first), each padded to whole 8-byte words plus one
+// spare word. Little-endian, mapped and read in place.
+struct EndgameTableHeader {
+    char magic[8];                 // ENDGAME_TABLE_MAGIC
+    std::uint32_t version;         // ENDGAME_TABLE_VERSION
+    std::uint8_t rows;
+    std::uint8_t cols;
+    std::uint8_t format;           // EndgameTableFormat
+    std::uint8_t bitsPerEntry;
+    char material[16];             // Name, zero-padded
+    std::uint64_t entriesPerSide;
+    std::uint32_t longestMate;     // Plies; 0 for WDL tables
+    std::uint32_t reserved0;
+    std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(EndgameTableHeader) == 64, "EndgameTableHeader must stay 64 bytes");
+
+constexpr char ENDGAME_TABLE_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'E', 'G', 'T'};
+constexpr std::uint32_t ENDGAME_TABLE_VERSION = 1;
+
+// File name of a table: "KQvKR.egt" on the standard board, "KQvKR.6x6.egt" otherwise
+std::string endgameTableFileName(const EndgameMaterial& material, BoardDimensions dimensions);
+
+// Bytes of one side's entry array
+std::size_t endgameTableSideBytes(std::uint64_t entries, int bitsPerEntry);
+
+// One memory-mapped table file
+class EndgameTable {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a valid table
+    explicit EndgameTable(const std::string& path);
+
+    const EndgameMaterial& getMaterial() const;
+    BoardDimensions getDimensions() const;
+    EndgameTableFormat getFormat() const;
+    const EndgameIndex& getIndex() const;
+
+    // Looks up a position with this table's material in either colour orientation
+    bool probe(const EndgamePosition& position, EndgameResult& result) const;
+
+    // Raw entry of a position index, as described at EndgameTableFormat
+    std::uint32_t entry(Color sideToMove, std::uint64_t index) const;
+
+private:
+    MappedFile file;
+    EndgameMaterial material;
+    BoardDimensions dimensions;
+    EndgameTableFormat format;
+    int bitsPerEntry;
+    std::unique_ptr<EndgameIndex> index;
+    const std::uint8_t* sideData[2];
+};
+
+// The tables of one directory. Files are opened the first time a position with
+// their material is probed; missing tables are remembered, so probing costs a
+// hash lookup after the first time. Thread-safe.
+class EndgameTablebase {
+public:
+    explicit EndgameTablebase(const std::string& directory);
+
+    // Table of 'material' (canonical orientation) for 'dimensions', nullptr if
+    // the directory has none. Tables stay valid as long as this object.
+    const EndgameTable* findTable(const EndgameMaterial& material, BoardDimensions dimensions) const;
+
+    // Bare kings are a draw without a table
+    bool probe(const EndgamePosition& position, EndgameResult& result) const;
+    bool probe(const Board& board, Color sideToMove, EndgameResult& result) const;
+
+private:
+    std::string directory;
+    mutable std::shared_mutex mutex;
+    mutable std::unordered_map<std::string, std::unique_ptr<EndgameTable>> tables; // By file name, null if absent
+};
+
+#endif // ENDGAME_TABLE_H
@@ -0,0 +1,47 @@
+#ifndef EVAL_TERMS_H
+#define EVAL_TERMS_H
+
+// Constants of the classical evaluation, shared by EvaluationEngine::staticEvaluate
+// and the batch evaluator (ai/BatchEvaluation.h), which must agree term for term.
+
+// Piece values as set by the Piece subclasses, indexed by PieceType
+// (PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING)
+inline constexpr float PIECE_VALUES[6] = {1.0f, 5.0f, 3.0f, 3.2f, 9.0f, 1000.0f};
+
+// Static piece-square weights for the center control term (8x8 boards).
+// Row 0 is rank 8, like Board's grid; the table is symmetric so either orientation works.
+inline constexpr float CENTER_CONTROL_MAP[8][8] = {
+    {0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f},
+    {0.8f, 1.0f, 1.2f, 1.4f, 1.4f, 1.2f, 1.0f, 0.8f},
+    {0.8f, 1.2f, 1.4f, 1.6f, 1.6f, 1.4f, 1.2f, 0.8f},
+    {0.8f, 1.2f, 1.4f, 1.8f, 1.8f, 1.4f, 1.2f, 0.8f},
+    {0.8f, 1.2f, 1.4f, 1.8f, 1.8f, 1.4f, 1.2f, 0.8f},
+    {0.8f, 1.2f, 1.4f, 1.6f, 1.6f, 1.4f, 1.2f, 0.8f},
+    {0.8f, 1.0f, 1.2f, 1.4f, 1.4f, 1.2f, 1.0f, 0.8f},
+    {0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f}
+};
+
+// The distinct values of CENTER_CONTROL_MAP ("rings"); the batch evaluator counts
+// pieces per ring instead of looking up every square
+inline constexpr int CENTER_RING_COUNT = 6;
+inline constexpr float CENTER_RING_VALUES[CENTER_RING_COUNT] = {0.8f, 1.0f, 1.2f, 1.4f, 1.6f, 1.8f};
+
+// Default pawn structure terms, per pawn and per file (tunable, see EvalWeights)
+inline constexpr float PAWN_SUPPORT_BONUS = 0.05f;        // Each diagonal neighbour holding a pawn
+inline constexpr float PAWN_UNSUPPORTED_PENALTY = 0.025f; // Each diagonal neighbour without one
+inline constexpr float DOUBLED_PAWN_PENALTY = 0.1f;       // Two own pawns on a file
+inline constexpr float TRIPLED_PAWN_PENALTY = 0.25f;      // Three own pawns on a file
+
+// King-zone attack weights by attacker type (indexed by PieceType)
+inline constexpr int KING_ATTACK_WEIGHT[6] = {0, 3, 2, 2, 5, 0}; // PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING
+// A lone attacker is rarely dangerous; scale the danger by the number of attackers
+inline constexpr float KING_ATTACKER_SCALE[8] = {0.0f, 0.0f, 0.5f, 0.75f, 0.88f, 0.94f, 0.97f, 0.99f};
+
+// King and pawn versus king positions the bitbase (ai/KpkBitbase.h) marks as won
+// score this much plus a bonus per rank the pawn has advanced, which keeps them
+// ahead of any ordinary evaluation of the ending but below a promoted queen.
+// Drawn ones score 0.
+inline constexpr float KPK_WIN_SCORE = 3.0f;
+inline constexpr float KPK_PAWN_RANK_BONUS = 0.5f;
+
+#endif // EVAL_TERMS_H
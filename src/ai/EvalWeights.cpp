@@ -0,0 +1,85 @@
+#include "ai/EvalWeights.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <limits>
+
+static const char* const WEIGHT_NAMES[EvalWeights::COUNT] = {
+    "material", "mobility", "king_safety", "pawn_structure", "center_control",
+    "pawn_support_bonus", "pawn_unsupported_penalty", "doubled_pawn_penalty", "tripled_pawn_penalty"
+};
+
+float& EvalWeights::operator[](int index) {
+    switch (index) {
+        case 0: return material;
+        case 1: return mobility;
+        case 2: return kingSafety;
+        case 3: return pawnStructure;
+        case 4: return centerControl;
+        case 5: return pawnSupportBonus;
+        case 6: return pawnUnsupportedPenalty;
+        case 7: return doubledPawnPenalty;
+        case 8: return tripledPawnPenalty;
+        default: throw std::out_of_range("EvalWeights index out of range.");
+    }
+}
+
+float EvalWeights::operator[](int index) const {
+    return (*const_cast<EvalWeights*>(this))[index];
+}
+
+const char* EvalWeights::name(int index) {
+    if (index < 0 || index >= COUNT) {
+        throw std::out_of_range("EvalWeights index out of range.");
+    }
+    return WEIGHT_NAMES[index];
+}
+
+void EvalWeights::load(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Cannot open weights file: " + path);
+    }
+
+    EvalWeights loaded = *this; // Only commit once the whole file parsed
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        std::string::size_type comment = line.find('#');
+        if (comment != std::string::npos) line.erase(comment);
+
+        std::istringstream fields(line);
+        std::string key;
+        if (!(fields >> key)) continue; // Blank line
+
+        float value;
+        std::string trailing;
+        if (!(fields >> value) || (fields >> trailing)) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected '<name> <value>'");
+        }
+
+        int index = 0;
+        while (index < COUNT && key != WEIGHT_NAMES[index]) ++index;
+        if (index == COUNT) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": unknown weight '" + key + "'");
+        }
+        loaded[index] = value;
+    }
+    *this = loaded;
+}
+
+void EvalWeights::save(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) {
+        throw std::runtime_error("Cannot write weights file: " + path);
+    }
+    out.precision(std::numeric_limits<float>::max_digits10);
+    out << "# Classical evaluation weights (see EvalWeights.h)\n";
+    for (int i = 0; i < COUNT; ++i) {
+        out << WEIGHT_NAMES[i] << ' ' << (*this)[i] << '\n';
+    }
+    if (!out) {
+        throw std::runtime_error("Failed writing weights file: " + path);
+    }
+}
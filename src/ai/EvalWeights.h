@@ -0,0 +1,40 @@
+#ifndef EVAL_WEIGHTS_H
+#define EVAL_WEIGHTS_H
+
+#include "ai/EvalTerms.h"
+#include <string>
+
+// Weights file the game loads at startup when present (and `tune` writes by default)
+inline constexpr const char* DEFAULT_WEIGHTS_FILE = "eval_weights.txt";
+
+// Tunable parameters of the classical evaluation. The defaults are the
+// hand-picked values; the `tune` tool fits them to game results and writes
+// them with save(), and the game loads them back at startup.
+struct EvalWeights {
+    float material = 1.0f;
+    float mobility = 0.02f;
+    float kingSafety = 0.05f;
+    float pawnStructure = 1.0f;
+    float centerControl = 0.5f;
+
+    // Pawn structure details, scaled by 'pawnStructure'
+    float pawnSupportBonus = PAWN_SUPPORT_BONUS;
+    float pawnUnsupportedPenalty = PAWN_UNSUPPORTED_PENALTY;
+    float doubledPawnPenalty = DOUBLED_PAWN_PENALTY;
+    float tripledPawnPenalty = TRIPLED_PAWN_PENALTY;
+
+    static constexpr int COUNT = 9;
+
+    // Parameters by index, in declaration order (used by the tuner)
+    float& operator[](int index);
+    float operator[](int index) const;
+    static const char* name(int index);
+
+    // Text file with one "name value" pair per line; '#' starts a comment.
+    // Names not present keep their current value. Throws std::runtime_error on
+    // unreadable files, unknown names or malformed values.
+    void load(const std::string& path);
+    void save(const std::string& path) const;
+};
+
+#endif // EVAL_WEIGHTS_H
@@ -2,21 +2,309 @@
 #include "core/Game.h"   // For Game and Board context
 #include "core/Board.h"
 #include "core/Piece.h"
+#include "core/AttackMap.h"
+#include "core/Zobrist.h"
+#include "ai/EvalTerms.h"
+#include "ai/KpkBitbase.h"
+#include "ai/nnue/NnueNetwork.h"
+#include "util/ThreadPool.h"
 #include <limits>     // For std::numeric_limits
 #include <algorithm>  // For std::sort, std::max, std::min
 #include <iostream>   // For debugging output
 #include <cmath>
+#include <mutex>
+#include <random>
+#include <stdexcept>
+#include <thread>
 
 const float INFINITY_SCORE = std::numeric_limits<float>::infinity();
 
+// Rough bound on what mobility + king safety can add with the default weights.
+// Larger values skip fewer evaluations; INFINITY_SCORE disables lazy exits.
+const float DEFAULT_LAZY_EVAL_MARGIN = 1.5f;
+
+// Nodes between two looks at the clock, node budget and stop signal
+const int LIMIT_CHECK_INTERVAL = 256;
+
+// Clock handling: moves assumed left when movestogo is not known, and the
+// time kept in reserve for GUI and process latency
+const int MOVES_TO_GO_GUESS = 30;
+const int MOVE_OVERHEAD_MS = 50;
+
+namespace {
+
+// Exact score of a king and pawn versus king position from the bitbase, from
+// White's point of view. False for any other material or board size.
+bool evaluateKpk(const Board& board, Color sideToMove, float& score) {
+    if (!board.hasBitboards() || popCount(board.getOccupied()) != 3) return false;
+    Bitboard whitePawns = board.getPieces(Color::WHITE, PieceType::PAWN);
+    Bitboard blackPawns = board.getPieces(Color::BLACK, PieceType::PAWN);
+    if (popCount(whitePawns | blackPawns) != 1) return false;
+
+    Color strongSide = whitePawns ? Color::WHITE : Color::BLACK;
+    Color weakSide = whitePawns ? Color::BLACK : Color::WHITE;
+    Bitboard strongKing = board.getPieces(strongSide, PieceType::KING);
+    Bitboard weakKing = board.getPieces(weakSide, PieceType::KING);
+    if (!strongKing || !weakKing) return false;
+
+    int pawn = lsb(whitePawns | blackPawns);
+    if ((pawn >> 3) == 0 || (pawn >> 3) == 7) return false;
+    if (!probeKpk(strongSide, lsb(strongKing), pawn, lsb(weakKing), sideToMove)) {
+        score = 0.0f;
+        return true;
+    }
+    int advance = strongSide == Color::WHITE ? (pawn >> 3) - 1 : 6 - (pawn >> 3); // 0 on the starting rank
+    float strongScore = KPK_WIN_SCORE + KPK_PAWN_RANK_BONUS * advance;
+    score = strongSide == Color::WHITE ? strongScore : -strongScore;
+    return true;
+}
+
+// Adds the nodes since the last check to the shared count and sets
+// context.stopped once any limit of analyze() has been reached
+void pollLimits(SearchContext& context) {
+    std::uint64_t nodes = 0;
+    if (context.nodeCount) {
+        nodes = context.nodeCount->fetch_add(context.nodesSinceCheck, std::memory_order_relaxed) + context.nodesSinceCheck;
+    }
+    context.nodesSinceCheck = 0;
+    if ((context.stopSignal && context.stopSignal->load(std::memory_order_relaxed)) ||
+        (context.nodeLimit > 0 && nodes >= context.nodeLimit) ||
+        (context.hasDeadline && std::chrono::steady_clock::now() >= context.deadline)) {
+        context.stopped = true;
+    }
+}
+
+// Puts the move of the followed line first among 'moves' while the search is
+// still on that line, and leaves it once the line ends or the move is missing
+void orderFollowedLine(SearchContext& context, std::vector<Move>& moves, int ply) {
+    if (!context.followingLine) return;
+    auto move = moves.end();
+    if (ply < static_cast<int>(context.followLine.size())) move = std::find(moves.begin(), moves.end(), context.followLine[ply]);
+    if (move == moves.end()) {
+        context.followingLine = false;
+        return;
+    }
+    std::rotate(moves.begin(), move, move + 1);
+}
+
+Color opposite(Color color) {
+    return (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+}
+
+// Fills context.keys with the positions the game went through since its last
+// capture or pawn move, replayed from the start FEN, then the root's, and
+// makes room for a search of 'maxPly' plies. Only the standard board has Zobrist keys.
+void initKeyStack(SearchContext& context, const Game& game, int maxPly) {
+    context.keys.clear();
+    context.rootIndex = 0;
+    if (!game.getBoard().hasBitboards()) return;
+
+    const std::vector<Move>& history = game.getMoveHistory();
+    std::size_t reversible = std::min(history.size(), static_cast<std::size_t>(std::max(0, game.getHalfMoveClock())));
+    if (reversible > 0) {
+        Board board;
+        board.initializeCustomSetup(game.getStartFen());
+        Color side = (history.size() % 2 == 0) ? game.getCurrentPlayerColor() : opposite(game.getCurrentPlayerColor());
+        for (std::size_t i = 0; i < history.size(); ++i) {
+            if (i >= history.size() - reversible) context.keys.push_back(zobristKey(board, side));
+            board.applyMove(history[i]);
+            side = opposite(side);
+        }
+    }
+    context.rootIndex = static_cast<int>(context.keys.size());
+    context.keys.push_back(zobristKey(game.getBoard(), game.getCurrentPlayerColor()));
+    context.keys.resize(context.rootIndex + maxPly + 1);
+}
+
+// Records the key of the position at 'ply' and tells whether it already
+// occurred since the last irreversible move, on the path or before the root.
+// Only every other ply can hold the same side to move, and the nearest
+// candidate is four plies back. One repetition is enough for a draw: if
+// repeating is good for one side, it can repeat again.
+bool isRepetition(SearchContext& context, const Game& game, int ply) {
+    if (context.keys.empty()) return false;
+    int index = context.rootIndex + ply;
+    std::uint64_t key = zobristKey(game.getBoard(), game.getCurrentPlayerColor());
+    context.keys[index] = key;
+    if (ply == 0) return false; // The root needs a move; the game itself judges threefold repetition
+
+    int limit = std::min(game.getHalfMoveClock(), index);
+    for (int back = 4; back <= limit; back += 2) {
+        if (context.keys[index - back] == key) return true;
+    }
+    return false;
+}
+
+// Randomness for weighted book moves; per thread, since one engine may serve several games at once
+std::uint64_t bookRandom() {
+    thread_local std::mt19937_64 generator(std::random_device{}());
+    return generator();
+}
+
+} // namespace
+
+void PrincipalVariationTable::resize(int maxPly) {
+    rows = maxPly + 1;
+    moves.assign(rowStart(rows), Move(Position(-1, -1), Position(-1, -1)));
+    lengths.assign(rows, 0);
+}
+
+void PrincipalVariationTable::update(int ply, const Move& move) {
+    std::size_t row = rowStart(ply);
+    std::size_t childRow = rowStart(ply + 1);
+    moves[row] = move;
+    for (int i = 0; i < lengths[ply + 1]; ++i) {
+        moves[row + 1 + i] = moves[childRow + i];
+    }
+    lengths[ply] = lengths[ply + 1] + 1;
+}
+
+std::vector<Move> PrincipalVariationTable::line(int ply) const {
+    auto row = moves.begin() + rowStart(ply);
+    return std::vector<Move>(row, row + lengths[ply]);
+}
+
+std::vector<Move> continueLine(const std::vector<Move>& principalVariation, const Move& ourMove, const Move& theirMove) {
+    if (principalVariation.size() < 3 || !(principalVariation[0] == ourMove) || !(principalVariation[1] == theirMove)) return {};
+    return std::vector<Move>(principalVariation.begin() + 2, principalVariation.end());
+}
+
+bool ponderMove(const EvaluationResult& result, Move& out) {
+    if (result.principalVariation.size() < 2) return false;
+    out = result.principalVariation[1];
+    return true;
+}
+
 EvaluationEngine::EvaluationEngine()
-    : materialWeight(1.0f), mobilityWeight(0.02f), kingSafetyWeight(0.05f),
-      pawnStructureWeight(1.0f), centerControlWeight(0.5f) {
+    : lazyEvalMargin(DEFAULT_LAZY_EVAL_MARGIN), evaluatorType(EvaluatorType::CLASSICAL), bookSelection(BookSelection::WEIGHTED),
+      bookMaxPly(DEFAULT_BOOK_MAX_PLY) {
 }
 
 EvaluationEngine::EvaluationEngine(float materialWeight, float mobilityWeight, float kingSafetyWeight, float pawnStructureWeight, float centerControlWeight)
-    : materialWeight(materialWeight), mobilityWeight(mobilityWeight), kingSafetyWeight(kingSafetyWeight),
-      pawnStructureWeight(pawnStructureWeight), centerControlWeight(centerControlWeight) {
+    : lazyEvalMargin(DEFAULT_LAZY_EVAL_MARGIN), evaluatorType(EvaluatorType::CLASSICAL), bookSelection(BookSelection::WEIGHTED),
+      bookMaxPly(DEFAULT_BOOK_MAX_PLY) {
+    weights.material = materialWeight;
+    weights.mobility = mobilityWeight;
+    weights.kingSafety = kingSafetyWeight;
+    weights.pawnStructure = pawnStructureWeight;
+    weights.centerControl = centerControlWeight;
+}
+
+EvaluationEngine::EvaluationEngine(const EvalWeights& weights)
+    : weights(weights), lazyEvalMargin(DEFAULT_LAZY_EVAL_MARGIN), evaluatorType(EvaluatorType::CLASSICAL),
+      bookSelection(BookSelection::WEIGHTED), bookMaxPly(DEFAULT_BOOK_MAX_PLY) {
+}
+
+const EvalWeights& EvaluationEngine::getWeights() const {
+    return weights;
+}
+
+void EvaluationEngine::setWeights(const EvalWeights& newWeights) {
+    weights = newWeights;
+}
+
+void EvaluationEngine::loadWeights(const std::string& path) {
+    weights.load(path);
+}
+
+void EvaluationEngine::loadNetwork(const std::string& path) {
+    nnueNetwork = NnueNetwork::load(path);
+    evaluatorType = EvaluatorType::NNUE;
+}
+
+void EvaluationEngine::setEvaluatorType(EvaluatorType type) {
+    if (type == EvaluatorType::NNUE && !nnueNetwork) {
+        throw std::runtime_error("NNUE evaluator selected but no network is loaded.");
+    }
+    evaluatorType = type;
+}
+
+EvaluatorType EvaluationEngine::getEvaluatorType() const {
+    return evaluatorType;
+}
+
+void EvaluationEngine::loadBook(const std::string& path) {
+    openingBook = std::make_shared<const OpeningBook>(path);
+}
+
+void EvaluationEngine::clearBook() {
+    openingBook.reset();
+}
+
+bool EvaluationEngine::hasBook() const {
+    return openingBook != nullptr;
+}
+
+void EvaluationEngine::setBookOptions(BookSelection selection, int maxPly) {
+    bookSelection = selection;
+    bookMaxPly = maxPly;
+}
+
+bool EvaluationEngine::probeBook(const Game& game, Move& out) const {
+    if (!openingBook || !game.getBoard().hasBitboards()) return false;
+    int ply = (game.getFullMoveCounter() - 1) * 2 + (game.getCurrentPlayerColor() == Color::BLACK ? 1 : 0);
+    if (ply >= bookMaxPly) return false;
+    return openingBook->pickMove(game, bookSelection, bookRandom(), out);
+}
+
+void EvaluationEngine::loadTablebases(const std::string& paths) {
+    auto tables = std::make_shared<const SyzygyTablebase>(paths);
+    if (tables->getTableCount() == 0) {
+        throw std::runtime_error("No Syzygy tables found in " + paths);
+    }
+    tablebase = tables;
+}
+
+void EvaluationEngine::clearTablebases() {
+    tablebase.reset();
+}
+
+bool EvaluationEngine::hasTablebases() const {
+    return tablebase != nullptr;
+}
+
+void EvaluationEngine::loadEndgameTables(const std::string& directory) {
+    endgameTables = std::make_shared<const EndgameTablebase>(directory);
+}
+
+void EvaluationEngine::clearEndgameTables() {
+    endgameTables.reset();
+}
+
+bool EvaluationEngine::hasEndgameTables() const {
+    return endgameTables != nullptr;
+}
+
+bool EvaluationEngine::probeTablebases(const Game& game, int ply, float& score) const {
+    const Board& board = game.getBoard();
+    Color side = game.getCurrentPlayerColor();
+    float sideScore = 0.0f;
+    Wdl wdl;
+    EndgameResult endgame;
+    if (tablebase && board.hasBitboards() && tablebase->probeWdl(board, side, wdl)) {
+        if (wdl == Wdl::WIN) sideScore = TABLEBASE_WIN_SCORE - ply;
+        else if (wdl == Wdl::LOSS) sideScore = -(TABLEBASE_WIN_SCORE - ply);
+    } else if (endgameTables && endgameTables->probe(board, side, endgame)) {
+        // Counted to the mate, so of two won positions the quicker mate scores higher
+        int plies = ply + std::max(endgame.matePlies, 0);
+        if (endgame.wdl == Wdl::WIN) sideScore = TABLEBASE_WIN_SCORE - plies;
+        else if (endgame.wdl == Wdl::LOSS) sideScore = -(TABLEBASE_WIN_SCORE - plies);
+    } else {
+        return false;
+    }
+    score = side == Color::WHITE ? sideScore : -sideScore;
+    return true;
+}
+
+bool EvaluationEngine::probeTablebaseRoot(const Game& game, EvaluationResult& out) const {
+    if (!tablebase || !game.getBoard().hasBitboards()) return false;
+    Wdl wdl;
+    if (!tablebase->probeRoot(game, out.bestMove, wdl)) return false;
+    // Cursed wins and blessed losses are draws under the 50-move rule
+    float score = wdl == Wdl::WIN ? TABLEBASE_WIN_SCORE : wdl == Wdl::LOSS ? -TABLEBASE_WIN_SCORE : 0.0f;
+    out.score = game.getCurrentPlayerColor() == Color::WHITE ? score : -score;
+    out.nodesSearched = 0;
+    return true;
 }
 
 // Basic move ordering: captures first, then checks, then others.
@@ -41,7 +329,71 @@ std::vector<Move> EvaluationEngine::orderMoves(const std::vector<Move>& moves, c
 }
 
 
+// Squares attacked by knights, bishops, rooks and queens that are neither
+// occupied by own pieces nor covered by enemy pawns.
+int EvaluationEngine::mobility(const AttackMap& attackMap, Color side) {
+    Color enemy = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    Bitboard mobilityArea = ~attackMap.getOccupancy(side) & ~attackMap.getAttacks(enemy, PieceType::PAWN);
+
+    int count = 0;
+    const AttackMap::PieceAttacks* pieces = attackMap.getPieceAttacks();
+    for (int i = 0; i < attackMap.getPieceCount(); ++i) {
+        const AttackMap::PieceAttacks& p = pieces[i];
+        if (p.color != side || p.type == PieceType::PAWN || p.type == PieceType::KING) continue;
+        count += popCount(p.attacks & mobilityArea);
+    }
+    return count;
+}
+
+// Weighted enemy attacks on the squares around 'side's king
+float EvaluationEngine::kingDanger(const AttackMap& attackMap, Color side) {
+    Color enemy = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    Bitboard zone = attackMap.getKingZone(side);
+
+    int attackers = 0;
+    int attackUnits = 0;
+    const AttackMap::PieceAttacks* pieces = attackMap.getPieceAttacks();
+    for (int i = 0; i < attackMap.getPieceCount(); ++i) {
+        const AttackMap::PieceAttacks& p = pieces[i];
+        if (p.color != enemy) continue;
+        Bitboard zoneHits = p.attacks & zone;
+        if (!zoneHits || KING_ATTACK_WEIGHT[static_cast<int>(p.type)] == 0) continue;
+        attackers++;
+        attackUnits += KING_ATTACK_WEIGHT[static_cast<int>(p.type)] * popCount(zoneHits);
+    }
+    return attackUnits * KING_ATTACKER_SCALE[std::min(attackers, 7)];
+}
+
+MateResult EvaluationEngine::findMate(const Game& game, const MateSearchLimits& limits, std::size_t hashMegabytes) const {
+    MateSolver solver(hashMegabytes);
+    return solver.solve(game, limits);
+}
+
 float EvaluationEngine::staticEvaluate(const Board& board, Color perspective, const bool report) const {
+    return evaluateStaged(board, perspective, -INFINITY_SCORE, INFINITY_SCORE, nullptr, report);
+}
+
+float EvaluationEngine::lazyEvaluate(const Board& board, Color perspective, float alpha, float beta, SearchStats* stats) const {
+    return evaluateStaged(board, perspective, alpha, beta, stats, false);
+}
+
+// Terms are computed cheapest first. After the cheap stage (material, center
+// control, pawn structure) the partial score is compared against the caller's
+// window: if it is outside by more than lazyEvalMargin, the expensive terms
+// (mobility, king safety) cannot bring it back and are skipped.
+// alpha/beta and the returned score are from White's point of view, like the search.
+float EvaluationEngine::evaluateStaged(const Board& board, Color perspective, float alpha, float beta,
+                                       SearchStats* stats, bool report) const {
+    // King and pawn versus king: the bitbase knows the result, but the board
+    // does not say who is to move. Positions with the same result either way
+    // are scored from it (evaluate() handles the rest when the side is known).
+    float kpkScore, kpkOtherScore;
+    if (evaluateKpk(board, Color::WHITE, kpkScore) && evaluateKpk(board, Color::BLACK, kpkOtherScore) &&
+        kpkScore == kpkOtherScore) {
+        if (report) std::cout << "Static evaluation score: " << kpkScore << " (KPK bitbase)" << std::endl;
+        return kpkScore;
+    }
+
     float allyMaterial = 0.0f;
     float enemyMaterial = 0.0f;
 
@@ -59,36 +411,23 @@ float EvaluationEngine::staticEvaluate(const Board& board, Color perspective, co
 
     BoardDimensions dimensions = board.getDimensions();
 
-    std::vector<std::vector<float>> centerControlMap = {
-        {0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f},
-        {0.8f, 1.0f, 1.2f, 1.4f, 1.4f, 1.2f, 1.0f, 0.8f},
-        {0.8f, 1.2f, 1.4f, 1.6f, 1.6f, 1.4f, 1.2f, 0.8f},
-        {0.8f, 1.2f, 1.4f, 1.8f, 1.8f, 1.4f, 1.2f, 0.8f},
-        {0.8f, 1.2f, 1.4f, 1.8f, 1.8f, 1.4f, 1.2f, 0.8f},
-        {0.8f, 1.2f, 1.4f, 1.6f, 1.6f, 1.4f, 1.2f, 0.8f},
-        {0.8f, 1.0f, 1.2f, 1.4f, 1.4f, 1.2f, 1.0f, 0.8f},
-        {0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f, 0.8f}
-    };
+    if (stats) stats->evaluations++;
 
+    // --- Stage 1: cheap terms ---
 
     for (int r = 0; r < dimensions.rows; ++r) {
         for (int c = 0; c < dimensions.cols; ++c) {
             const Piece* piece = board.getPieceAt(Position(r, c));
             if (!piece) continue;
-            int moveCount = static_cast<int>(piece->getPossibleMoves(board).size());
 
-            float centerScore = centerControlMap[r][c];
+            float centerScore = (r < 8 && c < 8) ? CENTER_CONTROL_MAP[r][c] : 0.8f;
             if (piece->getColor() == perspective) {
                 allyMaterial += piece->getValue();
-                allyMobilityScore += moveCount;
                 allyCenterControlScore += centerScore; 
-                
             } else {
                 enemyMaterial += piece->getValue();
-                enemyMobilityScore += moveCount;
                 enemyCenterControlScore += centerScore;
             }
-            
         }
     }
 
@@ -119,96 +458,473 @@ float EvaluationEngine::staticEvaluate(const Board& board, Color perspective, co
 
             if (piece->getColor() == perspective) {
                 allyPawnCount++;
-                bottomLeftPiece && bottomLeftPiece->getType() == PieceType::PAWN ? allyPawnStructureScore += 0.05f : allyPawnStructureScore -=0.025f;
-                bottomRightPiece && bottomRightPiece->getType() == PieceType::PAWN ? allyPawnStructureScore += 0.05f : allyPawnStructureScore -=0.025f;
+                bottomLeftPiece && bottomLeftPiece->getType() == PieceType::PAWN ? allyPawnStructureScore += weights.pawnSupportBonus : allyPawnStructureScore -= weights.pawnUnsupportedPenalty;
+                bottomRightPiece && bottomRightPiece->getType() == PieceType::PAWN ? allyPawnStructureScore += weights.pawnSupportBonus : allyPawnStructureScore -= weights.pawnUnsupportedPenalty;
             }
             else {
                 enemyPawnCount++;
-                bottomLeftPiece && bottomLeftPiece->getType() == PieceType::PAWN ? enemyPawnStructureScore += 0.05f : enemyPawnStructureScore -= 0.025f;
-                bottomRightPiece && bottomRightPiece->getType() == PieceType::PAWN ? enemyPawnStructureScore += 0.05f : enemyPawnStructureScore -= 0.025f;
+                bottomLeftPiece && bottomLeftPiece->getType() == PieceType::PAWN ? enemyPawnStructureScore += weights.pawnSupportBonus : enemyPawnStructureScore -= weights.pawnUnsupportedPenalty;
+                bottomRightPiece && bottomRightPiece->getType() == PieceType::PAWN ? enemyPawnStructureScore += weights.pawnSupportBonus : enemyPawnStructureScore -= weights.pawnUnsupportedPenalty;
             }            
         }
 
-        if (allyPawnCount == 2) allyPawnStructureScore -=0.1f;
-        else if (allyPawnCount == 3) allyPawnStructureScore -= 0.25f;
+        if (allyPawnCount == 2) allyPawnStructureScore -= weights.doubledPawnPenalty;
+        else if (allyPawnCount == 3) allyPawnStructureScore -= weights.tripledPawnPenalty;
 
-        if (enemyPawnCount == 2) enemyPawnStructureScore -=0.1f;
-        else if (enemyPawnCount == 3) enemyPawnStructureScore -= 0.25f;
+        if (enemyPawnCount == 2) enemyPawnStructureScore -= weights.doubledPawnPenalty;
+        else if (enemyPawnCount == 3) enemyPawnStructureScore -= weights.tripledPawnPenalty;
     }
 
     // score isolated pawns
 
+    float materialScore = weights.material * (allyMaterial - enemyMaterial);
+    float pawnStructureScore = weights.pawnStructure * (allyPawnStructureScore - enemyPawnStructureScore);
+    float centerControlScore = weights.centerControl * (allyCenterControlScore - enemyCenterControlScore); 
 
+    float cheapScore = materialScore + pawnStructureScore + centerControlScore;
+    float cheapScoreWhite = (perspective == Color::WHITE) ? cheapScore : -cheapScore;
 
-    Position allyKingPos = board.findKing(perspective);
-    Position enemyKingPos = board.findKing(perspective == Color::WHITE ? Color::BLACK : Color::WHITE);
+    if (!report && (cheapScoreWhite + lazyEvalMargin <= alpha || cheapScoreWhite - lazyEvalMargin >= beta)) {
+        if (stats) stats->lazyExits++;
+        return cheapScoreWhite;
+    }
 
-    if (perspective == Color::WHITE) {
-        for (int r = allyKingPos.row; r >= 0; --r) {
-            const Piece* allyFilePiece = board.getPieceAt(Position(r, allyKingPos.col));
-            if (allyFilePiece) allyKingSafetyScore += (allyFilePiece->getColor() == perspective ? 1 : 0);
-        }
-        for (int r = enemyKingPos.row; r < dimensions.rows; ++r) {
-            const Piece* enemyFilePiece = board.getPieceAt(Position(r, enemyKingPos.col));
-            if (enemyFilePiece) enemyKingSafetyScore += (enemyFilePiece->getColor() != perspective ? 1 : 0);
-        }
+    // --- Stage 2: expensive terms ---
+
+    if (board.hasBitboards()) {
+        // One attack map per evaluation feeds both mobility and king safety
+        AttackMap attackMap(board);
+        Color enemy = (perspective == Color::WHITE) ? Color::BLACK : Color::WHITE;
+        allyMobilityScore = static_cast<float>(mobility(attackMap, perspective));
+        enemyMobilityScore = static_cast<float>(mobility(attackMap, enemy));
+        allyKingSafetyScore = -kingDanger(attackMap, perspective);
+        enemyKingSafetyScore = -kingDanger(attackMap, enemy);
     } else {
-        for (int r = enemyKingPos.row; r >= 0; --r) {
-            const Piece* enemyFilePiece = board.getPieceAt(Position(r, allyKingPos.col));
-            if (enemyFilePiece) allyKingSafetyScore += (enemyFilePiece->getColor() != perspective ? 1 : 0);
+        // Custom board sizes have no bitboards: count pseudo-legal moves and file cover instead
+        for (int r = 0; r < dimensions.rows; ++r) {
+            for (int c = 0; c < dimensions.cols; ++c) {
+                const Piece* piece = board.getPieceAt(Position(r, c));
+                if (!piece) continue;
+                int moveCount = static_cast<int>(piece->getPossibleMoves(board).size());
+                if (piece->getColor() == perspective) {
+                    allyMobilityScore += moveCount;
+                } else {
+                    enemyMobilityScore += moveCount;
+                }
+            }
         }
-        for (int r = allyKingPos.row; r < dimensions.rows; ++r) {
-            const Piece* allyFilePiece = board.getPieceAt(Position(r, allyKingPos.col));
-            if (allyFilePiece) enemyKingSafetyScore += (allyFilePiece->getColor() == perspective ? 1 : 0);
+
+        Position allyKingPos = board.findKing(perspective);
+        Position enemyKingPos = board.findKing(perspective == Color::WHITE ? Color::BLACK : Color::WHITE);
+
+        if (perspective == Color::WHITE) {
+            for (int r = allyKingPos.row; r >= 0; --r) {
+                const Piece* allyFilePiece = board.getPieceAt(Position(r, allyKingPos.col));
+                if (allyFilePiece) allyKingSafetyScore += (allyFilePiece->getColor() == perspective ? 1 : 0);
+            }
+            for (int r = enemyKingPos.row; r < dimensions.rows; ++r) {
+                const Piece* enemyFilePiece = board.getPieceAt(Position(r, enemyKingPos.col));
+                if (enemyFilePiece) enemyKingSafetyScore += (enemyFilePiece->getColor() != perspective ? 1 : 0);
+            }
+        } else {
+            for (int r = enemyKingPos.row; r >= 0; --r) {
+                const Piece* enemyFilePiece = board.getPieceAt(Position(r, allyKingPos.col));
+                if (enemyFilePiece) allyKingSafetyScore += (enemyFilePiece->getColor() != perspective ? 1 : 0);
+            }
+            for (int r = allyKingPos.row; r < dimensions.rows; ++r) {
+                const Piece* allyFilePiece = board.getPieceAt(Position(r, allyKingPos.col));
+                if (allyFilePiece) enemyKingSafetyScore += (allyFilePiece->getColor() == perspective ? 1 : 0);
+            }
         }
     }
 
-    
-    
-    float materialScore = materialWeight * (allyMaterial - enemyMaterial);
-    float pawnStructureScore = pawnStructureWeight * (allyPawnStructureScore - enemyPawnStructureScore);
-    float centerControlScore = centerControlWeight * (allyCenterControlScore - enemyCenterControlScore); 
-    float kingSafetyScore = kingSafetyWeight * (allyKingSafetyScore - enemyKingSafetyScore);
-    float mobilityScore = mobilityWeight * (allyMobilityScore - enemyMobilityScore);
+    float kingSafetyScore = weights.kingSafety * (allyKingSafetyScore - enemyKingSafetyScore);
+    float mobilityScore = weights.mobility * (allyMobilityScore - enemyMobilityScore);
 
-    float score = materialScore + pawnStructureScore + centerControlScore + kingSafetyScore + mobilityScore;
+    float score = cheapScore + kingSafetyScore + mobilityScore;
 
     if (report) {
         auto round3 = [](float val) { return std::round(val * 1000.0f) / 1000.0f; };
         std::cout << "Static evaluation score: " << round3(score) << std::endl;
-        std::cout << "  Material: " << round3(materialScore) << " | (WGT=" << materialWeight << ")" << std::endl;
-        std::cout << "  Pawn structure: " << round3(pawnStructureScore) << " | (WGT=" << pawnStructureWeight << ")" << std::endl;
-        std::cout << "  Center control: " << round3(centerControlScore) << " | (WGT=" << centerControlWeight << ")" << std::endl;
-        std::cout << "  King safety: " << round3(kingSafetyScore) << " | (WGT=" << kingSafetyWeight << ")" << std::endl;
-        std::cout << "  Mobility: " << round3(mobilityScore) << " | (WGT=" << mobilityWeight << ")" << std::endl;
+        std::cout << "  Material: " << round3(materialScore) << " | (WGT=" << weights.material << ")" << std::endl;
+        std::cout << "  Pawn structure: " << round3(pawnStructureScore) << " | (WGT=" << weights.pawnStructure << ")" << std::endl;
+        std::cout << "  Center control: " << round3(centerControlScore) << " | (WGT=" << weights.centerControl << ")" << std::endl;
+        std::cout << "  King safety: " << round3(kingSafetyScore) << " | (WGT=" << weights.kingSafety << ")" << std::endl;
+        std::cout << "  Mobility: " << round3(mobilityScore) << " | (WGT=" << weights.mobility << ")" << std::endl;
     }
     
     // Adjust score based on perspective
     return (perspective == Color::WHITE) ? score : -score;
-;
 }
 
+void EvaluationEngine::setLazyEvalMargin(float margin) {
+    lazyEvalMargin = margin;
+}
+
+float EvaluationEngine::getLazyEvalMargin() const {
+    return lazyEvalMargin;
+}
+
+void EvaluationEngine::getFeatureWeights(float featureWeights[EVAL_FEATURE_COUNT]) const {
+    for (int t = 0; t < 6; ++t) {
+        featureWeights[EVAL_PAWNS + t] = weights.material * PIECE_VALUES[t];
+    }
+    for (int k = 0; k < CENTER_RING_COUNT; ++k) {
+        featureWeights[EVAL_CENTER_RING + k] = weights.centerControl * CENTER_RING_VALUES[k];
+    }
+    featureWeights[EVAL_PAWN_SUPPORTED] = weights.pawnStructure * weights.pawnSupportBonus;
+    featureWeights[EVAL_PAWN_UNSUPPORTED] = -weights.pawnStructure * weights.pawnUnsupportedPenalty;
+    featureWeights[EVAL_DOUBLED_PAWNS] = -weights.pawnStructure * weights.doubledPawnPenalty;
+    featureWeights[EVAL_TRIPLED_PAWNS] = -weights.pawnStructure * weights.tripledPawnPenalty;
+    featureWeights[EVAL_MOBILITY] = weights.mobility;
+    featureWeights[EVAL_KING_DANGER] = -weights.kingSafety; // King safety is minus the danger
+}
+
+// Below this many positions per worker, thread start-up costs more than it saves
+const std::size_t MIN_BATCH_PER_THREAD = 16384;
+
+static void evaluateBatchRange(const PackedPosition* positions, std::size_t count, std::int16_t* scores,
+                               const float featureWeights[EVAL_FEATURE_COUNT]) {
+    // ~11 KB of scratch per worker, reused for every block
+    std::unique_ptr<PositionBlock> block = std::make_unique<PositionBlock>();
+    std::unique_ptr<FeatureBlock> features = std::make_unique<FeatureBlock>();
+    float blockScores[BATCH_BLOCK_SIZE];
+
+    for (std::size_t start = 0; start < count; start += BATCH_BLOCK_SIZE) {
+        int n = static_cast<int>(std::min<std::size_t>(BATCH_BLOCK_SIZE, count - start));
+        unpackPositionBlock(positions + start, n, *block);
+        computeEvalFeatures(*block, *features);
+        scoreFeatureBlock(*features, featureWeights, n, blockScores);
+        for (int i = 0; i < n; ++i) {
+            float centipawns = std::round(blockScores[i] * 100.0f);
+            scores[start + i] = static_cast<std::int16_t>(std::clamp(centipawns, -32767.0f, 32767.0f));
+        }
+    }
+}
+
+void EvaluationEngine::evaluateBatch(const PackedPosition* positions, std::size_t count, std::int16_t* scores, int threads) const {
+    float featureWeights[EVAL_FEATURE_COUNT];
+    getFeatureWeights(featureWeights);
+
+    std::size_t workers = threads > 0 ? static_cast<std::size_t>(threads)
+                                      : std::max(1u, std::thread::hardware_concurrency());
+    workers = std::min(workers, std::max<std::size_t>(1, count / MIN_BATCH_PER_THREAD));
+    if (workers <= 1) {
+        evaluateBatchRange(positions, count, scores, featureWeights);
+        return;
+    }
+
+    // Contiguous, block-aligned slices; the calling thread takes the last one
+    std::size_t slice = (count + workers - 1) / workers;
+    slice = (slice + BATCH_BLOCK_SIZE - 1) / BATCH_BLOCK_SIZE * BATCH_BLOCK_SIZE;
+    std::vector<std::thread> pool;
+    std::size_t start = 0;
+    for (; start + slice < count; start += slice) {
+        pool.emplace_back(evaluateBatchRange, positions + start, slice, scores + start, featureWeights);
+    }
+    evaluateBatchRange(positions + start, count - start, scores + start, featureWeights);
+    for (std::thread& worker : pool) {
+        worker.join();
+    }
+}
+
+int allocateMoveTime(long long remainingMs, long long incrementMs, int movesToGo) {
+    int moves = movesToGo > 0 ? movesToGo : MOVES_TO_GO_GUESS;
+    long long budget = remainingMs / moves + incrementMs * 3 / 4;
+    budget = std::min(budget, remainingMs - MOVE_OVERHEAD_MS);
+    return static_cast<int>(std::max(1LL, budget));
+}
+
+EvaluationResult EvaluationEngine::analyze(const Game& game, const SearchLimits& limits, const AnalysisCallback& onIteration) const {
+    bool bounded = limits.depth > 0 || limits.moveTimeMs > 0 || limits.nodes > 0 || limits.infinite;
+    int maxDepth = (limits.depth > 0) ? std::min(limits.depth, MAX_ANALYSIS_DEPTH) : MAX_ANALYSIS_DEPTH;
+    if (!bounded) maxDepth = 1; // No limit given: one ply
+    int lineCount = std::max(1, limits.multiPv);
+
+    if (!limits.infinite && lineCount == 1) {
+        EvaluationResult bookResult;
+        if (probeBook(game, bookResult.bestMove)) {
+            bookResult.principalVariation.push_back(bookResult.bestMove);
+            if (onIteration) onIteration(1, bookResult);
+            return bookResult;
+        }
+    }
+
+    EvaluationResult tablebaseResult;
+    if (lineCount == 1 && probeTablebaseRoot(game, tablebaseResult)) {
+        tablebaseResult.principalVariation.push_back(tablebaseResult.bestMove);
+        if (onIteration) onIteration(1, tablebaseResult);
+        return tablebaseResult;
+    }
+
+    Color playerToMove = game.getCurrentPlayerColor();
+    bool isWhiteToMove = (playerToMove == Color::WHITE);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.moveTimeMs);
+    std::atomic<std::uint64_t> nodeCount{0};
+
+    SearchContext context;
+    BoardDimensions dims = game.getBoard().getDimensions();
+    context.useNnue = evaluatorType == EvaluatorType::NNUE && nnueNetwork && dims.rows == 8 && dims.cols == 8;
+    if (context.useNnue) {
+        context.accumulators.resize(maxDepth + 1);
+        context.accumulators[0].refresh(game.getBoard(), *nnueNetwork);
+    }
+    context.hasDeadline = limits.moveTimeMs > 0;
+    context.deadline = deadline;
+    context.nodeLimit = limits.nodes;
+    context.nodeCount = &nodeCount;
+    context.stopSignal = limits.stopSignal;
+    context.pv.resize(maxDepth);
+    initKeyStack(context, game, maxDepth);
+
+    std::unique_ptr<ThreadPool> pool;
+    if (limits.threads > 1) pool = std::make_unique<ThreadPool>(limits.threads);
+
+    EvaluationResult best;
+    int totalNodes = 0;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        context.checkLimits = depth > 1;
+        nodeCount.store(static_cast<std::uint64_t>(totalNodes), std::memory_order_relaxed);
+        // Each iteration first follows the line the previous one settled on
+        context.followLine = best.principalVariation.empty() ? limits.expectedLine : best.principalVariation;
+        context.followingLine = !context.followLine.empty();
+        EvaluationResult result;
+        if (lineCount > 1) {
+            result = searchRootMultiPv(game, depth, lineCount, best.lines, depth > 1 ? pool.get() : nullptr, context);
+        } else if (pool && depth > 1) {
+            result = searchRootParallel(game, depth, best.bestMove, *pool, context);
+        } else {
+            result = search(game.clone(), depth, -INFINITY_SCORE, INFINITY_SCORE, isWhiteToMove, playerToMove, context, 0);
+        }
+        totalNodes += result.nodesSearched;
+        if (context.stopped) break;
+
+        best = result;
+        best.nodesSearched = totalNodes;
+        if (onIteration) onIteration(depth, best);
+        if (limits.moveTimeMs > 0 && std::chrono::steady_clock::now() >= deadline) break;
+        if (limits.nodes > 0 && static_cast<std::uint64_t>(totalNodes) >= limits.nodes) break;
+        if (limits.stopSignal && limits.stopSignal->load(std::memory_order_relaxed)) break;
+        if (!best.bestMove.from.isValid()) break; // Mate or stalemate: deeper is no different
+    }
+    best.nodesSearched = totalNodes;
+    return best;
+}
+
+EvaluationResult EvaluationEngine::searchRootParallel(const Game& game, int depth, const Move& previousBest, ThreadPool& pool,
+                                                      SearchContext& context) const {
+    Color playerToMove = game.getCurrentPlayerColor();
+    bool isWhiteToMove = (playerToMove == Color::WHITE);
+    std::vector<Move> legalMoves = game.getLegalMoves();
+    if (legalMoves.size() < 2 || game.getHalfMoveClock() == 100 || game.getGameStateCount() >= 3) {
+        // Nothing to share out; search() also scores the game-over cases
+        return search(game.clone(), depth, -INFINITY_SCORE, INFINITY_SCORE, isWhiteToMove, playerToMove, context, 0);
+    }
+    legalMoves = orderMoves(legalMoves, game.getBoard());
+    auto previous = std::find(legalMoves.begin(), legalMoves.end(), previousBest);
+    if (previous != legalMoves.end()) std::rotate(legalMoves.begin(), previous, previous + 1);
+    orderFollowedLine(context, legalMoves, 0);
+
+    // The move followed by the line its search leaves in the worker's table
+    auto searchMove = [&](const Move& move, SearchContext& moveContext, float alpha, float beta, std::vector<Move>& line) {
+        Game nextGameState = game.afterMove(move);
+        updateAccumulator(moveContext, 0, game, move, nextGameState);
+        EvaluationResult result = search(std::move(nextGameState), depth - 1, alpha, beta, !isWhiteToMove, playerToMove, moveContext, 1);
+        line = moveContext.pv.line(1);
+        line.insert(line.begin(), move);
+        return result;
+    };
+
+    EvaluationResult best;
+    best.nodesSearched = 1;
+    EvaluationResult first = searchMove(legalMoves[0], context, -INFINITY_SCORE, INFINITY_SCORE, best.principalVariation);
+    context.followingLine = false;
+    best.nodesSearched += first.nodesSearched;
+    if (context.stopped) return best;
+    best.score = first.score;
+    best.bestMove = legalMoves[0];
+
+    // Every other move only has to be proven better than the best so far, so it
+    // is searched with that score as alpha (beta for Black). Each worker copies
+    // the root context for its own NNUE accumulators and stop flag.
+    std::mutex bestMutex;
+    std::atomic<int> nodes{0};
+    std::atomic<bool> stopped{false};
+    pool.parallelFor(legalMoves.size() - 1, [&](std::size_t i) {
+        const Move& move = legalMoves[i + 1];
+        SearchContext moveContext = context;
+        float bound;
+        {
+            std::lock_guard<std::mutex> lock(bestMutex);
+            bound = best.score;
+        }
+        std::vector<Move> line;
+        EvaluationResult result = isWhiteToMove ? searchMove(move, moveContext, bound, INFINITY_SCORE, line)
+                                                : searchMove(move, moveContext, -INFINITY_SCORE, bound, line);
+        nodes += result.nodesSearched;
+        if (moveContext.stopped) {
+            stopped = true;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(bestMutex);
+        if (isWhiteToMove ? result.score > best.score : result.score < best.score) {
+            best.score = result.score;
+            best.bestMove = move;
+            best.principalVariation = std::move(line);
+        }
+    });
+
+    best.nodesSearched += nodes;
+    if (stopped) context.stopped = true;
+    return best;
+}
+
+EvaluationResult EvaluationEngine::searchRootMultiPv(const Game& game, int depth, int lineCount, const std::vector<AnalysisLine>& previousLines,
+                                                     ThreadPool* pool, SearchContext& context) const {
+    Color playerToMove = game.getCurrentPlayerColor();
+    bool isWhiteToMove = (playerToMove == Color::WHITE);
+    std::vector<Move> legalMoves = game.getLegalMoves();
+    if (legalMoves.empty() || game.getHalfMoveClock() == 100 || game.getGameStateCount() >= 3) {
+        // Game over: search() scores it, and there are no lines to report
+        return search(game.clone(), depth, -INFINITY_SCORE, INFINITY_SCORE, isWhiteToMove, playerToMove, context, 0);
+    }
+    legalMoves = orderMoves(legalMoves, game.getBoard());
+    auto front = legalMoves.begin();
+    for (const AnalysisLine& line : previousLines) {
+        auto previous = std::find(front, legalMoves.end(), line.move);
+        if (previous == legalMoves.end()) continue;
+        std::rotate(front, previous, previous + 1);
+        ++front;
+    }
+    orderFollowedLine(context, legalMoves, 0);
 
-EvaluationResult EvaluationEngine::search(Game game, int depth, float alpha, float beta, bool isMaximizingTurn, Color originalPlayerColor) const {
+    std::size_t wanted = std::min(static_cast<std::size_t>(lineCount), legalMoves.size());
+    auto better = [isWhiteToMove](float a, float b) { return isWhiteToMove ? a > b : a < b; };
+    std::vector<AnalysisLine> lines; // Best first, at most 'wanted'
+    std::mutex linesMutex;
+    std::atomic<int> nodes{0};
+    std::atomic<bool> stopped{false};
+
+    // Once 'wanted' lines are known a move only has to be proven better than
+    // the last of them, so that score is its alpha (beta for Black). A move
+    // that beats it gets an exact score; the others fail low and are dropped.
+    auto searchMove = [&](const Move& move, SearchContext& moveContext) {
+        float alpha = -INFINITY_SCORE;
+        float beta = INFINITY_SCORE;
+        {
+            std::lock_guard<std::mutex> lock(linesMutex);
+            if (lines.size() == wanted) (isWhiteToMove ? alpha : beta) = lines.back().score;
+        }
+        Game nextGameState = game.afterMove(move);
+        updateAccumulator(moveContext, 0, game, move, nextGameState);
+        EvaluationResult result = search(std::move(nextGameState), depth - 1, alpha, beta, !isWhiteToMove, playerToMove, moveContext, 1);
+        moveContext.followingLine = false;
+        nodes += result.nodesSearched;
+        if (moveContext.stopped) {
+            stopped = true;
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(linesMutex);
+        if (lines.size() == wanted && !better(result.score, lines.back().score)) return;
+        auto position = std::find_if(lines.begin(), lines.end(),
+                                     [&](const AnalysisLine& line) { return better(result.score, line.score); });
+        std::vector<Move> principalVariation = moveContext.pv.line(1);
+        principalVariation.insert(principalVariation.begin(), move);
+        lines.insert(position, AnalysisLine{move, result.score, depth, std::move(principalVariation)});
+        if (lines.size() > wanted) lines.pop_back();
+    };
+
+    // The first 'wanted' moves, the previous lines among them, are searched
+    // with a full window to fill the list; the rest only against its last score
+    for (std::size_t i = 0; i < wanted && !stopped; ++i) {
+        searchMove(legalMoves[i], context);
+    }
+    std::size_t remaining = stopped ? 0 : legalMoves.size() - wanted;
+    if (pool && remaining > 0) {
+        pool->parallelFor(remaining, [&](std::size_t i) {
+            SearchContext moveContext = context;
+            searchMove(legalMoves[wanted + i], moveContext);
+        });
+    } else {
+        for (std::size_t i = 0; i < remaining && !stopped; ++i) {
+            searchMove(legalMoves[wanted + i], context);
+        }
+    }
+
+    EvaluationResult best;
+    best.nodesSearched = 1 + nodes;
+    if (stopped) {
+        context.stopped = true;
+        return best;
+    }
+    best.score = lines.front().score;
+    best.bestMove = lines.front().move;
+    best.principalVariation = lines.front().principalVariation;
+    best.lines = std::move(lines);
+    return best;
+}
+
+float EvaluationEngine::evaluate(const Game& game, Color perspective, float alpha, float beta, SearchContext& context, int ply) const {
+    float kpkScore;
+    if (evaluateKpk(game.getBoard(), game.getCurrentPlayerColor(), kpkScore)) return kpkScore;
+    if (context.useNnue) {
+        // The network scores from the side to move; the search expects White's point of view
+        Color sideToMove = game.getCurrentPlayerColor();
+        float score = nnueNetwork->evaluate(context.accumulators[ply], sideToMove) / 100.0f;
+        return (sideToMove == Color::WHITE) ? score : -score;
+    }
+    return lazyEvaluate(game.getBoard(), perspective, alpha, beta, &context.stats);
+}
+
+void EvaluationEngine::updateAccumulator(SearchContext& context, int ply, const Game& parent, const Move& move, const Game& child) const {
+    if (!context.useNnue) return;
+    NnueDelta delta = NnueDelta::fromMove(parent.getBoard(), move);
+    context.accumulators[ply + 1].update(context.accumulators[ply], delta, child.getBoard(), *nnueNetwork);
+}
+
+EvaluationResult EvaluationEngine::search(Game game, int depth, float alpha, float beta, bool isMaximizingTurn, Color originalPlayerColor,
+                                          SearchContext& context, int ply) const {
     EvaluationResult currentEval;
     currentEval.nodesSearched = 1;
+    context.pv.clear(ply);
 
+    // Checking the limits every few hundred nodes keeps their cost out of the profile
+    if (context.checkLimits && ++context.nodesSinceCheck >= LIMIT_CHECK_INTERVAL) {
+        pollLimits(context);
+    }
+    if (context.stopped) return currentEval;
 
-    std::vector<Move> legalMoves = game.getLegalMoves(); // Get moves for current player in 'game'
+    // Draws are found before generating moves. Search children (Game::afterMove)
+    // carry no repetition record, so repetitions are found on the search's own key stack.
+    // A checkmate on the hundredth half-move still wins, so only that case
+    // looks for a legal reply.
+    if (game.getHalfMoveClock() >= 100 || isRepetition(context, game, ply)) {
+        bool mated = game.getHalfMoveClock() >= 100 && game.isKingInCheck(game.getCurrentPlayerColor()) && game.getLegalMoves().empty();
+        if (mated) {
+            currentEval.score = isMaximizingTurn ? -INFINITY_SCORE : INFINITY_SCORE;
+        } else {
+            currentEval.score = 0;
+        }
+        return currentEval;
+    }
 
-    if (game.getHalfMoveClock() == 100 || game.getGameStateCount() >= 3) {
-        currentEval.score = 0;
+    // Positions covered by the tablebases are scored exactly, without searching
+    // further. Not at the root, which needs a move: see probeTablebaseRoot.
+    float tablebaseScore = 0.0f;
+    if (ply > 0 && probeTablebases(game, ply, tablebaseScore)) {
+        currentEval.score = tablebaseScore;
         return currentEval;
     }
 
     // Base cases for recursion
     if (depth == 0) {
-        currentEval.score = staticEvaluate(game.getBoard(), originalPlayerColor);
+        currentEval.score = evaluate(game, originalPlayerColor, alpha, beta, context, ply);
         // No bestMove at leaf node of this type
         return currentEval;
     }
 
-    
+    std::vector<Move> legalMoves = game.getLegalMoves(); // Get moves for current player in 'game'
     if (legalMoves.empty()) {
         if (game.isKingInCheck(game.getCurrentPlayerColor())) { // Checkmate
             currentEval.score = isMaximizingTurn ? -INFINITY_SCORE : INFINITY_SCORE; // Current player (whose turn it is) is checkmated
@@ -220,23 +936,27 @@ EvaluationResult EvaluationEngine::search(Game game, int depth, float alpha, flo
 
     
     
-    // Order moves for better alpha-beta pruning
+    // Order moves for better alpha-beta pruning, the followed line first
     legalMoves = orderMoves(legalMoves, game.getBoard());
+    orderFollowedLine(context, legalMoves, ply);
 
     if (isMaximizingTurn) { // Corresponds to originalPlayerColor's turn
         float maxEval = -INFINITY_SCORE;
         Move bestMoveSoFar = legalMoves.empty() ? Move(Position(-1,-1), Position(-1,-1)) : legalMoves[0];
 
         for (const auto& move : legalMoves) {
-            Game nextGameState = game.clone(); // Create a copy to simulate the move
-            nextGameState.makeMove(move);   // makeMove switches player and updates game state
+            Game nextGameState = game.afterMove(move);
+            updateAccumulator(context, ply, game, move, nextGameState);
 
-            EvaluationResult result = search(std::move(nextGameState), depth - 1, alpha, beta, false, originalPlayerColor);
+            EvaluationResult result = search(std::move(nextGameState), depth - 1, alpha, beta, false, originalPlayerColor, context, ply + 1);
+            context.followingLine = false; // Only the first move can be on the line
             currentEval.nodesSearched += result.nodesSearched;
+            if (context.stopped) break;
 
             if (result.score > maxEval) {
                 maxEval = result.score;
                 bestMoveSoFar = move;
+                context.pv.update(ply, move);
             }
             alpha = std::max(alpha, result.score);
             if (beta <= alpha) {
@@ -251,15 +971,18 @@ EvaluationResult EvaluationEngine::search(Game game, int depth, float alpha, flo
 
 
         for (const auto& move : legalMoves) {
-            Game nextGameState = game.clone(); // Create a copy
-            nextGameState.makeMove(move);
+            Game nextGameState = game.afterMove(move);
+            updateAccumulator(context, ply, game, move, nextGameState);
 
-            EvaluationResult result = search(std::move(nextGameState), depth - 1, alpha, beta, true, originalPlayerColor);
+            EvaluationResult result = search(std::move(nextGameState), depth - 1, alpha, beta, true, originalPlayerColor, context, ply + 1);
+            context.followingLine = false;
             currentEval.nodesSearched += result.nodesSearched;
+            if (context.stopped) break;
 
             if (result.score < minEval) {
                 minEval = result.score;
                 bestMoveSoFar = move; // This move is from opponent's perspective, not usually returned for original player
+                context.pv.update(ply, move);
             }
             
             beta = std::min(beta, result.score);
@@ -270,13 +993,37 @@ EvaluationResult EvaluationEngine::search(Game game, int depth, float alpha, flo
         currentEval.score = minEval;
         currentEval.bestMove = bestMoveSoFar;
     }
+    if (ply == 0) {
+        // A side that is mated after every move never updates its row
+        currentEval.principalVariation = context.pv.line(0);
+        if (currentEval.principalVariation.empty()) currentEval.principalVariation.push_back(currentEval.bestMove);
+    }
     return currentEval;
 }
 
 
 Move EvaluationEngine::findBestMove(const Game& game, int depth) const {
+    return searchBestMove(game, depth).bestMove;
+}
+
+EvaluationResult EvaluationEngine::searchBestMove(const Game& game, int depth, const std::vector<Move>& expectedLine) const {
     if (depth <= 0) depth = 1; // Ensure at least depth 1
 
+    Move bookMove(Position(-1, -1), Position(-1, -1));
+    if (probeBook(game, bookMove)) {
+        std::cout << "Book move: " << bookMove.toString() << std::endl;
+        EvaluationResult bookResult;
+        bookResult.bestMove = bookMove;
+        bookResult.principalVariation.push_back(bookMove);
+        return bookResult;
+    }
+
+    EvaluationResult tablebaseResult;
+    if (probeTablebaseRoot(game, tablebaseResult)) {
+        std::cout << "Tablebase move: " << tablebaseResult.bestMove.toString() << " with score: " << tablebaseResult.score << std::endl;
+        return tablebaseResult;
+    }
+
     // The 'game' state here is the current actual game state.
     // The 'search' function will work on copies.
     // Determine if the current player in 'game' is the one we are maximizing for.
@@ -306,17 +1053,36 @@ Move EvaluationEngine::findBestMove(const Game& game, int depth) const {
     // The 'search' function will then know if it's maximizing this (if White is originalPlayerColor)
     // or minimizing this (if Black is originalPlayerColor).
 
-    EvaluationResult result = search(game.clone(), depth, -INFINITY_SCORE, INFINITY_SCORE, isWhiteToMove, playerToMove);
+    // NNUE features assume a standard 8x8 board; other variants keep the classical terms
+    SearchContext context;
+    BoardDimensions dims = game.getBoard().getDimensions();
+    context.useNnue = evaluatorType == EvaluatorType::NNUE && nnueNetwork && dims.rows == 8 && dims.cols == 8;
+    if (context.useNnue) {
+        context.accumulators.resize(depth + 1);
+        context.accumulators[0].refresh(game.getBoard(), *nnueNetwork);
+    }
+    context.pv.resize(depth);
+    initKeyStack(context, game, depth);
+    context.followLine = expectedLine;
+    context.followingLine = !expectedLine.empty();
+
+    EvaluationResult result = search(game.clone(), depth, -INFINITY_SCORE, INFINITY_SCORE, isWhiteToMove, playerToMove, context, 0);
 
-    std::cout << "Nodes searched: " << result.nodesSearched << std::endl;
+    std::cout << "Nodes searched: " << result.nodesSearched
+              << " | Evaluations: " << context.stats.evaluations
+              << " (lazy exits: " << context.stats.lazyExits << ")" << std::endl;
     std::cout << "Best move found: " << result.bestMove.toString() << " with score: " << result.score << std::endl;
+    std::cout << "Principal variation:";
+    for (const Move& move : result.principalVariation) std::cout << " " << move.toString();
+    std::cout << std::endl;
     
     // If no moves are possible (checkmate/stalemate), result.bestMove might be invalid.
     // Game loop should handle this (e.g., by game state).
     if (game.getLegalMoves().empty()) {
         std::cout << "No legal moves available, returning invalid move from engine." << std::endl;
-        return Move(Position(-1,-1), Position(-1,-1));
+        result.bestMove = Move(Position(-1,-1), Position(-1,-1));
+        result.principalVariation.clear();
     }
     
-    return result.bestMove;
+    return result;
 }
\ No newline at end of file
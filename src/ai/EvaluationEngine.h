@@ -3,51 +3,299 @@
 
 #include "core/Move.h"
 #include "core/ChessTypes.h" // For Color
+#include "ai/nnue/NnueAccumulator.h"
+#include "ai/BatchEvaluation.h"
+#include "ai/EvalWeights.h"
+#include "ai/OpeningBook.h"
+#include "ai/Syzygy.h"
+#include "ai/EndgameTable.h"
+#include "ai/MateSolver.h"
 #include <vector> // For storing lines of play, etc.
+#include <memory> // For std::shared_ptr
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <functional>
 
 // Forward declarations
 class Game; // Game state is needed for evaluation
 class Board; // Board state is directly evaluated
+class NnueNetwork;
+class AttackMap;
+class ThreadPool;
+
+// One root move of a multi-PV analysis and its score
+struct AnalysisLine {
+    Move move;
+    float score; // White's point of view, like EvaluationResult::score
+    int depth;   // Iteration that produced the score
+    std::vector<Move> principalVariation; // Starts with 'move'
+};
 
 // Structure to hold evaluation result
 struct EvaluationResult {
     float score;         // The score of the position (+ for white, - for black)
     Move bestMove;       // The best move found from this position
     int nodesSearched;   // For performance tracking
-    // std::vector<Move> principalVariation; // Optional: the expected line of play
+    std::vector<Move> principalVariation; // The expected line of play, from bestMove on (root results only)
+    std::vector<AnalysisLine> lines; // analyze() with limits.multiPv > 1: the best root moves, best first
 
     EvaluationResult() : score(0.0f), bestMove(Position(-1,-1), Position(-1,-1)), nodesSearched(0) {}
 };
 
+// Which static evaluation the search uses at its leaves
+enum class EvaluatorType {
+    CLASSICAL, // Hand-tuned terms in staticEvaluate
+    NNUE       // Neural network, requires loadNetwork()
+};
+
+// Counters collected during one search
+struct SearchStats {
+    int evaluations = 0; // Classical static evaluations performed
+    int lazyExits = 0;   // ... of which returned after the cheap stage
+};
+
+// Triangular table of principal variations: row 'ply' holds the best line
+// found so far from that ply on, which is at most maxPly - ply moves long. A
+// node clears its row on entry and, when a move becomes its best, rewrites it
+// as that move followed by the child's row.
+class PrincipalVariationTable {
+public:
+    void resize(int maxPly);
+    void clear(int ply) { lengths[ply] = 0; }
+    void update(int ply, const Move& move);
+    std::vector<Move> line(int ply) const;
+
+private:
+    std::size_t rowStart(int ply) const { return static_cast<std::size_t>(ply) * rows - static_cast<std::size_t>(ply) * (ply - 1) / 2; }
+
+    int rows = 0;
+    std::vector<Move> moves;
+    std::vector<int> lengths;
+};
+
+// Per-search scratch state threaded through the recursion.
+// It lives on the stack of findBestMove, so concurrent searches never share it.
+struct SearchContext {
+    bool useNnue = false;
+    std::vector<NnueAccumulator> accumulators; // Indexed by ply
+    SearchStats stats;
+    PrincipalVariationTable pv;
+
+    // Line searched first at each ply as long as the search stays on it: the
+    // previous iteration's principal variation, or SearchLimits::expectedLine
+    std::vector<Move> followLine;
+    bool followingLine = false;
+
+    // Zobrist keys of the positions since the last irreversible move before
+    // the root, followed by one per ply of the current path: the key at ply p
+    // is keys[rootIndex + p]. Empty on boards without Zobrist keys.
+    std::vector<std::uint64_t> keys;
+    int rootIndex = 0;
+
+    // Limits of analyze(); once one is hit 'stopped' is set and the search
+    // unwinds, its unfinished iteration being discarded
+    bool checkLimits = false;
+    bool hasDeadline = false;
+    std::chrono::steady_clock::time_point deadline;
+    std::uint64_t nodeLimit = 0;                     // 0 = none
+    std::atomic<std::uint64_t>* nodeCount = nullptr; // Shared by the workers of one analyze()
+    const std::atomic<bool>* stopSignal = nullptr;
+    bool stopped = false;
+    int nodesSinceCheck = 0;
+};
+
+// Limits of an analyze() call; at least one should be set
+struct SearchLimits {
+    int depth = 0;          // Deepest iteration (0 = until another limit is hit, at most MAX_ANALYSIS_DEPTH)
+    int moveTimeMs = 0;     // Wall-clock budget in milliseconds (0 = none)
+    std::uint64_t nodes = 0; // Node budget (0 = none)
+    bool infinite = false;  // No limit but 'stopSignal' (UCI "go infinite" and pondering)
+    int threads = 1;        // Root moves searched in parallel from depth 2 on
+    int multiPv = 1;        // Root moves to score exactly, see EvaluationResult::lines
+
+    // Line expected from this position, searched first until the first
+    // iteration has a principal variation of its own; see continueLine
+    std::vector<Move> expectedLine;
+
+    // Set from another thread to end the search early, e.g. by the UCI "stop"
+    // command. The last completed iteration is returned as usual.
+    const std::atomic<bool>* stopSignal = nullptr;
+};
+
+constexpr int MAX_ANALYSIS_DEPTH = 64;
+
+// Half-moves from the start of the game during which the opening book is used
+constexpr int DEFAULT_BOOK_MAX_PLY = 20;
+
+// Score (in pawns) of a tablebase win, minus the ply it was found at so nearer
+// wins rank first. Far above any evaluation, well below a mate.
+constexpr float TABLEBASE_WIN_SCORE = 1000.0f;
+
+// Search time for one move under a clock: an even share of what is left over
+// 'movesToGo' moves (a guess when 0) plus most of the increment, keeping a
+// small reserve so the clock never runs out. Used by the UCI front end and the
+// match runner.
+int allocateMoveTime(long long remainingMs, long long incrementMs, int movesToGo = 0);
+
+// What is left of 'principalVariation', found two plies ago, once its first
+// two moves were played as 'ourMove' and 'theirMove': the expected line from
+// the new position (SearchLimits::expectedLine). Empty if the game left it.
+std::vector<Move> continueLine(const std::vector<Move>& principalVariation, const Move& ourMove, const Move& theirMove);
+
+// Move the engine expects in reply to its best move, to ponder on: the second
+// move of the principal variation. False if the line is shorter.
+bool ponderMove(const EvaluationResult& result, Move& out);
+
+// Called after each completed iteration of analyze() with its depth and result
+using AnalysisCallback = std::function<void(int depth, const EvaluationResult& result)>;
+
 
 class EvaluationEngine {
 public:
     EvaluationEngine();
     EvaluationEngine(float materialWeight, float mobilityWeight, float kingSafetyWeight, float pawnStructureWeight, float centerControlWeight);
+    explicit EvaluationEngine(const EvalWeights& weights);
 
     // Main method to find the best move for the current player in the given game state
     Move findBestMove(const Game& game, int depth) const;
+    // The same search, returning the score and principal variation as well.
+    // 'expectedLine' (see continueLine) is searched first while the tree follows it.
+    EvaluationResult searchBestMove(const Game& game, int depth, const std::vector<Move>& expectedLine = {}) const;
+
+    // Quiet iterative deepening search for tools and front ends: searches depth 1, 2, ...
+    // up to the limits and returns the last completed iteration, with nodesSearched
+    // summed over all iterations. Depth 1 always completes, even past the deadline
+    // or after a stop request.
+    // With limits.multiPv = N > 1 the N best root moves are scored exactly and
+    // returned in 'lines' (and passed to onIteration after every iteration);
+    // the book and the root tablebase probe are skipped so that there are N.
+    EvaluationResult analyze(const Game& game, const SearchLimits& limits, const AnalysisCallback& onIteration = nullptr) const;
+
+    // Forced mate for the side to move within limits.maxMoves, by proof-number
+    // search (see ai/MateSolver.h) rather than the alpha-beta search: for
+    // puzzles and mate finding. The solver's table is 'hashMegabytes' large
+    // and lives for this call.
+    MateResult findMate(const Game& game, const MateSearchLimits& limits, std::size_t hashMegabytes = 16) const;
 
     // Static evaluation of the board from a given player's perspective
     float staticEvaluate(const Board& board, Color perspective, const bool report = false) const;
 
+    // Staged evaluation against a search window (White's point of view, like the result).
+    // Returns after the cheap terms if they already put the score more than the
+    // lazy margin outside [alpha, beta]; such exits are counted in 'stats'.
+    float lazyEvaluate(const Board& board, Color perspective, float alpha, float beta, SearchStats* stats = nullptr) const;
+    void setLazyEvalMargin(float margin);
+    float getLazyEvalMargin() const;
+
+    // Classical evaluation parameters. loadWeights reads a file written by the
+    // `tune` tool and throws std::runtime_error on a bad file.
+    const EvalWeights& getWeights() const;
+    void setWeights(const EvalWeights& newWeights);
+    void loadWeights(const std::string& path);
+
+    // Classical evaluation of many positions at once: scores[i] is
+    // staticEvaluate(positions[i], Color::WHITE) in centipawns (saturated to int16),
+    // except that the KPK bitbase is not consulted: the batch scores stay linear.
+    // Batches large enough are split across 'threads' workers (0 = one per core).
+    void evaluateBatch(const PackedPosition* positions, std::size_t count, std::int16_t* scores, int threads = 0) const;
+    // Weight of each EvalFeature in the classical evaluation
+    void getFeatureWeights(float featureWeights[EVAL_FEATURE_COUNT]) const;
+
+    // Attack-map based terms (8x8 boards), also used by the batch evaluator
+    static int mobility(const AttackMap& attackMap, Color side);
+    static float kingDanger(const AttackMap& attackMap, Color side);
+
+    // Order moves for more efficient alpha-beta pruning (captures first).
+    // Public so the microbenchmarks can time it on its own.
+    std::vector<Move> orderMoves(const std::vector<Move>& moves, const Board& board) const;
+
+    // NNUE evaluator selection. loadNetwork throws std::runtime_error on a bad file
+    // and switches the engine to EvaluatorType::NNUE on success.
+    void loadNetwork(const std::string& path);
+    void setEvaluatorType(EvaluatorType type);
+    EvaluatorType getEvaluatorType() const;
+
+    // Polyglot opening book. While the game is fewer than 'maxPly' half-moves
+    // old (counted from the FEN move number), analyze() and findBestMove()
+    // play a book move without searching; infinite searches (analysis,
+    // pondering) always search. loadBook throws std::runtime_error.
+    void loadBook(const std::string& path);
+    void clearBook();
+    bool hasBook() const;
+    void setBookOptions(BookSelection selection, int maxPly);
+    // Book move for the side to move in 'game', if the book has one
+    bool probeBook(const Game& game, Move& out) const;
+
+    // Syzygy endgame tablebases, 'paths' as for SyzygyTablebase. Inside the
+    // search a position with few enough pieces is scored from its WDL table
+    // instead of being searched further; at the root the move is taken from
+    // the DTZ tables without searching. loadTablebases throws
+    // std::runtime_error if no table is found.
+    void loadTablebases(const std::string& paths);
+    void clearTablebases();
+    bool hasTablebases() const;
+
+    // Endgame tables written by tbgen (see ai/EndgameTable.h), which also
+    // cover the variant board sizes. Used inside the search like the Syzygy
+    // tables, which are asked first; their mate distances order the wins.
+    // Tables are opened on first use, so a directory without them is no error.
+    void loadEndgameTables(const std::string& directory);
+    void clearEndgameTables();
+    bool hasEndgameTables() const;
+
 private:
+    // Root move and its white-relative score from the tablebases, if the
+    // position is covered
+    bool probeTablebaseRoot(const Game& game, EvaluationResult& out) const;
+
+    // White-relative score of a position below the root from whichever tables
+    // cover it
+    bool probeTablebases(const Game& game, int ply, float& score) const;
+
     // Recursive search function (e.g., Minimax with Alpha-Beta Pruning)
     // 'game' is const Game& as we operate on copies or don't modify original game state directly during search.
     // The 'game' parameter here would likely be a *copy* of the game state that the search algorithm
     // can then modify by making/unmaking moves.
-    EvaluationResult search(Game game, int depth, float alpha, float beta, bool maximizingPlayer, Color originalPlayerColor) const;
+    EvaluationResult search(Game game, int depth, float alpha, float beta, bool maximizingPlayer, Color originalPlayerColor,
+                            SearchContext& context, int ply) const;
 
-    // Parameters for evaluation - can be made configurable
-    float materialWeight;
-    float mobilityWeight;
-    float kingSafetyWeight;
-    float pawnStructureWeight;
-    float centerControlWeight;
-    // Add more as needed
+    // One iteration of analyze() with the root moves shared out over 'pool'. The
+    // previous best move is searched first, alone, and its score bounds the rest.
+    EvaluationResult searchRootParallel(const Game& game, int depth, const Move& previousBest, ThreadPool& pool,
+                                        SearchContext& context) const;
 
-    // Helper: Order moves for more efficient alpha-beta pruning
-    std::vector<Move> orderMoves(const std::vector<Move>& moves, const Board& board) const;
+    // One iteration of a multi-PV analyze(): every root move is searched once,
+    // against the score of the Nth best so far, so only moves that enter the
+    // top N get exact scores. The previous iteration's lines go first, to set
+    // that bound early. The rest are shared out over 'pool' when there is one.
+    EvaluationResult searchRootMultiPv(const Game& game, int depth, int lineCount, const std::vector<AnalysisLine>& previousLines,
+                                       ThreadPool* pool, SearchContext& context) const;
+
+    // Leaf evaluation: the KPK bitbase for king and pawn versus king, then NNUE
+    // when enabled for this search, lazyEvaluate otherwise
+    float evaluate(const Game& game, Color perspective, float alpha, float beta, SearchContext& context, int ply) const;
+
+    float evaluateStaged(const Board& board, Color perspective, float alpha, float beta, SearchStats* stats, bool report) const;
+
+    // Derives the child's NNUE accumulator from the parent's after 'move' was played
+    void updateAccumulator(SearchContext& context, int ply, const Game& parent, const Move& move, const Game& child) const;
+
+    // Parameters for evaluation, see EvalWeights
+    EvalWeights weights;
+    float lazyEvalMargin; // See lazyEvaluate
+
+    EvaluatorType evaluatorType;
+    std::shared_ptr<const NnueNetwork> nnueNetwork; // Shared: engines are copied by value
+
+    std::shared_ptr<const OpeningBook> openingBook; // Shared like the network
+    BookSelection bookSelection;
+    int bookMaxPly;
+
+    std::shared_ptr<const SyzygyTablebase> tablebase; // Shared like the book
+    std::shared_ptr<const EndgameTablebase> endgameTables;
 };
 
 #endif // EVALUATION_ENGINE_H
\ No newline at end of file
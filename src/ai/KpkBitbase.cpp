@@ -0,0 +1,152 @@
+#include "ai/KpkBitbase.h"
+#include "core/Bitboard.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Positions: side to move (2) × weak king (64) × strong king (64) × pawn (files a-d, ranks 2-7)
+constexpr int KPK_POSITIONS = 2 * 64 * 64 * 24;
+
+// Classification states while building; combined as flags when scanning successors
+enum KpkState : std::uint8_t {
+    KPK_INVALID = 0,
+    KPK_UNKNOWN = 1,
+    KPK_DRAW = 2,
+    KPK_WIN = 4
+};
+
+int fileOf(int square) { return square & 7; }
+int rankOf(int square) { return square >> 3; }
+
+// 'weakToMove' is 0 with the strong side (White after normalising) to move, 1 otherwise
+int kpkIndex(int weakToMove, int weakKing, int strongKing, int pawn) {
+    return strongKing | (weakKing << 6) | (weakToMove << 12) | (fileOf(pawn) << 13) | ((6 - rankOf(pawn)) << 15);
+}
+
+int kingDistance(int a, int b) {
+    int files = fileOf(a) > fileOf(b) ? fileOf(a) - fileOf(b) : fileOf(b) - fileOf(a);
+    int ranks = rankOf(a) > rankOf(b) ? rankOf(a) - rankOf(b) : rankOf(b) - rankOf(a);
+    return files > ranks ? files : ranks;
+}
+
+class KpkBitbase {
+public:
+    KpkBitbase() : bits(KPK_POSITIONS / 32, 0) {
+        std::vector<std::uint8_t> states(KPK_POSITIONS);
+        for (int index = 0; index < KPK_POSITIONS; ++index) {
+            states[index] = initialState(index);
+        }
+
+        // Resolve unknown positions from their successors until nothing changes.
+        // Both sides' results feed each other, so a pass covers one more ply.
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (int index = 0; index < KPK_POSITIONS; ++index) {
+                if (states[index] != KPK_UNKNOWN) continue;
+                std::uint8_t state = classify(index, states);
+                if (state != KPK_UNKNOWN) {
+                    states[index] = state;
+                    changed = true;
+                }
+            }
+        }
+
+        for (int index = 0; index < KPK_POSITIONS; ++index) {
+            if (states[index] == KPK_WIN) bits[index >> 5] |= std::uint32_t(1) << (index & 31);
+        }
+    }
+
+    bool isWin(int weakToMove, int weakKing, int strongKing, int pawn) const {
+        int index = kpkIndex(weakToMove, weakKing, strongKing, pawn);
+        return (bits[index >> 5] >> (index & 31)) & 1;
+    }
+
+private:
+    static void decode(int index, int& weakToMove, int& weakKing, int& strongKing, int& pawn) {
+        strongKing = index & 63;
+        weakKing = (index >> 6) & 63;
+        weakToMove = (index >> 12) & 1;
+        pawn = ((6 - (index >> 15)) << 3) | ((index >> 13) & 3);
+    }
+
+    // Positions decided without looking ahead: illegal ones, safe promotions,
+    // stalemates and undefended pawns the weak king can take
+    static std::uint8_t initialState(int index) {
+        int weakToMove, weakKing, strongKing, pawn;
+        decode(index, weakToMove, weakKing, strongKing, pawn);
+        int promotion = pawn + 8;
+
+        if (kingDistance(weakKing, strongKing) <= 1 || weakKing == pawn || strongKing == pawn) return KPK_INVALID;
+        // The weak king in check with the strong side to move
+        if (!weakToMove && (pawnAttacks(Color::WHITE, pawn) & squareBB(weakKing))) return KPK_INVALID;
+
+        if (!weakToMove && rankOf(pawn) == 6 && strongKing != promotion &&
+            (kingDistance(weakKing, promotion) > 1 || kingDistance(strongKing, promotion) == 1)) {
+            return KPK_WIN;
+        }
+
+        if (weakToMove) {
+            Bitboard covered = kingAttacks(strongKing) | pawnAttacks(Color::WHITE, pawn);
+            Bitboard escapes = kingAttacks(weakKing) & ~covered;
+            bool pawnHanging = (kingAttacks(weakKing) & squareBB(pawn)) && !(kingAttacks(strongKing) & squareBB(pawn));
+            if (!escapes || pawnHanging) return KPK_DRAW;
+        }
+        return KPK_UNKNOWN;
+    }
+
+    // A position is won for the strong side if one of its moves wins, drawn for
+    // the weak side if one of its moves draws, and still unknown if neither
+    // holds while some successor is unknown. Moves into illegal positions
+    // (including captures, which were resolved up front) look up as invalid.
+    static std::uint8_t classify(int index, const std::vector<std::uint8_t>& states) {
+        int weakToMove, weakKing, strongKing, pawn;
+        decode(index, weakToMove, weakKing, strongKing, pawn);
+
+        std::uint8_t good = weakToMove ? KPK_DRAW : KPK_WIN;
+        std::uint8_t bad = weakToMove ? KPK_WIN : KPK_DRAW;
+        std::uint8_t reached = KPK_INVALID;
+
+        Bitboard kingMoves = kingAttacks(weakToMove ? weakKing : strongKing);
+        while (kingMoves) {
+            int to = popLsb(kingMoves);
+            reached |= weakToMove ? states[kpkIndex(0, to, strongKing, pawn)]
+                                  : states[kpkIndex(1, weakKing, to, pawn)];
+        }
+
+        if (!weakToMove) {
+            if (rankOf(pawn) < 6) reached |= states[kpkIndex(1, weakKing, strongKing, pawn + 8)];
+            if (rankOf(pawn) == 1 && pawn + 8 != strongKing && pawn + 8 != weakKing) {
+                reached |= states[kpkIndex(1, weakKing, strongKing, pawn + 16)];
+            }
+        }
+
+        if (reached & good) return good;
+        return (reached & KPK_UNKNOWN) ? static_cast<std::uint8_t>(KPK_UNKNOWN) : bad;
+    }
+
+    std::vector<std::uint32_t> bits;
+};
+
+const KpkBitbase& kpkBitbase() {
+    static const KpkBitbase bitbase; // Built once, on first use
+    return bitbase;
+}
+
+} // namespace
+
+bool probeKpk(Color strongSide, int strongKing, int strongPawn, int weakKing, Color sideToMove) {
+    // Normalise to White holding the pawn on files a-d
+    if (strongSide == Color::BLACK) {
+        strongKing ^= 56;
+        strongPawn ^= 56;
+        weakKing ^= 56;
+    }
+    if (fileOf(strongPawn) >= 4) {
+        strongKing ^= 7;
+        strongPawn ^= 7;
+        weakKing ^= 7;
+    }
+    return kpkBitbase().isWin(sideToMove == strongSide ? 0 : 1, weakKing, strongKing, strongPawn);
+}
@@ -0,0 +1,19 @@
+#ifndef KPK_BITBASE_H
+#define KPK_BITBASE_H
+
+#include "core/ChessTypes.h"
+
+// Win/draw bitbase of king and pawn versus king on the standard board.
+// It holds one bit per position with White's pawn on files a-d (the other
+// files are mirrored) and either side to move: 2 × 64 × 64 × 24 = 196608
+// bits, 24 KB. The table is built by iterative classification the first time
+// it is probed, which takes a few milliseconds; probing is thread-safe.
+//
+// Squares are numbered a1 = 0 ... h8 = 63 (Position::toSquareIndex).
+
+// True if the side with the pawn wins with 'sideToMove' to move. The position
+// must be legal: kings not touching, no piece sharing a square, the pawn on
+// ranks 2-7 and the side not to move not in check.
+bool probeKpk(Color strongSide, int strongKing, int strongPawn, int weakKing, Color sideToMove);
+
+#endif // KPK_BITBASE_H
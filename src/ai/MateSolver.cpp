@@ -0,0 +1,308 @@
+#include "ai/MateSolver.h"
+#include "core/Board.h"
+#include "core/Game.h"
+#include "core/Piece.h"
+#include "core/Zobrist.h"
+#include <algorithm>
+
+namespace {
+
+// Proof numbers saturate one below INF, which only settled positions reach
+constexpr std::uint32_t PN_INFINITY = 0x7FFFFFFF;
+constexpr std::uint32_t PN_MAX = PN_INFINITY - 1;
+
+// Positions per table bucket; a new entry replaces the one with the least work
+constexpr std::size_t BUCKET_SIZE = 4;
+
+// Nodes between two looks at the clock and the stop signal
+constexpr std::uint64_t LIMIT_CHECK_INTERVAL = 1024;
+
+Color opposite(Color color) {
+    return (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+}
+
+std::uint64_t splitMix64(std::uint64_t value) {
+    value += 0x9E3779B97F4A7C15ULL;
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+    return value ^ (value >> 31);
+}
+
+// Zobrist key on the standard board; other sizes hash the grid square by square
+std::uint64_t positionKey(const Board& board, Color sideToMove) {
+    if (board.hasBitboards()) return zobristKey(board, sideToMove);
+
+    BoardDimensions dimensions = board.getDimensions();
+    std::uint64_t key = sideToMove == Color::BLACK ? 0x5851F42D4C957F2DULL : 0;
+    for (int r = 0; r < dimensions.rows; ++r) {
+        for (int c = 0; c < dimensions.cols; ++c) {
+            const Piece* piece = board.getPieceAt(Position(r, c));
+            if (!piece) continue;
+            std::uint64_t feature = ((static_cast<std::uint64_t>(r * dimensions.cols + c) * 6 +
+                                      static_cast<std::uint64_t>(piece->getType())) << 1) |
+                                    static_cast<std::uint64_t>(piece->getColor());
+            key ^= splitMix64(feature);
+        }
+    }
+    int rights = (board.canCastleKingside(Color::WHITE) ? 1 : 0) | (board.canCastleQueenside(Color::WHITE) ? 2 : 0) |
+                 (board.canCastleKingside(Color::BLACK) ? 4 : 0) | (board.canCastleQueenside(Color::BLACK) ? 8 : 0);
+    Position enPassant = board.getEnPassantTargetSquare();
+    std::uint64_t extra = static_cast<std::uint64_t>(rights) |
+                          (enPassant.isValid(dimensions.rows, dimensions.cols) ? static_cast<std::uint64_t>(enPassant.col + 1) << 4 : 0);
+    return key ^ splitMix64(extra | (1ULL << 40));
+}
+
+// The same position with a different number of plies left is a different
+// problem, so the remaining plies are part of the table key
+std::uint64_t tableKey(std::uint64_t positionKey, int remaining) {
+    std::uint64_t key = positionKey ^ splitMix64(static_cast<std::uint64_t>(remaining) | (1ULL << 41));
+    return key ? key : 1; // 0 marks empty entries
+}
+
+bool isInCheck(const Board& board, Color color) {
+    return board.isSquareAttacked(board.findKing(color), opposite(color));
+}
+
+std::uint32_t saturatingAdd(std::uint32_t a, std::uint32_t b) {
+    std::uint64_t sum = static_cast<std::uint64_t>(a) + b;
+    return sum >= PN_INFINITY ? PN_MAX : static_cast<std::uint32_t>(sum);
+}
+
+} // namespace
+
+// A move of an expanded position with its child's current proof numbers
+struct MateSolver::Child {
+    Move move;
+    std::uint64_t key; // Table key of the child
+    ProofNumbers numbers;
+};
+
+MateSolver::MateSolver(std::size_t hashMegabytes)
+    : bucketMask(0), attacker(Color::WHITE), nodes(0), aborted(false), checkingLimits(false) {
+    std::size_t buckets = std::max<std::size_t>(1, hashMegabytes * 1024 * 1024 / (sizeof(Entry) * BUCKET_SIZE));
+    std::size_t powerOfTwo = 1;
+    while (powerOfTwo * 2 <= buckets) powerOfTwo *= 2;
+    table.resize(powerOfTwo * BUCKET_SIZE);
+    bucketMask = powerOfTwo - 1;
+}
+
+void MateSolver::clear() {
+    std::fill(table.begin(), table.end(), Entry());
+}
+
+MateResult MateSolver::solve(const Game& game, const MateSearchLimits& searchLimits) {
+    return solve(game.getBoard(), game.getCurrentPlayerColor(), searchLimits);
+}
+
+MateResult MateSolver::solve(const Board& board, Color sideToMove, const MateSearchLimits& searchLimits) {
+    attacker = sideToMove;
+    limits = searchLimits;
+    nodes = 0;
+    aborted = false;
+    checkingLimits = true;
+    if (limits.moveTimeMs > 0) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(limits.moveTimeMs);
+    }
+
+    MateResult result;
+    std::uint64_t rootKey = positionKey(board, sideToMove);
+    for (int moves = 1; moves <= limits.maxMoves; ++moves) {
+        int remaining = 2 * moves - 1;
+        ProofNumbers root = mid(board, sideToMove, remaining, tableKey(rootKey, remaining), PN_INFINITY, PN_INFINITY);
+        if (aborted) break;
+        if (root.phi == 0) {
+            result.status = MateStatus::MATE;
+            result.mateMoves = moves;
+            checkingLimits = false;
+            extractLine(board, sideToMove, moves, result.line);
+            break;
+        }
+    }
+    if (result.status != MateStatus::MATE && !aborted) result.status = MateStatus::NO_MATE;
+    result.nodes = nodes;
+    return result;
+}
+
+bool MateSolver::isAttacker(Color sideToMove) const {
+    return sideToMove == attacker;
+}
+
+void MateSolver::checkLimits() {
+    if (!checkingLimits || nodes % LIMIT_CHECK_INTERVAL != 0) return;
+    if ((limits.nodes > 0 && nodes >= limits.nodes) ||
+        (limits.moveTimeMs > 0 && std::chrono::steady_clock::now() >= deadline) ||
+        (limits.stopSignal && limits.stopSignal->load(std::memory_order_relaxed))) {
+        aborted = true;
+    }
+}
+
+const MateSolver::Entry* MateSolver::lookup(std::uint64_t key) const {
+    const Entry* bucket = &table[(key & bucketMask) * BUCKET_SIZE];
+    for (std::size_t i = 0; i < BUCKET_SIZE; ++i) {
+        if (bucket[i].key == key) return &bucket[i];
+    }
+    return nullptr;
+}
+
+void MateSolver::store(std::uint64_t key, std::uint32_t phi, std::uint32_t delta, std::uint64_t work) {
+    Entry* bucket = &table[(key & bucketMask) * BUCKET_SIZE];
+    Entry* slot = &bucket[0];
+    for (std::size_t i = 0; i < BUCKET_SIZE; ++i) {
+        if (bucket[i].key == key) {
+            slot = &bucket[i];
+            break;
+        }
+        if (bucket[i].work < slot->work) slot = &bucket[i];
+    }
+    slot->key = key;
+    slot->phi = phi;
+    slot->delta = delta;
+    slot->work = work;
+}
+
+// Children of a position with their proof numbers: from the table if they were
+// searched before, otherwise estimated. A defender's position counts as many
+// proofs as it has replies; mates, stalemates and positions without plies left
+// are settled right away.
+void MateSolver::expand(const Board& board, Color sideToMove, int remaining, std::vector<Child>& children) const {
+    std::vector<Move> moves;
+    Game::generateLegalMoves(board, sideToMove, moves);
+    Color opponent = opposite(sideToMove);
+    bool attackerToMove = isAttacker(sideToMove);
+
+    children.clear();
+    children.reserve(moves.size());
+    std::vector<Move> replies;
+    for (const Move& move : moves) {
+        Board child = board;
+        child.applyMove(move);
+        std::uint64_t key = tableKey(positionKey(child, opponent), remaining - 1);
+
+        ProofNumbers numbers{1, 1};
+        if (const Entry* entry = lookup(key)) {
+            numbers = {entry->phi, entry->delta};
+        } else if (attackerToMove) {
+            replies.clear();
+            Game::generateLegalMoves(child, opponent, replies);
+            if (replies.empty() && isInCheck(child, opponent)) {
+                numbers = {PN_INFINITY, 0}; // Mated
+            } else if (replies.empty() || remaining - 1 == 0) {
+                numbers = {0, PN_INFINITY}; // Stalemate, or out of plies
+            } else {
+                numbers = {1, static_cast<std::uint32_t>(replies.size())};
+            }
+        } else if (remaining - 1 == 0) {
+            numbers = {PN_INFINITY, 0}; // The attacker has no move left
+        }
+        children.push_back({move, key, numbers});
+    }
+}
+
+// Multiple-iterative deepening step of df-pn: searches below the position until
+// its phi or delta reaches the threshold, then stores and returns its numbers.
+// phi is the least delta of the children, delta the sum of their phi.
+MateSolver::ProofNumbers MateSolver::mid(const Board& board, Color sideToMove, int remaining, std::uint64_t key,
+                                         std::uint32_t thresholdPhi, std::uint32_t thresholdDelta) {
+    ++nodes;
+    checkLimits();
+    std::uint64_t startNodes = nodes;
+    std::vector<Child> children;
+    expand(board, sideToMove, remaining, children);
+
+    for (;;) {
+        std::uint32_t phi = PN_INFINITY;
+        std::uint32_t secondDelta = PN_INFINITY;
+        std::uint32_t delta = 0;
+        std::size_t best = 0;
+        for (std::size_t i = 0; i < children.size(); ++i) {
+            const ProofNumbers& c = children[i].numbers;
+            delta = c.phi == PN_INFINITY ? PN_INFINITY : (delta == PN_INFINITY ? delta : saturatingAdd(delta, c.phi));
+            if (c.delta < phi) {
+                secondDelta = phi;
+                phi = c.delta;
+                best = i;
+            } else if (c.delta < secondDelta) {
+                secondDelta = c.delta;
+            }
+        }
+        if (phi == 0) delta = PN_INFINITY;
+
+        if (phi >= thresholdPhi || delta >= thresholdDelta || aborted) {
+            if (!aborted) store(key, phi, delta, nodes - startNodes);
+            return {phi, delta};
+        }
+
+        // Search the most promising child until it is no longer the best:
+        // until its delta passes the runner-up's, or the parent's thresholds are hit
+        Child& child = children[best];
+        std::uint64_t childPhi = thresholdDelta == PN_INFINITY
+            ? PN_INFINITY
+            : std::min<std::uint64_t>(PN_INFINITY, static_cast<std::uint64_t>(thresholdDelta) + child.numbers.phi - delta);
+        std::uint64_t childDelta = std::min<std::uint64_t>(thresholdPhi, static_cast<std::uint64_t>(secondDelta) + 1);
+
+        Board next = board;
+        next.applyMove(child.move);
+        child.numbers = mid(next, opposite(sideToMove), remaining - 1, child.key,
+                            static_cast<std::uint32_t>(childPhi), static_cast<std::uint32_t>(childDelta));
+    }
+}
+
+// Mate length of the attacker's position in moves, 0 if there is none within
+// 'maxMoves', found like the root's by trying 1, 2, ... moves
+int MateSolver::shortestMate(const Board& board, Color sideToMove, int maxMoves) {
+    std::uint64_t key = positionKey(board, sideToMove);
+    for (int moves = 1; moves <= maxMoves; ++moves) {
+        int remaining = 2 * moves - 1;
+        if (mid(board, sideToMove, remaining, tableKey(key, remaining), PN_INFINITY, PN_INFINITY).phi == 0) return moves;
+    }
+    return 0;
+}
+
+// Best play in a position proven as mate in 'moves': the attacker keeps to the
+// shortest mate, the defender picks the reply that delays it longest. The
+// replies are solved one by one, mostly from the table; positions evicted
+// since are proven again.
+void MateSolver::extractLine(const Board& board, Color sideToMove, int moves, std::vector<Move>& line) {
+    Board current = board;
+    std::vector<Child> children;
+    std::vector<Move> replies;
+    while (moves > 0) {
+        int remaining = 2 * moves - 1;
+        expand(current, sideToMove, remaining, children);
+        const Child* mating = nullptr;
+        for (Child& child : children) {
+            if (child.numbers.delta != 0 && child.numbers.phi != 0) {
+                Board next = current;
+                next.applyMove(child.move);
+                child.numbers = mid(next, opposite(sideToMove), remaining - 1, child.key, PN_INFINITY, PN_INFINITY);
+            }
+            if (child.numbers.delta == 0) {
+                mating = &child;
+                break;
+            }
+        }
+        if (!mating) break; // Cannot happen in a proven position
+        line.push_back(mating->move);
+        current.applyMove(mating->move);
+
+        replies.clear();
+        Game::generateLegalMoves(current, opposite(sideToMove), replies);
+        if (replies.empty() || moves == 1) break; // Checkmate
+
+        int longest = 0;
+        Move defence = replies[0];
+        for (const Move& reply : replies) {
+            Board next = current;
+            next.applyMove(reply);
+            int mateMoves = shortestMate(next, sideToMove, moves - 1);
+            if (mateMoves > longest) {
+                longest = mateMoves;
+                defence = reply;
+            }
+        }
+        if (longest == 0) break;
+        line.push_back(defence);
+        current.applyMove(defence);
+        moves = longest;
+    }
+}
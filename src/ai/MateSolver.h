@@ -0,0 +1,100 @@
+#ifndef MATE_SOLVER_H
+#define MATE_SOLVER_H
+
+#include "core/ChessTypes.h"
+#include "core/Move.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Board;
+class Game;
+
+// Limits of a mate search; maxMoves is required, the others are optional
+struct MateSearchLimits {
+    int maxMoves = 5;         // Longest mate looked for, in moves of the mating side
+    std::uint64_t nodes = 0;  // Node budget (0 = none)
+    int moveTimeMs = 0;       // Wall-clock budget in milliseconds (0 = none)
+    const std::atomic<bool>* stopSignal = nullptr;
+};
+
+enum class MateStatus {
+    MATE,    // A forced mate was proven, see MateResult::line
+    NO_MATE, // Proven: the side to move has no mate within maxMoves
+    UNKNOWN  // A limit was hit before either was proven
+};
+
+struct MateResult {
+    MateStatus status = MateStatus::UNKNOWN;
+    int mateMoves = 0;      // Length of the shortest mate in moves of the mating side (MATE only)
+    std::vector<Move> line; // The mate with best defence, both sides' moves, ending in checkmate
+    std::uint64_t nodes = 0;
+};
+
+// Mate finder based on depth-first proof-number search (df-pn). Instead of
+// searching full width to a depth like the alpha-beta search, it keeps for
+// every position the number of positions still to be proven (or disproven)
+// to settle it, and always expands the most promising one: narrow forcing
+// lines are proven with few nodes even when they are deep. Attacker moves are
+// seeded with the defender's reply count, so checks and other moves that
+// leave few replies are looked at first.
+//
+// Mates are searched for in 1, 2, ... up to maxMoves moves, so the first
+// proof is the shortest mate. Results are kept in the solver's own
+// transposition table, keyed by position and remaining plies, and reused
+// across those iterations. Repetitions and the 50-move rule are ignored;
+// castling and en passant are played as usual. Works on every board size.
+class MateSolver {
+public:
+    explicit MateSolver(std::size_t hashMegabytes = 16);
+
+    MateResult solve(const Game& game, const MateSearchLimits& limits);
+    MateResult solve(const Board& board, Color sideToMove, const MateSearchLimits& limits);
+
+    // Forgets all results, e.g. between unrelated puzzles
+    void clear();
+
+private:
+    // Proof and disproof numbers from the side to move's point of view: phi is
+    // the proof number of its goal (mate for the attacker, escape for the
+    // defender), delta that of the opponent's. 0 means settled.
+    struct ProofNumbers {
+        std::uint32_t phi;
+        std::uint32_t delta;
+    };
+
+    struct Entry {
+        std::uint64_t key = 0; // 0 = empty
+        std::uint32_t phi = 0;
+        std::uint32_t delta = 0;
+        std::uint64_t work = 0; // Nodes spent below the position; the cheapest is replaced first
+    };
+
+    struct Child;
+
+    ProofNumbers mid(const Board& board, Color sideToMove, int remaining, std::uint64_t key,
+                     std::uint32_t thresholdPhi, std::uint32_t thresholdDelta);
+    void expand(const Board& board, Color sideToMove, int remaining, std::vector<Child>& children) const;
+    int shortestMate(const Board& board, Color sideToMove, int maxMoves);
+    void extractLine(const Board& board, Color sideToMove, int moves, std::vector<Move>& line);
+    bool isAttacker(Color sideToMove) const;
+    void checkLimits();
+
+    const Entry* lookup(std::uint64_t key) const;
+    void store(std::uint64_t key, std::uint32_t phi, std::uint32_t delta, std::uint64_t work);
+
+    std::vector<Entry> table;
+    std::size_t bucketMask;
+
+    // State of the running solve()
+    Color attacker;
+    MateSearchLimits limits;
+    std::uint64_t nodes;
+    bool aborted;
+    bool checkingLimits; // Off while the proven line is read back
+    std::chrono::steady_clock::time_point deadline;
+};
+
+#endif // MATE_SOLVER_H
@@ -0,0 +1,430 @@
+#include "ai/MctsSearcher.h"
+#include "ai/EvalTerms.h"
+#include "core/Board.h"
+#include "core/Game.h"
+#include "core/Piece.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace {
+
+// Node states. A node is expanded by the thread that moves it from UNEXPANDED
+// to EXPANDING; its children are visible to others once it reads EXPANDED.
+enum MctsNodeState : std::uint8_t {
+    NODE_UNEXPANDED = 0,
+    NODE_EXPANDING = 1,
+    NODE_EXPANDED = 2,
+    NODE_TERMINAL = 3 // Mate, stalemate or insufficient material
+};
+
+// Value sums are kept in fixed point so they can be added atomically
+constexpr double VALUE_UNIT = 65536.0;
+
+// Value assumed for a child that has not been visited: its parent's value
+// minus this, so untried moves are not preferred to ones known to be good
+constexpr float FIRST_PLAY_URGENCY_REDUCTION = 0.2f;
+
+// Prior logits: a capture counts this much plus a share of the victim's value,
+// a promotion a share of the new piece's; quiet moves count 0
+constexpr float CAPTURE_LOGIT = 1.0f;
+constexpr float VICTIM_LOGIT_PER_PAWN = 0.25f;
+constexpr float PROMOTION_LOGIT_PER_PAWN = 0.25f;
+
+// Playouts between two looks at the clock and the stop signal
+constexpr std::uint64_t LIMIT_CHECK_INTERVAL = 64;
+
+// Interval of the progress callback
+constexpr auto PROGRESS_INTERVAL = std::chrono::seconds(1);
+
+Color opposite(Color color) {
+    return (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+struct MctsSearcher::Node {
+    Move move = Move(Position(-1, -1), Position(-1, -1)); // Move leading here
+    float prior = 0.0f;
+    float terminalValue = 0.0f; // For the side to move, NODE_TERMINAL only
+    Node* children = nullptr;   // Written before 'state' turns NODE_EXPANDED
+    std::uint32_t childCount = 0;
+    std::atomic<std::uint8_t> state{NODE_UNEXPANDED};
+    std::atomic<std::uint32_t> visits{0};
+    std::atomic<std::int32_t> virtualLosses{0};
+    std::atomic<std::int64_t> valueSum{0}; // For the side that played 'move', in VALUE_UNITs
+
+    void reset(const Move& newMove, float newPrior) {
+        move = newMove;
+        prior = newPrior;
+        terminalValue = 0.0f;
+        children = nullptr;
+        childCount = 0;
+        state.store(NODE_UNEXPANDED, std::memory_order_relaxed);
+        visits.store(0, std::memory_order_relaxed);
+        virtualLosses.store(0, std::memory_order_relaxed);
+        valueSum.store(0, std::memory_order_relaxed);
+    }
+
+    // Mean value for the side that played 'move'
+    float meanValue() const {
+        std::uint32_t n = visits.load(std::memory_order_relaxed);
+        return n ? static_cast<float>(valueSum.load(std::memory_order_relaxed) / VALUE_UNIT / n) : 0.0f;
+    }
+};
+
+// Fixed block of nodes handed out by bumping an atomic index; reset() frees
+// everything at once
+class MctsSearcher::Arena {
+public:
+    explicit Arena(std::size_t capacity) : nodes(new Node[capacity]), capacity(capacity), used(0) {}
+
+    // 'count' consecutive nodes, nullptr once the arena is full
+    Node* allocate(std::size_t count) {
+        std::size_t start = used.fetch_add(count, std::memory_order_relaxed);
+        if (start + count > capacity) return nullptr;
+        return nodes.get() + start;
+    }
+
+    void reset() { used.store(0, std::memory_order_relaxed); }
+    std::size_t size() const { return std::min(used.load(std::memory_order_relaxed), capacity); }
+    std::size_t getCapacity() const { return capacity; }
+
+private:
+    std::unique_ptr<Node[]> nodes;
+    std::size_t capacity;
+    std::atomic<std::size_t> used;
+};
+
+// Per-thread scratch space, reused by every playout of the thread
+struct MctsSearcher::Worker {
+    std::vector<Node*> path;
+    std::vector<Move> moves;
+};
+
+MctsSearcher::MctsSearcher(const EvaluationEngine& engine, const MctsOptions& options)
+    : engine(engine), options(options), activeArena(0), root(nullptr), treeFull(false), maxDepth(0) {}
+
+MctsSearcher::~MctsSearcher() = default;
+
+const MctsStats& MctsSearcher::getLastStats() const {
+    return stats;
+}
+
+void MctsSearcher::clearTree() {
+    root = nullptr;
+    rootHistory.clear();
+    if (arenas[activeArena]) arenas[activeArena]->reset();
+}
+
+Move MctsSearcher::findBestMove(const Game& game, std::uint64_t playouts) {
+    SearchLimits limits;
+    limits.nodes = playouts;
+    return analyze(game, limits).bestMove;
+}
+
+EvaluationResult MctsSearcher::analyze(const Game& game, const SearchLimits& limits, const AnalysisCallback& onProgress) {
+    auto start = std::chrono::steady_clock::now();
+    stats = MctsStats();
+    Color rootSide = game.getCurrentPlayerColor();
+
+    if (game.getLegalMoves().empty()) {
+        EvaluationResult result;
+        if (game.isKingInCheck(rootSide)) {
+            float mate = std::numeric_limits<float>::infinity();
+            result.score = (rootSide == Color::WHITE) ? -mate : mate;
+        }
+        if (onProgress) onProgress(0, result);
+        return result;
+    }
+
+    // Each arena gets half the memory: the tree is copied from one to the other between moves
+    if (!arenas[activeArena]) {
+        std::size_t capacity = std::max<std::size_t>(1024, options.treeMegabytes * 1024 * 1024 / 2 / sizeof(Node));
+        arenas[0] = std::make_unique<Arena>(capacity);
+        arenas[1] = std::make_unique<Arena>(capacity);
+    }
+    prepareRoot(game);
+    stats.reusedVisits = root->visits.load(std::memory_order_relaxed);
+    treeFull.store(false, std::memory_order_relaxed);
+    maxDepth.store(0, std::memory_order_relaxed);
+
+    bool bounded = limits.nodes > 0 || limits.moveTimeMs > 0 || limits.infinite;
+    std::uint64_t playoutLimit = bounded ? limits.nodes : MCTS_DEFAULT_PLAYOUTS;
+    auto deadline = start + std::chrono::milliseconds(limits.moveTimeMs);
+
+    int threads = std::max(1, limits.threads);
+    ThreadPool pool(threads);
+    const Board& rootBoard = game.getBoard();
+    std::atomic<std::uint64_t> playouts{0};
+    std::atomic<bool> stop{false};
+    pool.parallelFor(static_cast<std::size_t>(threads), [&](std::size_t index) {
+        Worker worker;
+        auto lastReport = std::chrono::steady_clock::now();
+        while (!stop.load(std::memory_order_relaxed)) {
+            playout(rootBoard, rootSide, worker);
+            std::uint64_t done = playouts.fetch_add(1, std::memory_order_relaxed) + 1;
+
+            if ((playoutLimit > 0 && done >= playoutLimit) || treeFull.load(std::memory_order_relaxed)) {
+                stop.store(true, std::memory_order_relaxed);
+            }
+            if (done % LIMIT_CHECK_INTERVAL == 0) {
+                if ((limits.moveTimeMs > 0 && std::chrono::steady_clock::now() >= deadline) ||
+                    (limits.stopSignal && limits.stopSignal->load(std::memory_order_relaxed))) {
+                    stop.store(true, std::memory_order_relaxed);
+                }
+            }
+            // One thread reports, so the callback is never called concurrently
+            if (index == 0 && onProgress && std::chrono::steady_clock::now() - lastReport >= PROGRESS_INTERVAL) {
+                lastReport = std::chrono::steady_clock::now();
+                EvaluationResult progress = currentResult(rootSide);
+                progress.nodesSearched = static_cast<int>(playouts.load(std::memory_order_relaxed));
+                onProgress(maxDepth.load(std::memory_order_relaxed), progress);
+            }
+        }
+    });
+
+    stats.playouts = playouts.load();
+    stats.seconds = secondsSince(start);
+    stats.treeNodes = arenas[activeArena]->size();
+    stats.maxDepth = maxDepth.load();
+    stats.treeFull = treeFull.load();
+
+    EvaluationResult result = currentResult(rootSide);
+    result.nodesSearched = static_cast<int>(std::min<std::uint64_t>(stats.playouts, std::numeric_limits<int>::max()));
+    if (onProgress) onProgress(stats.maxDepth, result);
+    return result;
+}
+
+// Keeps the subtree of the game's position if the game continues the position
+// searched last (the same start and the old moves followed by new ones)
+void MctsSearcher::prepareRoot(const Game& game) {
+    const std::vector<Move>& history = game.getMoveHistory();
+    std::string startFen = game.getStartFen();
+
+    Node* reached = nullptr;
+    if (root && startFen == rootStartFen && history.size() >= rootHistory.size() &&
+        std::equal(rootHistory.begin(), rootHistory.end(), history.begin())) {
+        reached = root;
+        for (std::size_t i = rootHistory.size(); i < history.size() && reached; ++i) {
+            Node* parent = reached;
+            reached = nullptr;
+            if (parent->state.load(std::memory_order_acquire) != NODE_EXPANDED) break;
+            for (std::uint32_t c = 0; c < parent->childCount; ++c) {
+                if (parent->children[c].move == history[i]) {
+                    reached = &parent->children[c];
+                    break;
+                }
+            }
+        }
+    }
+
+    // The root's own tree has nothing to drop, but once it fills more than half
+    // the arena the next search would soon run out, so it is trimmed as well
+    std::size_t budget = arenas[activeArena]->getCapacity() / 2;
+    if (reached && (reached != root || arenas[activeArena]->size() > budget)) {
+        Arena& target = *arenas[1 - activeArena];
+        target.reset();
+        Node* copy = target.allocate(1);
+        copySubtree(*reached, *copy, target, budget);
+        arenas[activeArena]->reset();
+        activeArena = 1 - activeArena;
+        root = copy;
+    } else if (!reached) {
+        arenas[activeArena]->reset();
+        root = arenas[activeArena]->allocate(1);
+        root->reset(Move(Position(-1, -1), Position(-1, -1)), 1.0f);
+    }
+    // A dead draw is terminal below the root, but the root still needs a move
+    if (root->state.load(std::memory_order_relaxed) == NODE_TERMINAL) root->state.store(NODE_UNEXPANDED, std::memory_order_relaxed);
+    rootStartFen = startFen;
+    rootHistory = history;
+}
+
+// Copies level by level, so when the tree needs more than 'budget' nodes it is
+// the deepest ones that are left out. A node whose children do not fit keeps
+// its visits and value and is expanded again by the next playout reaching it.
+void MctsSearcher::copySubtree(const Node& source, Node& copy, Arena& target, std::size_t budget) {
+    std::vector<std::pair<const Node*, Node*>> queue{{&source, &copy}};
+    std::size_t copied = 1;
+    for (std::size_t i = 0; i < queue.size(); ++i) {
+        const Node& from = *queue[i].first;
+        Node& to = *queue[i].second;
+        to.reset(from.move, from.prior);
+        to.terminalValue = from.terminalValue;
+        to.visits.store(from.visits.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        to.valueSum.store(from.valueSum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        std::uint8_t state = from.state.load(std::memory_order_relaxed);
+        if (state == NODE_EXPANDING) state = NODE_UNEXPANDED;
+        if (state == NODE_EXPANDED) {
+            if (copied + from.childCount <= budget) {
+                to.children = target.allocate(from.childCount); // Never fails: budget is within the arena
+                to.childCount = from.childCount;
+                copied += from.childCount;
+                for (std::uint32_t c = 0; c < from.childCount; ++c) queue.emplace_back(&from.children[c], &to.children[c]);
+            } else {
+                state = NODE_UNEXPANDED;
+            }
+        }
+        to.state.store(state, std::memory_order_relaxed);
+    }
+}
+
+void MctsSearcher::playout(const Board& rootBoard, Color rootSide, Worker& worker) {
+    Board board = rootBoard;
+    Color side = rootSide;
+    std::vector<Node*>& path = worker.path;
+    path.clear();
+    path.push_back(root);
+
+    Node* node = root;
+    while (node->state.load(std::memory_order_acquire) == NODE_EXPANDED) {
+        node = selectChild(node);
+        node->virtualLosses.fetch_add(options.virtualLoss, std::memory_order_relaxed);
+        board.applyMove(node->move);
+        side = opposite(side);
+        path.push_back(node);
+    }
+
+    // Value of the leaf for its side to move. A leaf another thread is
+    // expanding is only evaluated.
+    float value;
+    std::uint8_t expected = NODE_UNEXPANDED;
+    if (node->state.compare_exchange_strong(expected, NODE_EXPANDING, std::memory_order_acquire)) {
+        value = expand(node, board, side, worker);
+    } else if (expected == NODE_TERMINAL) {
+        value = node->terminalValue;
+    } else {
+        value = evaluateLeaf(board, side);
+    }
+
+    int depth = static_cast<int>(path.size()) - 1;
+    int deepest = maxDepth.load(std::memory_order_relaxed);
+    while (depth > deepest && !maxDepth.compare_exchange_weak(deepest, depth, std::memory_order_relaxed)) {
+    }
+
+    // Each node keeps the value for the side that moved into it, so the sign
+    // flips on the way up
+    for (std::size_t i = path.size(); i-- > 0;) {
+        value = -value;
+        Node* pathNode = path[i];
+        pathNode->valueSum.fetch_add(std::llround(value * VALUE_UNIT), std::memory_order_relaxed);
+        pathNode->visits.fetch_add(1, std::memory_order_relaxed);
+        if (i > 0) pathNode->virtualLosses.fetch_sub(options.virtualLoss, std::memory_order_relaxed);
+    }
+}
+
+// PUCT: mean value plus exploration * prior * sqrt(parent visits) / (1 + visits).
+// Virtual losses count as visits that were lost.
+MctsSearcher::Node* MctsSearcher::selectChild(Node* node) const {
+    float parentVisits = static_cast<float>(node->visits.load(std::memory_order_relaxed) +
+                                            node->virtualLosses.load(std::memory_order_relaxed));
+    float explorationScale = options.exploration * std::sqrt(std::max(1.0f, parentVisits));
+    float firstPlayValue = -node->meanValue() - FIRST_PLAY_URGENCY_REDUCTION;
+
+    Node* best = &node->children[0];
+    float bestScore = -std::numeric_limits<float>::infinity();
+    for (std::uint32_t c = 0; c < node->childCount; ++c) {
+        Node* child = &node->children[c];
+        std::uint32_t visits = child->visits.load(std::memory_order_relaxed);
+        std::int32_t losses = child->virtualLosses.load(std::memory_order_relaxed);
+        float effectiveVisits = static_cast<float>(visits + losses);
+        float value = firstPlayValue;
+        if (effectiveVisits > 0) {
+            double sum = child->valueSum.load(std::memory_order_relaxed) / VALUE_UNIT - losses;
+            value = static_cast<float>(sum / effectiveVisits);
+        }
+        float score = value + explorationScale * child->prior / (1.0f + effectiveVisits);
+        if (score > bestScore) {
+            bestScore = score;
+            best = child;
+        }
+    }
+    return best;
+}
+
+// Creates the children of a claimed node with their priors and returns the
+// node's value. Mates, stalemates and (below the root) dead draws become
+// terminal instead.
+float MctsSearcher::expand(Node* node, const Board& board, Color sideToMove, Worker& worker) {
+    std::vector<Move>& moves = worker.moves;
+    moves.clear();
+    Game::generateLegalMoves(board, sideToMove, moves);
+    if (moves.empty() || (node != root && board.isInsufficientMaterial())) {
+        bool mated = moves.empty() && board.isSquareAttacked(board.findKing(sideToMove), opposite(sideToMove));
+        node->terminalValue = mated ? -1.0f : 0.0f;
+        node->state.store(NODE_TERMINAL, std::memory_order_release);
+        return node->terminalValue;
+    }
+
+    Node* children = arenas[activeArena]->allocate(moves.size());
+    if (!children) {
+        treeFull.store(true, std::memory_order_relaxed);
+        node->state.store(NODE_UNEXPANDED, std::memory_order_release);
+        return evaluateLeaf(board, sideToMove);
+    }
+
+    float weightSum = 0.0f;
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        const Move& move = moves[i];
+        float logit = 0.0f;
+        const Piece* victim = board.getPieceAt(move.to);
+        if (victim || move.isEnPassantCapture) {
+            PieceType victimType = victim ? victim->getType() : PieceType::PAWN;
+            logit += CAPTURE_LOGIT + VICTIM_LOGIT_PER_PAWN * PIECE_VALUES[static_cast<int>(victimType)];
+        }
+        if (move.promotionPiece != PieceType::EMPTY) {
+            logit += PROMOTION_LOGIT_PER_PAWN * PIECE_VALUES[static_cast<int>(move.promotionPiece)];
+        }
+        float weight = std::exp(logit);
+        children[i].reset(move, weight);
+        weightSum += weight;
+    }
+    for (std::size_t i = 0; i < moves.size(); ++i) {
+        children[i].prior /= weightSum;
+    }
+
+    node->children = children;
+    node->childCount = static_cast<std::uint32_t>(moves.size());
+    node->state.store(NODE_EXPANDED, std::memory_order_release);
+    return evaluateLeaf(board, sideToMove);
+}
+
+// Static evaluation squashed into [-1, 1] for the side to move
+float MctsSearcher::evaluateLeaf(const Board& board, Color sideToMove) const {
+    float value = std::tanh(engine.staticEvaluate(board, Color::WHITE) / options.evalScale);
+    return (sideToMove == Color::WHITE) ? value : -value;
+}
+
+// The most visited root move; its value is turned back into pawns (a mate it
+// delivers into an infinite score)
+EvaluationResult MctsSearcher::currentResult(Color rootSide) const {
+    EvaluationResult result;
+    if (root->state.load(std::memory_order_acquire) != NODE_EXPANDED) return result;
+
+    const Node* best = &root->children[0];
+    for (std::uint32_t c = 1; c < root->childCount; ++c) {
+        if (root->children[c].visits.load(std::memory_order_relaxed) > best->visits.load(std::memory_order_relaxed)) {
+            best = &root->children[c];
+        }
+    }
+    result.bestMove = best->move;
+
+    float score;
+    if (best->state.load(std::memory_order_acquire) == NODE_TERMINAL && best->terminalValue < 0.0f) {
+        score = std::numeric_limits<float>::infinity();
+    } else {
+        float value = std::clamp(best->meanValue(), -0.999f, 0.999f);
+        score = options.evalScale * std::atanh(value);
+    }
+    result.score = (rootSide == Color::WHITE) ? score : -score;
+    return result;
+}
@@ -0,0 +1,103 @@
+#ifndef MCTS_SEARCHER_H
+#define MCTS_SEARCHER_H
+
+#include "ai/EvaluationEngine.h"
+#include "core/Move.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class Game;
+class Board;
+
+// Playouts of a search without any other limit
+constexpr std::uint64_t MCTS_DEFAULT_PLAYOUTS = 10000;
+
+struct MctsOptions {
+    float exploration = 1.5f;  // PUCT constant: weight of the prior against the value
+    float evalScale = 2.0f;    // Pawns of static evaluation per tanh unit of value
+    int virtualLoss = 3;       // Losses a playout charges to the nodes on its path until it returns
+    std::size_t treeMegabytes = 128;
+};
+
+// Counters of the last MctsSearcher::analyze
+struct MctsStats {
+    std::uint64_t playouts = 0;     // Played by this search
+    std::uint64_t reusedVisits = 0; // Root visits carried over from the previous search
+    std::size_t treeNodes = 0;
+    int maxDepth = 0;               // Deepest node a playout reached, in plies from the root
+    double seconds = 0.0;
+    bool treeFull = false;          // The search stopped because the node arena ran out
+
+    double playoutsPerSecond() const { return seconds > 0.0 ? playouts / seconds : 0.0; }
+};
+
+// Monte Carlo tree search as an alternative to the alpha-beta search, for
+// boards where the evaluation is too weak to trust at a fixed depth.
+//
+// Each playout walks down the tree by PUCT (value plus an exploration bonus
+// weighted by the move's prior), expands the leaf it reaches and scores it with
+// the engine's static evaluation mapped to [-1, 1] instead of a random
+// rollout. Priors favour captures and promotions.
+//
+// Playouts run on limits.threads threads over one shared tree. Visit counts and
+// value sums are atomics, a node is expanded by whichever thread claims it
+// first, and a playout charges virtual losses to its path so the others spread
+// out. Nodes are allocated from an arena; between moves the subtree of the
+// position actually reached is copied into a second arena and the first one
+// is reset, so the tree carries over without fragmenting. The copy keeps at
+// most half an arena, its top levels first, so the next search has room to
+// grow; a tree searched again from the same root is compacted the same way
+// once it fills more than half its arena. Repetitions and the 50-move rule are
+// not modelled.
+class MctsSearcher {
+public:
+    // 'engine' scores the leaves and must outlive the searcher
+    explicit MctsSearcher(const EvaluationEngine& engine, const MctsOptions& options = MctsOptions());
+    ~MctsSearcher();
+
+    MctsSearcher(const MctsSearcher&) = delete;
+    MctsSearcher& operator=(const MctsSearcher&) = delete;
+
+    // Same contract as EvaluationEngine::analyze, except that limits.nodes
+    // counts playouts and limits.depth is ignored (MCTS_DEFAULT_PLAYOUTS when
+    // nothing else is set). The callback gets the deepest playout so far and
+    // the current result about once a second and at the end; the score is from
+    // White's point of view in pawns, converted back from the value.
+    EvaluationResult analyze(const Game& game, const SearchLimits& limits, const AnalysisCallback& onProgress = nullptr);
+    Move findBestMove(const Game& game, std::uint64_t playouts = MCTS_DEFAULT_PLAYOUTS);
+
+    const MctsStats& getLastStats() const;
+
+    // Drops the tree, so the next search starts from scratch
+    void clearTree();
+
+private:
+    struct Node;
+    class Arena;
+    struct Worker;
+
+    void prepareRoot(const Game& game);
+    void playout(const Board& rootBoard, Color rootSide, Worker& worker);
+    Node* selectChild(Node* node) const;
+    float expand(Node* node, const Board& board, Color sideToMove, Worker& worker);
+    float evaluateLeaf(const Board& board, Color sideToMove) const;
+    void copySubtree(const Node& source, Node& copy, Arena& target, std::size_t budget);
+    EvaluationResult currentResult(Color rootSide) const;
+
+    const EvaluationEngine& engine;
+    MctsOptions options;
+    std::unique_ptr<Arena> arenas[2]; // The tree lives in arenas[activeArena]
+    int activeArena;
+    Node* root;
+    std::string rootStartFen;      // Game::getStartFen of the root
+    std::vector<Move> rootHistory; // Moves from the start FEN to the root
+    std::atomic<bool> treeFull;
+    std::atomic<int> maxDepth;
+    MctsStats stats;
+};
+
+#endif // MCTS_SEARCHER_H
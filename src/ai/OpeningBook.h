@@ -0,0 +1,63 @@
+#ifndef OPENING_BOOK_H
+#define OPENING_BOOK_H
+
+#include "core/ChessTypes.h"
+#include "core/Move.h"
+#include "util/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class Board;
+class Game;
+
+// Key of a position as used by Polyglot opening books: the XOR of entries of
+// Polyglot's fixed 781-number table for every piece, castling right, the en
+// passant file (only if a pawn of the side to move could capture there) and
+// White to move. Differs from zobristKey(), which uses our own random table.
+// Throws std::invalid_argument for boards other than 8x8.
+std::uint64_t polyglotKey(const Board& board, Color sideToMove);
+
+// A move in Polyglot's 16-bit encoding: to square in bits 0-5, from square in
+// bits 6-11 (a1 = 0), promotion in bits 12-14 (none, N, B, R, Q). Castling is
+// written as the king taking its own rook.
+std::uint16_t polyglotMove(const Move& move);
+
+// How a move is chosen among the book moves of a position
+enum class BookSelection {
+    WEIGHTED, // At random, in proportion to the entry weights
+    BEST      // Always the highest weight (deterministic, for tests and benchmarks)
+};
+
+// One legal move of the probed position with its book weight
+struct BookMove {
+    Move move;
+    int weight;
+};
+
+// Read-only Polyglot opening book (.bin). The file is a sorted array of
+// 16-byte big-endian entries: uint64 key, uint16 move, uint16 weight,
+// uint32 learn. It is memory-mapped and looked up by binary search, so
+// opening even a large book costs nothing up front.
+class OpeningBook {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a whole number of entries
+    explicit OpeningBook(const std::string& path);
+
+    std::size_t size() const; // Entries
+
+    // Book moves of the position that are legal on 'board', highest weight first
+    std::vector<BookMove> probe(const Board& board, Color sideToMove) const;
+
+    // Picks a move for the side to move in 'game'. 'random' supplies the
+    // randomness of BookSelection::WEIGHTED. Returns false if the position is
+    // not in the book or all its entries have weight 0.
+    bool pickMove(const Game& game, BookSelection selection, std::uint64_t random, Move& out) const;
+
+private:
+    MappedFile file;
+    std::size_t entryCount;
+};
+
+#endif // OPENING_BOOK_H
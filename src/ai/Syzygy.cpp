@@ -0,0 +1,975 @@
+#include "ai/Syzygy.h"
+#include "core/Board.h"
+#include "core/Game.h"
+#include "core/Bitboard.h"
+#include "core/Piece.h"
+#include "util/MappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+
+// The decoding below follows the Syzygy format as written by Ronald de Man's
+// generator. Positions are mapped to an index by a "perfect" encoding that
+// removes symmetries (see encodePosition), and the values at consecutive
+// indices are compressed with Recursive Pairing followed by canonical Huffman
+// codes in fixed-size blocks (see decompressPairs).
+
+namespace {
+
+const int TB_PIECES = 7;
+
+// Squares are a1 = 0 ... h8 = 63, as in Bitboard.h
+int fileOf(int square) { return square & 7; }
+int rankOf(int square) { return square >> 3; }
+int flipFile(int square) { return square ^ 7; }
+int flipRank(int square) { return square ^ 56; }
+
+// Positive above the a1-h8 diagonal, negative below, 0 on it
+int offDiagonal(int square) { return rankOf(square) - fileOf(square); }
+
+// Piece codes of the format: white pawn, knight, bishop, rook, queen, king are
+// 1 to 6, the black pieces 9 to 14. XOR with 8 swaps the colour.
+const int BLACK_PIECE = 8;
+
+int pieceCode(PieceType type, Color color) {
+    int code = 0;
+    switch (type) {
+        case PieceType::PAWN: code = 1; break;
+        case PieceType::KNIGHT: code = 2; break;
+        case PieceType::BISHOP: code = 3; break;
+        case PieceType::ROOK: code = 4; break;
+        case PieceType::QUEEN: code = 5; break;
+        case PieceType::KING: code = 6; break;
+        default: return 0;
+    }
+    return color == Color::BLACK ? code | BLACK_PIECE : code;
+}
+
+// File header magics
+const std::uint8_t WDL_MAGIC[4] = {0x71, 0xE8, 0x23, 0x5D};
+const std::uint8_t DTZ_MAGIC[4] = {0xD7, 0x66, 0x0C, 0xA5};
+
+// Flags of a PairsData record
+const std::uint8_t FLAG_STM = 1;          // DTZ: the side to move the table is for
+const std::uint8_t FLAG_MAPPED = 2;       // DTZ: values go through the per-WDL map
+const std::uint8_t FLAG_WIN_PLIES = 4;    // DTZ: wins are in plies, not moves
+const std::uint8_t FLAG_LOSS_PLIES = 8;   // DTZ: losses are in plies, not moves
+const std::uint8_t FLAG_WIDE = 16;        // DTZ: 16-bit map entries
+const std::uint8_t FLAG_SINGLE_VALUE = 128; // Every position has the same value
+
+// Plies of a DTZ that is only known to end in a zeroing move
+int dtzBeforeZeroing(Wdl wdl) {
+    switch (wdl) {
+        case Wdl::WIN: return 1;
+        case Wdl::CURSED_WIN: return 101;
+        case Wdl::BLESSED_LOSS: return -101;
+        case Wdl::LOSS: return -1;
+        default: return 0;
+    }
+}
+
+Wdl negate(Wdl wdl) {
+    return static_cast<Wdl>(-static_cast<int>(wdl));
+}
+
+int signOf(int value) {
+    return (value > 0) - (value < 0);
+}
+
+std::uint16_t readLittleEndian16(const std::uint8_t* bytes) {
+    return static_cast<std::uint16_t>(bytes[0] | (bytes[1] << 8));
+}
+
+std::uint32_t readLittleEndian32(const std::uint8_t* bytes) {
+    return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+           (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+}
+
+std::uint32_t readBigEndian32(const std::uint8_t* bytes) {
+    return (static_cast<std::uint32_t>(bytes[0]) << 24) | (static_cast<std::uint32_t>(bytes[1]) << 16) |
+           (static_cast<std::uint32_t>(bytes[2]) << 8) | static_cast<std::uint32_t>(bytes[3]);
+}
+
+std::uint64_t readBigEndian64(const std::uint8_t* bytes) {
+    return (static_cast<std::uint64_t>(readBigEndian32(bytes)) << 32) | readBigEndian32(bytes + 4);
+}
+
+// Rounds a pointer into the mapping up to a multiple of 'alignment' bytes;
+// mappings start on a page boundary, so this matches offsets in the file
+const std::uint8_t* align(const std::uint8_t* data, std::uintptr_t alignment) {
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data);
+    return data + ((alignment - address % alignment) % alignment);
+}
+
+// Index tables shared by every table and probe
+struct EncodingTables {
+    int mapB1H1H7[64] = {};  // Squares below the a1-h8 diagonal -> 0..27
+    int mapA1D1D4[64] = {};  // The a1-d1-d4 triangle -> 0..9, diagonal squares last
+    int mapKK[10][64] = {};  // The 462 placements of two kings, the first in the triangle
+    std::uint64_t binomial[6][64] = {}; // binomial[k][n]: ways to choose k of n
+    int mapPawns[64] = {};   // a2-h7 -> 0..47, highest for the leading pawn
+    int leadPawnIdx[6][64] = {};
+    std::uint64_t leadPawnsSize[6][4] = {}; // [leading pawns][file a..d]
+
+    EncodingTables() {
+        int code = 0;
+        for (int square = 0; square < 64; ++square) {
+            if (offDiagonal(square) < 0) mapB1H1H7[square] = code++;
+        }
+
+        std::vector<int> diagonal;
+        code = 0;
+        for (int square = 0; square <= 27; ++square) { // a1..d4
+            if (offDiagonal(square) < 0 && fileOf(square) <= 3) mapA1D1D4[square] = code++;
+            else if (offDiagonal(square) == 0 && fileOf(square) <= 3) diagonal.push_back(square);
+        }
+        for (int square : diagonal) mapA1D1D4[square] = code++;
+
+        // Kings next to each other are impossible; with the first king on the
+        // diagonal the second is kept below it. Both on the diagonal come last.
+        std::vector<std::pair<int, int>> bothOnDiagonal;
+        code = 0;
+        for (int index = 0; index < 10; ++index) {
+            for (int first = 0; first <= 27; ++first) {
+                if (mapA1D1D4[first] != index || (index == 0 && first != 1)) continue; // b1 is 0
+                Bitboard taken = kingAttacks(first) | squareBB(first);
+                for (int second = 0; second < 64; ++second) {
+                    if (taken & squareBB(second)) continue;
+                    if (offDiagonal(first) == 0 && offDiagonal(second) > 0) continue;
+                    if (offDiagonal(first) == 0 && offDiagonal(second) == 0) bothOnDiagonal.emplace_back(index, second);
+                    else mapKK[index][second] = code++;
+                }
+            }
+        }
+        for (const auto& kings : bothOnDiagonal) mapKK[kings.first][kings.second] = code++;
+
+        binomial[0][0] = 1;
+        for (int n = 1; n < 64; ++n) {
+            for (int k = 0; k < 6 && k <= n; ++k) {
+                binomial[k][n] = (k > 0 ? binomial[k - 1][n - 1] : 0) + (k < n ? binomial[k][n - 1] : 0);
+            }
+        }
+
+        // The leading pawn is the one nearest the edge and, on the same file,
+        // the one on the lowest rank; every other pawn has a lower mapPawns
+        int available = 47;
+        for (int leadPawns = 1; leadPawns <= 5; ++leadPawns) {
+            for (int file = 0; file < 4; ++file) {
+                std::uint64_t index = 0;
+                for (int rank = 1; rank <= 6; ++rank) {
+                    int square = rank * 8 + file;
+                    if (leadPawns == 1) {
+                        mapPawns[square] = available--;
+                        mapPawns[flipFile(square)] = available--;
+                    }
+                    leadPawnIdx[leadPawns][square] = static_cast<int>(index);
+                    index += binomial[leadPawns - 1][mapPawns[square]];
+                }
+                leadPawnsSize[leadPawns][file] = index;
+            }
+        }
+    }
+};
+
+const EncodingTables& encoding() {
+    static const EncodingTables tables;
+    return tables;
+}
+
+// Decoding state of one (side to move, leading file) slice of a table
+struct PairsData {
+    std::uint8_t flags = 0;
+    int maxSymLen = 0;
+    int minSymLen = 0;                          // The single value with FLAG_SINGLE_VALUE
+    std::uint32_t numBlocks = 0;
+    std::size_t sizeofBlock = 0;
+    std::size_t span = 0;                       // Values between sparse index entries
+    const std::uint8_t* lowestSym = nullptr;    // 16-bit lowest symbol of each code length
+    const std::uint8_t* btree = nullptr;        // 3 bytes per symbol: its left and right halves
+    const std::uint8_t* blockLength = nullptr;  // 16-bit values per block, minus one
+    std::uint32_t blockLengthSize = 0;
+    const std::uint8_t* sparseIndex = nullptr;  // 6 bytes per entry: 32-bit block, 16-bit offset
+    std::size_t sparseIndexSize = 0;
+    const std::uint8_t* data = nullptr;         // Huffman-coded blocks
+    std::vector<std::uint64_t> base64;          // Lowest code of each length, left-aligned
+    std::vector<std::uint8_t> symlen;           // Values per symbol, minus one
+    int pieces[TB_PIECES] = {};                 // Piece codes in encoding order
+    std::uint64_t groupIdx[TB_PIECES + 1] = {}; // Multiplier of each group, last = table size
+    int groupLen[TB_PIECES + 1] = {};           // Pieces per group, zero-terminated
+    std::uint16_t mapIdx[4] = {};               // DTZ map start for WIN, LOSS, CURSED_WIN, BLESSED_LOSS
+
+    int leftSymbol(int symbol) const {
+        const std::uint8_t* pair = btree + 3 * symbol;
+        return ((pair[1] & 0xF) << 8) | pair[0];
+    }
+    int rightSymbol(int symbol) const {
+        const std::uint8_t* pair = btree + 3 * symbol;
+        return (pair[2] << 4) | (pair[1] >> 4);
+    }
+};
+
+// One .rtbw or .rtbz file, mapped on first use
+struct Table {
+    std::atomic<bool> ready{false};
+    bool usable = false;
+    MappedFile file;
+    const std::uint8_t* dtzMap = nullptr;
+    PairsData items[2][4]; // [side to move][leading file, or 0 without pawns]
+};
+
+std::mutex loadMutex; // Serializes the first mapping of each table
+
+// Number of symbols a symbol stands for, minus one; the tree is acyclic
+int setSymbolLength(PairsData& d, int symbol, std::vector<bool>& visited) {
+    visited[symbol] = true;
+    int right = d.rightSymbol(symbol);
+    if (right == 0xFFF) return 0;
+    int left = d.leftSymbol(symbol);
+    if (!visited[left]) d.symlen[left] = static_cast<std::uint8_t>(setSymbolLength(d, left, visited));
+    if (!visited[right]) d.symlen[right] = static_cast<std::uint8_t>(setSymbolLength(d, right, visited));
+    return d.symlen[left] + d.symlen[right] + 1;
+}
+
+const std::uint8_t* setSizes(PairsData& d, const std::uint8_t* data) {
+    d.flags = *data++;
+    if (d.flags & FLAG_SINGLE_VALUE) {
+        d.minSymLen = *data++;
+        return data;
+    }
+
+    std::uint64_t tableSize = d.groupIdx[std::find(d.groupLen, d.groupLen + TB_PIECES, 0) - d.groupLen];
+    d.sizeofBlock = std::size_t{1} << *data++;
+    d.span = std::size_t{1} << *data++;
+    d.sparseIndexSize = static_cast<std::size_t>((tableSize + d.span - 1) / d.span);
+    int padding = *data++;
+    d.numBlocks = readLittleEndian32(data);
+    data += 4;
+    d.blockLengthSize = d.numBlocks + padding; // Padded so the sparse index never points past it
+    d.maxSymLen = *data++;
+    d.minSymLen = *data++;
+    d.lowestSym = data;
+
+    // Canonical Huffman code: longer codes have lower values. base64[i] is the
+    // lowest code of length minSymLen + i, left-aligned in 64 bits, so a code
+    // read from the stream has length i when base64[i - 1] > code >= base64[i].
+    d.base64.assign(d.maxSymLen - d.minSymLen + 1, 0);
+    for (int i = static_cast<int>(d.base64.size()) - 2; i >= 0; --i) {
+        d.base64[i] = (d.base64[i + 1] + readLittleEndian16(d.lowestSym + 2 * i) - readLittleEndian16(d.lowestSym + 2 * (i + 1))) / 2;
+    }
+    for (std::size_t i = 0; i < d.base64.size(); ++i) {
+        d.base64[i] <<= 64 - i - d.minSymLen;
+    }
+    data += d.base64.size() * 2;
+
+    d.symlen.assign(readLittleEndian16(data), 0);
+    data += 2;
+    d.btree = data;
+    std::vector<bool> visited(d.symlen.size());
+    for (std::size_t symbol = 0; symbol < d.symlen.size(); ++symbol) {
+        if (!visited[symbol]) d.symlen[symbol] = static_cast<std::uint8_t>(setSymbolLength(d, static_cast<int>(symbol), visited));
+    }
+    return data + d.symlen.size() * 3 + (d.symlen.size() & 1);
+}
+
+// Value number 'index' of a slice
+int decompressPairs(const PairsData& d, std::uint64_t index) {
+    if (d.flags & FLAG_SINGLE_VALUE) return d.minSymLen;
+
+    // Block n holds blockLength[n] + 1 values. Sparse index entry k gives the
+    // block and offset of value k * span + span / 2; walk from there.
+    std::size_t k = static_cast<std::size_t>(index / d.span);
+    const std::uint8_t* entry = d.sparseIndex + 6 * k;
+    std::uint32_t block = readLittleEndian32(entry);
+    int offset = readLittleEndian16(entry + 4);
+    offset += static_cast<int>(index % d.span) - static_cast<int>(d.span / 2);
+    while (offset < 0) offset += readLittleEndian16(d.blockLength + 2 * --block) + 1;
+    while (offset > readLittleEndian16(d.blockLength + 2 * block)) offset -= readLittleEndian16(d.blockLength + 2 * block++) + 1;
+
+    // Read symbols until the one that covers 'offset'; each stands for symlen + 1 values
+    const std::uint8_t* stream = d.data + static_cast<std::uint64_t>(block) * d.sizeofBlock;
+    std::uint64_t buffer = readBigEndian64(stream);
+    stream += 8;
+    int bufferBits = 64;
+    int symbol = 0;
+    for (;;) {
+        int length = 0; // Code length minus minSymLen
+        while (buffer < d.base64[length]) ++length;
+        symbol = static_cast<int>((buffer - d.base64[length]) >> (64 - length - d.minSymLen));
+        symbol += readLittleEndian16(d.lowestSym + 2 * length);
+        if (offset < d.symlen[symbol] + 1) break;
+
+        offset -= d.symlen[symbol] + 1;
+        length += d.minSymLen;
+        buffer <<= length;
+        bufferBits -= length;
+        if (bufferBits <= 32) {
+            bufferBits += 32;
+            buffer |= static_cast<std::uint64_t>(readBigEndian32(stream)) << (64 - bufferBits);
+            stream += 4;
+        }
+    }
+
+    // Expand the pair symbol down to the single value at 'offset'
+    while (d.symlen[symbol]) {
+        int left = d.leftSymbol(symbol);
+        if (offset < d.symlen[left] + 1) {
+            symbol = left;
+        } else {
+            offset -= d.symlen[left] + 1;
+            symbol = d.rightSymbol(symbol);
+        }
+    }
+    return d.leftSymbol(symbol);
+}
+
+} // namespace
+
+struct SyzygyTablePair {
+    std::string name;     // File name without extension, e.g. "KRvK"
+    std::uint64_t key;    // Material key with the first side of the name as White
+    std::uint64_t key2;   // ... and as Black
+    int pieceCount;
+    bool hasPawns;
+    bool hasUniquePieces; // Some side has exactly one piece of some kind besides the king
+    int pawnCount[2];     // Pawns of the leading colour (fewer pawns, White if equal) and the other
+    Table wdl;
+    Table dtz;
+};
+
+enum class SyzygyTablebase::ProbeState {
+    OK,
+    FAIL,
+    ZEROING_BEST_MOVE, // The best move is a capture or pawn move; the table value may be wrong
+    CHANGE_STM         // DTZ only: the table stores the other side to move
+};
+
+namespace {
+
+// Material signature: 4 bits per count, White's six kinds then Black's
+std::uint64_t materialKey(const int counts[2][6]) {
+    std::uint64_t key = 0;
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            key |= static_cast<std::uint64_t>(counts[c][t]) << (4 * (c * 6 + t));
+        }
+    }
+    return key;
+}
+
+std::uint64_t materialKey(const Board& board) {
+    int counts[2][6];
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            counts[c][t] = popCount(board.getPieces(static_cast<Color>(c), static_cast<PieceType>(t)));
+        }
+    }
+    return materialKey(counts);
+}
+
+PieceType pieceFromLetter(char letter) {
+    switch (letter) {
+        case 'K': return PieceType::KING;
+        case 'Q': return PieceType::QUEEN;
+        case 'R': return PieceType::ROOK;
+        case 'B': return PieceType::BISHOP;
+        case 'N': return PieceType::KNIGHT;
+        case 'P': return PieceType::PAWN;
+        default: return PieceType::EMPTY;
+    }
+}
+
+// Splits the pieces of a table into the groups the index is built from:
+// pieces of one kind and colour form a group, except that the first group
+// holds the leading pawns, or without pawns the first three unique pieces
+// (or just the two kings when there are none), e.g. KRvKN -> KRK + N.
+void setGroups(bool hasPawns, bool hasUniquePieces, int pieceCount, bool pawnsOnBothSides, PairsData& d, const int order[2],
+               int file) {
+    const EncodingTables& tables = encoding();
+    int n = 0;
+    int firstLen = hasPawns ? 0 : hasUniquePieces ? 3 : 2;
+    d.groupLen[n] = 1;
+    for (int i = 1; i < pieceCount; ++i) {
+        if (--firstLen > 0 || d.pieces[i] == d.pieces[i - 1]) d.groupLen[n]++;
+        else d.groupLen[++n] = 1;
+    }
+    d.groupLen[++n] = 0;
+
+    // The groups are combined as g1 * N(g2) * N(g3) + g2 * N(g3) + g3 in an
+    // order the file chooses: order[0] is the position of the leading group,
+    // order[1] that of the other side's pawns.
+    int next = pawnsOnBothSides ? 2 : 1;
+    int freeSquares = 64 - d.groupLen[0] - (pawnsOnBothSides ? d.groupLen[1] : 0);
+    std::uint64_t index = 1;
+    for (int k = 0; next < n || k == order[0] || k == order[1]; ++k) {
+        if (k == order[0]) {
+            d.groupIdx[0] = index;
+            index *= hasPawns ? tables.leadPawnsSize[d.groupLen[0]][file] : hasUniquePieces ? 31332 : 462;
+        } else if (k == order[1]) {
+            d.groupIdx[1] = index;
+            index *= tables.binomial[d.groupLen[1]][48 - d.groupLen[0]];
+        } else {
+            d.groupIdx[next] = index;
+            index *= tables.binomial[d.groupLen[next]][freeSquares];
+            freeSquares -= d.groupLen[next++];
+        }
+    }
+    d.groupIdx[n] = index;
+}
+
+PairsData& slice(const SyzygyTablePair& pair, Table& table, bool isDtz, int sideToMove, int file) {
+    return table.items[isDtz ? 0 : sideToMove % 2][pair.hasPawns ? file : 0];
+}
+
+// Decodes the header of a freshly mapped table into its PairsData records
+bool initTable(const SyzygyTablePair& pair, Table& table, bool isDtz) {
+    const std::uint8_t* data = table.file.data() + 4; // After the magic
+    bool split = pair.key != pair.key2;
+    if (((*data & 2) != 0) != pair.hasPawns || (!isDtz && ((*data & 1) != 0) != split)) return false;
+    ++data;
+
+    int sides = !isDtz && split ? 2 : 1;
+    int maxFile = pair.hasPawns ? 3 : 0;
+    bool pawnsOnBothSides = pair.hasPawns && pair.pawnCount[1] > 0;
+
+    for (int file = 0; file <= maxFile; ++file) {
+        int order[2][2] = {{*data & 0xF, pawnsOnBothSides ? *(data + 1) & 0xF : 0xF},
+                           {*data >> 4, pawnsOnBothSides ? *(data + 1) >> 4 : 0xF}};
+        data += 1 + (pawnsOnBothSides ? 1 : 0);
+        for (int k = 0; k < pair.pieceCount; ++k, ++data) {
+            for (int side = 0; side < sides; ++side) {
+                slice(pair, table, isDtz, side, file).pieces[k] = side ? *data >> 4 : *data & 0xF;
+            }
+        }
+        for (int side = 0; side < sides; ++side) {
+            setGroups(pair.hasPawns, pair.hasUniquePieces, pair.pieceCount, pawnsOnBothSides, slice(pair, table, isDtz, side, file),
+                      order[side], file);
+        }
+    }
+    data = align(data, 2);
+
+    for (int file = 0; file <= maxFile; ++file) {
+        for (int side = 0; side < sides; ++side) data = setSizes(slice(pair, table, isDtz, side, file), data);
+    }
+
+    if (isDtz) {
+        // Per file, four maps (one per WDL value other than draw) from stored
+        // values to distances, ordered by frequency
+        table.dtzMap = data;
+        for (int file = 0; file <= maxFile; ++file) {
+            PairsData& d = slice(pair, table, true, 0, file);
+            if (!(d.flags & FLAG_MAPPED)) continue;
+            if (d.flags & FLAG_WIDE) {
+                data = align(data, 2);
+                for (int i = 0; i < 4; ++i) {
+                    d.mapIdx[i] = static_cast<std::uint16_t>((data - table.dtzMap) / 2 + 1);
+                    data += 2 * readLittleEndian16(data) + 2;
+                }
+            } else {
+                for (int i = 0; i < 4; ++i) {
+                    d.mapIdx[i] = static_cast<std::uint16_t>(data - table.dtzMap + 1);
+                    data += *data + 1;
+                }
+            }
+        }
+        data = align(data, 2);
+    }
+
+    for (int file = 0; file <= maxFile; ++file) {
+        for (int side = 0; side < sides; ++side) {
+            PairsData& d = slice(pair, table, isDtz, side, file);
+            d.sparseIndex = data;
+            data += d.sparseIndexSize * 6;
+        }
+    }
+    for (int file = 0; file <= maxFile; ++file) {
+        for (int side = 0; side < sides; ++side) {
+            PairsData& d = slice(pair, table, isDtz, side, file);
+            d.blockLength = data;
+            data += static_cast<std::size_t>(d.blockLengthSize) * 2;
+        }
+    }
+    for (int file = 0; file <= maxFile; ++file) {
+        for (int side = 0; side < sides; ++side) {
+            PairsData& d = slice(pair, table, isDtz, side, file);
+            data = align(data, 64);
+            d.data = data;
+            data += static_cast<std::size_t>(d.numBlocks) * d.sizeofBlock;
+        }
+    }
+    return data <= table.file.data() + table.file.size();
+}
+
+// Maps 'table' on first use; false if its file is missing or corrupt
+bool ensureMapped(const SyzygyTablePair& pair, Table& table, bool isDtz, const std::vector<std::string>& directories) {
+    if (table.ready.load(std::memory_order_acquire)) return table.usable;
+    std::lock_guard<std::mutex> lock(loadMutex);
+    if (table.ready.load(std::memory_order_relaxed)) return table.usable;
+
+    std::string fileName = pair.name + (isDtz ? ".rtbz" : ".rtbw");
+    for (const std::string& directory : directories) {
+        try {
+            table.file = MappedFile(directory + "/" + fileName);
+            break;
+        } catch (const std::runtime_error&) {
+            // Not in this directory
+        }
+    }
+    if (table.file.data()) {
+        // Every table file is 16 bytes plus a multiple of 64
+        const std::uint8_t* magic = isDtz ? DTZ_MAGIC : WDL_MAGIC;
+        bool valid = table.file.size() % 64 == 16 && std::equal(magic, magic + 4, table.file.data()) && initTable(pair, table, isDtz);
+        if (valid) table.usable = true;
+        else std::cerr << "Corrupt tablebase file " << fileName << std::endl;
+    }
+    table.ready.store(true, std::memory_order_release);
+    return table.usable;
+}
+
+bool comparePawns(int a, int b) {
+    const EncodingTables& tables = encoding();
+    return tables.mapPawns[a] < tables.mapPawns[b];
+}
+
+// Index of the position in 'd' plus the slice itself. The pieces are mapped so
+// the table's stronger side is White, then mirrored into the canonical region.
+// Returns false for DTZ tables stored for the other side to move.
+bool encodePosition(const SyzygyTablePair& pair, Table& table, bool isDtz, const Board& board, Color sideToMove,
+                    std::uint64_t positionKey, const PairsData*& slicePtr, int& leadFile, std::uint64_t& index) {
+    const EncodingTables& tables = encoding();
+    int squares[TB_PIECES];
+    int pieces[TB_PIECES];
+    int size = 0;
+    int leadPawnsCount = 0;
+    Bitboard leadPawns = 0;
+    leadFile = 0;
+
+    // A symmetric table (KRvKR) only stores White to move, and tables are
+    // stored with the stronger side as White: in both other cases swap colours
+    // and mirror the ranks
+    bool symmetricBlackToMove = pair.key == pair.key2 && sideToMove == Color::BLACK;
+    bool blackStronger = positionKey != pair.key;
+    bool flip = symmetricBlackToMove || blackStronger;
+    int flipColor = flip ? BLACK_PIECE : 0;
+    int flipSquares = flip ? 56 : 0;
+    int stm = (flip ? 1 : 0) ^ (sideToMove == Color::BLACK ? 1 : 0);
+
+    // With pawns the table is split by the file of the leading pawn, the one
+    // with the highest mapPawns value
+    if (pair.hasPawns) {
+        int leadCode = slice(pair, table, isDtz, 0, 0).pieces[0] ^ flipColor;
+        Color leadColor = (leadCode & BLACK_PIECE) ? Color::BLACK : Color::WHITE;
+        Bitboard pawns = leadPawns = board.getPieces(leadColor, PieceType::PAWN);
+        while (pawns) squares[size++] = popLsb(pawns) ^ flipSquares;
+        leadPawnsCount = size;
+        std::swap(squares[0], *std::max_element(squares, squares + leadPawnsCount, comparePawns));
+        leadFile = std::min(fileOf(squares[0]), 7 - fileOf(squares[0]));
+    }
+
+    if (isDtz) {
+        const PairsData& d = slice(pair, table, true, 0, leadFile);
+        bool storedSide = (d.flags & FLAG_STM) == stm;
+        if (!storedSide && !(pair.key == pair.key2 && !pair.hasPawns)) return false;
+    }
+
+    Bitboard rest = board.getOccupied() ^ leadPawns;
+    while (rest) {
+        int square = popLsb(rest);
+        const Piece* piece = board.getPieceAt(Position::fromSquareIndex(square));
+        squares[size] = square ^ flipSquares;
+        pieces[size++] = pieceCode(piece->getType(), piece->getColor()) ^ flipColor;
+    }
+
+    const PairsData& d = slice(pair, table, isDtz, stm, leadFile);
+    slicePtr = &d;
+
+    // Put the pieces in the table's order
+    for (int i = leadPawnsCount; i < size - 1; ++i) {
+        for (int j = i + 1; j < size; ++j) {
+            if (d.pieces[i] == pieces[j]) {
+                std::swap(pieces[i], pieces[j]);
+                std::swap(squares[i], squares[j]);
+                break;
+            }
+        }
+    }
+
+    // The leading piece goes to files a-d
+    if (fileOf(squares[0]) > 3) {
+        for (int i = 0; i < size; ++i) squares[i] = flipFile(squares[i]);
+    }
+
+    if (pair.hasPawns) {
+        index = tables.leadPawnIdx[leadPawnsCount][squares[0]];
+        std::stable_sort(squares + 1, squares + leadPawnsCount, comparePawns);
+        for (int i = 1; i < leadPawnsCount; ++i) index += tables.binomial[i][tables.mapPawns[squares[i]]];
+    } else {
+        // Without pawns also to ranks 1-4, and below the a1-h8 diagonal
+        if (rankOf(squares[0]) > 3) {
+            for (int i = 0; i < size; ++i) squares[i] = flipRank(squares[i]);
+        }
+        for (int i = 0; i < d.groupLen[0]; ++i) {
+            if (!offDiagonal(squares[i])) continue;
+            if (offDiagonal(squares[i]) > 0) {
+                for (int j = i; j < size; ++j) squares[j] = ((squares[j] >> 3) | (squares[j] << 3)) & 63;
+            }
+            break;
+        }
+
+        if (pair.hasUniquePieces) {
+            // Three unique pieces together: 63 squares are left for the second
+            // and 62 for the third, with special cases along the diagonal
+            int adjust1 = squares[1] > squares[0];
+            int adjust2 = (squares[2] > squares[0]) + (squares[2] > squares[1]);
+            if (offDiagonal(squares[0])) {
+                index = (tables.mapA1D1D4[squares[0]] * 63 + (squares[1] - adjust1)) * 62 + squares[2] - adjust2;
+            } else if (offDiagonal(squares[1])) {
+                index = (6 * 63 + rankOf(squares[0]) * 28 + tables.mapB1H1H7[squares[1]]) * 62 + squares[2] - adjust2;
+            } else if (offDiagonal(squares[2])) {
+                index = 6 * 63 * 62 + 4 * 28 * 62 + rankOf(squares[0]) * 7 * 28 + (rankOf(squares[1]) - adjust1) * 28 +
+                        tables.mapB1H1H7[squares[2]];
+            } else {
+                index = 6 * 63 * 62 + 4 * 28 * 62 + 4 * 7 * 28 + rankOf(squares[0]) * 7 * 6 + (rankOf(squares[1]) - adjust1) * 6 +
+                        (rankOf(squares[2]) - adjust2);
+            }
+        } else {
+            index = tables.mapKK[tables.mapA1D1D4[squares[0]]][squares[1]];
+        }
+    }
+
+    // The remaining groups, each as a combination of squares not taken by the
+    // groups before it (pawns of the other side only on ranks 2-7)
+    index *= d.groupIdx[0];
+    int* groupSquares = squares + d.groupLen[0];
+    bool remainingPawns = pair.hasPawns && pair.pawnCount[1] > 0;
+    for (int next = 1; d.groupLen[next]; ++next) {
+        std::stable_sort(groupSquares, groupSquares + d.groupLen[next]);
+        std::uint64_t combination = 0;
+        for (int i = 0; i < d.groupLen[next]; ++i) {
+            int square = groupSquares[i];
+            int adjust = static_cast<int>(std::count_if(squares, groupSquares, [square](int taken) { return square > taken; }));
+            combination += tables.binomial[i + 1][square - adjust - (remainingPawns ? 8 : 0)];
+        }
+        remainingPawns = false;
+        index += combination * d.groupIdx[next];
+        groupSquares += d.groupLen[next];
+    }
+    return true;
+}
+
+bool hasCastlingRights(const Board& board) {
+    return board.canCastleKingside(Color::WHITE) || board.canCastleQueenside(Color::WHITE) || board.canCastleKingside(Color::BLACK) ||
+           board.canCastleQueenside(Color::BLACK);
+}
+
+Color opponentOf(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+bool isZeroingMove(const Board& board, const Move& move) {
+    if (move.isEnPassantCapture || board.getPieceAt(move.to) != nullptr) return true;
+    const Piece* piece = board.getPieceAt(move.from);
+    return piece && piece->getType() == PieceType::PAWN;
+}
+
+bool isCapture(const Board& board, const Move& move) {
+    return move.isEnPassantCapture || board.getPieceAt(move.to) != nullptr;
+}
+
+bool isCheckmated(const Board& board, Color side) {
+    if (!board.isSquareAttacked(board.findKing(side), opponentOf(side))) return false;
+    std::vector<Move> replies;
+    Game::generateLegalMoves(board, side, replies);
+    return replies.empty();
+}
+
+} // namespace
+
+SyzygyTablebase::SyzygyTablebase(const std::string& paths) : maxPieces(0) {
+#ifdef _WIN32
+    const char separator = ';';
+#else
+    const char separator = ':';
+#endif
+    std::size_t start = 0;
+    while (start <= paths.size()) {
+        std::size_t end = paths.find(separator, start);
+        if (end == std::string::npos) end = paths.size();
+        if (end > start) directories.push_back(paths.substr(start, end - start));
+        start = end + 1;
+    }
+
+    // Every combination of up to five pieces besides the kings, each side's in
+    // the file name order Q, R, B, N, P. A table covers both colourings, and
+    // its name has the stronger side first, so both orders of the sides are tried.
+    std::vector<std::string> sides;
+    const std::string letters = "QRBNP";
+    std::vector<std::string> current{""};
+    for (int length = 0; length <= TB_PIECES - 2; ++length) {
+        sides.insert(sides.end(), current.begin(), current.end());
+        std::vector<std::string> longer;
+        for (const std::string& side : current) {
+            std::size_t from = side.empty() ? 0 : letters.find(side.back());
+            for (std::size_t l = from; l < letters.size(); ++l) longer.push_back(side + letters[l]);
+        }
+        current.swap(longer);
+    }
+
+    for (std::size_t i = 0; i < sides.size(); ++i) {
+        for (std::size_t j = i; j < sides.size(); ++j) {
+            if (sides[i].size() + sides[j].size() > TB_PIECES - 2 || sides[i].size() + sides[j].size() == 0) continue;
+            for (int orientation = 0; orientation < (i == j ? 1 : 2); ++orientation) {
+                const std::string& white = orientation ? sides[j] : sides[i];
+                const std::string& black = orientation ? sides[i] : sides[j];
+                std::string name = "K" + white + "vK" + black;
+                bool found = false;
+                for (const std::string& directory : directories) {
+                    if (std::ifstream(directory + "/" + name + ".rtbw").good()) {
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) continue;
+
+                auto pair = std::make_unique<SyzygyTablePair>();
+                int counts[2][6] = {};
+                std::string pieceNames[2] = {"K" + white, "K" + black};
+                for (int c = 0; c < 2; ++c) {
+                    for (char letter : pieceNames[c]) ++counts[c][static_cast<int>(pieceFromLetter(letter))];
+                }
+                int swapped[2][6];
+                for (int t = 0; t < 6; ++t) {
+                    swapped[0][t] = counts[1][t];
+                    swapped[1][t] = counts[0][t];
+                }
+                pair->name = name;
+                pair->key = materialKey(counts);
+                pair->key2 = materialKey(swapped);
+                pair->pieceCount = static_cast<int>(pieceNames[0].size() + pieceNames[1].size());
+                int pawns = static_cast<int>(PieceType::PAWN);
+                pair->hasPawns = counts[0][pawns] + counts[1][pawns] > 0;
+                pair->hasUniquePieces = false;
+                for (int c = 0; c < 2; ++c) {
+                    for (int t = 0; t < 6; ++t) {
+                        if (t != static_cast<int>(PieceType::KING) && counts[c][t] == 1) pair->hasUniquePieces = true;
+                    }
+                }
+                // The side with fewer pawns leads, White if they have as many
+                bool whiteLeads = counts[1][pawns] == 0 || (counts[0][pawns] > 0 && counts[1][pawns] >= counts[0][pawns]);
+                pair->pawnCount[0] = whiteLeads ? counts[0][pawns] : counts[1][pawns];
+                pair->pawnCount[1] = whiteLeads ? counts[1][pawns] : counts[0][pawns];
+
+                if (tablesByMaterial.count(pair->key)) continue;
+                tablesByMaterial[pair->key] = pair.get();
+                tablesByMaterial[pair->key2] = pair.get();
+                maxPieces = std::max(maxPieces, pair->pieceCount);
+                tables.push_back(std::move(pair));
+            }
+        }
+    }
+}
+
+SyzygyTablebase::~SyzygyTablebase() = default;
+
+int SyzygyTablebase::getMaxPieces() const {
+    return maxPieces;
+}
+
+std::size_t SyzygyTablebase::getTableCount() const {
+    return tables.size();
+}
+
+SyzygyTablePair* SyzygyTablebase::findTables(const Board& board) const {
+    auto found = tablesByMaterial.find(materialKey(board));
+    return found == tablesByMaterial.end() ? nullptr : found->second;
+}
+
+bool SyzygyTablebase::canProbe(const Board& board) const {
+    return board.hasBitboards() && popCount(board.getOccupied()) <= maxPieces && !hasCastlingRights(board);
+}
+
+Wdl SyzygyTablebase::probeWdlTable(const Board& board, Color sideToMove, ProbeState& state) const {
+    if (popCount(board.getOccupied()) == 2) return Wdl::DRAW; // Bare kings
+    SyzygyTablePair* pair = findTables(board);
+    if (!pair || !ensureMapped(*pair, pair->wdl, false, directories)) {
+        state = ProbeState::FAIL;
+        return Wdl::DRAW;
+    }
+    const PairsData* d = nullptr;
+    int leadFile = 0;
+    std::uint64_t index = 0;
+    encodePosition(*pair, pair->wdl, false, board, sideToMove, materialKey(board), d, leadFile, index);
+    return static_cast<Wdl>(decompressPairs(*d, index) - 2);
+}
+
+int SyzygyTablebase::probeDtzTable(const Board& board, Color sideToMove, Wdl wdl, ProbeState& state) const {
+    SyzygyTablePair* pair = findTables(board);
+    if (!pair || !ensureMapped(*pair, pair->dtz, true, directories)) {
+        state = ProbeState::FAIL;
+        return 0;
+    }
+    const PairsData* d = nullptr;
+    int leadFile = 0;
+    std::uint64_t index = 0;
+    if (!encodePosition(*pair, pair->dtz, true, board, sideToMove, materialKey(board), d, leadFile, index)) {
+        state = ProbeState::CHANGE_STM;
+        return 0;
+    }
+    int value = decompressPairs(*d, index);
+
+    // Values are stored by frequency; the map turns them back into distances
+    const PairsData& flagsSlice = pair->dtz.items[0][pair->hasPawns ? leadFile : 0];
+    static const int WDL_MAP[] = {1, 3, 0, 2, 0}; // LOSS, BLESSED_LOSS, DRAW, CURSED_WIN, WIN -> mapIdx
+    int mapIndex = flagsSlice.mapIdx[WDL_MAP[static_cast<int>(wdl) + 2]];
+    if (flagsSlice.flags & FLAG_MAPPED) {
+        if (flagsSlice.flags & FLAG_WIDE) value = readLittleEndian16(pair->dtz.dtzMap + 2 * (mapIndex + value));
+        else value = pair->dtz.dtzMap[mapIndex + value];
+    }
+
+    // Wins and losses may be stored in moves; the result is always in plies
+    if ((wdl == Wdl::WIN && !(flagsSlice.flags & FLAG_WIN_PLIES)) || (wdl == Wdl::LOSS && !(flagsSlice.flags & FLAG_LOSS_PLIES)) ||
+        wdl == Wdl::CURSED_WIN || wdl == Wdl::BLESSED_LOSS) {
+        value *= 2;
+    }
+    return value + 1;
+}
+
+// A won position need not store its value when a capture wins (and a drawn
+// one may store a loss when a capture draws), so captures are searched first
+// and the better of them and the stored value is the result. For DTZ, pawn
+// moves are searched as well, since DTZ tables leave positions whose best move
+// zeroes the counter undefined.
+Wdl SyzygyTablebase::searchWdl(const Board& board, Color sideToMove, bool checkZeroingMoves, ProbeState& state) const {
+    std::vector<Move> moves;
+    Game::generateLegalMoves(board, sideToMove, moves);
+    Wdl bestValue = Wdl::LOSS;
+    std::size_t searched = 0;
+
+    for (const Move& move : moves) {
+        if (!isCapture(board, move) && (!checkZeroingMoves || !isZeroingMove(board, move))) continue;
+        ++searched;
+        Board child(board);
+        child.applyMove(move);
+        Wdl value = negate(searchWdl(child, opponentOf(sideToMove), false, state));
+        if (state == ProbeState::FAIL) return Wdl::DRAW;
+        if (value > bestValue) {
+            bestValue = value;
+            if (value >= Wdl::WIN) {
+                state = ProbeState::ZEROING_BEST_MOVE;
+                return value;
+            }
+        }
+    }
+
+    // When every legal move was searched the stored value is not needed (and
+    // may be wrong, e.g. with an en passant capture available)
+    bool noMoreMoves = searched > 0 && searched == moves.size();
+    Wdl value = bestValue;
+    if (!noMoreMoves) {
+        value = probeWdlTable(board, sideToMove, state);
+        if (state == ProbeState::FAIL) return Wdl::DRAW;
+    }
+    if (bestValue >= value) {
+        state = (bestValue > Wdl::DRAW || noMoreMoves) ? ProbeState::ZEROING_BEST_MOVE : ProbeState::OK;
+        return bestValue;
+    }
+    state = ProbeState::OK;
+    return value;
+}
+
+int SyzygyTablebase::searchDtz(const Board& board, Color sideToMove, ProbeState& state) const {
+    state = ProbeState::OK;
+    Wdl wdl = searchWdl(board, sideToMove, true, state);
+    if (state == ProbeState::FAIL || wdl == Wdl::DRAW) return 0;
+    if (state == ProbeState::ZEROING_BEST_MOVE) return dtzBeforeZeroing(wdl);
+
+    int dtz = probeDtzTable(board, sideToMove, wdl, state);
+    if (state == ProbeState::FAIL) return 0;
+    if (state != ProbeState::CHANGE_STM) {
+        bool cursed = wdl == Wdl::BLESSED_LOSS || wdl == Wdl::CURSED_WIN;
+        return (dtz + (cursed ? 100 : 0)) * signOf(static_cast<int>(wdl));
+    }
+
+    // The table holds the other side to move: take the best reply by one ply of search
+    std::vector<Move> moves;
+    Game::generateLegalMoves(board, sideToMove, moves);
+    int minDtz = 0xFFFF;
+    for (const Move& move : moves) {
+        bool zeroing = isZeroingMove(board, move);
+        Board child(board);
+        child.applyMove(move);
+        Color opponent = opponentOf(sideToMove);
+
+        // After a zeroing move the distance is that of the move itself; the
+        // search only supplies the sign (a capture may lose or draw)
+        dtz = zeroing ? -dtzBeforeZeroing(searchWdl(child, opponent, false, state)) : -searchDtz(child, opponent, state);
+        if (state == ProbeState::FAIL) return 0;
+        if (dtz == 1 && isCheckmated(child, opponent)) minDtz = 1;
+        if (!zeroing) dtz += signOf(dtz);
+        if (dtz < minDtz && signOf(dtz) == signOf(static_cast<int>(wdl))) minDtz = dtz;
+    }
+    return minDtz == 0xFFFF ? -1 : minDtz; // No legal moves: mated
+}
+
+bool SyzygyTablebase::probeWdl(const Board& board, Color sideToMove, Wdl& result) const {
+    if (!canProbe(board)) return false;
+    ProbeState state = ProbeState::OK;
+    result = searchWdl(board, sideToMove, false, state);
+    return state != ProbeState::FAIL;
+}
+
+bool SyzygyTablebase::probeDtz(const Board& board, Color sideToMove, int& result) const {
+    if (!canProbe(board)) return false;
+    ProbeState state = ProbeState::OK;
+    result = searchDtz(board, sideToMove, state);
+    return state != ProbeState::FAIL;
+}
+
+bool SyzygyTablebase::probeRoot(const Game& game, Move& bestMove, Wdl& result) const {
+    const Board& board = game.getBoard();
+    if (!canProbe(board)) return false;
+    Color side = game.getCurrentPlayerColor();
+    Color opponent = opponentOf(side);
+    int halfMoveClock = game.getHalfMoveClock();
+
+    std::vector<Move> moves;
+    Game::generateLegalMoves(board, side, moves);
+    if (moves.empty()) return false;
+
+    // DTZ of each move counted from the root: positive wins, smaller is faster
+    int bestDtz = 0;
+    bool haveBest = false;
+    for (const Move& move : moves) {
+        Board child(board);
+        child.applyMove(move);
+        ProbeState state = ProbeState::OK;
+        int dtz = 0;
+        if (isZeroingMove(board, move)) {
+            dtz = dtzBeforeZeroing(negate(searchWdl(child, opponent, false, state)));
+        } else if (halfMoveClock + 1 >= 100) {
+            dtz = 0; // The move draws by the 50-move rule
+        } else {
+            dtz = -searchDtz(child, opponent, state);
+            dtz += signOf(dtz);
+        }
+        if (state == ProbeState::FAIL) return false;
+        if (dtz == 2 && isCheckmated(child, opponent)) dtz = 1;
+
+        // Wins first, the fastest among them; then draws; then the slowest loss
+        auto rank = [](int value) { return value > 0 ? 2 : value == 0 ? 1 : 0; };
+        bool better = !haveBest || rank(dtz) > rank(bestDtz) || (rank(dtz) == rank(bestDtz) && dtz != 0 && dtz < bestDtz);
+        if (better) {
+            bestDtz = dtz;
+            bestMove = move;
+            haveBest = true;
+        }
+    }
+
+    // Wins and losses that the 50-move counter turns into draws
+    if (bestDtz > 0) result = bestDtz + halfMoveClock <= 100 ? Wdl::WIN : Wdl::CURSED_WIN;
+    else if (bestDtz < 0) result = -bestDtz + halfMoveClock <= 100 ? Wdl::LOSS : Wdl::BLESSED_LOSS;
+    else result = Wdl::DRAW;
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef SYZYGY_H
+#define SYZYGY_H
+
+#include "core/ChessTypes.h"
+#include "core/Move.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class Board;
+class Game;
+struct SyzygyTablePair; // The WDL and DTZ table of one material signature
+
+// Endgame result from the side to move's point of view. Cursed wins and
+// blessed losses are won (lost) on the board but drawn under the 50-move rule.
+enum class Wdl {
+    LOSS = -2,
+    BLESSED_LOSS = -1,
+    DRAW = 0,
+    CURSED_WIN = 1,
+    WIN = 2
+};
+
+// Read-only access to Syzygy endgame tablebases (.rtbw for win/draw/loss,
+// .rtbz for distance to zeroing, i.e. to the next capture or pawn move).
+//
+// The constructor only looks for the WDL files of every material combination
+// up to seven pieces; a table is memory-mapped and its header decoded the first
+// time a position with that material is probed, so opening a full set is cheap
+// and only the endings that occur cost memory. Probing is thread-safe.
+//
+// Tables do not cover castling rights, so positions that still have any are
+// never probed. The en passant square is handled by resolving captures first,
+// as the format requires.
+class SyzygyTablebase {
+public:
+    // 'paths' lists directories separated by ':' (';' on Windows). Directories
+    // without tables are fine; getMaxPieces() is 0 if nothing was found.
+    explicit SyzygyTablebase(const std::string& paths);
+    ~SyzygyTablebase();
+
+    SyzygyTablebase(const SyzygyTablebase&) = delete;
+    SyzygyTablebase& operator=(const SyzygyTablebase&) = delete;
+
+    // Most pieces (kings included) of any table found
+    int getMaxPieces() const;
+    std::size_t getTableCount() const; // WDL tables found
+
+    // Result of the position with 'sideToMove' to move, ignoring the 50-move
+    // counter. False if the position cannot be probed (castling rights, too
+    // many pieces, a missing or corrupt table).
+    bool probeWdl(const Board& board, Color sideToMove, Wdl& result) const;
+
+    // Plies to the next zeroing move with best play: positive when the side to
+    // move wins, negative when it loses, 0 for a draw. Cursed wins and blessed
+    // losses are counted past 100. Needs the .rtbz table as well.
+    bool probeDtz(const Board& board, Color sideToMove, int& result) const;
+
+    // Picks a root move for the side to move in 'game' by DTZ: the fastest
+    // win, a draw otherwise, or the slowest loss, taking the game's 50-move
+    // counter into account. 'result' is what the chosen move achieves.
+    bool probeRoot(const Game& game, Move& bestMove, Wdl& result) const;
+
+private:
+    enum class ProbeState;
+
+    Wdl searchWdl(const Board& board, Color sideToMove, bool checkZeroingMoves, ProbeState& state) const;
+    int searchDtz(const Board& board, Color sideToMove, ProbeState& state) const;
+    Wdl probeWdlTable(const Board& board, Color sideToMove, ProbeState& state) const;
+    int probeDtzTable(const Board& board, Color sideToMove, Wdl wdl, ProbeState& state) const;
+    SyzygyTablePair* findTables(const Board& board) const;
+    bool canProbe(const Board& board) const;
+
+    std::vector<std::string> directories;
+    std::vector<std::unique_ptr<SyzygyTablePair>> tables;
+    std::unordered_map<std::uint64_t, SyzygyTablePair*> tablesByMaterial; // Both colourings of each table
+    int maxPieces;
+};
+
+#endif // SYZYGY_H
@@ -0,0 +1,97 @@
+#include "ai/nnue/NnueAccumulator.h"
+#include "ai/nnue/NnueNetwork.h"
+#include "ai/nnue/NnueSimd.h"
+#include "core/Board.h"
+#include "core/Move.h"
+#include <cstring> // For std::memcpy
+
+NnueDelta::NnueDelta() : count(0), kingMoved{false, false} {}
+
+NnueDelta NnueDelta::fromMove(const Board& boardBefore, const Move& move) {
+    NnueDelta delta;
+    const Piece* mover = boardBefore.getPieceAt(move.from);
+    if (!mover) return delta;
+
+    Color moverColor = mover->getColor();
+    int fromSquare = move.from.toSquareIndex();
+    int toSquare = move.to.toSquareIndex();
+
+    // Captured piece (en passant removes the pawn beside the destination)
+    Position capturedPos = move.isEnPassantCapture ? Position(move.from.row, move.to.col) : move.to;
+    const Piece* captured = boardBefore.getPieceAt(capturedPos);
+    if (captured && captured->getColor() != moverColor) {
+        delta.pieces[delta.count++] = {captured->getType(), captured->getColor(), capturedPos.toSquareIndex(), -1};
+    }
+
+    if (mover->getType() == PieceType::KING) {
+        delta.kingMoved[static_cast<int>(moverColor)] = true;
+        if (move.isCastling) {
+            // Mirrors the rook placement in Board::performMove
+            int rookFromCol = (move.to.col > move.from.col) ? boardBefore.getDimensions().cols - 1 : 0;
+            int rookToCol = (move.to.col > move.from.col) ? move.to.col - 1 : move.to.col + 1;
+            delta.pieces[delta.count++] = {PieceType::ROOK, moverColor,
+                                           Position(move.from.row, rookFromCol).toSquareIndex(),
+                                           Position(move.from.row, rookToCol).toSquareIndex()};
+        }
+    } else if (move.promotionPiece != PieceType::EMPTY && mover->getType() == PieceType::PAWN) {
+        delta.pieces[delta.count++] = {PieceType::PAWN, moverColor, fromSquare, -1};
+        delta.pieces[delta.count++] = {move.promotionPiece, moverColor, -1, toSquare};
+    } else {
+        delta.pieces[delta.count++] = {mover->getType(), moverColor, fromSquare, toSquare};
+    }
+    return delta;
+}
+
+void NnueAccumulator::refresh(const Board& board, Color perspective, const NnueNetwork& network) {
+    int side = static_cast<int>(perspective);
+    int kingSquare = board.findKing(perspective).toSquareIndex();
+    kingSquares[side] = kingSquare;
+
+    std::int16_t* acc = values[side];
+    std::memcpy(acc, network.getFeatureBiases(), sizeof(values[side]));
+
+    for (int square = 0; square < 64; ++square) {
+        const Piece* piece = board.getPieceAt(Position::fromSquareIndex(square));
+        if (!piece || piece->getType() == PieceType::KING) continue;
+        int feature = nnueFeatureIndex(perspective, kingSquare, piece->getType(), piece->getColor(), square);
+        nnueAddColumn(acc, network.getFeatureColumn(feature));
+    }
+}
+
+void NnueAccumulator::refresh(const Board& board, const NnueNetwork& network) {
+    refresh(board, Color::WHITE, network);
+    refresh(board, Color::BLACK, network);
+}
+
+void NnueAccumulator::update(const NnueAccumulator& parent, const NnueDelta& delta, const Board& boardAfter,
+                             const NnueNetwork& network) {
+    for (Color perspective : {Color::WHITE, Color::BLACK}) {
+        int side = static_cast<int>(perspective);
+        if (delta.kingMoved[side]) {
+            // HalfKP features are relative to the own king: a king move changes all of them
+            refresh(boardAfter, perspective, network);
+            continue;
+        }
+
+        int kingSquare = parent.kingSquares[side];
+        kingSquares[side] = kingSquare;
+        std::int16_t* acc = values[side];
+        std::memcpy(acc, parent.values[side], sizeof(values[side]));
+
+        for (int i = 0; i < delta.count; ++i) {
+            const NnueDirtyPiece& dirty = delta.pieces[i];
+            if (dirty.from >= 0) {
+                nnueSubColumn(acc, network.getFeatureColumn(
+                    nnueFeatureIndex(perspective, kingSquare, dirty.type, dirty.color, dirty.from)));
+            }
+            if (dirty.to >= 0) {
+                nnueAddColumn(acc, network.getFeatureColumn(
+                    nnueFeatureIndex(perspective, kingSquare, dirty.type, dirty.color, dirty.to)));
+            }
+        }
+    }
+}
+
+const std::int16_t* NnueAccumulator::getValues(Color perspective) const {
+    return values[static_cast<int>(perspective)];
+}
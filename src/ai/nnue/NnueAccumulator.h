@@ -0,0 +1,52 @@
+#ifndef NNUE_ACCUMULATOR_H
+#define NNUE_ACCUMULATOR_H
+
+#include "ai/nnue/NnueArchitecture.h"
+#include "core/ChessTypes.h"
+#include <cstdint>
+
+class Board;
+class NnueNetwork;
+struct Move;
+
+// One piece appearing, disappearing or moving as the result of a move.
+// 'from' / 'to' are square indices (see Position::toSquareIndex), -1 for none.
+struct NnueDirtyPiece {
+    PieceType type;
+    Color color;
+    int from;
+    int to;
+};
+
+// Feature changes caused by one move: at most the mover, a captured piece and
+// a castling rook. Built from the board *before* the move is played.
+struct NnueDelta {
+    NnueDirtyPiece pieces[3];
+    int count;
+    bool kingMoved[2]; // Indexed by Color; that half must be rebuilt from scratch
+
+    NnueDelta();
+    static NnueDelta fromMove(const Board& boardBefore, const Move& move);
+};
+
+// First-layer output for both perspectives.
+// The search keeps one accumulator per ply and derives each child from its
+// parent with update(), so undoing a move is free: the parent is untouched.
+class NnueAccumulator {
+private:
+    alignas(32) std::int16_t values[2][NNUE_HALF_DIMENSIONS];
+    int kingSquares[2];
+
+public:
+    // Full recomputation of one or both halves from the board.
+    void refresh(const Board& board, Color perspective, const NnueNetwork& network);
+    void refresh(const Board& board, const NnueNetwork& network);
+
+    // this = parent + delta. 'boardAfter' is only read for halves whose king moved.
+    void update(const NnueAccumulator& parent, const NnueDelta& delta, const Board& boardAfter,
+                const NnueNetwork& network);
+
+    const std::int16_t* getValues(Color perspective) const;
+};
+
+#endif // NNUE_ACCUMULATOR_H
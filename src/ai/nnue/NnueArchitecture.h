@@ -0,0 +1,60 @@
+#ifndef NNUE_ARCHITECTURE_H
+#define NNUE_ARCHITECTURE_H
+
+#include "core/ChessTypes.h"
+#include <cstdint>
+
+// HalfKP 256x2-32-32-1 network layout.
+//
+// Input features are (own king square, piece, piece square) triples for every
+// non-king piece, seen from each side separately. Both halves share one
+// feature transformer, whose output (the "accumulator") only changes by a few
+// weight columns per move, which is what makes incremental updates cheap.
+//
+// Quantisation:
+//   feature transformer  int16 weights/biases, int16 accumulator
+//   hidden layers        int8 weights, int32 biases, uint8 activations
+//   clipped ReLU         clamp to [0, 127] after shifting by NNUE_WEIGHT_SCALE_BITS
+
+constexpr int NNUE_KING_SQUARES = 64;
+constexpr int NNUE_PS_END = 10 * 64 + 1; // 5 piece types x 2 colors x 64 squares, plus an unused slot
+constexpr int NNUE_INPUT_DIMENSIONS = NNUE_KING_SQUARES * NNUE_PS_END; // 41024
+constexpr int NNUE_HALF_DIMENSIONS = 256;
+constexpr int NNUE_L1_INPUTS = 2 * NNUE_HALF_DIMENSIONS;
+constexpr int NNUE_L1_OUTPUTS = 32;
+constexpr int NNUE_L2_OUTPUTS = 32;
+
+constexpr int NNUE_WEIGHT_SCALE_BITS = 6;
+constexpr int NNUE_OUTPUT_SCALE = 16; // Raw network output / 16 = centipawns
+
+constexpr std::uint32_t NNUE_FILE_VERSION = 0x7AF32F16u;
+
+// Features are computed on a rotated board for black, so that both halves of
+// the network see "their" king on ranks 1-2 in the opening.
+inline int nnueOrient(Color perspective, int square) {
+    return perspective == Color::WHITE ? square : square ^ 63;
+}
+
+// Maps (piece type, piece color) to the piece-square base offset for a given
+// perspective. Returns -1 for kings, which are not input features in HalfKP.
+inline int nnuePieceBase(Color perspective, PieceType type, Color pieceColor) {
+    int typeOrder;
+    switch (type) {
+        case PieceType::PAWN:   typeOrder = 0; break;
+        case PieceType::KNIGHT: typeOrder = 1; break;
+        case PieceType::BISHOP: typeOrder = 2; break;
+        case PieceType::ROOK:   typeOrder = 3; break;
+        case PieceType::QUEEN:  typeOrder = 4; break;
+        default: return -1;
+    }
+    int theirs = (pieceColor == perspective) ? 0 : 1;
+    return 1 + (typeOrder * 2 + theirs) * 64;
+}
+
+inline int nnueFeatureIndex(Color perspective, int kingSquare, PieceType type, Color pieceColor, int square) {
+    return nnueOrient(perspective, square)
+         + nnuePieceBase(perspective, type, pieceColor)
+         + NNUE_PS_END * nnueOrient(perspective, kingSquare);
+}
+
+#endif // NNUE_ARCHITECTURE_H
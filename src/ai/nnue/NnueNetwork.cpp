@@ -0,0 +1,133 @@
+#include "ai/nnue/NnueNetwork.h"
+#include "ai/nnue/NnueAccumulator.h"
+#include "ai/nnue/NnueSimd.h"
+#include <cstdint>   // For std::uintptr_t
+#include <cstring>   // For std::memcpy
+#include <stdexcept> // For runtime_error
+
+namespace {
+
+// Sequential little-endian reader over the network file bytes.
+class NetworkReader {
+private:
+    const std::uint8_t* cursor;
+    const std::uint8_t* end;
+    const std::string& path;
+
+    const std::uint8_t* take(size_t bytes) {
+        if (static_cast<size_t>(end - cursor) < bytes) {
+            throw std::runtime_error("NNUE network file is truncated: " + path);
+        }
+        const std::uint8_t* start = cursor;
+        cursor += bytes;
+        return start;
+    }
+
+public:
+    NetworkReader(const std::uint8_t* data, size_t size, const std::string& filePath)
+        : cursor(data), end(data + size), path(filePath) {}
+
+    void read(void* destination, size_t bytes) {
+        std::memcpy(destination, take(bytes), bytes);
+    }
+
+    std::uint32_t readUint32() {
+        const std::uint8_t* bytes = take(4);
+        return static_cast<std::uint32_t>(bytes[0]) | (static_cast<std::uint32_t>(bytes[1]) << 8) |
+               (static_cast<std::uint32_t>(bytes[2]) << 16) | (static_cast<std::uint32_t>(bytes[3]) << 24);
+    }
+
+    // The weight arrays are used in place; every supported target is little-endian.
+    // The caller guarantees the alignment (see NnueNetwork.h).
+    template <typename T>
+    const T* view(size_t count) {
+        return reinterpret_cast<const T*>(take(count * sizeof(T)));
+    }
+
+    const std::uint8_t* position() const { return cursor; }
+    size_t remaining() const { return static_cast<size_t>(end - cursor); }
+    bool atEnd() const { return cursor == end; }
+};
+
+} // namespace
+
+NnueNetwork::NnueNetwork()
+    : featureBiases(nullptr), featureWeights(nullptr), l1Biases(nullptr), l1Weights(nullptr),
+      l2Biases(nullptr), l2Weights(nullptr), outputBias(0), outputWeights(nullptr) {}
+
+std::shared_ptr<const NnueNetwork> NnueNetwork::load(const std::string& path) {
+    std::shared_ptr<NnueNetwork> network(new NnueNetwork());
+    network->file = MappedFile(path);
+    NetworkReader header(network->file.data(), network->file.size(), path);
+
+    if (header.readUint32() != NNUE_FILE_VERSION) {
+        throw std::runtime_error("Unsupported NNUE network version: " + path);
+    }
+    header.readUint32(); // Architecture hash
+    std::uint32_t descriptionLength = header.readUint32();
+    network->description.resize(descriptionLength);
+    header.read(&network->description[0], descriptionLength);
+
+    // The mapping is page-aligned, so only the description's length can leave
+    // the weights misaligned; in that rare case they are copied once
+    const std::uint8_t* weights = header.position();
+    size_t weightBytes = header.remaining();
+    if (reinterpret_cast<std::uintptr_t>(weights) % alignof(std::int32_t) != 0) {
+        network->alignedCopy.resize((weightBytes + sizeof(std::uint32_t) - 1) / sizeof(std::uint32_t));
+        std::memcpy(network->alignedCopy.data(), weights, weightBytes);
+        weights = reinterpret_cast<const std::uint8_t*>(network->alignedCopy.data());
+    }
+    NetworkReader reader(weights, weightBytes, path);
+
+    reader.readUint32(); // Feature transformer hash
+    network->featureBiases = reader.view<std::int16_t>(NNUE_HALF_DIMENSIONS);
+    network->featureWeights = reader.view<std::int16_t>(static_cast<size_t>(NNUE_INPUT_DIMENSIONS) * NNUE_HALF_DIMENSIONS);
+
+    reader.readUint32(); // Network hash
+    network->l1Biases = reader.view<std::int32_t>(NNUE_L1_OUTPUTS);
+    network->l1Weights = reader.view<std::int8_t>(NNUE_L1_OUTPUTS * NNUE_L1_INPUTS);
+    network->l2Biases = reader.view<std::int32_t>(NNUE_L2_OUTPUTS);
+    network->l2Weights = reader.view<std::int8_t>(NNUE_L2_OUTPUTS * NNUE_L1_OUTPUTS);
+    network->outputBias = static_cast<std::int32_t>(reader.readUint32());
+    network->outputWeights = reader.view<std::int8_t>(NNUE_L2_OUTPUTS);
+
+    if (!reader.atEnd()) {
+        throw std::runtime_error("NNUE network file has trailing data (wrong architecture?): " + path);
+    }
+    return network;
+}
+
+const std::string& NnueNetwork::getDescription() const {
+    return description;
+}
+
+const std::int16_t* NnueNetwork::getFeatureBiases() const {
+    return featureBiases;
+}
+
+const std::int16_t* NnueNetwork::getFeatureColumn(int featureIndex) const {
+    return featureWeights + static_cast<size_t>(featureIndex) * NNUE_HALF_DIMENSIONS;
+}
+
+int NnueNetwork::evaluate(const NnueAccumulator& accumulator, Color sideToMove) const {
+    Color opponent = (sideToMove == Color::WHITE) ? Color::BLACK : Color::WHITE;
+
+    // Side to move goes first so the same weights serve both colors
+    alignas(32) std::uint8_t transformed[NNUE_L1_INPUTS];
+    nnueClippedReluHalf(accumulator.getValues(sideToMove), transformed);
+    nnueClippedReluHalf(accumulator.getValues(opponent), transformed + NNUE_HALF_DIMENSIONS);
+
+    alignas(32) std::int32_t l1Out[NNUE_L1_OUTPUTS];
+    alignas(32) std::uint8_t l1Activations[NNUE_L1_OUTPUTS];
+    nnueAffine(transformed, l1Weights, l1Biases, l1Out, NNUE_L1_INPUTS, NNUE_L1_OUTPUTS);
+    nnueClippedReluScaled(l1Out, l1Activations, NNUE_L1_OUTPUTS);
+
+    alignas(32) std::int32_t l2Out[NNUE_L2_OUTPUTS];
+    alignas(32) std::uint8_t l2Activations[NNUE_L2_OUTPUTS];
+    nnueAffine(l1Activations, l2Weights, l2Biases, l2Out, NNUE_L1_OUTPUTS, NNUE_L2_OUTPUTS);
+    nnueClippedReluScaled(l2Out, l2Activations, NNUE_L2_OUTPUTS);
+
+    std::int32_t output;
+    nnueAffine(l2Activations, outputWeights, &outputBias, &output, NNUE_L2_OUTPUTS, 1);
+    return output / NNUE_OUTPUT_SCALE;
+}
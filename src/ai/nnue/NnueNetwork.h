@@ -0,0 +1,62 @@
+#ifndef NNUE_NETWORK_H
+#define NNUE_NETWORK_H
+
+#include "ai/nnue/NnueArchitecture.h"
+#include "core/ChessTypes.h"
+#include "util/MappedFile.h"
+#include <cstdint>
+#include <memory> // For std::shared_ptr
+#include <string>
+#include <vector>
+
+class NnueAccumulator;
+
+// Quantised HalfKP network weights plus the forward pass.
+//
+// File layout (little-endian), see NnueArchitecture.h for the dimensions:
+//   uint32 version (NNUE_FILE_VERSION), uint32 hash, uint32 descLength, char description[descLength]
+//   uint32 hash, int16 featureBiases[256], int16 featureWeights[41024 * 256]
+//   uint32 hash, int32 l1Biases[32], int8 l1Weights[32 * 512]
+//                int32 l2Biases[32], int8 l2Weights[32 * 32]
+//                int32 outputBias,   int8 outputWeights[32]
+// The hashes are stored but not validated; the exact file size is.
+//
+// A network is immutable once loaded and is shared between engine copies and
+// search threads through a shared_ptr.
+//
+// The weights are not copied: the layer pointers below point straight into
+// the mapped file, which the network keeps open. Past the description every
+// array sits at a 4-byte multiple from the feature transformer hash, so they
+// are naturally aligned whenever the description's length is a multiple of 4.
+// Otherwise the weight section is copied once into alignedCopy.
+class NnueNetwork {
+private:
+    MappedFile file;
+    std::vector<std::uint32_t> alignedCopy;      // Empty unless the file's layout left the weights misaligned
+    std::string description;
+    const std::int16_t* featureBiases;           // [NNUE_HALF_DIMENSIONS]
+    const std::int16_t* featureWeights;          // [NNUE_INPUT_DIMENSIONS][NNUE_HALF_DIMENSIONS]
+    const std::int32_t* l1Biases;
+    const std::int8_t* l1Weights;                // [NNUE_L1_OUTPUTS][NNUE_L1_INPUTS]
+    const std::int32_t* l2Biases;
+    const std::int8_t* l2Weights;                // [NNUE_L2_OUTPUTS][NNUE_L1_OUTPUTS]
+    std::int32_t outputBias;
+    const std::int8_t* outputWeights;            // [NNUE_L2_OUTPUTS]
+
+    NnueNetwork();
+
+public:
+    // Memory-maps a network file and points the layers into the mapping.
+    // Throws std::runtime_error on a missing, truncated or mismatched file.
+    static std::shared_ptr<const NnueNetwork> load(const std::string& path);
+
+    const std::string& getDescription() const;
+    const std::int16_t* getFeatureBiases() const;
+    const std::int16_t* getFeatureColumn(int featureIndex) const;
+
+    // Runs the layers above the feature transformer.
+    // Returns centipawns from sideToMove's point of view.
+    int evaluate(const NnueAccumulator& accumulator, Color sideToMove) const;
+};
+
+#endif // NNUE_NETWORK_H
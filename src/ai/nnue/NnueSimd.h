@@ -0,0 +1,190 @@
+#ifndef NNUE_SIMD_H
+#define NNUE_SIMD_H
+
+#include "ai/nnue/NnueArchitecture.h"
+#include <cstddef> // For std::ptrdiff_t
+#include <cstdint>
+#include <algorithm> // For std::clamp
+
+// Inner-loop kernels for NNUE inference. The instruction set is picked at
+// compile time (see CHESS_NATIVE_ARCH in CMakeLists.txt); every kernel has a
+// scalar fallback that produces bit-identical results.
+
+#if defined(__AVX2__)
+#define NNUE_USE_AVX2
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#define NNUE_USE_SSE41
+#include <smmintrin.h>
+#endif
+
+inline const char* nnueSimdName() {
+#if defined(NNUE_USE_AVX2)
+    return "avx2";
+#elif defined(NNUE_USE_SSE41)
+    return "sse4.1";
+#else
+    return "scalar";
+#endif
+}
+
+// acc[0..NNUE_HALF_DIMENSIONS) += column
+inline void nnueAddColumn(std::int16_t* acc, const std::int16_t* column) {
+#if defined(NNUE_USE_AVX2)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_add_epi16(a, w));
+    }
+#elif defined(NNUE_USE_SSE41)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), _mm_add_epi16(a, w));
+    }
+#else
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; ++i) {
+        acc[i] = static_cast<std::int16_t>(acc[i] + column[i]);
+    }
+#endif
+}
+
+// acc[0..NNUE_HALF_DIMENSIONS) -= column
+inline void nnueSubColumn(std::int16_t* acc, const std::int16_t* column) {
+#if defined(NNUE_USE_AVX2)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 16) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(acc + i));
+        __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(column + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(acc + i), _mm256_sub_epi16(a, w));
+    }
+#elif defined(NNUE_USE_SSE41)
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(acc + i));
+        __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(acc + i), _mm_sub_epi16(a, w));
+    }
+#else
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; ++i) {
+        acc[i] = static_cast<std::int16_t>(acc[i] - column[i]);
+    }
+#endif
+}
+
+// out[i] = clamp(in[i], 0, 127) for one accumulator half
+inline void nnueClippedReluHalf(const std::int16_t* in, std::uint8_t* out) {
+#if defined(NNUE_USE_AVX2)
+    const __m256i zero = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 32) {
+        __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 16));
+        // packs works per 128-bit lane; the permute restores element order
+        __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(lo, hi), zero);
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), packed);
+    }
+#elif defined(NNUE_USE_SSE41)
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; i += 16) {
+        __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 8));
+        __m128i packed = _mm_max_epi8(_mm_packs_epi16(lo, hi), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), packed);
+    }
+#else
+    for (int i = 0; i < NNUE_HALF_DIMENSIONS; ++i) {
+        out[i] = static_cast<std::uint8_t>(std::clamp<int>(in[i], 0, 127));
+    }
+#endif
+}
+
+#if defined(NNUE_USE_AVX2)
+inline int nnueHorizontalSum(__m256i v) {
+    __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+#elif defined(NNUE_USE_SSE41)
+inline int nnueHorizontalSum(__m128i sum) {
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+}
+#endif
+
+// out[i] = bias[i] + sum_j weights[i * inputs + j] * in[j]
+// 'inputs' must be a multiple of 32. Activations are in [0, 127], so the
+// 16-bit pairwise products of maddubs can never saturate.
+inline void nnueAffine(const std::uint8_t* in, const std::int8_t* weights, const std::int32_t* biases,
+                       std::int32_t* out, int inputs, int outputs) {
+#if defined(NNUE_USE_AVX2)
+    const __m256i ones = _mm256_set1_epi16(1);
+    int i = 0;
+    // Four rows at a time: each input chunk is loaded once and the four sums
+    // are reduced together with hadd
+    for (; i + 4 <= outputs; i += 4) {
+        const std::int8_t* row = weights + static_cast<std::ptrdiff_t>(i) * inputs;
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+        __m256i sum2 = _mm256_setzero_si256();
+        __m256i sum3 = _mm256_setzero_si256();
+        for (int j = 0; j < inputs; j += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + j));
+            __m256i w0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j));
+            __m256i w1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + inputs + j));
+            __m256i w2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 2 * inputs + j));
+            __m256i w3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 3 * inputs + j));
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(a, w0), ones));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_maddubs_epi16(a, w1), ones));
+            sum2 = _mm256_add_epi32(sum2, _mm256_madd_epi16(_mm256_maddubs_epi16(a, w2), ones));
+            sum3 = _mm256_add_epi32(sum3, _mm256_madd_epi16(_mm256_maddubs_epi16(a, w3), ones));
+        }
+        __m256i sums = _mm256_hadd_epi32(_mm256_hadd_epi32(sum0, sum1), _mm256_hadd_epi32(sum2, sum3));
+        __m128i total = _mm_add_epi32(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+        total = _mm_add_epi32(total, _mm_loadu_si128(reinterpret_cast<const __m128i*>(biases + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), total);
+    }
+    for (; i < outputs; ++i) {
+        const std::int8_t* row = weights + static_cast<std::ptrdiff_t>(i) * inputs;
+        __m256i sum = _mm256_setzero_si256();
+        for (int j = 0; j < inputs; j += 32) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + j));
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + j));
+            __m256i product = _mm256_madd_epi16(_mm256_maddubs_epi16(a, w), ones);
+            sum = _mm256_add_epi32(sum, product);
+        }
+        out[i] = biases[i] + nnueHorizontalSum(sum);
+    }
+#elif defined(NNUE_USE_SSE41)
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int i = 0; i < outputs; ++i) {
+        const std::int8_t* row = weights + i * inputs;
+        __m128i sum = _mm_setzero_si128();
+        for (int j = 0; j < inputs; j += 16) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + j));
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + j));
+            __m128i product = _mm_madd_epi16(_mm_maddubs_epi16(a, w), ones);
+            sum = _mm_add_epi32(sum, product);
+        }
+        out[i] = biases[i] + nnueHorizontalSum(sum);
+    }
+#else
+    for (int i = 0; i < outputs; ++i) {
+        const std::int8_t* row = weights + i * inputs;
+        std::int32_t sum = biases[i];
+        for (int j = 0; j < inputs; ++j) {
+            sum += static_cast<std::int32_t>(in[j]) * row[j];
+        }
+        out[i] = sum;
+    }
+#endif
+}
+
+// out[i] = clamp(in[i] >> NNUE_WEIGHT_SCALE_BITS, 0, 127)
+inline void nnueClippedReluScaled(const std::int32_t* in, std::uint8_t* out, int count) {
+    for (int i = 0; i < count; ++i) {
+        out[i] = static_cast<std::uint8_t>(std::clamp(in[i] >> NNUE_WEIGHT_SCALE_BITS, 0, 127));
+    }
+}
+
+#endif // NNUE_SIMD_H
@@ -0,0 +1,102 @@
+#include "core/AttackMap.h"
+#include "core/Board.h"
+
+namespace {
+
+struct BoardPieces {
+    Bitboard bb[2][6];
+
+    explicit BoardPieces(const Board& board) {
+        for (Color side : {Color::WHITE, Color::BLACK}) {
+            for (int t = 0; t < 6; ++t) {
+                bb[static_cast<int>(side)][t] = board.getPieces(side, static_cast<PieceType>(t));
+            }
+        }
+    }
+};
+
+} // namespace
+
+AttackMap::AttackMap(const Board& board) : AttackMap(BoardPieces(board).bb) {
+}
+
+AttackMap::AttackMap(const Bitboard pieceBitboards[2][6]) : pieceCount(0) {
+    for (int s = 0; s < 2; ++s) {
+        occupancy[s] = 0;
+        for (int t = 0; t < 6; ++t) {
+            occupancy[s] |= pieceBitboards[s][t];
+        }
+    }
+    Bitboard occupied = occupancy[0] | occupancy[1];
+
+    for (Color side : {Color::WHITE, Color::BLACK}) {
+        int s = static_cast<int>(side);
+        attacksAll[s] = 0;
+        attackedTwice[s] = 0;
+        for (int t = 0; t < 6; ++t) {
+            attacksByType[s][t] = 0;
+        }
+
+        Bitboard kings = pieceBitboards[s][static_cast<int>(PieceType::KING)];
+        kingSquares[s] = kings ? lsb(kings) : -1;
+        kingZones[s] = kings ? (kingAttacks(kingSquares[s]) | kings) : 0;
+    }
+
+    for (Color side : {Color::WHITE, Color::BLACK}) {
+        int s = static_cast<int>(side);
+        for (int t = 0; t < 6; ++t) {
+            PieceType type = static_cast<PieceType>(t);
+            Bitboard bb = pieceBitboards[s][t];
+            while (bb) {
+                int square = popLsb(bb);
+                Bitboard attacks = pieceAttacks(type, side, square, occupied);
+                pieces[pieceCount++] = {type, side, square, attacks};
+                attackedTwice[s] |= attacksAll[s] & attacks;
+                attacksAll[s] |= attacks;
+                attacksByType[s][t] |= attacks;
+            }
+        }
+    }
+}
+
+Bitboard AttackMap::getAttacks(Color side) const {
+    return attacksAll[static_cast<int>(side)];
+}
+
+Bitboard AttackMap::getAttacks(Color side, PieceType type) const {
+    return attacksByType[static_cast<int>(side)][static_cast<int>(type)];
+}
+
+Bitboard AttackMap::getAttackedTwice(Color side) const {
+    return attackedTwice[static_cast<int>(side)];
+}
+
+Bitboard AttackMap::getOccupancy(Color side) const {
+    return occupancy[static_cast<int>(side)];
+}
+
+Bitboard AttackMap::getKingZone(Color side) const {
+    return kingZones[static_cast<int>(side)];
+}
+
+int AttackMap::getKingSquare(Color side) const {
+    return kingSquares[static_cast<int>(side)];
+}
+
+const AttackMap::PieceAttacks* AttackMap::getPieceAttacks() const {
+    return pieces;
+}
+
+int AttackMap::getPieceCount() const {
+    return pieceCount;
+}
+
+bool AttackMap::isAttacked(int square, Color bySide) const {
+    return (attacksAll[static_cast<int>(bySide)] & squareBB(square)) != 0;
+}
+
+bool AttackMap::isInCheck(Color side) const {
+    int kingSquare = kingSquares[static_cast<int>(side)];
+    Color opponent = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    return kingSquare >= 0 && isAttacked(kingSquare, opponent);
+}
@@ -0,0 +1,55 @@
+#ifndef ATTACK_MAP_H
+#define ATTACK_MAP_H
+
+#include "core/Bitboard.h"
+#include "core/ChessTypes.h"
+
+class Board;
+
+// Every square attacked by each side, built once from the board's bitboards.
+// Evaluation reads mobility and king-zone pressure from it, and the same
+// tables answer threat queries (is a square attacked, is a side in check)
+// without generating moves. Only valid for 8x8 boards (Board::hasBitboards).
+class AttackMap {
+public:
+    // Attack set of one piece (listed by side, then piece type)
+    struct PieceAttacks {
+        PieceType type;
+        Color color;
+        int square;
+        Bitboard attacks;
+    };
+
+    explicit AttackMap(const Board& board);
+    // From raw [Color][PieceType] bitboards, e.g. an unpacked PackedPosition
+    explicit AttackMap(const Bitboard pieces[2][6]);
+
+    Bitboard getAttacks(Color side) const;
+    Bitboard getAttacks(Color side, PieceType type) const;
+    Bitboard getAttackedTwice(Color side) const;
+
+    // Squares occupied by 'side'
+    Bitboard getOccupancy(Color side) const;
+
+    // King square plus its neighbours
+    Bitboard getKingZone(Color side) const;
+    int getKingSquare(Color side) const; // -1 if the side has no king
+
+    const PieceAttacks* getPieceAttacks() const;
+    int getPieceCount() const;
+
+    bool isAttacked(int square, Color bySide) const;
+    bool isInCheck(Color side) const;
+
+private:
+    Bitboard attacksByType[2][6];
+    Bitboard attacksAll[2];
+    Bitboard attackedTwice[2];
+    Bitboard kingZones[2];
+    Bitboard occupancy[2];
+    int kingSquares[2];
+    PieceAttacks pieces[64];
+    int pieceCount;
+};
+
+#endif // ATTACK_MAP_H
@@ -0,0 +1,128 @@
+#include "core/Bitboard.h"
+
+namespace {
+
+// Ray directions as (rank step, file step). The first four increase the
+// square index, so their nearest blocker is the lowest set bit.
+const int RAY_DIRECTIONS[8][2] = {
+    {1, 0}, {0, 1}, {1, 1}, {1, -1},   // N, E, NE, NW
+    {-1, 0}, {0, -1}, {-1, -1}, {-1, 1} // S, W, SW, SE
+};
+
+struct AttackTables {
+    Bitboard pawn[2][64];
+    Bitboard knight[64];
+    Bitboard king[64];
+    Bitboard rays[8][64];
+
+    AttackTables() {
+        const int knightSteps[8][2] = {{2, 1}, {2, -1}, {-2, 1}, {-2, -1}, {1, 2}, {1, -2}, {-1, 2}, {-1, -2}};
+        const int kingSteps[8][2] = {{0, 1}, {0, -1}, {1, 0}, {-1, 0}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+
+        for (int square = 0; square < 64; ++square) {
+            int rank = square / 8;
+            int file = square % 8;
+            auto bitAt = [](int r, int f) -> Bitboard {
+                return (r >= 0 && r < 8 && f >= 0 && f < 8) ? squareBB(r * 8 + f) : 0;
+            };
+
+            pawn[static_cast<int>(Color::WHITE)][square] = bitAt(rank + 1, file - 1) | bitAt(rank + 1, file + 1);
+            pawn[static_cast<int>(Color::BLACK)][square] = bitAt(rank - 1, file - 1) | bitAt(rank - 1, file + 1);
+
+            knight[square] = 0;
+            king[square] = 0;
+            for (int i = 0; i < 8; ++i) {
+                knight[square] |= bitAt(rank + knightSteps[i][0], file + knightSteps[i][1]);
+                king[square] |= bitAt(rank + kingSteps[i][0], file + kingSteps[i][1]);
+            }
+
+            for (int dir = 0; dir < 8; ++dir) {
+                rays[dir][square] = 0;
+                for (int r = rank + RAY_DIRECTIONS[dir][0], f = file + RAY_DIRECTIONS[dir][1];
+                     r >= 0 && r < 8 && f >= 0 && f < 8;
+                     r += RAY_DIRECTIONS[dir][0], f += RAY_DIRECTIONS[dir][1]) {
+                    rays[dir][square] |= squareBB(r * 8 + f);
+                }
+            }
+        }
+    }
+};
+
+const AttackTables ATTACK_TABLES;
+
+inline const AttackTables& tables() {
+    return ATTACK_TABLES;
+}
+
+// Classical ray attacks: cut the ray behind the first blocker
+inline Bitboard rayAttacks(const AttackTables& t, int dir, int square, Bitboard occupied) {
+    Bitboard attacks = t.rays[dir][square];
+    Bitboard blockers = attacks & occupied;
+    if (blockers) {
+        int blocker = (dir < 4) ? lsb(blockers) : msb(blockers);
+        attacks ^= t.rays[dir][blocker];
+    }
+    return attacks;
+}
+
+} // namespace
+
+Bitboard pawnAttacks(Color color, int square) {
+    return tables().pawn[static_cast<int>(color)][square];
+}
+
+Bitboard knightAttacks(int square) {
+    return tables().knight[square];
+}
+
+Bitboard kingAttacks(int square) {
+    return tables().king[square];
+}
+
+Bitboard bishopAttacks(int square, Bitboard occupied) {
+    const AttackTables& t = tables();
+    return rayAttacks(t, 2, square, occupied) | rayAttacks(t, 3, square, occupied) |
+           rayAttacks(t, 6, square, occupied) | rayAttacks(t, 7, square, occupied);
+}
+
+Bitboard rookAttacks(int square, Bitboard occupied) {
+    const AttackTables& t = tables();
+    return rayAttacks(t, 0, square, occupied) | rayAttacks(t, 1, square, occupied) |
+           rayAttacks(t, 4, square, occupied) | rayAttacks(t, 5, square, occupied);
+}
+
+Bitboard queenAttacks(int square, Bitboard occupied) {
+    return bishopAttacks(square, occupied) | rookAttacks(square, occupied);
+}
+
+Bitboard pieceAttacks(PieceType type, Color color, int square, Bitboard occupied) {
+    switch (type) {
+        case PieceType::PAWN:   return pawnAttacks(color, square);
+        case PieceType::KNIGHT: return knightAttacks(square);
+        case PieceType::BISHOP: return bishopAttacks(square, occupied);
+        case PieceType::ROOK:   return rookAttacks(square, occupied);
+        case PieceType::QUEEN:  return queenAttacks(square, occupied);
+        case PieceType::KING:   return kingAttacks(square);
+        default:                return 0;
+    }
+}
+
+Bitboard pawnAttacksBB(Color color, Bitboard pawns) {
+    if (color == Color::WHITE) {
+        return ((pawns & ~FILE_A_BB) << 7) | ((pawns & ~FILE_H_BB) << 9);
+    }
+    return ((pawns & ~FILE_A_BB) >> 9) | ((pawns & ~FILE_H_BB) >> 7);
+}
+
+bool isSquareAttackedBy(const Bitboard pieces[2][6], Bitboard occupied, int square, Color attacker) {
+    // Reverse lookup: a square is attacked by a piece type if that piece,
+    // standing on the square, would attack one of the attacker's pieces of that type.
+    const Bitboard* own = pieces[static_cast<int>(attacker)];
+    Color defender = (attacker == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    Bitboard queens = own[static_cast<int>(PieceType::QUEEN)];
+    return (pawnAttacks(defender, square) & own[static_cast<int>(PieceType::PAWN)])
+        || (knightAttacks(square) & own[static_cast<int>(PieceType::KNIGHT)])
+        || (kingAttacks(square) & own[static_cast<int>(PieceType::KING)])
+        || (bishopAttacks(square, occupied) & (own[static_cast<int>(PieceType::BISHOP)] | queens))
+        || (rookAttacks(square, occupied) & (own[static_cast<int>(PieceType::ROOK)] | queens));
+}
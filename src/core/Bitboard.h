@@ -0,0 +1,77 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include "core/ChessTypes.h"
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// 64-bit square sets for standard 8x8 boards.
+// Bit n corresponds to square index n (a1 = 0, h8 = 63, see Position::toSquareIndex).
+using Bitboard = std::uint64_t;
+
+constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+constexpr Bitboard RANK_1_BB = 0xFFULL;
+constexpr Bitboard RANK_8_BB = RANK_1_BB << 56;
+
+inline Bitboard squareBB(int square) {
+    return Bitboard(1) << square;
+}
+
+inline int popCount(Bitboard bb) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(bb));
+#else
+    return __builtin_popcountll(bb);
+#endif
+}
+
+// Index of the least / most significant set bit. 'bb' must be non-zero.
+inline int lsb(Bitboard bb) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bb);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bb);
+#endif
+}
+
+inline int msb(Bitboard bb) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, bb);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(bb);
+#endif
+}
+
+// Removes and returns the least significant set bit
+inline int popLsb(Bitboard& bb) {
+    int square = lsb(bb);
+    bb &= bb - 1;
+    return square;
+}
+
+// Attack sets. Slider attacks stop at (and include) the first occupied square
+// in each direction; friendly blockers are not masked out.
+Bitboard pawnAttacks(Color color, int square);
+Bitboard knightAttacks(int square);
+Bitboard kingAttacks(int square);
+Bitboard bishopAttacks(int square, Bitboard occupied);
+Bitboard rookAttacks(int square, Bitboard occupied);
+Bitboard queenAttacks(int square, Bitboard occupied);
+Bitboard pieceAttacks(PieceType type, Color color, int square, Bitboard occupied);
+
+// Whole-set pawn attacks, e.g. every square attacked by any white pawn
+Bitboard pawnAttacksBB(Color color, Bitboard pawns);
+
+// Whether any of 'attacker's pieces attacks 'square', given [Color][PieceType]
+// bitboards and the occupancy that blocks sliders
+bool isSquareAttackedBy(const Bitboard pieces[2][6], Bitboard occupied, int square, Color attacker);
+
+#endif // BITBOARD_H
@@ -9,12 +9,16 @@
 #include "core/King.h"
 #include <stdexcept> // For out_of_range
 #include <vector>    // Ensure vector is included for swap
+#include <algorithm> // For std::copy, std::fill
+#include <sstream>   // For FEN parsing
+#include <cctype>
 
 // Constructor
 Board::Board(int rows, int cols) : dimensions({rows, cols}), lastMove(nullptr),
                                    whiteCanCastleKingside(true), whiteCanCastleQueenside(true),
                                    blackCanCastleKingside(true), blackCanCastleQueenside(true),
-                                   enPassantTargetSquare(-1, -1) {
+                                   enPassantTargetSquare(-1, -1),
+                                   bitboardsEnabled(rows == 8 && cols == 8) {
     initializeEmptyBoard();
 }
 
@@ -26,7 +30,10 @@ Board::Board(const Board& other)
       whiteCanCastleQueenside(other.whiteCanCastleQueenside),
       blackCanCastleKingside(other.blackCanCastleKingside),
       blackCanCastleQueenside(other.blackCanCastleQueenside),
-      enPassantTargetSquare(other.enPassantTargetSquare) {
+      enPassantTargetSquare(other.enPassantTargetSquare),
+      bitboardsEnabled(other.bitboardsEnabled) {
+    std::copy(&other.pieceBitboards[0][0], &other.pieceBitboards[0][0] + 12, &pieceBitboards[0][0]);
+    std::copy(other.colorBitboards, other.colorBitboards + 2, colorBitboards);
     
     grid.resize(dimensions.rows); 
     for (int r = 0; r < dimensions.rows; ++r) {
@@ -54,6 +61,9 @@ Board& Board::operator=(const Board& other) {
     blackCanCastleKingside = other.blackCanCastleKingside;
     blackCanCastleQueenside = other.blackCanCastleQueenside;
     enPassantTargetSquare = other.enPassantTargetSquare;
+    bitboardsEnabled = other.bitboardsEnabled;
+    std::copy(&other.pieceBitboards[0][0], &other.pieceBitboards[0][0] + 12, &pieceBitboards[0][0]);
+    std::copy(other.colorBitboards, other.colorBitboards + 2, colorBitboards);
 
     std::vector<std::vector<std::unique_ptr<Piece>>> new_grid(other.dimensions.rows);
     for (int r = 0; r < other.dimensions.rows; ++r) {
@@ -79,7 +89,10 @@ Board::Board(Board&& other) noexcept
       whiteCanCastleQueenside(other.whiteCanCastleQueenside),
       blackCanCastleKingside(other.blackCanCastleKingside),
       blackCanCastleQueenside(other.blackCanCastleQueenside),
-      enPassantTargetSquare(other.enPassantTargetSquare) {
+      enPassantTargetSquare(other.enPassantTargetSquare),
+      bitboardsEnabled(other.bitboardsEnabled) {
+    std::copy(&other.pieceBitboards[0][0], &other.pieceBitboards[0][0] + 12, &pieceBitboards[0][0]);
+    std::copy(other.colorBitboards, other.colorBitboards + 2, colorBitboards);
     other.lastMove = nullptr;
     other.enPassantTargetSquare = Position(-1,-1);
 }
@@ -97,6 +110,9 @@ Board& Board::operator=(Board&& other) noexcept {
     blackCanCastleKingside = other.blackCanCastleKingside;
     blackCanCastleQueenside = other.blackCanCastleQueenside;
     enPassantTargetSquare = other.enPassantTargetSquare;
+    bitboardsEnabled = other.bitboardsEnabled;
+    std::copy(&other.pieceBitboards[0][0], &other.pieceBitboards[0][0] + 12, &pieceBitboards[0][0]);
+    std::copy(other.colorBitboards, other.colorBitboards + 2, colorBitboards);
 
     other.lastMove = nullptr;
     other.enPassantTargetSquare = Position(-1,-1);
@@ -122,6 +138,7 @@ void Board::initializeEmptyBoard() {
     blackCanCastleKingside = true;
     blackCanCastleQueenside = true;
     enPassantTargetSquare = Position(-1, -1);
+    rebuildBitboards();
 }
 
 // ... (rest of Board.cpp remains the same as the previous full version) ...
@@ -170,8 +187,154 @@ void Board::initializeDefaultSetup() {
     blackCanCastleQueenside = true;
     enPassantTargetSquare = Position(-1,-1);
     lastMove = nullptr;
+    rebuildBitboards();
 }
 
+void Board::initializeCustomSetup(const std::string& fen) {
+    if (dimensions.rows != 8 || dimensions.cols != 8) {
+        throw std::runtime_error("FEN setup is designed for 8x8 board.");
+    }
+
+    std::istringstream fields(fen);
+    std::string placement;
+    std::string sideToMove;
+    std::string castling = "-";
+    std::string enPassant = "-";
+    if (!(fields >> placement)) {
+        throw std::invalid_argument("Empty FEN string.");
+    }
+    fields >> sideToMove >> castling >> enPassant; // Optional here; Game validates the side to move
+
+    // Build into a scratch board so a malformed string leaves this one untouched
+    Board parsed(8, 8);
+    int row = 0;
+    int col = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            if (col != 8 || row == 7) throw std::invalid_argument("Bad FEN rank layout: " + fen);
+            ++row;
+            col = 0;
+        } else if (ch >= '1' && ch <= '8') {
+            col += ch - '0';
+            if (col > 8) throw std::invalid_argument("Bad FEN rank layout: " + fen);
+        } else {
+            PieceType type;
+            switch (std::tolower(static_cast<unsigned char>(ch))) {
+                case 'p': type = PieceType::PAWN; break;
+                case 'r': type = PieceType::ROOK; break;
+                case 'n': type = PieceType::KNIGHT; break;
+                case 'b': type = PieceType::BISHOP; break;
+                case 'q': type = PieceType::QUEEN; break;
+                case 'k': type = PieceType::KING; break;
+                default: throw std::invalid_argument("Bad FEN piece '" + std::string(1, ch) + "': " + fen);
+            }
+            if (col >= 8) throw std::invalid_argument("Bad FEN rank layout: " + fen);
+            Color color = std::isupper(static_cast<unsigned char>(ch)) ? Color::WHITE : Color::BLACK;
+            parsed.grid[row][col] = createPiece(type, color, Position(row, col));
+            ++col;
+        }
+    }
+    if (row != 7 || col != 8) throw std::invalid_argument("Bad FEN rank layout: " + fen);
+
+    parsed.setCastlingRights(Color::WHITE, false, false);
+    parsed.setCastlingRights(Color::BLACK, false, false);
+    if (castling != "-") {
+        for (char ch : castling) {
+            switch (ch) {
+                case 'K': parsed.whiteCanCastleKingside = true; break;
+                case 'Q': parsed.whiteCanCastleQueenside = true; break;
+                case 'k': parsed.blackCanCastleKingside = true; break;
+                case 'q': parsed.blackCanCastleQueenside = true; break;
+                default: throw std::invalid_argument("Bad FEN castling field: " + fen);
+            }
+        }
+    }
+
+    if (enPassant != "-") {
+        parsed.enPassantTargetSquare = Position::fromAlgebraic(enPassant); // Throws std::invalid_argument
+    }
+
+    // Pieces that cannot be on their original squares count as moved: pawns
+    // lose the double step, kings and rooks without a castling right never castle
+    for (int r = 0; r < 8; ++r) {
+        for (int c = 0; c < 8; ++c) {
+            Piece* piece = parsed.grid[r][c].get();
+            if (!piece) continue;
+            Color color = piece->getColor();
+            int backRank = (color == Color::WHITE) ? 7 : 0;
+            bool moved = false;
+            switch (piece->getType()) {
+                case PieceType::PAWN:
+                    moved = r != ((color == Color::WHITE) ? 6 : 1);
+                    break;
+                case PieceType::KING:
+                    moved = !(parsed.canCastleKingside(color) || parsed.canCastleQueenside(color));
+                    break;
+                case PieceType::ROOK:
+                    moved = !(r == backRank && ((c == 7 && parsed.canCastleKingside(color)) ||
+                                                (c == 0 && parsed.canCastleQueenside(color))));
+                    break;
+                default:
+                    break;
+            }
+            piece->setHasMoved(moved);
+        }
+    }
+
+    parsed.rebuildBitboards();
+    *this = std::move(parsed);
+}
+
+std::string Board::toFen(Color sideToMove, int halfMoveClock, int fullMoveNumber) const {
+    if (dimensions.rows != 8 || dimensions.cols != 8) {
+        throw std::runtime_error("FEN is defined for 8x8 boards only.");
+    }
+
+    std::string fen;
+    fen.reserve(90);
+    for (int r = 0; r < 8; ++r) {
+        int emptyRun = 0;
+        for (int c = 0; c < 8; ++c) {
+            const Piece* piece = grid[r][c].get();
+            if (!piece) {
+                ++emptyRun;
+                continue;
+            }
+            if (emptyRun > 0) {
+                fen += static_cast<char>('0' + emptyRun);
+                emptyRun = 0;
+            }
+            char symbol = piece->getSymbol();
+            fen += (piece->getColor() == Color::WHITE) ? symbol : static_cast<char>(std::tolower(symbol));
+        }
+        if (emptyRun > 0) fen += static_cast<char>('0' + emptyRun);
+        if (r < 7) fen += '/';
+    }
+
+    fen += (sideToMove == Color::WHITE) ? " w " : " b ";
+    std::string castling;
+    if (whiteCanCastleKingside) castling += 'K';
+    if (whiteCanCastleQueenside) castling += 'Q';
+    if (blackCanCastleKingside) castling += 'k';
+    if (blackCanCastleQueenside) castling += 'q';
+    fen += castling.empty() ? "-" : castling;
+    fen += ' ';
+    fen += enPassantTargetSquare.isValid(8, 8) ? enPassantTargetSquare.toAlgebraic() : "-";
+    fen += ' ' + std::to_string(halfMoveClock) + ' ' + std::to_string(fullMoveNumber);
+    return fen;
+}
+
+std::unique_ptr<Piece> Board::createPiece(PieceType type, Color color, Position pos) {
+    switch (type) {
+        case PieceType::PAWN:   return std::make_unique<Pawn>(color, pos);
+        case PieceType::ROOK:   return std::make_unique<Rook>(color, pos);
+        case PieceType::KNIGHT: return std::make_unique<Knight>(color, pos);
+        case PieceType::BISHOP: return std::make_unique<Bishop>(color, pos);
+        case PieceType::QUEEN:  return std::make_unique<Queen>(color, pos);
+        case PieceType::KING:   return std::make_unique<King>(color, pos);
+        default:                return nullptr;
+    }
+}
 
 const Piece* Board::getPieceAt(Position pos) const {
     if (!pos.isValid(dimensions.rows, dimensions.cols)) {
@@ -191,8 +354,10 @@ void Board::addPiece(std::unique_ptr<Piece> piece, Position pos) {
     if (!pos.isValid(dimensions.rows, dimensions.cols)) {
         throw std::out_of_range("Position out of board bounds in addPiece.");
     }
+    clearBitboardPiece(grid[pos.row][pos.col].get(), pos); // Replacing a piece (e.g. promotion)
     if (piece) {
         piece->setPosition(pos); 
+        setBitboardPiece(piece.get(), pos);
         grid[pos.row][pos.col] = std::move(piece);
     } else {
         grid[pos.row][pos.col] = nullptr; 
@@ -203,6 +368,7 @@ std::unique_ptr<Piece> Board::removePiece(Position pos) {
     if (!pos.isValid(dimensions.rows, dimensions.cols) || !grid[pos.row][pos.col]) {
         return nullptr; 
     }
+    clearBitboardPiece(grid[pos.row][pos.col].get(), pos);
     return std::move(grid[pos.row][pos.col]); 
 }
 
@@ -226,21 +392,31 @@ std::unique_ptr<Piece> Board::performMove(const Move& move) {
         }
     }
 
+    // A rook captured on its original corner takes that castling right with it
+    if (capturedPiece && capturedPiece->getType() == PieceType::ROOK && dimensions.rows == 8 && dimensions.cols == 8) {
+        Color rookColor = capturedPiece->getColor();
+        int backRank = (rookColor == Color::WHITE) ? 7 : 0;
+        if (move.to.row == backRank && move.to.col == 0) {
+            setCastlingRights(rookColor, canCastleKingside(rookColor), false);
+        } else if (move.to.row == backRank && move.to.col == 7) {
+            setCastlingRights(rookColor, false, canCastleQueenside(rookColor));
+        }
+    }
+
     addPiece(std::move(pieceFromSource), move.to); 
     movingPieceOriginalPtr->setHasMoved(true); 
 
-    if (move.promotionPiece != PieceType::EMPTY && movingPieceOriginalPtr->getType() == PieceType::PAWN) {
+    // Must run before a promotion replaces (and destroys) the moving pawn
+    updateCastlingRights(move, movingPieceOriginalPtr); 
+
+    PieceType movingPieceType = movingPieceOriginalPtr->getType();
+    if (move.promotionPiece != PieceType::EMPTY && movingPieceType == PieceType::PAWN) {
         bool atPromotionRank = (movingPieceOriginalPtr->getColor() == Color::WHITE && move.to.row == 0) ||
                                (movingPieceOriginalPtr->getColor() == Color::BLACK && move.to.row == dimensions.rows - 1);
         if (atPromotionRank) {
             std::unique_ptr<Piece> promotedPiece;
-            Color color = movingPieceOriginalPtr->getColor();
-            switch (move.promotionPiece) {
-                case PieceType::QUEEN:  promotedPiece = std::make_unique<Queen>(color, move.to); break;
-                case PieceType::ROOK:   promotedPiece = std::make_unique<Rook>(color, move.to);   break;
-                case PieceType::BISHOP: promotedPiece = std::make_unique<Bishop>(color, move.to); break;
-                case PieceType::KNIGHT: promotedPiece = std::make_unique<Knight>(color, move.to); break;
-                default: break; 
+            if (move.promotionPiece != PieceType::PAWN && move.promotionPiece != PieceType::KING) {
+                promotedPiece = createPiece(move.promotionPiece, movingPieceOriginalPtr->getColor(), move.to);
             }
             if (promotedPiece) {
                 promotedPiece->setHasMoved(true); 
@@ -249,7 +425,7 @@ std::unique_ptr<Piece> Board::performMove(const Move& move) {
         }
     }
 
-    if (move.isCastling && movingPieceOriginalPtr->getType() == PieceType::KING) {
+    if (move.isCastling && movingPieceType == PieceType::KING) {
         Position rookFromPos, rookToPos;
         if (move.to.col > move.from.col) { 
             rookFromPos = Position(move.from.row, dimensions.cols - 1); 
@@ -269,8 +445,6 @@ std::unique_ptr<Piece> Board::performMove(const Move& move) {
         }
     }
     
-    updateCastlingRights(move, movingPieceOriginalPtr); 
-    
     return capturedPiece;
 }
 
@@ -278,6 +452,68 @@ std::unique_ptr<Piece> Board::performUnmove(const Move& move) {
     return NULL;
 }
 
+void Board::applyMove(const Move& move) {
+    const Piece* movingPiece = getPieceAt(move.from);
+    clearEnPassantTargetSquare();
+    if (movingPiece && movingPiece->getType() == PieceType::PAWN && std::abs(move.to.row - move.from.row) == 2) {
+        setEnPassantTargetSquare(Position((move.from.row + move.to.row) / 2, move.from.col));
+    }
+    performMove(move);
+}
+
+bool Board::isKingSafeAfter(const Move& move, Color color) const {
+    Color opponent = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    const Piece* movingPiece = getPieceAt(move.from);
+    if (!movingPiece) return false;
+
+    if (!bitboardsEnabled) {
+        Board tempBoard = *this;
+        tempBoard.performMove(move);
+        return !tempBoard.isSquareAttacked(tempBoard.findKing(color), opponent);
+    }
+
+    // Replay the move on a copy of the bitboards only
+    Bitboard pieces[2][6];
+    std::copy(&pieceBitboards[0][0], &pieceBitboards[0][0] + 12, &pieces[0][0]);
+    int us = static_cast<int>(color);
+    int them = static_cast<int>(opponent);
+    int movingType = static_cast<int>(movingPiece->getType());
+    Bitboard fromBB = squareBB(move.from.toSquareIndex());
+    Bitboard toBB = squareBB(move.to.toSquareIndex());
+
+    Bitboard capturedBB = toBB;
+    if (move.isEnPassantCapture && movingPiece->getType() == PieceType::PAWN) {
+        capturedBB = squareBB(Position(move.from.row, move.to.col).toSquareIndex());
+    }
+    for (int t = 0; t < 6; ++t) {
+        pieces[them][t] &= ~capturedBB;
+    }
+
+    int placedType = movingType;
+    if (move.promotionPiece != PieceType::EMPTY && movingPiece->getType() == PieceType::PAWN) {
+        placedType = static_cast<int>(move.promotionPiece);
+    }
+    pieces[us][movingType] &= ~fromBB;
+    pieces[us][placedType] |= toBB;
+
+    if (move.isCastling && movingPiece->getType() == PieceType::KING) {
+        bool kingside = move.to.col > move.from.col;
+        Position rookFrom(move.from.row, kingside ? 7 : 0);
+        Position rookTo(move.from.row, kingside ? move.to.col - 1 : move.to.col + 1);
+        int rook = static_cast<int>(PieceType::ROOK);
+        pieces[us][rook] = (pieces[us][rook] & ~squareBB(rookFrom.toSquareIndex())) | squareBB(rookTo.toSquareIndex());
+    }
+
+    Bitboard king = pieces[us][static_cast<int>(PieceType::KING)];
+    if (!king) return true; // Nothing to attack (custom setups)
+
+    Bitboard occupied = 0;
+    for (int t = 0; t < 6; ++t) {
+        occupied |= pieces[0][t] | pieces[1][t];
+    }
+    return !isSquareAttackedBy(pieces, occupied, lsb(king), opponent);
+}
+
 
 BoardDimensions Board::getDimensions() const {
     return dimensions;
@@ -369,7 +605,24 @@ std::vector<Piece*> Board::findPieces(Color color, PieceType type) const {
     return foundPieces;
 }
 
+bool Board::isInsufficientMaterial() const {
+    int minors = 0;
+    for (int r = 0; r < dimensions.rows; ++r) {
+        for (int c = 0; c < dimensions.cols; ++c) {
+            const Piece* piece = getPieceAt(Position(r, c));
+            if (!piece || piece->getType() == PieceType::KING) continue;
+            if (piece->getType() != PieceType::KNIGHT && piece->getType() != PieceType::BISHOP) return false;
+            ++minors;
+        }
+    }
+    return minors <= 1;
+}
+
 Position Board::findKing(Color color) const {
+    if (bitboardsEnabled) {
+        Bitboard kings = pieceBitboards[static_cast<int>(color)][static_cast<int>(PieceType::KING)];
+        return kings ? Position::fromSquareIndex(lsb(kings)) : Position(-1, -1);
+    }
     for (int r = 0; r < dimensions.rows; ++r) {
         for (int c = 0; c < dimensions.cols; ++c) {
             const Piece* p = grid[r][c].get();
@@ -386,6 +639,10 @@ bool Board::isSquareAttacked(Position square, Color attackerColor) const {
         return false; 
     }
 
+    if (bitboardsEnabled) {
+        return isSquareAttackedBy(pieceBitboards, getOccupied(), square.toSquareIndex(), attackerColor);
+    }
+
     for (int r = 0; r < dimensions.rows; ++r) {
         for (int c = 0; c < dimensions.cols; ++c) {
             const Piece* p = grid[r][c].get();
@@ -410,3 +667,47 @@ bool Board::isSquareAttacked(Position square, Color attackerColor) const {
     }
     return false; 
 }
+
+bool Board::hasBitboards() const {
+    return bitboardsEnabled;
+}
+
+Bitboard Board::getPieces(Color color, PieceType type) const {
+    return pieceBitboards[static_cast<int>(color)][static_cast<int>(type)];
+}
+
+Bitboard Board::getPieces(Color color) const {
+    return colorBitboards[static_cast<int>(color)];
+}
+
+Bitboard Board::getOccupied() const {
+    return colorBitboards[0] | colorBitboards[1];
+}
+
+void Board::setBitboardPiece(const Piece* piece, Position pos) {
+    if (!bitboardsEnabled || !piece) return;
+    Bitboard bit = squareBB(pos.toSquareIndex());
+    int side = static_cast<int>(piece->getColor());
+    pieceBitboards[side][static_cast<int>(piece->getType())] |= bit;
+    colorBitboards[side] |= bit;
+}
+
+void Board::clearBitboardPiece(const Piece* piece, Position pos) {
+    if (!bitboardsEnabled || !piece) return;
+    Bitboard bit = squareBB(pos.toSquareIndex());
+    int side = static_cast<int>(piece->getColor());
+    pieceBitboards[side][static_cast<int>(piece->getType())] &= ~bit;
+    colorBitboards[side] &= ~bit;
+}
+
+// Full resync after the grid was written directly (setup functions)
+void Board::rebuildBitboards() {
+    std::fill(&pieceBitboards[0][0], &pieceBitboards[0][0] + 12, Bitboard(0));
+    std::fill(colorBitboards, colorBitboards + 2, Bitboard(0));
+    if (!bitboardsEnabled) return;
+    for (int r = 0; r < dimensions.rows; ++r) {
+        for (int c = 0; c < dimensions.cols; ++c) {
+            setBitboardPiece(grid[r][c].get(), Position(r, c));
+        }
+    }
+}
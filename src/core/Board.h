@@ -5,8 +5,10 @@
 #include "core/Position.h"
 #include "core/Piece.h"
 #include "core/Move.h" // For lastMove
+#include "core/Bitboard.h"
 #include <vector>
 #include <memory> // For std::unique_ptr, std::shared_ptr
+#include <string>
 
 // Forward declare Piece derived classes to avoid circular dependencies
 // if Board methods need to know about specific piece types for setup.
@@ -36,6 +38,15 @@ private:
     // If no such pawn, position can be invalid.
     Position enPassantTargetSquare;
 
+    // Bitboard mirror of 'grid' for 8x8 boards, kept in sync by addPiece/removePiece.
+    // Indexed by [Color][PieceType].
+    bool bitboardsEnabled;
+    Bitboard pieceBitboards[2][6];
+    Bitboard colorBitboards[2];
+
+    void setBitboardPiece(const Piece* piece, Position pos);
+    void clearBitboardPiece(const Piece* piece, Position pos);
+    void rebuildBitboards();
 
 public:
     Board(int rows = 8, int cols = 8); // Default to standard 8x8 board
@@ -46,7 +57,16 @@ public:
 
     void initializeEmptyBoard();
     void initializeDefaultSetup(); // Sets up the standard chess starting position
-    // void initializeCustomSetup(const std::string& fen); // Future: FEN string setup
+    // Sets up pieces, castling rights and the en passant square from a FEN record
+    // (8x8 boards only; side to move and clocks belong to Game and are ignored).
+    // Throws std::invalid_argument on malformed input.
+    void initializeCustomSetup(const std::string& fen);
+    // FEN of the position (8x8 boards only, throws std::runtime_error otherwise).
+    // The board does not know whose move it is, so the caller supplies it.
+    std::string toFen(Color sideToMove, int halfMoveClock = 0, int fullMoveNumber = 1) const;
+
+    // Creates a piece of the given type (PieceType::EMPTY yields nullptr)
+    static std::unique_ptr<Piece> createPiece(PieceType type, Color color, Position pos);
 
     const Piece* getPieceAt(Position pos) const;
     Piece* getPieceAt(Position pos); // Non-const version for internal modification
@@ -59,6 +79,14 @@ public:
     std::unique_ptr<Piece> performMove(const Move& move);
     std::unique_ptr<Piece> performUnmove(const Move& move);
 
+    // performMove plus the en passant target bookkeeping Game does for a move.
+    // No legality checks: used for trusted moves (search, perft).
+    void applyMove(const Move& move);
+
+    // Whether 'color's king is safe after 'move' (a pseudo-legal move of 'color').
+    // Uses the bitboards on 8x8 boards instead of copying the board.
+    bool isKingSafeAfter(const Move& move, Color color) const;
+
     BoardDimensions getDimensions() const;
 
     // En Passant related
@@ -84,6 +112,15 @@ public:
     // Check if a square is attacked by the opponent
     bool isSquareAttacked(Position square, Color attackerColor) const;
 
+    // Neither side can mate: bare kings, or kings and a single knight or bishop
+    bool isInsufficientMaterial() const;
+
+    // Bitboard view of the position (8x8 boards only, see hasBitboards)
+    bool hasBitboards() const;
+    Bitboard getPieces(Color color, PieceType type) const;
+    Bitboard getPieces(Color color) const;
+    Bitboard getOccupied() const;
+
 };
 
 #endif // BOARD_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "core/EpdLoader.h"
+#include "util/MappedFile.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// Chunks per thread; more chunks than threads keeps the cores busy when
+// some parts of the file have longer lines than others
+const int CHUNKS_PER_THREAD = 8;
+
+// Parses the lines in [begin, end) into 'out'
+void loadChunk(const char* begin, const char* end, EpdDataset& out) {
+    while (begin < end) {
+        const char* newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<std::size_t>(end - begin)));
+        const char* lineEnd = newline ? newline : end;
+        std::string_view line(begin, static_cast<std::size_t>(lineEnd - begin));
+        begin = lineEnd + 1;
+
+        if (line.find_first_not_of(" \t\r") == std::string_view::npos) continue;
+        PackedPosition position;
+        if (!PackedPosition::parseFen(line, position)) {
+            ++out.skippedLines;
+            continue;
+        }
+        float result;
+        out.positions.push_back(position);
+        out.results.push_back(parseEpdResult(line, result) ? result : EPD_NO_RESULT);
+    }
+}
+
+} // namespace
+
+bool parseEpdResult(std::string_view line, float& result) {
+    std::string_view::size_type bracket = line.find('[');
+    if (bracket != std::string_view::npos) {
+        // strtof needs a terminated string; scores are short
+        char buffer[32] = {};
+        std::string_view score = line.substr(bracket + 1, sizeof(buffer) - 1);
+        std::copy(score.begin(), score.end(), buffer);
+        char* parsedEnd = nullptr;
+        result = std::strtof(buffer, &parsedEnd);
+        return parsedEnd != buffer && result >= 0.0f && result <= 1.0f;
+    }
+    if (line.find("1/2-1/2") != std::string_view::npos) {
+        result = 0.5f;
+    } else if (line.find("1-0") != std::string_view::npos) {
+        result = 1.0f;
+    } else if (line.find("0-1") != std::string_view::npos) {
+        result = 0.0f;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+EpdDataset loadEpdFile(const std::string& path, int threads) {
+    MappedFile file(path);
+    EpdDataset dataset;
+    if (file.size() == 0) return dataset;
+    const char* data = reinterpret_cast<const char*>(file.data());
+    const char* end = data + file.size();
+
+    ThreadPool pool(threads);
+    std::size_t chunkCount = static_cast<std::size_t>(pool.size()) * CHUNKS_PER_THREAD;
+    std::vector<const char*> cuts{data};
+    for (std::size_t c = 1; c < chunkCount; ++c) {
+        const char* cut = std::max(data + file.size() * c / chunkCount, cuts.back());
+        const char* newline = static_cast<const char*>(std::memchr(cut, '\n', static_cast<std::size_t>(end - cut)));
+        cuts.push_back(newline ? newline + 1 : end);
+    }
+    cuts.push_back(end);
+
+    std::vector<EpdDataset> parts(chunkCount);
+    pool.parallelFor(chunkCount, [&](std::size_t c) {
+        // Records average well over 40 bytes; reserving avoids most regrowth
+        parts[c].positions.reserve(static_cast<std::size_t>(cuts[c + 1] - cuts[c]) / 40);
+        parts[c].results.reserve(parts[c].positions.capacity());
+        loadChunk(cuts[c], cuts[c + 1], parts[c]);
+    });
+
+    std::size_t total = 0;
+    for (const EpdDataset& part : parts) {
+        total += part.positions.size();
+        dataset.skippedLines += part.skippedLines;
+    }
+    dataset.positions.reserve(total);
+    dataset.results.reserve(total);
+    for (EpdDataset& part : parts) {
+        dataset.positions.insert(dataset.positions.end(), part.positions.begin(), part.positions.end());
+        dataset.results.insert(dataset.results.end(), part.results.begin(), part.results.end());
+        part = EpdDataset(); // Release the chunk early
+    }
+    return dataset;
+}
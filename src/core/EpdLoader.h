@@ -0,0 +1,31 @@
+#ifndef EPD_LOADER_H
+#define EPD_LOADER_H
+
+#include "core/PackedPosition.h"
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Result value of a line that carries no game result
+inline constexpr float EPD_NO_RESULT = -1.0f;
+
+// Positions of an EPD/FEN file in file order, as 32-byte records
+struct EpdDataset {
+    std::vector<PackedPosition> positions;
+    std::vector<float> results;   // Per position: 1 = White won, 0.5 = draw, 0 = Black won, or EPD_NO_RESULT
+    std::size_t skippedLines = 0; // Non-blank lines without a valid position
+};
+
+// Game result of one EPD line, either a PGN result token ("1-0", "0-1",
+// "1/2-1/2", optionally quoted as in 'c9 "1-0";') or a bracketed score from
+// White's side ("[1.0]", "[0.5]"). Returns false if the line has none.
+bool parseEpdResult(std::string_view line, float& result);
+
+// Reads a file with one FEN or EPD record per line. The file is memory-mapped
+// and split at line boundaries into chunks that are parsed on 'threads' cores
+// (0 = all); the chunks are then joined in order. Throws std::runtime_error if
+// the file cannot be opened.
+EpdDataset loadEpdFile(const std::string& path, int threads = 0);
+
+#endif // EPD_LOADER_H
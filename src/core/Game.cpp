@@ -5,6 +5,14 @@
 #include "ai/EvaluationEngine.h" // For requestAIMove
 #include <iostream> // For simple error messages
 #include <algorithm> // For std::any_of, std::all_of
+#include <sstream>   // For FEN parsing
+#include <stdexcept>
+
+namespace {
+
+const char* STANDARD_START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+} // namespace
 
 Game::Game(PlayerType p1Type, PlayerType p2Type, int boardRows, int boardCols)
     : board(boardRows, boardCols), currentPlayerColor(Color::WHITE), gameState(GameState::PLAYING),
@@ -60,47 +68,41 @@ std::vector<Move> Game::generatePseudoLegalMoves(Color playerColor) const {
     return allMoves;
 }
 
-std::vector<Move> Game::getLegalMovesForColor(Color color) const {
-    std::vector<Move> legalMoves;
-    std::vector<Move> pseudoLegalMoves = generatePseudoLegalMoves(color);
-
-    for (const auto& move : pseudoLegalMoves) {
-        // Simulate the move on a temporary board
-        Board tempBoard = board; // Uses Board's copy constructor
-        Piece* movingPiece = tempBoard.getPieceAt(move.from); // Get piece from temp board
-        if (!movingPiece) continue; // Should not happen if generatePseudoLegalMoves is correct
-
-        tempBoard.performMove(move); // Perform the move
-
-        // Check if the current player's king is in check AFTER the move
-        if (!tempBoard.isSquareAttacked(tempBoard.findKing(color), (color == Color::WHITE) ? Color::BLACK : Color::WHITE)) {
-             // Special castling rules: King cannot castle through or into check
-            if (move.isCastling) {
-                bool canCastle = true;
-                Position kingFrom = move.from;
-                Position kingTo = move.to;
-                Color opponentColor = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
-
-                // Cannot castle out of check
-                if (board.isSquareAttacked(kingFrom, opponentColor)) {
-                    canCastle = false;
-                }
-                // Cannot castle through check
-                Position intermediateSquare = (kingTo.col > kingFrom.col) ?
-                                             Position(kingFrom.row, kingFrom.col + 1) :
-                                             Position(kingFrom.row, kingFrom.col - 1);
-                if (board.isSquareAttacked(intermediateSquare, opponentColor)) {
-                    canCastle = false;
-                }
-                // Cannot castle into check (already covered by the general check after tempBoard.performMove)
-
-                if(canCastle) legalMoves.push_back(move);
+void Game::generateLegalMoves(const Board& board, Color color, std::vector<Move>& out) {
+    Color opponentColor = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    const int rows = board.getDimensions().rows;
+    const int cols = board.getDimensions().cols;
 
-            } else {
-                 legalMoves.push_back(move);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            const Piece* piece = board.getPieceAt(Position(r, c));
+            if (!piece || piece->getColor() != color) continue;
+
+            for (const auto& move : piece->getPossibleMoves(board)) {
+                // Check if the player's king is in check AFTER the move (bitboards on 8x8)
+                if (!board.isKingSafeAfter(move, color)) continue;
+
+                // Special castling rules: King cannot castle out of or through check
+                // (castling into check is already covered by isKingSafeAfter)
+                if (move.isCastling) {
+                    Position kingFrom = move.from;
+                    Position intermediateSquare = (move.to.col > kingFrom.col) ?
+                                                 Position(kingFrom.row, kingFrom.col + 1) :
+                                                 Position(kingFrom.row, kingFrom.col - 1);
+                    if (board.isSquareAttacked(kingFrom, opponentColor) ||
+                        board.isSquareAttacked(intermediateSquare, opponentColor)) {
+                        continue;
+                    }
+                }
+                out.push_back(move);
             }
         }
     }
+}
+
+std::vector<Move> Game::getLegalMovesForColor(Color color) const {
+    std::vector<Move> legalMoves;
+    generateLegalMoves(board, color, legalMoves);
     return legalMoves;
 }
 
@@ -187,15 +189,8 @@ bool Game::makeMove(const Move& proposedMove) {
         halfMoveClock++;
     }
 
-    // Set en passant target square if it's a two-square pawn move
-    board.clearEnPassantTargetSquare(); // Clear previous one
-    if (pieceToMove->getType() == PieceType::PAWN && std::abs(proposedMove.to.row - proposedMove.from.row) == 2) {
-        int direction = (currentPlayerColor == Color::WHITE) ? -1 : 1;
-        board.setEnPassantTargetSquare(Position(proposedMove.from.row + direction, proposedMove.from.col));
-    }
-
-    // --- Actually perform the move ---
-    board.performMove(proposedMove);
+    // --- Actually perform the move (also updates the en passant target square) ---
+    board.applyMove(proposedMove);
     moveHistory.push_back(proposedMove);
     board.setLastMove(&moveHistory.back());
 
@@ -214,6 +209,49 @@ bool Game::makeMove(const Move& proposedMove) {
     return true;
 }
 
+void Game::loadFen(const std::string& fen) {
+    std::istringstream fields(fen);
+    std::string placement, side, castling, enPassant;
+    if (!(fields >> placement >> side >> castling >> enPassant)) {
+        throw std::invalid_argument("FEN needs at least four fields: " + fen);
+    }
+    if (side != "w" && side != "b") {
+        throw std::invalid_argument("Bad FEN side to move: " + fen);
+    }
+    int halfMoves = 0;
+    int fullMoves = 1;
+    if (fields >> halfMoves) {
+        if (!(fields >> fullMoves)) fullMoves = 1;
+    } else {
+        halfMoves = 0;
+    }
+    if (halfMoves < 0 || fullMoves < 0) {
+        throw std::invalid_argument("Bad FEN move counters: " + fen);
+    }
+    // Some tools write a full-move counter of 0; treat it as the first move
+    if (fullMoves == 0) fullMoves = 1;
+
+    board.initializeCustomSetup(fen); // Validates the rest; throws before touching the board
+    currentPlayerColor = (side == "w") ? Color::WHITE : Color::BLACK;
+    halfMoveClock = halfMoves;
+    fullMoveCounter = fullMoves;
+    moveHistory.clear();
+    board.setLastMove(nullptr);
+    gameStateRecord.clear();
+    gameState = GameState::PLAYING;
+    updateGameState();
+    recordGameState();
+    startFen = std::make_shared<const std::string>(toFen());
+}
+
+std::string Game::toFen() const {
+    return board.toFen(currentPlayerColor, halfMoveClock, fullMoveCounter);
+}
+
+std::string Game::getStartFen() const {
+    return startFen ? *startFen : STANDARD_START_FEN;
+}
+
 bool Game::unmakeMove(const Move& proposedMove) {
     Position source = proposedMove.to;
     Position destination = proposedMove.from;
@@ -274,6 +312,7 @@ Game Game::clone() const {
     clonedGame.moveHistory = this->moveHistory; // Copies the vector of Moves
     clonedGame.halfMoveClock = this->halfMoveClock;
     clonedGame.fullMoveCounter = this->fullMoveCounter;
+    clonedGame.startFen = this->startFen;
 
     // Re-point the board's lastMove to the cloned history if not empty
     if (!clonedGame.moveHistory.empty()) {
@@ -303,6 +342,23 @@ Game Game::clone() const {
     return clonedGame;
 }
 
+Game::Game(const Board& position)
+    : board(position), currentPlayerColor(Color::WHITE), gameState(GameState::PLAYING),
+      halfMoveClock(0), fullMoveCounter(1), gameStateHash(0) {}
+
+Game Game::afterMove(const Move& move) const {
+    Game next(board);
+    const Piece* piece = board.getPieceAt(move.from);
+    bool reversible = piece->getType() != PieceType::PAWN && board.getPieceAt(move.to) == nullptr; // As in makeMove
+    next.halfMoveClock = reversible ? halfMoveClock + 1 : 0;
+    next.fullMoveCounter = (currentPlayerColor == Color::BLACK) ? fullMoveCounter + 1 : fullMoveCounter;
+    next.startFen = startFen;
+    next.board.applyMove(move);
+    next.board.setLastMove(nullptr);
+    next.currentPlayerColor = (currentPlayerColor == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    return next;
+}
+
 Move Game::requestAIMove(const EvaluationEngine& engine, int depth) {
     // This method would typically be called by an AIPlayer.
     // For now, it's a utility in Game.
@@ -319,7 +375,8 @@ Game::Game(Game&& other) noexcept
       gameState(other.gameState),
       moveHistory(std::move(other.moveHistory)),
       halfMoveClock(other.halfMoveClock),
-      fullMoveCounter(other.fullMoveCounter) {
+      fullMoveCounter(other.fullMoveCounter),
+      startFen(std::move(other.startFen)) {
     // After moving, 'other' should be in a valid but unspecified state.
     // For example, its unique_ptrs are now null.
     // Ensure its board's lastMove pointer is also sensible if it was pointing into its own history
@@ -342,6 +399,7 @@ Game& Game::operator=(Game&& other) noexcept {
         moveHistory = std::move(other.moveHistory);
         halfMoveClock = other.halfMoveClock;
         fullMoveCounter = other.fullMoveCounter;
+        startFen = std::move(other.startFen);
 
         // Similar to move constructor, handle board's lastMove
         if (!this->moveHistory.empty()) {
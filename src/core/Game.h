@@ -26,6 +26,9 @@ private:
     int fullMoveCounter; // Increments after Black moves
     std::unordered_map<uint64_t, int> gameStateRecord;
     uint64_t gameStateHash;
+    // FEN the move history starts from; null for the standard starting position.
+    // Shared so that clone() (called for every search node) stays cheap.
+    std::shared_ptr<const std::string> startFen;
 
 
 
@@ -33,6 +36,9 @@ private:
     void updateGameState(); // Checks for check, checkmate, stalemate, draw conditions
     bool hasLegalMoves(Color playerColor); // Checks if the player has any legal moves
 
+    // Copy of 'position' with no players, history or repetition record (see afterMove)
+    explicit Game(const Board& position);
+
     // Generates all pseudo-legal moves for a player (moves that are valid on the board
     std::vector<Move> generatePseudoLegalMoves(Color playerColor) const;
 
@@ -44,6 +50,15 @@ public:
     bool makeMove(const Move& move); // Attempts to make a move, returns true if successful
     bool unmakeMove(const Move& move);
 
+    // Replaces the position with a FEN record (side to move and clocks included;
+    // missing clocks default to 0 and 1). The move history and repetition record
+    // start afresh. Throws std::invalid_argument on malformed input, leaving the
+    // game unchanged.
+    void loadFen(const std::string& fen);
+    std::string toFen() const;
+    // Position the move history starts from (the last loadFen, or the standard start)
+    std::string getStartFen() const;
+
     // Getters
     const Board& getBoard() const;
     Board& getBoard(); // Non-const version for internal use or AI needing to modify a copy
@@ -58,11 +73,21 @@ public:
     // Generates all fully legal moves for the current player
     std::vector<Move> getLegalMoves() const;
     std::vector<Move> getLegalMovesForColor(Color color) const;
+    // Appends the legal moves of 'color' on 'board' to 'out' without clearing it,
+    // so callers that generate many positions (perft, search) can reuse one buffer
+    static void generateLegalMoves(const Board& board, Color color, std::vector<Move>& out);
 
 
     // For AI and deep copying/simulation
     Game clone() const;
 
+    // The position after 'move', which must be one of getLegalMoves(), for
+    // searches: board, side to move and clocks only. The copy has no players,
+    // move history or repetition record, and its game state is left at PLAYING
+    // rather than re-evaluated, which saves clone() and makeMove() their two
+    // extra legal move generations and the default board setup per node.
+    Game afterMove(const Move& move) const;
+
     // To allow AI player to suggest a move
     Move requestAIMove(const EvaluationEngine& engine, int depth);
     bool isKingInCheck(Color kingColor) const;
@@ -74,7 +99,7 @@ public:
     Game& operator=(Game&& other) noexcept;
 
     uint64_t getGameStateHash() const;
-    int Game::getGameStateCount() const;
+    int getGameStateCount() const;
     void recordGameState();
     void hashGameState();
 };
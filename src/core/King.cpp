@@ -45,7 +45,8 @@ std::vector<Move> King::getPossibleMoves(const Board& board) const {
         // For now, just generate the move; Game logic will validate it fully.
         Position kingsideRookPos(currentPos.row, dims.cols - 1);
         const Piece* kRook = board.getPieceAt(kingsideRookPos);
-        if (kRook && kRook->getType() == PieceType::ROOK && kRook->getColor() == color && !kRook->getHasMoved()) {
+        if (board.canCastleKingside(color) &&
+            kRook && kRook->getType() == PieceType::ROOK && kRook->getColor() == color && !kRook->getHasMoved()) {
             bool pathClear = true;
             for (int c = currentPos.col + 1; c < kingsideRookPos.col; ++c) {
                 if (board.getPieceAt({currentPos.row, c}) != nullptr) {
@@ -62,7 +63,8 @@ std::vector<Move> King::getPossibleMoves(const Board& board) const {
         // Queenside (O-O-O)
         Position queensideRookPos(currentPos.row, 0);
         const Piece* qRook = board.getPieceAt(queensideRookPos);
-        if (qRook && qRook->getType() == PieceType::ROOK && qRook->getColor() == color && !qRook->getHasMoved()) {
+        if (board.canCastleQueenside(color) &&
+            qRook && qRook->getType() == PieceType::ROOK && qRook->getColor() == color && !qRook->getHasMoved()) {
             bool pathClear = true;
             for (int c = currentPos.col - 1; c > queensideRookPos.col; --c) {
                 if (board.getPieceAt({currentPos.row, c}) != nullptr) {
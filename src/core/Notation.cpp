@@ -0,0 +1,282 @@
+#include "core/Notation.h"
+#include "core/Bitboard.h"
+#include "core/Piece.h"
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+char pieceLetter(PieceType type) {
+    switch (type) {
+        case PieceType::KNIGHT: return 'N';
+        case PieceType::BISHOP: return 'B';
+        case PieceType::ROOK: return 'R';
+        case PieceType::QUEEN: return 'Q';
+        case PieceType::KING: return 'K';
+        default: return '\0';
+    }
+}
+
+bool letterPiece(char letter, PieceType& type) {
+    switch (letter) {
+        case 'N': type = PieceType::KNIGHT; return true;
+        case 'B': type = PieceType::BISHOP; return true;
+        case 'R': type = PieceType::ROOK; return true;
+        case 'Q': type = PieceType::QUEEN; return true;
+        case 'K': type = PieceType::KING; return true;
+        default: return false;
+    }
+}
+
+Color opposite(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+// Whether 'move' by 'side' leaves the opponent's king attacked. Replays the
+// move on a copy of the bitboards only, as Board::isKingSafeAfter does.
+bool givesCheck(const Board& board, Color side, const Move& move) {
+    const Piece* movingPiece = board.getPieceAt(move.from);
+    Bitboard pieces[2][6];
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            pieces[c][t] = board.getPieces(static_cast<Color>(c), static_cast<PieceType>(t));
+        }
+    }
+    int us = static_cast<int>(side);
+    int them = 1 - us;
+    Bitboard fromBB = squareBB(move.from.toSquareIndex());
+    Bitboard toBB = squareBB(move.to.toSquareIndex());
+    Bitboard capturedBB = toBB;
+    if (move.isEnPassantCapture) capturedBB = squareBB(Position(move.from.row, move.to.col).toSquareIndex());
+    for (int t = 0; t < 6; ++t) {
+        pieces[them][t] &= ~capturedBB;
+    }
+    int movingType = static_cast<int>(movingPiece->getType());
+    int placedType = move.promotionPiece != PieceType::EMPTY ? static_cast<int>(move.promotionPiece) : movingType;
+    pieces[us][movingType] &= ~fromBB;
+    pieces[us][placedType] |= toBB;
+    if (move.isCastling) {
+        bool kingside = move.to.col > move.from.col;
+        Position rookFrom(move.from.row, kingside ? 7 : 0);
+        Position rookTo(move.from.row, kingside ? move.to.col - 1 : move.to.col + 1);
+        int rook = static_cast<int>(PieceType::ROOK);
+        pieces[us][rook] = (pieces[us][rook] & ~squareBB(rookFrom.toSquareIndex())) | squareBB(rookTo.toSquareIndex());
+    }
+
+    Bitboard king = pieces[them][static_cast<int>(PieceType::KING)];
+    if (!king) return false;
+    Bitboard occupied = 0;
+    for (int t = 0; t < 6; ++t) {
+        occupied |= pieces[0][t] | pieces[1][t];
+    }
+    return isSquareAttackedBy(pieces, occupied, lsb(king), side);
+}
+
+// The castling move of 'side' towards the given wing, if it is legal now
+bool findCastling(const Board& board, Color side, bool kingside, Move& out) {
+    Bitboard king = board.getPieces(side, PieceType::KING);
+    if (!king) return false;
+    const Piece* kingPiece = board.getPieceAt(Position::fromSquareIndex(lsb(king)));
+    Color opponent = opposite(side);
+    for (const Move& move : kingPiece->getPossibleMoves(board)) {
+        if (!move.isCastling || (move.to.col > move.from.col) != kingside) continue;
+        // Not out of, through or into check (the same rules as Game::generateLegalMoves)
+        Position passed(move.from.row, kingside ? move.from.col + 1 : move.from.col - 1);
+        if (board.isSquareAttacked(move.from, opponent) || board.isSquareAttacked(passed, opponent)) return false;
+        if (!board.isKingSafeAfter(move, side)) return false;
+        out = move;
+        return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::string moveToSan(const Board& board, Color side, const Move& move) {
+    const Piece* piece = board.getPieceAt(move.from);
+    if (!piece) return move.toString();
+
+    std::string san;
+    if (move.isCastling) {
+        san = (move.to.col > move.from.col) ? "O-O" : "O-O-O";
+    } else {
+        std::string from = move.from.toAlgebraic();
+        bool isCapture = move.isEnPassantCapture || board.getPieceAt(move.to) != nullptr;
+        PieceType type = piece->getType();
+
+        if (type == PieceType::PAWN) {
+            if (isCapture) san += from[0];
+        } else {
+            san += pieceLetter(type);
+            // Other pieces of the same kind that can legally reach the same square
+            bool ambiguous = false;
+            bool sameFile = false;
+            bool sameRank = false;
+            auto addRival = [&](Position rival) {
+                ambiguous = true;
+                if (rival.col == move.from.col) sameFile = true;
+                if (rival.row == move.from.row) sameRank = true;
+            };
+            if (board.hasBitboards()) {
+                // Piece attacks are symmetric: the rivals are the pieces of this
+                // type that a piece of this type on the target square would attack
+                int target = move.to.toSquareIndex();
+                Bitboard rivals = board.getPieces(side, type) & pieceAttacks(type, side, target, board.getOccupied()) &
+                                  ~squareBB(move.from.toSquareIndex());
+                while (rivals) {
+                    Position rival = Position::fromSquareIndex(popLsb(rivals));
+                    if (board.isKingSafeAfter(Move(rival, move.to), side)) addRival(rival);
+                }
+            } else {
+                std::vector<Move> legalMoves;
+                Game::generateLegalMoves(board, side, legalMoves);
+                for (const Move& other : legalMoves) {
+                    if (other.to != move.to || other.from == move.from) continue;
+                    const Piece* rival = board.getPieceAt(other.from);
+                    if (rival && rival->getType() == type) addRival(other.from);
+                }
+            }
+            if (ambiguous) {
+                if (!sameFile) san += from[0];
+                else if (!sameRank) san += from.substr(1);
+                else san += from;
+            }
+        }
+
+        if (isCapture) san += 'x';
+        san += move.to.toAlgebraic();
+        if (move.promotionPiece != PieceType::EMPTY) {
+            san += '=';
+            san += pieceLetter(move.promotionPiece);
+        }
+    }
+
+    bool check;
+    if (board.hasBitboards()) {
+        check = givesCheck(board, side, move);
+    } else {
+        Board after = board;
+        after.applyMove(move);
+        check = after.isSquareAttacked(after.findKing(opposite(side)), side);
+    }
+    if (check) {
+        // Only a check can be mate, so the reply list is built for checks alone
+        Board after = board;
+        after.applyMove(move);
+        std::vector<Move> replies;
+        Game::generateLegalMoves(after, opposite(side), replies);
+        san += replies.empty() ? '#' : '+';
+    }
+    return san;
+}
+
+std::string moveToSan(const Game& game, const Move& move) {
+    return moveToSan(game.getBoard(), game.getCurrentPlayerColor(), move);
+}
+
+bool parseSan(const Board& board, Color side, std::string_view san, Move& out) {
+    if (!board.hasBitboards()) return false;
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?')) {
+        san.remove_suffix(1);
+    }
+
+    if (san == "O-O" || san == "0-0") return findCastling(board, side, true, out);
+    if (san == "O-O-O" || san == "0-0-0") return findCastling(board, side, false, out);
+
+    // Promotion suffix: "=Q" or a bare piece letter after the target square
+    PieceType promotion = PieceType::EMPTY;
+    if (san.size() >= 3 && letterPiece(san.back(), promotion)) {
+        if (promotion == PieceType::KING) return false;
+        san.remove_suffix(san[san.size() - 2] == '=' ? 2 : 1);
+    }
+
+    if (san.size() < 2) return false;
+    char fileChar = san[san.size() - 2];
+    char rankChar = san[san.size() - 1];
+    if (fileChar < 'a' || fileChar > 'h' || rankChar < '1' || rankChar > '8') return false;
+    int target = (rankChar - '1') * 8 + (fileChar - 'a');
+    san.remove_suffix(2);
+
+    PieceType type = PieceType::PAWN;
+    if (!san.empty() && letterPiece(san.front(), type)) san.remove_prefix(1);
+    bool capture = false;
+    int fromFile = -1;
+    int fromRank = -1;
+    for (char c : san) {
+        if (c == 'x' || c == ':') capture = true;
+        else if (c >= 'a' && c <= 'h') fromFile = c - 'a';
+        else if (c >= '1' && c <= '8') fromRank = c - '1';
+        else return false;
+    }
+
+    Bitboard own = board.getPieces(side);
+    Bitboard occupied = board.getOccupied();
+    if (own & squareBB(target)) return false;
+    Position to = Position::fromSquareIndex(target);
+
+    if (type == PieceType::PAWN) {
+        int forward = (side == Color::WHITE) ? 8 : -8;
+        int lastRank = (side == Color::WHITE) ? 7 : 0;
+        if ((target / 8 == lastRank) != (promotion != PieceType::EMPTY)) return false;
+        Bitboard pawns = board.getPieces(side, PieceType::PAWN);
+        int from = -1;
+        bool enPassant = false;
+        if (fromFile < 0 || fromFile == target % 8) {
+            // Push: one step, or two from the starting rank over an empty square
+            if (capture || (occupied & squareBB(target))) return false;
+            int oneBack = target - forward;
+            int startRank = (side == Color::WHITE) ? 1 : 6;
+            if (oneBack < 0 || oneBack > 63) return false;
+            if (pawns & squareBB(oneBack)) {
+                from = oneBack;
+            } else if (!(occupied & squareBB(oneBack)) && (oneBack - forward) / 8 == startRank &&
+                       (pawns & squareBB(oneBack - forward))) {
+                from = oneBack - forward;
+            } else {
+                return false;
+            }
+        } else {
+            // Capture from the given file, one rank behind the target
+            if (std::abs(fromFile - target % 8) != 1) return false;
+            from = target - forward - target % 8 + fromFile;
+            if (from < 0 || from > 63 || !(pawns & squareBB(from))) return false;
+            if (!(occupied & squareBB(target))) {
+                if (board.getEnPassantTargetSquare() != to) return false;
+                enPassant = true;
+            }
+        }
+        if (fromRank >= 0 && from / 8 != fromRank) return false;
+        Move move(Position::fromSquareIndex(from), to, promotion, false, enPassant);
+        if (!board.isKingSafeAfter(move, side)) return false;
+        out = move;
+        return true;
+    }
+
+    if (promotion != PieceType::EMPTY) return false;
+    Bitboard candidates = board.getPieces(side, type) & pieceAttacks(type, side, target, occupied);
+    bool found = false;
+    Move result{Position(), Position()};
+    while (candidates) {
+        int from = popLsb(candidates);
+        if (fromFile >= 0 && from % 8 != fromFile) continue;
+        if (fromRank >= 0 && from / 8 != fromRank) continue;
+        Move move(Position::fromSquareIndex(from), to);
+        if (!board.isKingSafeAfter(move, side)) continue;
+        if (found) return false; // Ambiguous
+        found = true;
+        result = move;
+    }
+    if (!found) return false;
+    out = result;
+    return true;
+}
+
+Move sanToMove(const Game& game, const std::string& san) {
+    Move move{Position(), Position()};
+    if (!parseSan(game.getBoard(), game.getCurrentPlayerColor(), san, move)) {
+        throw std::invalid_argument("Not a legal move in SAN: " + san + " in position " + game.toFen());
+    }
+    return move;
+}
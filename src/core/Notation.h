@@ -0,0 +1,27 @@
+#ifndef NOTATION_H
+#define NOTATION_H
+
+#include "core/Board.h"
+#include "core/Game.h"
+#include "core/Move.h"
+#include <string>
+#include <string_view>
+
+// Standard algebraic notation of a legal 'move' by 'side' on 'board': "Nbd7",
+// "exd5", "O-O", "e8=Q+", "Qh4#". Disambiguates by file, then rank, then both,
+// and appends the check or mate suffix. On 8x8 boards only the pieces that
+// could also reach the target square are tested (with bitboards), so no legal
+// move list is built except to tell mate from check.
+std::string moveToSan(const Board& board, Color side, const Move& move);
+// Same for the side to move in 'game'; the game itself is not changed
+std::string moveToSan(const Game& game, const Move& move);
+
+// Resolves a SAN move of 'side' on an 8x8 'board'. Accepts the usual variants
+// ("O-O"/"0-0", "e8=Q"/"e8Q", "Nxe5"/"Ne5", trailing +, #, ! and ?). Returns
+// false, leaving 'out' untouched, if the text is malformed, ambiguous or not a
+// legal move. Only the pieces that can reach the target square are examined.
+bool parseSan(const Board& board, Color side, std::string_view san, Move& out);
+// Same for the side to move in 'game'. Throws std::invalid_argument.
+Move sanToMove(const Game& game, const std::string& san);
+
+#endif // NOTATION_H
@@ -0,0 +1,267 @@
+#include "core/PackedPosition.h"
+#include "core/Board.h"
+#include "core/Game.h"
+#include <stdexcept>
+#include <algorithm> // For std::clamp
+#include <cstring>   // For std::memset
+#include <array>
+#include <cctype>
+#include <cstdlib>   // For std::abs
+
+PackedPosition PackedPosition::fromBoard(const Board& board, Color sideToMove, int halfMoveClock, int fullMoveNumber) {
+    if (!board.hasBitboards()) {
+        throw std::invalid_argument("PackedPosition requires a standard 8x8 board.");
+    }
+
+    PackedPosition packed;
+    std::memset(&packed, 0, sizeof(packed));
+    packed.occupancy = board.getOccupied();
+    if (popCount(packed.occupancy) > 32) {
+        throw std::invalid_argument("PackedPosition holds at most 32 pieces.");
+    }
+
+    int n = 0;
+    Bitboard occupied = packed.occupancy;
+    while (occupied) {
+        int square = popLsb(occupied);
+        const Piece* piece = board.getPieceAt(Position::fromSquareIndex(square));
+        int code = static_cast<int>(piece->getColor()) * 6 + static_cast<int>(piece->getType());
+        packed.pieces[n >> 1] |= static_cast<std::uint8_t>(code << ((n & 1) * 4));
+        ++n;
+    }
+
+    packed.sideToMove = (sideToMove == Color::WHITE) ? 0 : 1;
+    if (board.canCastleKingside(Color::WHITE)) packed.castlingRights |= PACKED_CASTLE_WHITE_KINGSIDE;
+    if (board.canCastleQueenside(Color::WHITE)) packed.castlingRights |= PACKED_CASTLE_WHITE_QUEENSIDE;
+    if (board.canCastleKingside(Color::BLACK)) packed.castlingRights |= PACKED_CASTLE_BLACK_KINGSIDE;
+    if (board.canCastleQueenside(Color::BLACK)) packed.castlingRights |= PACKED_CASTLE_BLACK_QUEENSIDE;
+
+    Position enPassant = board.getEnPassantTargetSquare();
+    packed.enPassantSquare = enPassant.isValid(8, 8) ? static_cast<std::uint8_t>(enPassant.toSquareIndex()) : PACKED_NO_SQUARE;
+    packed.halfMoveClock = static_cast<std::uint8_t>(std::clamp(halfMoveClock, 0, 255));
+    packed.fullMoveNumber = static_cast<std::uint16_t>(std::clamp(fullMoveNumber, 1, 65535));
+    return packed;
+}
+
+PackedPosition PackedPosition::fromGame(const Game& game) {
+    return fromBoard(game.getBoard(), game.getCurrentPlayerColor(), game.getHalfMoveClock(), game.getFullMoveCounter());
+}
+
+bool PackedPosition::toBitboards(Bitboard out[2][6]) const {
+    for (int c = 0; c < 2; ++c) {
+        for (int t = 0; t < 6; ++t) {
+            out[c][t] = 0;
+        }
+    }
+
+    int n = 0;
+    Bitboard occupied = occupancy;
+    while (occupied) {
+        int square = popLsb(occupied);
+        int code = pieceCode(n++);
+        if (code >= 12) return false;
+        out[code / 6][code % 6] |= squareBB(square);
+    }
+    return true;
+}
+
+std::string PackedPosition::toFen() const {
+    static const char PIECE_LETTERS[] = "PRNBQKprnbqk"; // Indexed by piece code
+
+    char board[64];
+    std::memset(board, 0, sizeof(board));
+    int n = 0;
+    Bitboard occupied = occupancy;
+    while (occupied) {
+        int square = popLsb(occupied);
+        int code = pieceCode(n++);
+        if (code >= 12) throw std::invalid_argument("PackedPosition holds an invalid piece code.");
+        board[square] = PIECE_LETTERS[code];
+    }
+
+    std::string fen;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            char piece = board[rank * 8 + file];
+            if (!piece) {
+                ++empty;
+                continue;
+            }
+            if (empty) fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += piece;
+        }
+        if (empty) fen += static_cast<char>('0' + empty);
+        if (rank > 0) fen += '/';
+    }
+
+    fen += sideToMove ? " b " : " w ";
+    if (castlingRights & PACKED_CASTLE_WHITE_KINGSIDE) fen += 'K';
+    if (castlingRights & PACKED_CASTLE_WHITE_QUEENSIDE) fen += 'Q';
+    if (castlingRights & PACKED_CASTLE_BLACK_KINGSIDE) fen += 'k';
+    if (castlingRights & PACKED_CASTLE_BLACK_QUEENSIDE) fen += 'q';
+    if (!(castlingRights & 0xF)) fen += '-';
+    fen += ' ';
+    if (enPassantSquare < 64) {
+        fen += static_cast<char>('a' + enPassantSquare % 8);
+        fen += static_cast<char>('1' + enPassantSquare / 8);
+    } else {
+        fen += '-';
+    }
+    fen += ' ' + std::to_string(halfMoveClock) + ' ' + std::to_string(fullMoveNumber);
+    return fen;
+}
+
+Board PackedPosition::toBoard() const {
+    Board board(8, 8);
+    board.initializeCustomSetup(toFen());
+    return board;
+}
+
+PackedPosition PackedPosition::fromFen(const std::string& fen) {
+    PackedPosition packed;
+    if (!parseFen(fen, packed)) {
+        throw std::invalid_argument("Bad FEN: " + fen);
+    }
+    return packed;
+}
+
+namespace {
+
+// Next space-separated field of 'text' starting at 'pos' (empty at the end)
+std::string_view nextField(std::string_view text, std::size_t& pos) {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t')) ++pos;
+    std::size_t start = pos;
+    while (pos < text.size() && text[pos] != ' ' && text[pos] != '\t' && text[pos] != '\r' && text[pos] != '\n') ++pos;
+    return text.substr(start, pos - start);
+}
+
+// Non-negative decimal field; false if it is not all digits
+bool parseNumber(std::string_view field, int& value) {
+    if (field.empty() || field.size() > 6) return false;
+    value = 0;
+    for (char ch : field) {
+        if (ch < '0' || ch > '9') return false;
+        value = value * 10 + (ch - '0');
+    }
+    return true;
+}
+
+} // namespace
+
+bool PackedPosition::parseFen(std::string_view fen, PackedPosition& out) {
+    // Piece letter -> code (color * 6 + PieceType), -1 for anything else
+    static const auto PIECE_CODES = [] {
+        std::array<std::int8_t, 128> codes;
+        codes.fill(-1);
+        const char* letters = "prnbqk"; // PieceType order
+        for (int type = 0; type < 6; ++type) {
+            codes[static_cast<unsigned char>(letters[type])] = static_cast<std::int8_t>(6 + type);
+            codes[static_cast<unsigned char>(std::toupper(letters[type]))] = static_cast<std::int8_t>(type);
+        }
+        return codes;
+    }();
+
+    PackedPosition packed;
+    std::memset(&packed, 0, sizeof(packed));
+
+    std::size_t pos = 0;
+    std::string_view placement = nextField(fen, pos);
+    std::string_view side = nextField(fen, pos);
+    std::string_view castling = nextField(fen, pos);
+    std::string_view enPassant = nextField(fen, pos);
+    if (placement.empty() || castling.empty() || enPassant.empty()) return false;
+
+    // Placement lists ranks 8..1, files a..h; collect codes by square first
+    std::int8_t codes[64];
+    std::memset(codes, -1, sizeof(codes));
+    int rank = 7;
+    int file = 0;
+    for (char ch : placement) {
+        if (ch == '/') {
+            if (file != 8 || rank == 0) return false;
+            --rank;
+            file = 0;
+        } else if (ch >= '1' && ch <= '8') {
+            file += ch - '0';
+            if (file > 8) return false;
+        } else {
+            int code = (static_cast<unsigned char>(ch) < 128) ? PIECE_CODES[static_cast<unsigned char>(ch)] : -1;
+            if (code < 0 || file >= 8) return false;
+            codes[rank * 8 + file] = static_cast<std::int8_t>(code);
+            ++file;
+        }
+    }
+    if (rank != 0 || file != 8) return false;
+
+    int n = 0;
+    for (int square = 0; square < 64; ++square) {
+        if (codes[square] < 0) continue;
+        if (n == 32) return false; // At most 32 pieces fit
+        packed.occupancy |= squareBB(square);
+        packed.pieces[n >> 1] |= static_cast<std::uint8_t>(codes[square] << ((n & 1) * 4));
+        ++n;
+    }
+
+    if (side != "w" && side != "b") return false;
+    packed.sideToMove = (side == "w") ? 0 : 1;
+
+    if (castling != "-") {
+        for (char ch : castling) {
+            switch (ch) {
+                case 'K': packed.castlingRights |= PACKED_CASTLE_WHITE_KINGSIDE; break;
+                case 'Q': packed.castlingRights |= PACKED_CASTLE_WHITE_QUEENSIDE; break;
+                case 'k': packed.castlingRights |= PACKED_CASTLE_BLACK_KINGSIDE; break;
+                case 'q': packed.castlingRights |= PACKED_CASTLE_BLACK_QUEENSIDE; break;
+                default: return false;
+            }
+        }
+    }
+
+    packed.enPassantSquare = PACKED_NO_SQUARE;
+    if (enPassant != "-") {
+        if (enPassant.size() != 2 || enPassant[0] < 'a' || enPassant[0] > 'h' || enPassant[1] < '1' || enPassant[1] > '8') {
+            return false;
+        }
+        packed.enPassantSquare = static_cast<std::uint8_t>((enPassant[1] - '1') * 8 + (enPassant[0] - 'a'));
+    }
+
+    // Optional clocks (absent in EPD, where operations follow instead)
+    int halfMoveClock = 0;
+    int fullMoveNumber = 1;
+    if (parseNumber(nextField(fen, pos), halfMoveClock)) {
+        if (!parseNumber(nextField(fen, pos), fullMoveNumber)) fullMoveNumber = 1;
+    } else {
+        halfMoveClock = 0;
+    }
+    packed.halfMoveClock = static_cast<std::uint8_t>(std::clamp(halfMoveClock, 0, 255));
+    packed.fullMoveNumber = static_cast<std::uint16_t>(std::clamp(fullMoveNumber, 1, 65535));
+    out = packed;
+    return true;
+}
+
+namespace {
+
+const PieceType PROMOTION_CODES[5] = {PieceType::EMPTY, PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN};
+
+} // namespace
+
+std::uint16_t PackedSample::encodeMove(const Move& move) {
+    int promotion = 0;
+    for (int i = 1; i < 5; ++i) {
+        if (PROMOTION_CODES[i] == move.promotionPiece) promotion = i;
+    }
+    return static_cast<std::uint16_t>(move.from.toSquareIndex() | (move.to.toSquareIndex() << 6) | (promotion << 12));
+}
+
+Move PackedSample::decodeMove(std::uint16_t code, const Board& board) {
+    Position from = Position::fromSquareIndex(code & 63);
+    Position to = Position::fromSquareIndex((code >> 6) & 63);
+    PieceType promotion = PROMOTION_CODES[std::min((code >> 12) & 7, 4)];
+
+    const Piece* piece = board.getPieceAt(from);
+    bool castling = piece && piece->getType() == PieceType::KING && std::abs(to.col - from.col) == 2;
+    bool enPassant = piece && piece->getType() == PieceType::PAWN && to.col != from.col && !board.getPieceAt(to);
+    return Move(from, to, promotion, castling, enPassant);
+}
@@ -0,0 +1,99 @@
+#ifndef PACKED_POSITION_H
+#define PACKED_POSITION_H
+
+#include "core/ChessTypes.h"
+#include "core/Bitboard.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+class Board;
+class Game;
+struct Move;
+
+// Castling right bits of PackedPosition::castlingRights
+constexpr std::uint8_t PACKED_CASTLE_WHITE_KINGSIDE = 1;
+constexpr std::uint8_t PACKED_CASTLE_WHITE_QUEENSIDE = 2;
+constexpr std::uint8_t PACKED_CASTLE_BLACK_KINGSIDE = 4;
+constexpr std::uint8_t PACKED_CASTLE_BLACK_QUEENSIDE = 8;
+
+// enPassantSquare value when there is no en passant target
+constexpr std::uint8_t PACKED_NO_SQUARE = 64;
+
+// A standard 8x8 position in 32 bytes, for evaluating and storing positions in bulk.
+// Pieces are stored as a 4-bit code (color * 6 + PieceType) per occupied square,
+// in square order (a1 = 0), so at most 32 pieces fit.
+struct PackedPosition {
+    std::uint64_t occupancy;       // Bit n set if square n holds a piece
+    std::uint8_t pieces[16];       // Piece codes, low nibble first
+    std::uint8_t sideToMove;       // 0 = White, 1 = Black
+    std::uint8_t castlingRights;   // PACKED_CASTLE_* bits
+    std::uint8_t enPassantSquare;  // Square index or PACKED_NO_SQUARE
+    std::uint8_t halfMoveClock;
+    std::uint16_t fullMoveNumber;
+    std::uint16_t reserved;        // Zero
+
+    // Throws std::invalid_argument for non-8x8 boards or more than 32 pieces
+    static PackedPosition fromBoard(const Board& board, Color sideToMove, int halfMoveClock = 0, int fullMoveNumber = 1);
+    static PackedPosition fromGame(const Game& game);
+    // Parses the first fields of a FEN or EPD record (placement, side to move,
+    // castling, en passant, and the clocks if present). Anything after them,
+    // such as EPD operations, is ignored. Throws std::invalid_argument.
+    static PackedPosition fromFen(const std::string& fen);
+    // Same parse without exceptions, for bulk loading: returns false (leaving
+    // 'out' untouched) if the record is malformed
+    static bool parseFen(std::string_view fen, PackedPosition& out);
+
+    // Piece code of the n-th occupied square (in square order)
+    int pieceCode(int n) const {
+        return (pieces[n >> 1] >> ((n & 1) * 4)) & 0xF;
+    }
+
+    // Expands the position into per-color, per-type bitboards ([Color][PieceType]).
+    // Returns false if the record holds an invalid piece code.
+    bool toBitboards(Bitboard out[2][6]) const;
+
+    Color getSideToMove() const { return sideToMove ? Color::BLACK : Color::WHITE; }
+
+    // Full FEN record, clocks included. Throws std::invalid_argument if the
+    // record holds an invalid piece code.
+    std::string toFen() const;
+    // Board set up from the record (castling rights and en passant target
+    // included; the side to move and clocks stay in the record)
+    Board toBoard() const;
+};
+
+static_assert(sizeof(PackedPosition) == 32, "PackedPosition must stay 32 bytes");
+
+// Game result codes of PackedSample::result
+constexpr std::uint8_t PACKED_RESULT_BLACK_WIN = 0;
+constexpr std::uint8_t PACKED_RESULT_DRAW = 1;
+constexpr std::uint8_t PACKED_RESULT_WHITE_WIN = 2;
+
+// result value of a position whose game result is not known
+constexpr std::uint8_t PACKED_RESULT_UNKNOWN = 255;
+
+// bestMove value when no move is stored
+constexpr std::uint16_t PACKED_NO_MOVE = 0;
+
+// Labelled training position, as written by `datagen`: the position, the
+// search score and best move, and the result of the game it was taken from.
+struct PackedSample {
+    PackedPosition position;
+    std::int16_t score;     // Centipawns from White's point of view
+    std::uint8_t result;    // PACKED_RESULT_*
+    std::uint8_t reserved;  // Zero
+    std::uint16_t bestMove; // encodeMove(), or PACKED_NO_MOVE
+    std::uint16_t reserved2;
+
+    // From square (bits 0-5), to square (6-11) and promotion piece (12-14:
+    // 0 = none, then knight, bishop, rook, queen); a1 = 0 as in PackedPosition
+    static std::uint16_t encodeMove(const Move& move);
+    // The castling and en passant flags are recovered from 'board', the
+    // position the move is played in
+    static Move decodeMove(std::uint16_t code, const Board& board);
+};
+
+static_assert(sizeof(PackedSample) == 40, "PackedSample must stay 40 bytes");
+
+#endif // PACKED_POSITION_H
@@ -0,0 +1,136 @@
+#include "core/PackedPositionFile.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+// Bytes per write; large enough that the write calls do not show up in a profile
+const std::size_t WRITE_CHUNK_BYTES = 1 << 20;
+
+bool isValidHeader(const PackedFileHeader& header) {
+    return std::memcmp(header.magic, PACKED_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+           header.version == PACKED_FILE_VERSION &&
+           (header.recordSize == sizeof(PackedPosition) || header.recordSize == sizeof(PackedSample));
+}
+
+} // namespace
+
+PackedPositionReader::PackedPositionReader(const std::string& path)
+    : file(path), records(nullptr), recordSize(0), recordCount(0) {
+    PackedFileHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::runtime_error("Not a packed position file: " + path);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (!isValidHeader(header)) {
+        throw std::runtime_error("Not a packed position file (bad header): " + path);
+    }
+    records = file.data() + sizeof(header);
+    recordSize = header.recordSize;
+    recordCount = (file.size() - sizeof(header)) / recordSize; // A torn last record is ignored
+    file.adviseSequential();
+}
+
+bool PackedPositionReader::isPackedFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    PackedFileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) return false;
+    return isValidHeader(header);
+}
+
+bool PackedPositionReader::hasTrailer() const {
+    return recordSize == sizeof(PackedSample);
+}
+
+std::size_t PackedPositionReader::size() const {
+    return recordCount;
+}
+
+const PackedPosition& PackedPositionReader::position(std::size_t index) const {
+    // The header keeps records 8-byte aligned in the page-aligned mapping
+    return *reinterpret_cast<const PackedPosition*>(records + index * recordSize);
+}
+
+PackedSample PackedPositionReader::sample(std::size_t index) const {
+    if (hasTrailer()) {
+        return *reinterpret_cast<const PackedSample*>(records + index * recordSize);
+    }
+    PackedSample sample{};
+    sample.position = position(index);
+    sample.result = PACKED_RESULT_UNKNOWN;
+    return sample;
+}
+
+void PackedPositionReader::forEachChunk(std::size_t recordsPerChunk,
+                                        const std::function<void(std::size_t first, std::size_t last)>& visit) const {
+    recordsPerChunk = std::max<std::size_t>(1, recordsPerChunk);
+    for (std::size_t first = 0; first < recordCount; first += recordsPerChunk) {
+        visit(first, std::min(recordCount, first + recordsPerChunk));
+    }
+}
+
+PackedPositionWriter::PackedPositionWriter(const std::string& path, bool withTrailer)
+    : out(path, std::ios::binary | std::ios::trunc), path(path), withTrailer(withTrailer),
+      recordSize(withTrailer ? sizeof(PackedSample) : sizeof(PackedPosition)), chunkUsed(0), count(0) {
+    if (!out) throw std::runtime_error("Cannot write packed position file " + path);
+
+    PackedFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, PACKED_FILE_MAGIC, sizeof(header.magic));
+    header.version = PACKED_FILE_VERSION;
+    header.recordSize = static_cast<std::uint32_t>(recordSize);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    chunk.resize(WRITE_CHUNK_BYTES / recordSize * recordSize);
+}
+
+PackedPositionWriter::~PackedPositionWriter() {
+    try {
+        close();
+    } catch (const std::exception&) {
+        // Destructors must not throw; call close() to see write errors
+    }
+}
+
+bool PackedPositionWriter::hasTrailer() const {
+    return withTrailer;
+}
+
+std::uint64_t PackedPositionWriter::getCount() const {
+    return count;
+}
+
+void PackedPositionWriter::write(const PackedPosition& position) {
+    if (!withTrailer) {
+        append(&position);
+        return;
+    }
+    PackedSample sample{};
+    sample.position = position;
+    sample.result = PACKED_RESULT_UNKNOWN;
+    append(&sample);
+}
+
+void PackedPositionWriter::write(const PackedSample& sample) {
+    append(withTrailer ? static_cast<const void*>(&sample) : static_cast<const void*>(&sample.position));
+}
+
+void PackedPositionWriter::append(const void* record) {
+    if (!out.is_open()) throw std::runtime_error("Packed position file is closed: " + path);
+    std::memcpy(chunk.data() + chunkUsed, record, recordSize);
+    chunkUsed += recordSize;
+    ++count;
+    if (chunkUsed == chunk.size()) flushChunk();
+}
+
+void PackedPositionWriter::flushChunk() {
+    out.write(reinterpret_cast<const char*>(chunk.data()), static_cast<std::streamsize>(chunkUsed));
+    chunkUsed = 0;
+}
+
+void PackedPositionWriter::close() {
+    if (!out.is_open()) return;
+    flushChunk();
+    out.close();
+    if (!out) throw std::runtime_error("Writing packed position file " + path + " failed");
+}
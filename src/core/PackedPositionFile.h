@@ -0,0 +1,96 @@
+#ifndef PACKED_POSITION_FILE_H
+#define PACKED_POSITION_FILE_H
+
+#include "core/PackedPosition.h"
+#include "util/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+// On-disk layout of a packed position file: a 32-byte header followed by
+// fixed-size records, either bare 32-byte PackedPositions or 40-byte
+// PackedSamples (position plus score/result/best-move trailer). Records are
+// stored exactly as in memory (little-endian), so a mapped file is used in
+// place without parsing. The record count follows from the file size, which
+// keeps appending cheap and leaves an interrupted file readable.
+struct PackedFileHeader {
+    char magic[8];            // PACKED_FILE_MAGIC
+    std::uint32_t version;    // PACKED_FILE_VERSION
+    std::uint32_t recordSize; // sizeof(PackedPosition) or sizeof(PackedSample)
+    std::uint64_t reserved[2];
+};
+
+static_assert(sizeof(PackedFileHeader) == 32, "PackedFileHeader must stay 32 bytes");
+
+constexpr char PACKED_FILE_MAGIC[8] = {'C', 'H', 'E', 'S', 'S', 'P', 'K', 'D'};
+constexpr std::uint32_t PACKED_FILE_VERSION = 1;
+
+// Memory-mapped reader. Records are returned by reference into the mapping;
+// forEachChunk walks the file in runs of records for streaming passes (the
+// mapping is advised for sequential access, so the OS reads ahead).
+class PackedPositionReader {
+public:
+    // Throws std::runtime_error if the file cannot be mapped or is not a packed position file
+    explicit PackedPositionReader(const std::string& path);
+
+    // True if 'path' exists and starts with a packed position file header
+    static bool isPackedFile(const std::string& path);
+
+    bool hasTrailer() const;
+    std::size_t size() const;
+
+    const PackedPosition& position(std::size_t index) const;
+    // Position plus trailer; without a trailer the score and best move are
+    // zero and the result is PACKED_RESULT_UNKNOWN
+    PackedSample sample(std::size_t index) const;
+
+    // Calls visit(first, last) for consecutive record ranges [first, last) of
+    // at most 'recordsPerChunk' records
+    void forEachChunk(std::size_t recordsPerChunk, const std::function<void(std::size_t first, std::size_t last)>& visit) const;
+
+private:
+    MappedFile file;
+    const std::uint8_t* records;
+    std::size_t recordSize;
+    std::size_t recordCount;
+};
+
+// Buffered writer: records are collected in a chunk that is written out when
+// full and on close().
+class PackedPositionWriter {
+public:
+    // Creates (truncates) 'path'. Throws std::runtime_error if it cannot be written.
+    PackedPositionWriter(const std::string& path, bool withTrailer);
+    ~PackedPositionWriter(); // Closes the file; errors are only reported by close()
+
+    PackedPositionWriter(const PackedPositionWriter&) = delete;
+    PackedPositionWriter& operator=(const PackedPositionWriter&) = delete;
+
+    bool hasTrailer() const;
+    std::uint64_t getCount() const;
+
+    // Without a trailer the sample's score, result and move are dropped; a bare
+    // position written to a file with trailers gets PACKED_RESULT_UNKNOWN
+    void write(const PackedPosition& position);
+    void write(const PackedSample& sample);
+
+    // Flushes the last chunk and closes the file. Throws std::runtime_error on an I/O error.
+    void close();
+
+private:
+    void append(const void* record);
+    void flushChunk();
+
+    std::ofstream out;
+    std::string path;
+    bool withTrailer;
+    std::size_t recordSize;
+    std::vector<std::uint8_t> chunk;
+    std::size_t chunkUsed;
+    std::uint64_t count;
+};
+
+#endif // PACKED_POSITION_FILE_H
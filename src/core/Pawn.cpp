@@ -66,43 +66,14 @@ std::vector<Move> Pawn::getPossibleMoves(const Board& board) const {
                     moves.emplace_back(currentPos, capturePos);
                 }
             }
-            // 4. En Passant (More complex, requires knowledge of the last move made in the game)
-            // This requires the Board or Game to provide info on the last move
-            // For now, we'll placeholder it. A full implementation would check:
-            // - If the opponent's last move was a two-square pawn advance
-            // - If that pawn landed adjacent to this pawn
-            // - If this pawn is on its 5th rank (for white) or 4th rank (for black)
-
-            Position enPassantTargetSquare(currentPos.row + direction, currentPos.col + offset);
+            // 4. En Passant: the board records the square skipped by the last
+            // double pawn push, which also covers positions set up from FEN
             Position opponentPawnSquare(currentPos.row, currentPos.col + offset);
-
-            const Move* lastMove = board.getLastMove(); // Board needs to store this
-            if (lastMove && lastMove->to == opponentPawnSquare) {
-                 const Piece* lastMovedPiece = board.getPieceAt(opponentPawnSquare);
-                 if (lastMovedPiece && lastMovedPiece->getType() == PieceType::PAWN &&
-                     lastMovedPiece->getColor() != color &&
-                     std::abs(lastMove->to.row - lastMove->from.row) == 2) { // Opponent pawn moved two squares
-                     // Check if current pawn is in the correct rank for en passant
-                     bool canEnPassant = false;
-                     if (color == Color::WHITE && currentPos.row == 3 && dims.rows == 8) { // White pawn on 5th rank (row 3 if 0-indexed from black side)
-                         canEnPassant = true;
-                     } else if (color == Color::BLACK && currentPos.row == 4 && dims.rows == 8) { // Black pawn on 4th rank (row 4)
-                         canEnPassant = true;
-                     }
-                     // Add more general rank checks if board size is variable.
-                     // For a standard 8x8 board where white starts on rank 2 (row 6) and black on rank 7 (row 1):
-                     // White pawn on rank 5 (row 3 for 0-indexed, 0 is black's back rank)
-                     // Black pawn on rank 4 (row 4 for 0-indexed)
-                     if ( (color == Color::WHITE && currentPos.row == (dims.rows / 2) - 1 ) ||
-                          (color == Color::BLACK && currentPos.row == (dims.rows / 2) ) ) {
-                        // This is a simplified check. Actual rank depends on board setup.
-                        // For standard 8x8 (0-7 rows): White on row 3, Black on row 4.
-                        if ( (color == Color::WHITE && currentPos.row == 3 && dims.rows == 8) ||
-                             (color == Color::BLACK && currentPos.row == 4 && dims.rows == 8) ) {
-                             moves.emplace_back(currentPos, enPassantTargetSquare, PieceType::EMPTY, false, true);
-                        }
-                     }
-                 }
+            if (capturePos == board.getEnPassantTargetSquare()) {
+                const Piece* opponentPawn = board.getPieceAt(opponentPawnSquare);
+                if (opponentPawn && opponentPawn->getType() == PieceType::PAWN && opponentPawn->getColor() != color) {
+                    moves.emplace_back(currentPos, capturePos, PieceType::EMPTY, false, true);
+                }
             }
         }
     }
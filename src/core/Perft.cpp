@@ -0,0 +1,202 @@
+#include "core/Perft.h"
+#include "core/Game.h" // For Game::generateLegalMoves
+#include "core/Zobrist.h"
+#include <sstream>
+#include <stdexcept>
+
+PerftStats& PerftStats::operator+=(const PerftStats& other) {
+    nodes += other.nodes;
+    captures += other.captures;
+    enPassants += other.enPassants;
+    castles += other.castles;
+    promotions += other.promotions;
+    checks += other.checks;
+    checkmates += other.checkmates;
+    return *this;
+}
+
+namespace {
+
+Color opposite(Color color) {
+    return (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+}
+
+// Move lists indexed by remaining depth; each level is cleared and refilled, so
+// a worker allocates only while its buffers grow to the widest node it has seen
+using MoveBuffers = std::vector<std::vector<Move>>;
+
+// Subtrees this shallow are cheaper to count than to hash and look up
+const int MIN_HASHED_DEPTH = 2;
+
+std::uint64_t countNodes(const Board& board, Color sideToMove, int depth, MoveBuffers& buffers,
+                         PerftTable* table, PerftHashStats& hashStats) {
+    std::uint64_t key = 0;
+    if (table && depth >= MIN_HASHED_DEPTH) {
+        key = zobristKey(board, sideToMove);
+        std::uint64_t cached;
+        ++hashStats.probes;
+        if (table->probe(key, depth, cached)) {
+            ++hashStats.hits;
+            return cached;
+        }
+    }
+
+    std::vector<Move>& moves = buffers[depth];
+    moves.clear();
+    Game::generateLegalMoves(board, sideToMove, moves);
+    if (depth == 1) return moves.size(); // Bulk counting
+
+    std::uint64_t nodes = 0;
+    for (const Move& move : moves) {
+        Board child = board;
+        child.applyMove(move);
+        nodes += countNodes(child, opposite(sideToMove), depth - 1, buffers, table, hashStats);
+    }
+
+    if (table && depth >= MIN_HASHED_DEPTH) {
+        table->store(key, depth, nodes);
+    }
+    return nodes;
+}
+
+// Counts the leaf 'move' played from 'board' into 'stats'
+void classifyLeaf(const Board& board, Color sideToMove, const Move& move, MoveBuffers& buffers, PerftStats& stats) {
+    ++stats.nodes;
+    if (move.isEnPassantCapture) {
+        ++stats.captures;
+        ++stats.enPassants;
+    } else if (board.getPieceAt(move.to)) {
+        ++stats.captures;
+    }
+    if (move.isCastling) ++stats.castles;
+    if (move.promotionPiece != PieceType::EMPTY) ++stats.promotions;
+
+    Board child = board;
+    child.applyMove(move);
+    Color opponent = opposite(sideToMove);
+    if (child.isSquareAttacked(child.findKing(opponent), sideToMove)) {
+        ++stats.checks;
+        std::vector<Move>& replies = buffers[0];
+        replies.clear();
+        Game::generateLegalMoves(child, opponent, replies);
+        if (replies.empty()) ++stats.checkmates;
+    }
+}
+
+void collectStats(const Board& board, Color sideToMove, int depth, MoveBuffers& buffers, PerftStats& stats) {
+    std::vector<Move>& moves = buffers[depth];
+    moves.clear();
+    Game::generateLegalMoves(board, sideToMove, moves);
+
+    for (const Move& move : moves) {
+        if (depth == 1) {
+            classifyLeaf(board, sideToMove, move, buffers, stats);
+        } else {
+            Board child = board;
+            child.applyMove(move);
+            collectStats(child, opposite(sideToMove), depth - 1, buffers, stats);
+        }
+    }
+}
+
+} // namespace
+
+Perft::Perft(int threads) : pool(threads) {}
+
+int Perft::getThreadCount() const {
+    return pool.size();
+}
+
+void Perft::setHashSize(std::size_t megabytes) {
+    if (megabytes == 0) {
+        table.reset();
+    } else if (table) {
+        table->resize(megabytes);
+    } else {
+        table = std::make_unique<PerftTable>(megabytes);
+    }
+}
+
+std::size_t Perft::getHashSizeBytes() const {
+    return table ? table->getSizeBytes() : 0;
+}
+
+PerftHashStats Perft::getHashStats() const {
+    return hashStats;
+}
+
+std::uint64_t Perft::run(const Board& board, Color sideToMove, int depth) {
+    std::uint64_t nodes = 0;
+    for (const auto& entry : divide(board, sideToMove, depth)) {
+        nodes += entry.second;
+    }
+    return depth <= 0 ? 1 : nodes;
+}
+
+PerftStats Perft::runDetailed(const Board& board, Color sideToMove, int depth) {
+    PerftStats total;
+    if (depth <= 0) {
+        total.nodes = 1;
+        return total;
+    }
+
+    std::vector<Move> rootMoves;
+    Game::generateLegalMoves(board, sideToMove, rootMoves);
+    std::vector<PerftStats> results(rootMoves.size());
+
+    pool.parallelFor(rootMoves.size(), [&](std::size_t i) {
+        MoveBuffers buffers(depth);
+        if (depth == 1) {
+            classifyLeaf(board, sideToMove, rootMoves[i], buffers, results[i]);
+        } else {
+            Board child = board;
+            child.applyMove(rootMoves[i]);
+            collectStats(child, opposite(sideToMove), depth - 1, buffers, results[i]);
+        }
+    });
+
+    for (const PerftStats& stats : results) {
+        total += stats;
+    }
+    return total;
+}
+
+std::vector<std::pair<Move, std::uint64_t>> Perft::divide(const Board& board, Color sideToMove, int depth) {
+    std::vector<std::pair<Move, std::uint64_t>> results;
+    hashStats = PerftHashStats();
+    if (depth <= 0) return results;
+
+    std::vector<Move> rootMoves;
+    Game::generateLegalMoves(board, sideToMove, rootMoves);
+    for (const Move& move : rootMoves) {
+        results.emplace_back(move, 1);
+    }
+    if (depth == 1) return results;
+
+    // Hash usage is counted per root move and summed afterwards, keeping the
+    // shared counters out of the inner loop
+    std::vector<PerftHashStats> rootHashStats(rootMoves.size());
+    PerftTable* sharedTable = (table && board.hasBitboards()) ? table.get() : nullptr;
+    pool.parallelFor(rootMoves.size(), [&](std::size_t i) {
+        MoveBuffers buffers(depth);
+        Board child = board;
+        child.applyMove(rootMoves[i]);
+        results[i].second = countNodes(child, opposite(sideToMove), depth - 1, buffers, sharedTable, rootHashStats[i]);
+    });
+
+    for (const PerftHashStats& stats : rootHashStats) {
+        hashStats.probes += stats.probes;
+        hashStats.hits += stats.hits;
+    }
+    return results;
+}
+
+Color Perft::sideToMoveFromFen(const std::string& fen) {
+    std::istringstream fields(fen);
+    std::string placement;
+    std::string side;
+    fields >> placement >> side;
+    if (side.empty() || side == "w") return Color::WHITE;
+    if (side == "b") return Color::BLACK;
+    throw std::invalid_argument("Bad FEN side to move: " + fen);
+}
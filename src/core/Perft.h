@@ -0,0 +1,75 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "core/Board.h"
+#include "core/ChessTypes.h"
+#include "core/Move.h"
+#include "core/PerftTable.h"
+#include "util/ThreadPool.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Leaf-node counters of a perft run. Only 'nodes' is filled by Perft::run;
+// Perft::runDetailed classifies the moves of the last ply as well.
+struct PerftStats {
+    std::uint64_t nodes = 0;
+    std::uint64_t captures = 0;
+    std::uint64_t enPassants = 0;
+    std::uint64_t castles = 0;
+    std::uint64_t promotions = 0;
+    std::uint64_t checks = 0;
+    std::uint64_t checkmates = 0;
+
+    PerftStats& operator+=(const PerftStats& other);
+};
+
+// Perft hash table usage of the last run() or divide()
+struct PerftHashStats {
+    std::uint64_t probes = 0;
+    std::uint64_t hits = 0;
+
+    double hitRate() const { return probes ? static_cast<double>(hits) / probes : 0.0; }
+};
+
+// Move generator verification: counts the leaf nodes of the legal move tree to
+// a fixed depth, so the totals can be compared with published reference values.
+// The root moves are split across a thread pool; each worker walks its subtree
+// with copy-make boards and per-ply move buffers that are reused between nodes.
+// An optional PerftTable lets deep runs skip subtrees that were already counted.
+class Perft {
+public:
+    explicit Perft(int threads = 0); // 0 = one per hardware thread
+
+    int getThreadCount() const;
+
+    // Caches subtree counts of run() and divide() in a table shared by the
+    // workers, so transpositions are counted once. 0 MB turns caching off
+    // (the default). runDetailed() never uses the table.
+    void setHashSize(std::size_t megabytes);
+    std::size_t getHashSizeBytes() const;
+    PerftHashStats getHashStats() const;
+
+    // Leaf count with bulk counting (the last ply is counted, not played)
+    std::uint64_t run(const Board& board, Color sideToMove, int depth);
+
+    // Plays out every leaf to classify it: captures, en passant, castles,
+    // promotions, checks and checkmates, as in the usual perft tables
+    PerftStats runDetailed(const Board& board, Color sideToMove, int depth);
+
+    // Leaf count below each root move, in move generation order
+    std::vector<std::pair<Move, std::uint64_t>> divide(const Board& board, Color sideToMove, int depth);
+
+    // Side to move of a FEN record ("w" when the field is missing).
+    // Throws std::invalid_argument on anything else.
+    static Color sideToMoveFromFen(const std::string& fen);
+
+private:
+    ThreadPool pool;
+    std::unique_ptr<PerftTable> table;
+    PerftHashStats hashStats;
+};
+
+#endif // PERFT_H
@@ -0,0 +1,74 @@
+#include "core/PerftTable.h"
+#include <stdexcept>
+
+PerftTable::PerftTable(std::size_t megabytes) : bucketMask(0) {
+    resize(megabytes);
+}
+
+void PerftTable::resize(std::size_t megabytes) {
+    std::size_t count = megabytes * 1024 * 1024 / sizeof(Bucket);
+    if (count == 0) {
+        throw std::invalid_argument("Perft hash table needs at least 1 MB.");
+    }
+    std::size_t powerOfTwo = 1;
+    while (powerOfTwo * 2 <= count) {
+        powerOfTwo *= 2;
+    }
+
+    buckets = std::vector<Bucket>(powerOfTwo);
+    bucketMask = powerOfTwo - 1;
+    clear();
+}
+
+void PerftTable::clear() {
+    for (Bucket& bucket : buckets) {
+        for (Entry& entry : bucket.entries) {
+            entry.check.store(0, std::memory_order_relaxed);
+            entry.data.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+std::size_t PerftTable::getSizeBytes() const {
+    return buckets.size() * sizeof(Bucket);
+}
+
+std::size_t PerftTable::getEntryCount() const {
+    return buckets.size() * BUCKET_ENTRIES;
+}
+
+bool PerftTable::probe(std::uint64_t key, int depth, std::uint64_t& nodes) const {
+    const Bucket& bucket = buckets[key & bucketMask];
+    for (const Entry& entry : bucket.entries) {
+        std::uint64_t data = entry.data.load(std::memory_order_relaxed);
+        std::uint64_t check = entry.check.load(std::memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key && static_cast<int>(data & 0xFF) == depth) {
+            nodes = data >> 8;
+            return true;
+        }
+    }
+    return false;
+}
+
+void PerftTable::store(std::uint64_t key, int depth, std::uint64_t nodes) {
+    Bucket& bucket = buckets[key & bucketMask];
+    std::uint64_t data = (nodes << 8) | static_cast<std::uint64_t>(depth & 0xFF);
+
+    // Prefer the slot already holding this key, then an empty or the shallowest one
+    Entry* replace = &bucket.entries[0];
+    int replaceDepth = 256;
+    for (Entry& entry : bucket.entries) {
+        std::uint64_t oldData = entry.data.load(std::memory_order_relaxed);
+        int oldDepth = static_cast<int>(oldData & 0xFF);
+        if (oldData == 0 || ((entry.check.load(std::memory_order_relaxed) ^ oldData) == key && oldDepth == depth)) {
+            replace = &entry;
+            break;
+        }
+        if (oldDepth < replaceDepth) {
+            replace = &entry;
+            replaceDepth = oldDepth;
+        }
+    }
+    replace->check.store(key ^ data, std::memory_order_relaxed);
+    replace->data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,49 @@
+#ifndef PERFT_TABLE_H
+#define PERFT_TABLE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Transposition table of perft subtree sizes, shared by all perft workers
+// without locks. Entries are keyed by Zobrist key and remaining depth.
+//
+// Each entry is two relaxed atomic words, 'data' (node count and depth) and
+// 'check' (key XOR data). A reader that sees halves of two different stores
+// gets a check that does not match its key and treats the entry as a miss,
+// so torn writes from concurrent stores can never produce a wrong count.
+class PerftTable {
+public:
+    explicit PerftTable(std::size_t megabytes);
+
+    PerftTable(const PerftTable&) = delete;
+    PerftTable& operator=(const PerftTable&) = delete;
+
+    // Reallocates (and clears) the table; the size is rounded down to a power of two
+    void resize(std::size_t megabytes);
+    void clear();
+
+    std::size_t getSizeBytes() const;
+    std::size_t getEntryCount() const;
+
+    bool probe(std::uint64_t key, int depth, std::uint64_t& nodes) const;
+    void store(std::uint64_t key, int depth, std::uint64_t nodes);
+
+private:
+    struct Entry {
+        std::atomic<std::uint64_t> check;
+        std::atomic<std::uint64_t> data; // nodes << 8 | depth; 0 = empty
+    };
+
+    // One cache line; the shallowest entry in a bucket is replaced first
+    static constexpr int BUCKET_ENTRIES = 4;
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_ENTRIES];
+    };
+
+    std::vector<Bucket> buckets;
+    std::size_t bucketMask;
+};
+
+#endif // PERFT_TABLE_H
@@ -0,0 +1,354 @@
+#include "core/Pgn.h"
+#include "core/Notation.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const char* STANDARD_START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const std::size_t PGN_LINE_WIDTH = 80;
+
+// Slices per thread in PgnFile::forEachGame, so that uneven slices balance out
+const std::size_t SLICES_PER_THREAD = 4;
+
+const char* const SEVEN_TAG_ROSTER[] = {"Event", "Site", "Date", "Round", "White", "Black", "Result"};
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// Characters that end a movetext token
+inline bool isDelimiter(char c) {
+    return isSpace(c) || c == '{' || c == '}' || c == '(' || c == ')' || c == ';' || c == '[' || c == ']' || c == '$';
+}
+
+inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+bool isResult(std::string_view token) {
+    return token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*";
+}
+
+Color sideToMoveOf(const std::string& fen) {
+    std::size_t space = fen.find(' ');
+    return (space != std::string::npos && space + 1 < fen.size() && fen[space + 1] == 'b') ? Color::BLACK : Color::WHITE;
+}
+
+Color opposite(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+// Start of the first game beginning at or after 'from': a tag line whose
+// previous non-blank line is not a tag line. Returns npos if there is none.
+std::size_t findGameStart(std::string_view text, std::size_t from) {
+    while (true) {
+        std::size_t newline = text.find("\n[", from);
+        if (newline == std::string_view::npos) return newline;
+        std::size_t back = newline;
+        while (back > 0 && isSpace(text[back - 1])) --back;
+        std::size_t lineStart = back;
+        while (lineStart > 0 && text[lineStart - 1] != '\n') --lineStart;
+        while (lineStart < back && isSpace(text[lineStart])) ++lineStart;
+        if (back == 0 || text[lineStart] != '[') return newline + 1;
+        from = newline + 1; // Another tag of the same header
+    }
+}
+
+std::string escapeTagValue(const std::string& value) {
+    std::string escaped;
+    for (char c : value) {
+        if (c == '\\' || c == '"') escaped += '\\';
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string resultOf(GameState state) {
+    switch (state) {
+        case GameState::CHECKMATE_WHITE_WINS: return "1-0";
+        case GameState::CHECKMATE_BLACK_WINS: return "0-1";
+        case GameState::PLAYING:
+        case GameState::CHECK: return "*";
+        default: return "1/2-1/2";
+    }
+}
+
+} // namespace
+
+std::string_view PgnGame::tag(std::string_view name) const {
+    for (const auto& entry : tags) {
+        if (entry.first == name) return entry.second;
+    }
+    return std::string_view();
+}
+
+void PgnGame::clear() {
+    tags.clear();
+    moves.clear();
+    result = std::string_view();
+}
+
+PgnReader::PgnReader(std::string_view text) : begin(text.data()), cursor(text.data()), end(text.data() + text.size()) {}
+
+std::size_t PgnReader::getOffset() const {
+    return static_cast<std::size_t>(cursor - begin);
+}
+
+bool PgnReader::next(PgnGame& game) {
+    game.clear();
+    bool started = false;  // Anything of this game read yet
+    bool inMoves = false;  // Movetext reached: a tag line now starts the next game
+    int variationDepth = 0;
+
+    auto skipLine = [&]() {
+        while (cursor < end && *cursor != '\n') ++cursor;
+    };
+
+    while (cursor < end) {
+        char c = *cursor;
+        if (isSpace(c)) {
+            ++cursor;
+            continue;
+        }
+        if (c == '%' && (cursor == begin || cursor[-1] == '\n')) { // Escape line
+            skipLine();
+            continue;
+        }
+
+        if (c == '[' && variationDepth == 0) {
+            if (inMoves) break; // A game without a result token
+            // [Name "value"]
+            started = true;
+            ++cursor;
+            while (cursor < end && isSpace(*cursor)) ++cursor;
+            const char* nameStart = cursor;
+            while (cursor < end && !isSpace(*cursor) && *cursor != '"' && *cursor != ']') ++cursor;
+            std::string_view name(nameStart, static_cast<std::size_t>(cursor - nameStart));
+            while (cursor < end && isSpace(*cursor) && *cursor != '\n') ++cursor;
+            std::string_view value;
+            if (cursor < end && *cursor == '"') {
+                const char* valueStart = ++cursor;
+                while (cursor < end && *cursor != '"' && *cursor != '\n') {
+                    if (*cursor == '\\' && cursor + 1 < end) ++cursor;
+                    ++cursor;
+                }
+                value = std::string_view(valueStart, static_cast<std::size_t>(cursor - valueStart));
+            }
+            while (cursor < end && *cursor != ']' && *cursor != '\n') ++cursor;
+            if (cursor < end && *cursor == ']') ++cursor;
+            if (!name.empty()) game.tags.emplace_back(name, value);
+            continue;
+        }
+
+        started = true;
+        switch (c) {
+            case '{': {
+                const char* close = std::find(cursor, end, '}');
+                cursor = (close == end) ? end : close + 1;
+                continue;
+            }
+            case ';':
+                skipLine();
+                continue;
+            case '(':
+                ++variationDepth;
+                ++cursor;
+                continue;
+            case ')':
+                if (variationDepth > 0) --variationDepth;
+                ++cursor;
+                continue;
+            case '$': // Numeric annotation glyph
+                ++cursor;
+                while (cursor < end && isDigit(*cursor)) ++cursor;
+                continue;
+            case ']':
+            case '}':
+                ++cursor; // Stray bracket
+                continue;
+            default:
+                break;
+        }
+
+        const char* tokenStart = cursor;
+        while (cursor < end && !isDelimiter(*cursor)) ++cursor;
+        std::string_view token(tokenStart, static_cast<std::size_t>(cursor - tokenStart));
+        if (variationDepth > 0) continue;
+        inMoves = true;
+        if (isResult(token)) {
+            game.result = token;
+            return true;
+        }
+
+        // Move numbers: "12.", "12...", "12.e4" and "...e5"
+        std::size_t digits = 0;
+        while (digits < token.size() && isDigit(token[digits])) ++digits;
+        if (digits == token.size()) continue;
+        if (token[digits] == '.') {
+            while (digits < token.size() && token[digits] == '.') ++digits;
+            token.remove_prefix(digits);
+        }
+        if (!token.empty()) game.moves.push_back(token);
+    }
+    return started;
+}
+
+std::vector<std::string_view> splitPgnText(std::string_view text, std::size_t parts) {
+    std::vector<std::string_view> slices;
+    parts = std::max<std::size_t>(1, parts);
+    std::size_t start = 0;
+    for (std::size_t k = 1; k < parts; ++k) {
+        std::size_t cut = findGameStart(text, std::max(start, text.size() / parts * k));
+        if (cut == std::string_view::npos) break;
+        if (cut <= start) continue;
+        slices.push_back(text.substr(start, cut - start));
+        start = cut;
+    }
+    if (start < text.size() || slices.empty()) slices.push_back(text.substr(start));
+    return slices;
+}
+
+PgnFile::PgnFile(const std::string& path) : file(path) {
+    file.adviseSequential();
+}
+
+std::string_view PgnFile::text() const {
+    return std::string_view(reinterpret_cast<const char*>(file.data()), file.size());
+}
+
+std::size_t PgnFile::forEachGame(int threads, const std::function<void(const PgnGame& game, std::size_t slice)>& visit) const {
+    ThreadPool pool(threads);
+    std::size_t parts = pool.size() > 1 ? static_cast<std::size_t>(pool.size()) * SLICES_PER_THREAD : 1;
+    std::vector<std::string_view> slices = splitPgnText(text(), parts);
+    pool.parallelFor(slices.size(), [&](std::size_t slice) {
+        PgnReader reader(slices[slice]);
+        PgnGame game;
+        while (reader.next(game)) {
+            visit(game, slice);
+        }
+    });
+    return slices.size();
+}
+
+std::string pgnStartFen(const PgnGame& game) {
+    std::string_view fen = game.tag("FEN");
+    return fen.empty() ? std::string(STANDARD_START_FEN) : std::string(fen);
+}
+
+std::size_t replayPgnGame(const PgnGame& game, const std::function<bool(const Board& board, Color side, const Move& move)>& visit,
+                          std::string* error) {
+    std::string fen = pgnStartFen(game);
+    Board board(8, 8);
+    board.initializeCustomSetup(fen);
+    Color side = sideToMoveOf(fen);
+
+    std::size_t played = 0;
+    for (std::string_view san : game.moves) {
+        Move move{Position(), Position()};
+        if (!parseSan(board, side, san, move)) {
+            if (error) *error = "Illegal move " + std::string(san) + " at ply " + std::to_string(played + 1);
+            return played;
+        }
+        if (!visit(board, side, move)) return played;
+        board.applyMove(move);
+        side = opposite(side);
+        ++played;
+    }
+    return played;
+}
+
+PgnWriter::PgnWriter(std::ostream& out) : out(out), count(0) {}
+
+std::uint64_t PgnWriter::getCount() const {
+    return count;
+}
+
+void PgnWriter::write(const Game& game, const std::vector<PgnTag>& tags, const std::string& result) {
+    std::string startFen = game.getStartFen();
+    BoardDimensions dimensions = game.getBoard().getDimensions();
+    Board board(dimensions.rows, dimensions.cols);
+    board.initializeCustomSetup(startFen);
+    Color side = sideToMoveOf(startFen);
+
+    std::vector<std::string> sanMoves;
+    sanMoves.reserve(game.getMoveHistory().size());
+    for (const Move& move : game.getMoveHistory()) {
+        sanMoves.push_back(moveToSan(board, side, move));
+        board.applyMove(move);
+        side = opposite(side);
+    }
+    write(tags, startFen, sanMoves, result.empty() ? resultOf(game.getGameState()) : result);
+}
+
+void PgnWriter::write(const std::vector<PgnTag>& tags, const std::string& startFen, const std::vector<std::string>& sanMoves,
+                      const std::string& result, const std::string& comment) {
+    auto findTag = [&](const std::string& name) -> const PgnTag* {
+        for (const PgnTag& tag : tags) {
+            if (tag.name == name) return &tag;
+        }
+        return nullptr;
+    };
+
+    std::ostringstream pgn;
+    for (const char* name : SEVEN_TAG_ROSTER) {
+        std::string value;
+        if (std::string(name) == "Result") {
+            value = result;
+        } else if (const PgnTag* tag = findTag(name)) {
+            value = tag->value;
+        } else {
+            value = std::string(name) == "Date" ? "????.??.??" : "?";
+        }
+        pgn << "[" << name << " \"" << escapeTagValue(value) << "\"]\n";
+    }
+    for (const PgnTag& tag : tags) {
+        bool roster = std::find_if(std::begin(SEVEN_TAG_ROSTER), std::end(SEVEN_TAG_ROSTER),
+                                   [&](const char* name) { return tag.name == name; }) != std::end(SEVEN_TAG_ROSTER);
+        if (roster || tag.name == "SetUp" || tag.name == "FEN") continue;
+        pgn << "[" << tag.name << " \"" << escapeTagValue(tag.value) << "\"]\n";
+    }
+    if (startFen != STANDARD_START_FEN) {
+        pgn << "[SetUp \"1\"]\n"
+            << "[FEN \"" << startFen << "\"]\n";
+    }
+    pgn << "\n";
+
+    // Move numbers follow the starting FEN
+    std::istringstream fields(startFen);
+    std::string placement, side, castling, enPassant;
+    int halfMoves = 0;
+    int moveNumber = 1;
+    fields >> placement >> side >> castling >> enPassant >> halfMoves >> moveNumber;
+    bool whiteToMove = side != "b";
+
+    std::string text;
+    std::size_t lineLength = 0;
+    auto append = [&](const std::string& token) {
+        if (lineLength > 0 && lineLength + 1 + token.size() > PGN_LINE_WIDTH) {
+            text += "\n";
+            lineLength = 0;
+        } else if (lineLength > 0) {
+            text += " ";
+            ++lineLength;
+        }
+        text += token;
+        lineLength += token.size();
+    };
+    for (std::size_t i = 0; i < sanMoves.size(); ++i) {
+        if (whiteToMove) append(std::to_string(moveNumber) + ".");
+        else if (i == 0) append(std::to_string(moveNumber) + "...");
+        append(sanMoves[i]);
+        if (!whiteToMove) ++moveNumber;
+        whiteToMove = !whiteToMove;
+    }
+    if (!comment.empty()) append("{" + comment + "}");
+    append(result);
+    pgn << text << "\n\n";
+    out << pgn.str();
+    ++count;
+}
@@ -0,0 +1,111 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include "core/Board.h"
+#include "core/Game.h"
+#include "core/Move.h"
+#include "util/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// One game of a PGN text. Everything is a view into the text (nothing is
+// copied), so a PgnGame is only valid while the text is. Tag values keep their
+// backslash escapes. Comments, NAGs, move numbers and variations are dropped;
+// 'moves' is the main line in SAN.
+struct PgnGame {
+    std::vector<std::pair<std::string_view, std::string_view>> tags;
+    std::vector<std::string_view> moves;
+    std::string_view result; // "1-0", "0-1", "1/2-1/2", "*" or empty if missing
+
+    // Value of the first tag called 'name', or an empty view
+    std::string_view tag(std::string_view name) const;
+    void clear();
+};
+
+// Streaming tokenizer over a PGN text: next() fills in one game at a time and
+// keeps the vectors' capacity, so a loop over a large file allocates only
+// while the vectors are still growing.
+class PgnReader {
+public:
+    explicit PgnReader(std::string_view text);
+
+    // Reads the next game. Returns false at the end of the text.
+    bool next(PgnGame& game);
+
+    // Bytes consumed so far
+    std::size_t getOffset() const;
+
+private:
+    const char* begin;
+    const char* cursor;
+    const char* end;
+};
+
+// Splits a PGN text into at most 'parts' consecutive slices that each start
+// at a game (the first tag line after a game's moves), for parsing in
+// parallel. Slices are about equal in size; fewer are returned for small texts.
+std::vector<std::string_view> splitPgnText(std::string_view text, std::size_t parts);
+
+// A memory-mapped PGN file
+class PgnFile {
+public:
+    // Throws std::runtime_error if the file cannot be mapped
+    explicit PgnFile(const std::string& path);
+
+    std::string_view text() const;
+
+    // Calls visit(game, slice) for every game, reading the file in slices on
+    // 'threads' cores (0 = all). Games of one slice arrive in file order on one
+    // thread; different slices run concurrently, so 'visit' must be thread-safe
+    // or keep per-slice state. Returns the number of slices used.
+    std::size_t forEachGame(int threads, const std::function<void(const PgnGame& game, std::size_t slice)>& visit) const;
+
+private:
+    MappedFile file;
+};
+
+// Starting FEN of 'game': its FEN tag, or the standard start position
+std::string pgnStartFen(const PgnGame& game);
+
+// Replays the main line of 'game' on an 8x8 board. visit(board, sideToMove,
+// move) is called before each move is played and may return false to stop.
+// Returns the number of moves played; if a move is not legal SAN the replay
+// stops there and 'error' (if given) describes it. Throws std::invalid_argument
+// on a bad FEN tag.
+std::size_t replayPgnGame(const PgnGame& game, const std::function<bool(const Board& board, Color side, const Move& move)>& visit,
+                          std::string* error = nullptr);
+
+// PGN tag pair for PgnWriter
+struct PgnTag {
+    std::string name;
+    std::string value;
+};
+
+// Writes games as PGN export format: the seven tag roster first (missing
+// tags as "?"), then any other tags, SetUp/FEN when the game did not begin at
+// the standard position, and the movetext wrapped at 80 columns.
+class PgnWriter {
+public:
+    explicit PgnWriter(std::ostream& out);
+
+    // The game's move history in SAN. An empty 'result' is taken from the game state ("*" while playing).
+    void write(const Game& game, const std::vector<PgnTag>& tags = {}, const std::string& result = "");
+    // Moves already in SAN, e.g. collected while the game was played. 'comment'
+    // (if any) is placed before the result, as in "{White mates}".
+    void write(const std::vector<PgnTag>& tags, const std::string& startFen, const std::vector<std::string>& sanMoves,
+               const std::string& result, const std::string& comment = "");
+
+    std::uint64_t getCount() const;
+
+private:
+    std::ostream& out;
+    std::uint64_t count;
+};
+
+#endif // PGN_H
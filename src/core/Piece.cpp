@@ -1,7 +1,7 @@
 #include "core/Piece.h"
 #include "core/Board.h" // Required for getPossibleMoves (though not used directly in base impl)
 
-int Piece::nextId = 0;
+std::atomic<int> Piece::nextId{0};
 
 Piece::Piece(Color c, Position pos, PieceType t, float val)
     : color(c), position(pos), type(t), value(val), hasMoved(false), pieceId(nextId++) {}
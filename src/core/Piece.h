@@ -7,6 +7,7 @@
 #include <vector>
 #include <string>
 #include <memory> // For std::unique_ptr in derived classes if needed for specific data
+#include <atomic>
 
 // Forward declaration
 class Board;
@@ -20,7 +21,7 @@ protected:
     bool hasMoved;
     int pieceId; // Unique ID for the piece instance, can be useful
 
-    static int nextId; // For generating unique piece IDs
+    static std::atomic<int> nextId; // For generating unique piece IDs (pieces are created on worker threads too)
 
 public:
     Piece(Color c, Position pos, PieceType t, float val);
@@ -17,6 +17,12 @@ struct Position {
     std::string toAlgebraic() const;
     // Helper to create Position from algebraic notation
     static Position fromAlgebraic(const std::string& algNot);
+
+    // Square index on a standard 8x8 board: a1 = 0, b1 = 1, ..., h8 = 63.
+    // Row 0 is rank 8, so the row has to be flipped. Used by bitboard- and
+    // table-based code (NNUE features, attack maps, hashing).
+    int toSquareIndex() const { return (7 - row) * 8 + col; }
+    static Position fromSquareIndex(int square) { return Position(7 - square / 8, square % 8); }
 };
 
 // For using Position as a key in std::map or std::unordered_map if needed later
@@ -0,0 +1,82 @@
+#include "core/Zobrist.h"
+#include "core/Board.h"
+#include "core/PackedPosition.h" // For the PACKED_CASTLE_* bits
+#include <stdexcept>
+
+namespace {
+
+// SplitMix64: small, fast and well distributed; plenty for hash keys
+std::uint64_t splitMix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+ZobristKeys generateKeys() {
+    ZobristKeys keys;
+    std::uint64_t state = 0x5A0B1257C4E55EEDULL;
+    for (auto& color : keys.pieces) {
+        for (auto& type : color) {
+            for (std::uint64_t& key : type) {
+                key = splitMix64(state);
+            }
+        }
+    }
+    // Castling keys are per right; combinations are the XOR of their rights
+    std::uint64_t rightKeys[4];
+    for (std::uint64_t& key : rightKeys) {
+        key = splitMix64(state);
+    }
+    for (int rights = 0; rights < 16; ++rights) {
+        keys.castling[rights] = 0;
+        for (int bit = 0; bit < 4; ++bit) {
+            if (rights & (1 << bit)) keys.castling[rights] ^= rightKeys[bit];
+        }
+    }
+    for (std::uint64_t& key : keys.enPassantFile) {
+        key = splitMix64(state);
+    }
+    keys.blackToMove = splitMix64(state);
+    return keys;
+}
+
+} // namespace
+
+const ZobristKeys& zobristKeys() {
+    static const ZobristKeys keys = generateKeys();
+    return keys;
+}
+
+std::uint64_t zobristKey(const Board& board, Color sideToMove) {
+    if (!board.hasBitboards()) {
+        throw std::invalid_argument("Zobrist keys are defined for 8x8 boards only.");
+    }
+    const ZobristKeys& keys = zobristKeys();
+
+    std::uint64_t key = 0;
+    for (int color = 0; color < 2; ++color) {
+        for (int type = 0; type < 6; ++type) {
+            Bitboard pieces = board.getPieces(static_cast<Color>(color), static_cast<PieceType>(type));
+            while (pieces) {
+                key ^= keys.pieces[color][type][popLsb(pieces)];
+            }
+        }
+    }
+
+    int rights = 0;
+    if (board.canCastleKingside(Color::WHITE)) rights |= PACKED_CASTLE_WHITE_KINGSIDE;
+    if (board.canCastleQueenside(Color::WHITE)) rights |= PACKED_CASTLE_WHITE_QUEENSIDE;
+    if (board.canCastleKingside(Color::BLACK)) rights |= PACKED_CASTLE_BLACK_KINGSIDE;
+    if (board.canCastleQueenside(Color::BLACK)) rights |= PACKED_CASTLE_BLACK_QUEENSIDE;
+    key ^= keys.castling[rights];
+
+    Position enPassant = board.getEnPassantTargetSquare();
+    if (enPassant.isValid(8, 8)) {
+        key ^= keys.enPassantFile[enPassant.col];
+    }
+    if (sideToMove == Color::BLACK) {
+        key ^= keys.blackToMove;
+    }
+    return key;
+}
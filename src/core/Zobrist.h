@@ -0,0 +1,26 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "core/ChessTypes.h"
+#include <cstdint>
+
+class Board;
+
+// Random keys for Zobrist hashing of standard 8x8 positions. A position's key is
+// the XOR of the keys of its pieces, castling rights, en passant file and side
+// to move, so a move can update it by XOR-ing the changed features in and out.
+// The keys come from a fixed seed and are identical in every run.
+struct ZobristKeys {
+    std::uint64_t pieces[2][6][64]; // [Color][PieceType][square index]
+    std::uint64_t castling[16];     // By PACKED_CASTLE_* bit combination
+    std::uint64_t enPassantFile[8];
+    std::uint64_t blackToMove;
+};
+
+const ZobristKeys& zobristKeys();
+
+// Key of the position on 'board' with 'sideToMove' to play.
+// Throws std::invalid_argument for boards other than 8x8.
+std::uint64_t zobristKey(const Board& board, Color sideToMove);
+
+#endif // ZOBRIST_H
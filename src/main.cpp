@@ -3,7 +3,10 @@
 #include "player/AIPlayer.h"
 #include "ai/EvaluationEngine.h"
 #include "ui/TextDisplay.h"
+#include "ui/CommandLine.h"
 #include <iostream>
+#include <fstream>
+#include <stdexcept>
 #include <string>
 #include <limits> // For numeric_limits
 
@@ -36,7 +39,12 @@ int getAIDepthChoice(const std::string& playerNumber) {
 }
 
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Subcommands (bench, perft, analyze, selfplay) run without prompts
+    if (argc > 1) {
+        return runCommandLine(argc, argv);
+    }
+
     std::cout << "Welcome to C++ Chess!" << std::endl;
 
     PlayerType p1Type = getPlayerTypeChoice("1 (White)");
@@ -62,7 +70,21 @@ int main() {
 
     EvaluationEngine engineA;
     EvaluationEngine engineB;
+
+    // Tuned weights from the `tune` tool replace the built-in defaults
+    if (std::ifstream(DEFAULT_WEIGHTS_FILE)) {
+        try {
+            engineA.loadWeights(DEFAULT_WEIGHTS_FILE);
+            engineB.loadWeights(DEFAULT_WEIGHTS_FILE);
+            std::cout << "Loaded evaluation weights from " << DEFAULT_WEIGHTS_FILE << std::endl;
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Ignoring " << DEFAULT_WEIGHTS_FILE << ": " << e.what() << std::endl;
+        }
+    }
     TextDisplay display;
+    // The AI's score and expected line from the previous turn; shown under the board,
+    // since the screen is cleared before each turn.
+    const AIPlayer* lastAI = nullptr;
 
     chessGame.start(); // Initialize game state and board
 
@@ -75,6 +97,7 @@ int main() {
         }
         display.displayBoard(chessGame.getBoard(), lastMovePtr);
         display.displayGameStatus(chessGame, true, engineToUse);
+        if (lastAI) display.displayEvaluation(lastAI->getLastResult());
 
         const Player* currentPlayer = chessGame.getCurrentPlayer();
         if (!currentPlayer) {
@@ -85,6 +108,7 @@ int main() {
         std::cout << currentPlayer->getName() << "'s turn." << std::endl;
         
         Move move = currentPlayer->getMove(chessGame, &engineToUse);
+        lastAI = dynamic_cast<const AIPlayer*>(currentPlayer);
 
         if (!move.from.isValid()) { // Indicates an issue or no move (e.g. AI couldn't find one)
             std::cout << "Player could not make a move. Game might be stuck or ended." << std::endl;
@@ -105,6 +129,7 @@ int main() {
     }
     display.displayBoard(chessGame.getBoard(), lastMovePtr);
     display.displayGameStatus(chessGame, true, engineA);
+    if (lastAI) display.displayEvaluation(lastAI->getLastResult());
     std::cout << "Game Over!" << std::endl;
 
     return 0;
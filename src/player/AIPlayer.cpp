@@ -16,10 +16,17 @@ Move AIPlayer::getMove(const Game& game, const EvaluationEngine* engine) const {
     std::cout << getName() << " (" << (playerColor == Color::WHITE ? "White" : "Black")
               << ") is thinking with depth " << searchDepth << "..." << std::endl;
 
+    // Our last move and the opponent's reply are the two newest history entries; if they
+    // match the head of our last principal variation, the rest of it is searched first.
+    std::vector<Move> expectedLine;
+    const auto& history = game.getMoveHistory();
+    if (history.size() >= 2) {
+        expectedLine = continueLine(lastResult.principalVariation, history[history.size() - 2], history.back());
+    }
+
     // The EvaluationEngine should operate on a const Game or a copy.
-    // The Game class's requestAIMove can be a helper, or engine can be called directly.
-    return engine->findBestMove(game, searchDepth);
-    // Or: return game.requestAIMove(*engine, searchDepth); if Game has that method
+    lastResult = engine->searchBestMove(game, searchDepth, expectedLine);
+    return lastResult.bestMove;
 }
 
 void AIPlayer::setSearchDepth(int depth) {
@@ -28,4 +35,8 @@ void AIPlayer::setSearchDepth(int depth) {
 
 int AIPlayer::getSearchDepth() const {
     return searchDepth;
+}
+
+const EvaluationResult& AIPlayer::getLastResult() const {
+    return lastResult;
 }
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define AI_PLAYER_H
 
 #include "player/Player.h"
+#include "ai/EvaluationEngine.h" // For EvaluationResult
 
 // Forward declare EvaluationEngine as AIPlayer uses it.
 class EvaluationEngine;
@@ -10,6 +11,9 @@ class Game; // Also need Game for context
 class AIPlayer : public Player {
 private:
     int searchDepth; // Configurable search depth for this AI instance
+    // Result of this player's last search. Its principal variation seeds the next
+    // search when the opponent replied as expected (see continueLine).
+    mutable EvaluationResult lastResult;
 
 public:
     AIPlayer(Color color, std::string name = "AI", int depth = 3); // Default depth
@@ -18,6 +22,7 @@ public:
 
     void setSearchDepth(int depth);
     int getSearchDepth() const;
+    const EvaluationResult& getLastResult() const;
 };
 
 #endif // AI_PLAYER_H
\ No newline at end of file
@@ -0,0 +1,115 @@
+// Throughput benchmark for EvaluationEngine::evaluateBatch.
+//
+// Usage: batch_eval_bench [positions] [threads]
+//
+// Samples positions from random games, replicates them up to the requested
+// batch size, and reports positions per second for the scalar staticEvaluate
+// loop and for the batch path (single-threaded and with 'threads' workers).
+
+#include "core/Game.h"
+#include "core/PackedPosition.h"
+#include "ai/EvaluationEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const int SAMPLE_POSITIONS = 4096;
+const int MAX_GAME_PLIES = 160;
+
+struct Sample {
+    std::vector<Board> boards;
+    std::vector<PackedPosition> packed;
+};
+
+// Random legal playouts from the starting position
+Sample samplePositions(int count, unsigned seed) {
+    Sample sample;
+    std::mt19937 rng(seed);
+
+    while (static_cast<int>(sample.packed.size()) < count) {
+        Game game(PlayerType::HUMAN, PlayerType::HUMAN);
+        for (int ply = 0; ply < MAX_GAME_PLIES && static_cast<int>(sample.packed.size()) < count; ++ply) {
+            std::vector<Move> moves = game.getLegalMoves();
+            if (moves.empty()) break;
+            std::uniform_int_distribution<std::size_t> pick(0, moves.size() - 1);
+            if (!game.makeMove(moves[pick(rng)])) break;
+            sample.boards.push_back(game.getBoard());
+            sample.packed.push_back(PackedPosition::fromGame(game));
+        }
+    }
+    return sample;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const std::string& label, std::size_t positions, double seconds) {
+    std::cout << "  " << label << ": " << static_cast<long long>(positions / seconds) << " positions/s ("
+              << seconds << " s)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::size_t batchSize = 1000000;
+    int threads = 0;
+    try {
+        if (argc > 1) batchSize = std::stoul(argv[1]);
+        if (argc > 2) threads = std::stoi(argv[2]);
+    } catch (const std::exception&) {
+        std::cerr << "Usage: " << argv[0] << " [positions] [threads]" << std::endl;
+        return 1;
+    }
+    if (threads <= 0) threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    EvaluationEngine engine;
+    Sample sample = samplePositions(SAMPLE_POSITIONS, 12345);
+
+    std::vector<PackedPosition> batch(batchSize);
+    for (std::size_t i = 0; i < batchSize; ++i) {
+        batch[i] = sample.packed[i % sample.packed.size()];
+    }
+    std::vector<std::int16_t> scores(batchSize);
+
+    std::cout << "Batch evaluation benchmark (" << batchEvalSimdName() << ", "
+              << batchSize << " positions)" << std::endl;
+
+    // Scalar reference, also used to check that both paths agree
+    std::vector<float> reference(sample.boards.size());
+    std::size_t scalarCount = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (scalarCount < batchSize / 10 || secondsSince(start) < 0.5) {
+        for (std::size_t i = 0; i < sample.boards.size(); ++i) {
+            reference[i] = engine.staticEvaluate(sample.boards[i], Color::WHITE);
+        }
+        scalarCount += sample.boards.size();
+    }
+    report("staticEvaluate", scalarCount, secondsSince(start));
+
+    start = std::chrono::steady_clock::now();
+    engine.evaluateBatch(batch.data(), batch.size(), scores.data(), 1);
+    report("evaluateBatch, 1 thread", batchSize, secondsSince(start));
+
+    if (threads > 1) {
+        start = std::chrono::steady_clock::now();
+        engine.evaluateBatch(batch.data(), batch.size(), scores.data(), threads);
+        report("evaluateBatch, " + std::to_string(threads) + " threads", batchSize, secondsSince(start));
+    }
+
+    int mismatches = 0;
+    for (std::size_t i = 0; i < std::min(batchSize, sample.boards.size()); ++i) {
+        if (std::abs(std::lround(reference[i] * 100.0f) - scores[i]) > 1) ++mismatches;
+    }
+    std::cout << "  Mismatches against staticEvaluate (> 1 cp): " << mismatches << std::endl;
+    return mismatches == 0 ? 0 : 2;
+}
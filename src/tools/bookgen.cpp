@@ -0,0 +1,378 @@
+// Opening book builder: turns PGN collections into a Polyglot book.
+//
+// Usage: bookgen <PGN...> [--out FILE] [--threads N] [--max-ply N] [--min-games N]
+//                [--min-score PCT] [--memory-mb MB] [--tmp PREFIX]
+//
+// Games are replayed on every core (PgnFile::forEachGame). For each of the
+// first --max-ply moves of a decided or drawn game, the (Polyglot key, move)
+// pair is counted as a win, draw or loss for the side that played it. The
+// counts live in sharded hash maps, each shard with its own lock. When the maps
+// hold more than --memory-mb worth of entries, they are drained, sorted and
+// written to a temporary run file (PREFIX.runN, next to the output by
+// default), so memory stays bounded however many positions the input has. At
+// the end the runs are merged, counts of the same (key, move) are added up,
+// and moves played fewer than --min-games times or scoring below --min-score
+// percent are dropped. The rest are written sorted by key as 16-byte Polyglot
+// entries with weight 2 * wins + draws, scaled per position to fit 16 bits,
+// so the book can be memory-mapped and probed by OpeningBook.
+
+#include "core/Board.h"
+#include "core/Pgn.h"
+#include "ai/OpeningBook.h"
+#include "util/MappedFile.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const int DEFAULT_MAX_PLY = 30;
+const int DEFAULT_MIN_GAMES = 3;
+const int DEFAULT_MEMORY_MB = 1024;
+
+// Power of two, so the shard is a few bits of the (random) Polyglot key
+const std::size_t SHARD_COUNT = 256;
+
+// Rough cost of one map entry (node, key, counts, bucket), for --memory-mb
+const std::size_t BYTES_PER_ENTRY = 64;
+
+const std::size_t WRITE_BUFFER_SIZE = 1 << 20;
+
+struct MoveCounts {
+    std::uint32_t wins = 0;
+    std::uint32_t draws = 0;
+    std::uint32_t losses = 0;
+};
+
+// One (key, move) with its counts, as stored in the sorted run files
+struct RunRecord {
+    std::uint64_t key;
+    std::uint16_t move;
+    std::uint16_t reserved;
+    std::uint32_t wins;
+    std::uint32_t draws;
+    std::uint32_t losses;
+
+    bool operator<(const RunRecord& other) const {
+        return key != other.key ? key < other.key : move < other.move;
+    }
+};
+static_assert(sizeof(RunRecord) == 24, "RunRecord is written to disk as is");
+
+struct EntryKey {
+    std::uint64_t key;
+    std::uint16_t move;
+
+    bool operator==(const EntryKey& other) const { return key == other.key && move == other.move; }
+};
+
+struct EntryKeyHash {
+    std::size_t operator()(const EntryKey& entry) const {
+        return static_cast<std::size_t>(entry.key ^ (entry.move * 0x9E3779B97F4A7C15ULL));
+    }
+};
+
+// Result of a game for White: 1 win, 0 draw, -1 loss; false for "*" or a missing result
+bool whiteOutcome(std::string_view result, int& outcome) {
+    if (result == "1-0") outcome = 1;
+    else if (result == "0-1") outcome = -1;
+    else if (result == "1/2-1/2") outcome = 0;
+    else return false;
+    return true;
+}
+
+// The (key, move) counts of all games read so far, minus what was spilled to
+// run files. add() takes the spill lock shared and one shard lock; spill()
+// takes the spill lock exclusively, so it sees every shard at rest.
+class BookAggregator {
+public:
+    BookAggregator(std::size_t maxEntries, std::string runPrefix) : maxEntries(maxEntries), runPrefix(std::move(runPrefix)) {}
+
+    ~BookAggregator() {
+        for (const std::string& path : runPaths) std::remove(path.c_str());
+    }
+
+    // Counts one game's moves; 'outcomes' are from the mover's side
+    void add(const std::vector<EntryKey>& moves, const std::vector<int>& outcomes) {
+        {
+            std::shared_lock<std::shared_mutex> spillGuard(spillMutex);
+            for (std::size_t i = 0; i < moves.size(); ++i) {
+                Shard& shard = shards[moves[i].key & (SHARD_COUNT - 1)];
+                std::lock_guard<std::mutex> lock(shard.mutex);
+                auto inserted = shard.counts.try_emplace(moves[i]);
+                if (inserted.second) entryCount.fetch_add(1, std::memory_order_relaxed);
+                MoveCounts& counts = inserted.first->second;
+                if (outcomes[i] > 0) ++counts.wins;
+                else if (outcomes[i] == 0) ++counts.draws;
+                else ++counts.losses;
+            }
+        }
+        if (entryCount.load(std::memory_order_relaxed) >= maxEntries) spill();
+    }
+
+    // Writes the current counts as a sorted run file and empties the maps
+    void spill() {
+        std::unique_lock<std::shared_mutex> spillGuard(spillMutex);
+        if (entryCount.load() < maxEntries) return; // Another thread spilled first
+        std::vector<RunRecord> records = drain();
+        std::string path = runPrefix + ".run" + std::to_string(runPaths.size());
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(RunRecord)));
+        if (!out) throw std::runtime_error("Could not write run file " + path);
+        runPaths.push_back(path);
+        std::cout << "Spilled " << records.size() << " entries to " << path << std::endl;
+    }
+
+    // Everything in memory as sorted records, leaving the maps empty
+    std::vector<RunRecord> drain() {
+        std::vector<RunRecord> records;
+        records.reserve(entryCount.load());
+        for (Shard& shard : shards) {
+            for (const auto& entry : shard.counts) {
+                records.push_back({entry.first.key, entry.first.move, 0, entry.second.wins, entry.second.draws, entry.second.losses});
+            }
+            std::unordered_map<EntryKey, MoveCounts, EntryKeyHash>().swap(shard.counts); // Give the memory back
+        }
+        entryCount = 0;
+        std::sort(records.begin(), records.end());
+        return records;
+    }
+
+    const std::vector<std::string>& getRunPaths() const { return runPaths; }
+
+private:
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<EntryKey, MoveCounts, EntryKeyHash> counts;
+    };
+
+    std::array<Shard, SHARD_COUNT> shards;
+    std::shared_mutex spillMutex;
+    std::atomic<std::size_t> entryCount{0};
+    const std::size_t maxEntries;
+    const std::string runPrefix;
+    std::vector<std::string> runPaths;
+};
+
+// Polyglot entries written big-endian through a large buffer
+class BookWriter {
+public:
+    explicit BookWriter(const std::string& path) : out(path, std::ios::binary | std::ios::trunc), path(path) {
+        if (!out) throw std::runtime_error("Could not open " + path + " for writing");
+        buffer.reserve(WRITE_BUFFER_SIZE);
+    }
+
+    void write(std::uint64_t key, std::uint16_t move, std::uint16_t weight) {
+        putBigEndian(key, 8);
+        putBigEndian(move, 2);
+        putBigEndian(weight, 2);
+        putBigEndian(0, 4); // Learn field, unused
+        ++count;
+        if (buffer.size() >= WRITE_BUFFER_SIZE) flush();
+    }
+
+    void close() {
+        flush();
+        out.close();
+        if (!out) throw std::runtime_error("Could not write " + path);
+    }
+
+    std::uint64_t getCount() const { return count; }
+
+private:
+    void putBigEndian(std::uint64_t value, int bytes) {
+        for (int i = bytes - 1; i >= 0; --i) {
+            buffer.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+        }
+    }
+
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    std::ofstream out;
+    std::string path;
+    std::vector<char> buffer;
+    std::uint64_t count = 0;
+};
+
+struct PruneOptions {
+    std::uint32_t minGames = DEFAULT_MIN_GAMES;
+    double minScore = 0.0; // Fraction of the points, 0 to 1
+};
+
+// Writes the moves of one position that survive pruning
+void writePosition(BookWriter& writer, std::vector<RunRecord>& moves, const PruneOptions& prune) {
+    std::vector<std::pair<std::uint16_t, std::uint64_t>> kept; // Move, 2 * wins + draws
+    std::uint64_t maxPoints = 0;
+    for (const RunRecord& record : moves) {
+        std::uint64_t games = std::uint64_t{record.wins} + record.draws + record.losses;
+        std::uint64_t points = 2 * std::uint64_t{record.wins} + record.draws;
+        if (games < prune.minGames || points < prune.minScore * 2.0 * static_cast<double>(games) || points == 0) continue;
+        kept.emplace_back(record.move, points);
+        maxPoints = std::max(maxPoints, points);
+    }
+    // Scale so the best move fits in 16 bits, keeping every kept move at least 1
+    std::uint64_t divisor = maxPoints / 0xFFFF + 1;
+    std::sort(kept.begin(), kept.end(), [](const auto& a, const auto& b) { return a.second > b.second; });
+    for (const auto& entry : kept) {
+        writer.write(moves.front().key, entry.first, static_cast<std::uint16_t>(std::max<std::uint64_t>(1, entry.second / divisor)));
+    }
+    moves.clear();
+}
+
+// K-way merge of the sorted runs: adds up the counts of each (key, move) and
+// writes the book one position at a time
+void mergeRuns(const std::vector<std::pair<const RunRecord*, const RunRecord*>>& runs, BookWriter& writer, const PruneOptions& prune,
+               std::uint64_t& distinctMoves) {
+    using Cursor = std::pair<const RunRecord*, const RunRecord*>; // Next record, end of run
+    auto later = [](const Cursor& a, const Cursor& b) { return *b.first < *a.first; };
+    std::priority_queue<Cursor, std::vector<Cursor>, decltype(later)> heap(later);
+    for (const Cursor& run : runs) {
+        if (run.first != run.second) heap.push(run);
+    }
+
+    std::vector<RunRecord> position; // Merged moves of the current key
+    while (!heap.empty()) {
+        Cursor cursor = heap.top();
+        heap.pop();
+        const RunRecord& record = *cursor.first;
+        if (!position.empty() && position.front().key != record.key) writePosition(writer, position, prune);
+        if (!position.empty() && position.back().move == record.move) {
+            position.back().wins += record.wins;
+            position.back().draws += record.draws;
+            position.back().losses += record.losses;
+        } else {
+            position.push_back(record);
+            ++distinctMoves;
+        }
+        if (++cursor.first != cursor.second) heap.push(cursor);
+    }
+    if (!position.empty()) writePosition(writer, position, prune);
+}
+
+void printUsage() {
+    std::cerr << "Usage: bookgen <PGN...> [--out FILE] [--threads N] [--max-ply N] [--min-games N]\n"
+              << "               [--min-score PCT] [--memory-mb MB] [--tmp PREFIX]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string outPath = "book.bin";
+    std::string runPrefix;
+    int threads = 0;
+    int maxPly = DEFAULT_MAX_PLY;
+    int memoryMegabytes = DEFAULT_MEMORY_MB;
+    PruneOptions prune;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--out") outPath = value();
+            else if (arg == "--threads") threads = std::stoi(value());
+            else if (arg == "--max-ply") maxPly = std::stoi(value());
+            else if (arg == "--min-games") prune.minGames = static_cast<std::uint32_t>(std::stoul(value()));
+            else if (arg == "--min-score") prune.minScore = std::stod(value()) / 100.0;
+            else if (arg == "--memory-mb") memoryMegabytes = std::stoi(value());
+            else if (arg == "--tmp") runPrefix = value();
+            else if (arg.rfind("--", 0) == 0) throw std::invalid_argument("Unknown option " + arg);
+            else inputs.push_back(arg);
+        }
+        if (inputs.empty()) throw std::invalid_argument("No PGN files given");
+        if (maxPly <= 0) throw std::invalid_argument("--max-ply must be positive");
+        if (memoryMegabytes <= 0) throw std::invalid_argument("--memory-mb must be positive");
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+    if (runPrefix.empty()) runPrefix = outPath;
+
+    auto start = std::chrono::steady_clock::now();
+    std::size_t maxEntries = std::max<std::size_t>(1, static_cast<std::size_t>(memoryMegabytes) * 1024 * 1024 / BYTES_PER_ENTRY);
+    BookAggregator aggregator(maxEntries, runPrefix);
+    std::atomic<std::uint64_t> games{0};
+    std::atomic<std::uint64_t> positions{0};
+    std::atomic<std::uint64_t> skipped{0}; // No result, or a move that does not replay
+
+    try {
+        for (const std::string& input : inputs) {
+            PgnFile file(input);
+            file.forEachGame(threads, [&](const PgnGame& game, std::size_t) {
+                int outcome = 0;
+                if (!whiteOutcome(game.result, outcome)) {
+                    ++skipped;
+                    return;
+                }
+                std::vector<EntryKey> moves;
+                std::vector<int> outcomes;
+                std::string error;
+                try {
+                    replayPgnGame(game, [&](const Board& board, Color side, const Move& move) {
+                        if (static_cast<int>(moves.size()) >= maxPly) return false;
+                        moves.push_back({polyglotKey(board, side), polyglotMove(move)});
+                        outcomes.push_back(side == Color::WHITE ? outcome : -outcome);
+                        return true;
+                    }, &error);
+                } catch (const std::invalid_argument&) {
+                    ++skipped; // Bad FEN tag
+                    return;
+                }
+                // The moves before an illegal one are still good
+                if (!error.empty()) ++skipped;
+                aggregator.add(moves, outcomes);
+                ++games;
+                positions += moves.size();
+            });
+            std::cout << input << ": " << games.load() << " games, " << positions.load() << " positions so far" << std::endl;
+        }
+
+        // Merge the runs with what is still in memory
+        std::vector<RunRecord> inMemory = aggregator.drain();
+        std::vector<MappedFile> runFiles;
+        std::vector<std::pair<const RunRecord*, const RunRecord*>> runs;
+        for (const std::string& path : aggregator.getRunPaths()) {
+            runFiles.emplace_back(path);
+            runFiles.back().adviseSequential();
+            const RunRecord* records = reinterpret_cast<const RunRecord*>(runFiles.back().data());
+            runs.emplace_back(records, records + runFiles.back().size() / sizeof(RunRecord));
+        }
+        runs.emplace_back(inMemory.data(), inMemory.data() + inMemory.size());
+
+        BookWriter writer(outPath);
+        std::uint64_t distinctMoves = 0;
+        mergeRuns(runs, writer, prune, distinctMoves);
+        writer.close();
+
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Games: " << games.load() << " (" << skipped.load() << " skipped or cut short), positions: " << positions.load()
+                  << ", runs: " << aggregator.getRunPaths().size() << "\n"
+                  << "Distinct moves: " << distinctMoves << ", kept: " << writer.getCount() << "\n"
+                  << "Wrote " << writer.getCount() * 16 << " bytes to " << outPath << " in " << seconds << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,370 @@
+// Microbenchmarks of the core hot paths.
+//
+// Usage: chess_bench [--out FILE] [--baseline FILE] [--threshold PCT] [--min-time MS] [--filter TEXT]
+//
+// Times Board copy and move, Game::clone, getLegalMoves, isSquareAttacked,
+// staticEvaluate, orderMoves and hashGameState over a fixed set of positions
+// and prints a JSON report with nanoseconds and heap allocations per operation
+// (one operation = one call on one position; the fastest of three timed runs
+// is reported). --out also writes the report to FILE; --baseline compares with
+// a report saved earlier and exits with status 1 if any benchmark got slower
+// by more than --threshold percent (default 10).
+
+#include "core/Game.h"
+#include "ai/EvaluationEngine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <new>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Every heap allocation in the process goes through these, so the benchmarks
+// can report allocations per operation. The whole set is replaced (plain,
+// array, aligned and nothrow new, with their sized and aligned deletes) so
+// that over-aligned buffers such as the NNUE accumulators are counted too;
+// aligned blocks come from std::aligned_alloc, and both kinds go back with
+// std::free.
+namespace {
+
+std::atomic<std::uint64_t> allocationCount{0};
+
+void* countedAllocate(std::size_t size, std::size_t alignment) noexcept {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    // aligned_alloc wants a size that is a multiple of the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+void* countedAllocateOrThrow(std::size_t size, std::size_t alignment) {
+    if (void* p = countedAllocate(size, alignment)) return p;
+    throw std::bad_alloc();
+}
+
+// Kept out of line so that the compiler does not pair the free() with the
+// allocation it inlined and warn about mismatched new/delete
+[[gnu::noinline]] void countedRelease(void* p) noexcept {
+    std::free(p);
+}
+
+} // namespace
+
+void* operator new(std::size_t size) { return countedAllocateOrThrow(size, 0); }
+void* operator new[](std::size_t size) { return countedAllocateOrThrow(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* p) noexcept { countedRelease(p); }
+void operator delete[](void* p) noexcept { countedRelease(p); }
+void operator delete(void* p, std::size_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::size_t) noexcept { countedRelease(p); }
+void operator delete(void* p, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { countedRelease(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { countedRelease(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { countedRelease(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedRelease(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { countedRelease(p); }
+
+namespace {
+
+// Fixed inputs: changing them invalidates saved baselines
+const std::vector<std::string> BENCH_FENS = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+};
+
+struct BenchOptions {
+    std::string outputPath;
+    std::string baselinePath;
+    double thresholdPercent = 10.0;
+    int minTimeMs = 200; // Per repetition
+    std::string filter;
+};
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp = 0.0;
+    double allocsPerOp = 0.0;
+    std::uint64_t operations = 0;
+};
+
+// Keeps results alive so the optimiser cannot drop the measured work
+volatile std::uint64_t benchSink = 0;
+
+// Each benchmark is timed this many times and the fastest run is reported,
+// which filters out most of the noise from other processes
+const int REPETITIONS = 3;
+
+// Runs 'pass' (which performs 'opsPerPass' operations) until 'minTimeMs' has
+// elapsed, REPETITIONS times
+BenchResult measure(const std::string& name, std::size_t opsPerPass, int minTimeMs, const std::function<void()>& pass) {
+    pass(); // Warm-up (first-touch allocations, lazily built tables)
+
+    using Clock = std::chrono::steady_clock;
+    BenchResult result;
+    result.name = name;
+    for (int repetition = 0; repetition < REPETITIONS; ++repetition) {
+        std::uint64_t passes = 0;
+        std::uint64_t allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+        auto start = Clock::now();
+        auto minTime = std::chrono::milliseconds(minTimeMs);
+        do {
+            pass();
+            ++passes;
+        } while (Clock::now() - start < minTime);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        std::uint64_t allocations = allocationCount.load(std::memory_order_relaxed) - allocationsBefore;
+
+        std::uint64_t operations = passes * opsPerPass;
+        double nsPerOp = seconds * 1e9 / static_cast<double>(operations);
+        if (repetition == 0 || nsPerOp < result.nsPerOp) {
+            result.nsPerOp = nsPerOp;
+            result.operations = operations;
+            result.allocsPerOp = static_cast<double>(allocations) / static_cast<double>(operations);
+        }
+    }
+    return result;
+}
+
+std::vector<BenchResult> runBenchmarks(const BenchOptions& options) {
+    std::vector<Game> games;
+    for (const std::string& fen : BENCH_FENS) {
+        games.emplace_back(PlayerType::AI, PlayerType::AI);
+        games.back().loadFen(fen);
+    }
+    std::vector<std::vector<Move>> legalMoves;
+    for (const Game& game : games) {
+        legalMoves.push_back(game.getLegalMoves());
+    }
+    EvaluationEngine engine;
+    const std::size_t positions = games.size();
+
+    std::vector<std::pair<std::string, std::function<BenchResult()>>> benchmarks = {
+        {"board_copy", [&] {
+            return measure("board_copy", positions, options.minTimeMs, [&] {
+                for (const Game& game : games) {
+                    Board copy = game.getBoard();
+                    benchSink = benchSink + copy.getOccupied();
+                }
+            });
+        }},
+        {"board_move", [&] {
+            // One operation = move-construct plus move-assign back
+            std::vector<Board> boards;
+            for (const Game& game : games) boards.push_back(game.getBoard());
+            return measure("board_move", positions, options.minTimeMs, [&] {
+                for (Board& board : boards) {
+                    Board moved(std::move(board));
+                    board = std::move(moved);
+                }
+            });
+        }},
+        {"game_clone", [&] {
+            return measure("game_clone", positions, options.minTimeMs, [&] {
+                for (const Game& game : games) {
+                    Game copy = game.clone();
+                    benchSink = benchSink + static_cast<std::uint64_t>(copy.getHalfMoveClock());
+                }
+            });
+        }},
+        {"get_legal_moves", [&] {
+            return measure("get_legal_moves", positions, options.minTimeMs, [&] {
+                for (const Game& game : games) {
+                    benchSink = benchSink + game.getLegalMoves().size();
+                }
+            });
+        }},
+        {"is_square_attacked", [&] {
+            // One operation = one square tested for one attacker color
+            return measure("is_square_attacked", positions * 128, options.minTimeMs, [&] {
+                std::uint64_t attacked = 0;
+                for (const Game& game : games) {
+                    const Board& board = game.getBoard();
+                    for (int r = 0; r < 8; ++r) {
+                        for (int c = 0; c < 8; ++c) {
+                            attacked += board.isSquareAttacked(Position(r, c), Color::WHITE);
+                            attacked += board.isSquareAttacked(Position(r, c), Color::BLACK);
+                        }
+                    }
+                }
+                benchSink = benchSink + attacked;
+            });
+        }},
+        {"static_evaluate", [&] {
+            return measure("static_evaluate", positions, options.minTimeMs, [&] {
+                float total = 0.0f;
+                for (const Game& game : games) {
+                    total += engine.staticEvaluate(game.getBoard(), Color::WHITE);
+                }
+                benchSink = benchSink + static_cast<std::uint64_t>(total != 0.0f);
+            });
+        }},
+        {"order_moves", [&] {
+            return measure("order_moves", positions, options.minTimeMs, [&] {
+                for (std::size_t i = 0; i < positions; ++i) {
+                    benchSink = benchSink + engine.orderMoves(legalMoves[i], games[i].getBoard()).size();
+                }
+            });
+        }},
+        {"hash_game_state", [&] {
+            std::vector<Game> hashed;
+            for (const Game& game : games) hashed.push_back(game.clone());
+            return measure("hash_game_state", positions, options.minTimeMs, [&] {
+                for (Game& game : hashed) {
+                    game.hashGameState();
+                    benchSink = benchSink + game.getGameStateHash();
+                }
+            });
+        }},
+    };
+
+    std::vector<BenchResult> results;
+    for (const auto& benchmark : benchmarks) {
+        if (!options.filter.empty() && benchmark.first.find(options.filter) == std::string::npos) continue;
+        results.push_back(benchmark.second());
+        const BenchResult& r = results.back();
+        std::cerr << std::left << std::setw(20) << r.name << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(12) << r.nsPerOp << " ns/op" << std::setw(10) << std::setprecision(2) << r.allocsPerOp
+                  << " allocs/op" << std::endl;
+    }
+    return results;
+}
+
+// One benchmark per line, so baselines can be read back without a JSON library
+std::string toJson(const std::vector<BenchResult>& results) {
+    std::ostringstream json;
+    json << std::setprecision(6);
+    json << "{\n  \"positions\": " << BENCH_FENS.size() << ",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        json << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.nsPerOp
+             << ", \"allocs_per_op\": " << r.allocsPerOp << ", \"operations\": " << r.operations << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n}\n";
+    return json.str();
+}
+
+// name -> ns/op from a report written by toJson
+std::map<std::string, double> readBaseline(const std::string& path) {
+    std::ifstream in(path);
+    if (!in) {
+        throw std::runtime_error("Could not open baseline " + path);
+    }
+    static const std::regex ENTRY("\"name\":\\s*\"([^\"]+)\".*\"ns_per_op\":\\s*([0-9.eE+-]+)");
+    std::map<std::string, double> baseline;
+    std::string line;
+    std::smatch match;
+    while (std::getline(in, line)) {
+        if (std::regex_search(line, match, ENTRY)) {
+            baseline[match[1]] = std::stod(match[2]);
+        }
+    }
+    if (baseline.empty()) {
+        throw std::runtime_error("No benchmarks found in baseline " + path);
+    }
+    return baseline;
+}
+
+// Prints the comparison and returns the number of regressions
+int compareWithBaseline(const std::vector<BenchResult>& results, const std::map<std::string, double>& baseline,
+                        double thresholdPercent) {
+    int regressions = 0;
+    std::cerr << std::defaultfloat << "\nAgainst baseline (threshold " << thresholdPercent << "%):" << std::endl;
+    for (const BenchResult& r : results) {
+        auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second <= 0.0) {
+            std::cerr << "  " << std::left << std::setw(20) << r.name << std::right << "  (not in baseline)" << std::endl;
+            continue;
+        }
+        double change = (r.nsPerOp / it->second - 1.0) * 100.0;
+        bool regressed = change > thresholdPercent;
+        if (regressed) ++regressions;
+        std::cerr << "  " << std::left << std::setw(20) << r.name << std::right << std::showpos << std::fixed
+                  << std::setprecision(1) << std::setw(8) << change << "%" << std::noshowpos
+                  << (regressed ? "  REGRESSION" : "") << std::endl;
+    }
+    return regressions;
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) options.outputPath = argv[++i];
+        else if (arg == "--baseline" && hasValue) options.baselinePath = argv[++i];
+        else if (arg == "--threshold" && hasValue) options.thresholdPercent = std::stod(argv[++i]);
+        else if (arg == "--min-time" && hasValue) options.minTimeMs = std::stoi(argv[++i]);
+        else if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else return false;
+    }
+    return options.minTimeMs > 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--out FILE] [--baseline FILE] [--threshold PCT] [--min-time MS] [--filter TEXT]" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Invalid numeric option." << std::endl;
+        return 1;
+    }
+
+    try {
+        // Read the baseline first so a bad path fails before the long run
+        std::map<std::string, double> baseline;
+        if (!options.baselinePath.empty()) baseline = readBaseline(options.baselinePath);
+
+        std::vector<BenchResult> results = runBenchmarks(options);
+        std::string json = toJson(results);
+        std::cout << json;
+        if (!options.outputPath.empty()) {
+            std::ofstream out(options.outputPath);
+            if (!(out << json)) throw std::runtime_error("Could not write " + options.outputPath);
+        }
+
+        if (!baseline.empty()) {
+            int regressions = compareWithBaseline(results, baseline, options.thresholdPercent);
+            if (regressions > 0) {
+                std::cerr << regressions << " benchmark(s) regressed." << std::endl;
+                return 1;
+            }
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,42 @@
+// UCI engine: connects the search to chess GUIs and match runners.
+//
+// Usage: chess_uci [--weights FILE] [--nnue FILE] [--book FILE] [--syzygy PATHS] [--tables DIR]
+//
+// Speaks the Universal Chess Interface on stdin/stdout (see src/ui/UciProtocol.h).
+// --weights and --nnue choose the evaluation as for the ChessGame subcommands.
+// --book loads a Polyglot opening book and turns OwnBook on; the GUI can also
+// set it with the BookFile option. --syzygy loads endgame tablebases from the
+// given directories, like the SyzygyPath option, and --tables the tables
+// built by tbgen, like EndgameTablePath.
+
+#include "ui/UciProtocol.h"
+#include "ai/EvaluationEngine.h"
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char* argv[]) {
+    EvaluationEngine engine;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--weights") engine.loadWeights(value());
+            else if (arg == "--nnue") engine.loadNetwork(value());
+            else if (arg == "--book") engine.loadBook(value());
+            else if (arg == "--syzygy") engine.loadTablebases(value());
+            else if (arg == "--tables") engine.loadEndgameTables(value());
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n"
+                  << "Usage: chess_uci [--weights FILE] [--nnue FILE] [--book FILE] [--syzygy PATHS] [--tables DIR]" << std::endl;
+        return 1;
+    }
+
+    UciProtocol protocol(std::cin, std::cout, engine);
+    return protocol.run();
+}
@@ -0,0 +1,411 @@
+// Self-play training data generator.
+//
+// Usage: datagen [--positions N] [--out FILE] [--threads N] [--nodes N] [--random-plies N]
+//                [--max-plies N] [--seed N] [--dedupe-mb MB] [--weights FILE] [--nnue FILE]
+//
+// Every worker thread plays games against itself from a random opening
+// (--random-plies uniformly random moves from the start position), searching a
+// fixed number of nodes per move (--nodes, 1000 by default); the search score
+// is the label. --nodes 0 instead plays each move by a one-ply look-ahead of
+// the static evaluation on a bare Board: about 50 times faster, but the labels
+// are only that evaluation. Quiet positions are kept: not in check, and
+// the best move neither a capture nor a promotion; positions with a mate score
+// are left out too. When a game ends each kept position is labelled with the
+// result. Games cut short (the ply limit, or in the one-ply mode a first
+// repetition or the 50-move rule) are adjudicated by the last score: a win for
+// a side at least ADJUDICATION_PAWNS ahead, and otherwise dropped, so they
+// never pass for draws. Each labelled position, unless its Zobrist key was seen before, is handed to a bounded
+// lock-free queue. One writer thread drains the queue into FILE, a packed
+// position file of 40-byte PackedSample records (position, score in centipawns
+// from White's side, best move, result; see core/PackedPositionFile.h), until
+// --positions records have been written.
+
+#include "core/Game.h"
+#include "core/Board.h"
+#include "core/PackedPosition.h"
+#include "core/PackedPositionFile.h"
+#include "core/Zobrist.h"
+#include "ai/EvaluationEngine.h"
+#include "util/BoundedQueue.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const int DEFAULT_NODES = 1000;
+const int DEFAULT_RANDOM_PLIES = 8;
+const int DEFAULT_MAX_PLIES = 400;
+const int DEFAULT_DEDUPE_MB = 64;
+
+// Lead in pawns that wins a game cut short; closer games are dropped
+const float ADJUDICATION_PAWNS = 3.0f;
+
+// Records between the workers and the writer; producers wait while it is full
+const std::size_t QUEUE_CAPACITY = 1 << 16;
+
+// Zobrist keys seen so far, in a fixed-size open-addressing table of atomics.
+// insert() claims an empty slot with one compare-and-swap; when every slot of
+// the probe window is taken the key is let through, so memory stays bounded at
+// the cost of a few late duplicates.
+class KeyFilter {
+public:
+    explicit KeyFilter(std::size_t megabytes) : slots(std::max<std::size_t>(1, megabytes * 1024 * 1024 / sizeof(std::uint64_t))) {}
+
+    // True if 'key' was not seen before
+    bool insert(std::uint64_t key) {
+        if (key == EMPTY) key = 1;
+        std::size_t index = static_cast<std::size_t>(key % slots.size());
+        for (int probe = 0; probe < PROBE_WINDOW; ++probe) {
+            std::atomic<std::uint64_t>& slot = slots[(index + probe) % slots.size()];
+            std::uint64_t current = slot.load(std::memory_order_relaxed);
+            if (current == EMPTY && slot.compare_exchange_strong(current, key, std::memory_order_relaxed)) return true;
+            if (current == key) return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr std::uint64_t EMPTY = 0;
+    static constexpr int PROBE_WINDOW = 16;
+    std::vector<std::atomic<std::uint64_t>> slots;
+};
+
+struct GeneratorOptions {
+    std::uint64_t positions = 100000;
+    int nodes = DEFAULT_NODES; // 0 = one-ply look-ahead instead of a search
+    int randomPlies = DEFAULT_RANDOM_PLIES;
+    int maxPlies = DEFAULT_MAX_PLIES;
+    unsigned seed = 1;
+};
+
+// Counters shared by the workers and reported at the end
+struct GeneratorStats {
+    std::atomic<std::uint64_t> games{0};
+    std::atomic<std::uint64_t> kept{0};       // Quiet positions handed to the writer
+    std::atomic<std::uint64_t> duplicates{0}; // Quiet positions dropped by the key filter
+    std::atomic<std::uint64_t> filtered{0};   // Positions in check, with a capture, promotion or mate score
+    std::atomic<std::uint64_t> unfinished{0}; // Games cut short too close to adjudicate, dropped
+};
+
+using Samples = std::vector<std::pair<std::uint64_t, PackedSample>>;
+
+// Result of a game cut short, from its last score (White's point of view);
+// false if neither side is far enough ahead to call it
+bool adjudicate(float score, std::uint8_t& result) {
+    if (std::fabs(score) < ADJUDICATION_PAWNS) return false;
+    result = (score > 0.0f) ? PACKED_RESULT_WHITE_WIN : PACKED_RESULT_BLACK_WIN;
+    return true;
+}
+
+Color opposite(Color color) {
+    return (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
+}
+
+bool isQuiet(const Board& board, const Move& move) {
+    bool capture = move.isEnPassantCapture || board.getPieceAt(move.to) != nullptr;
+    return !capture && move.promotionPiece == PieceType::EMPTY;
+}
+
+// Buffers one worker reuses from game to game
+struct WorkerState {
+    Board board;
+    Board child;
+    std::vector<Move> moves;
+    std::vector<std::uint64_t> keys; // Positions since the last irreversible move
+    Samples samples;
+};
+
+// One game with --nodes 0, on a bare Board: every move is the one whose
+// resulting position the static evaluation likes best for the mover, and that
+// evaluation is the label. Mate, stalemate and insufficient material end the
+// game with its result. The ply limit, the 50-move rule and the first
+// repetition (greedy play would only shuffle on and produce duplicates) cut it
+// short, to be adjudicated. Fills worker.samples; empty if 'abort' is set
+// first or the game could not be adjudicated.
+void playFastGame(const EvaluationEngine& engine, const GeneratorOptions& options, std::mt19937_64& rng, GeneratorStats& stats,
+                  const std::atomic<bool>& abort, WorkerState& worker) {
+    Board& board = worker.board;
+    std::vector<Move>& moves = worker.moves;
+    Samples& samples = worker.samples;
+    samples.clear();
+    board.initializeCustomSetup(START_FEN);
+    Color side = Color::WHITE;
+    int halfMoveClock = 0;
+    int fullMoveNumber = 1;
+
+    auto play = [&](const Move& move) {
+        bool reversible = isQuiet(board, move) && board.getPieceAt(move.from)->getType() != PieceType::PAWN;
+        halfMoveClock = reversible ? halfMoveClock + 1 : 0;
+        board.applyMove(move);
+        if (side == Color::BLACK) ++fullMoveNumber;
+        side = opposite(side);
+    };
+
+    for (int ply = 0; ply < options.randomPlies; ++ply) {
+        moves.clear();
+        Game::generateLegalMoves(board, side, moves);
+        if (moves.empty()) return;
+        play(moves[std::uniform_int_distribution<std::size_t>(0, moves.size() - 1)(rng)]);
+    }
+
+    std::uint8_t result = PACKED_RESULT_DRAW;
+    bool finished = false;
+    worker.keys.clear();
+    for (int ply = 0; ply < options.maxPlies; ++ply) {
+        if (abort.load(std::memory_order_relaxed)) {
+            samples.clear();
+            return;
+        }
+        if (halfMoveClock == 0) worker.keys.clear();
+        std::uint64_t key = zobristKey(board, side);
+        if (std::find(worker.keys.begin(), worker.keys.end(), key) != worker.keys.end()) break;
+        worker.keys.push_back(key);
+        moves.clear();
+        Game::generateLegalMoves(board, side, moves);
+        bool inCheck = board.isSquareAttacked(board.findKing(side), opposite(side));
+        if (moves.empty()) {
+            if (inCheck) result = (side == Color::WHITE) ? PACKED_RESULT_BLACK_WIN : PACKED_RESULT_WHITE_WIN;
+            finished = true;
+            break;
+        }
+        if (board.isInsufficientMaterial()) {
+            finished = true;
+            break;
+        }
+        if (halfMoveClock >= 100) break;
+
+        // One-ply look-ahead; scores are White's point of view
+        std::size_t best = 0;
+        float bestScore = 0.0f;
+        for (std::size_t i = 0; i < moves.size(); ++i) {
+            worker.child = board;
+            worker.child.applyMove(moves[i]);
+            float score = engine.staticEvaluate(worker.child, Color::WHITE);
+            if (i == 0 || (side == Color::WHITE ? score > bestScore : score < bestScore)) {
+                best = i;
+                bestScore = score;
+            }
+        }
+        const Move& move = moves[best];
+
+        if (inCheck || !isQuiet(board, move)) {
+            ++stats.filtered;
+        } else {
+            PackedSample sample{};
+            sample.position = PackedPosition::fromBoard(board, side, halfMoveClock, fullMoveNumber);
+            sample.score = static_cast<std::int16_t>(std::clamp(std::lround(bestScore * 100.0f), -32000L, 32000L));
+            sample.bestMove = PackedSample::encodeMove(move);
+            samples.emplace_back(key, sample);
+        }
+        play(move);
+    }
+
+    if (!finished && !adjudicate(engine.staticEvaluate(board, Color::WHITE), result)) {
+        ++stats.unfinished;
+        samples.clear();
+        return;
+    }
+    for (auto& entry : samples) {
+        entry.second.result = result;
+    }
+}
+
+// One game in the default mode: the alpha-beta search picks and labels the
+// moves. Mate and the game's own draws (stalemate, 50-move rule, threefold
+// repetition, insufficient material) give the result; the ply limit cuts the
+// game short, to be adjudicated by the last search score. Fills
+// worker.samples; empty if 'abort' is set first or the game could not be
+// adjudicated.
+void playSearchGame(const EvaluationEngine& engine, const GeneratorOptions& options, std::mt19937_64& rng, GeneratorStats& stats,
+                    const std::atomic<bool>& abort, WorkerState& worker) {
+    Samples& samples = worker.samples;
+    samples.clear();
+    Game game(PlayerType::AI, PlayerType::AI);
+    game.loadFen(START_FEN);
+
+    for (int ply = 0; ply < options.randomPlies; ++ply) {
+        std::vector<Move> legalMoves = game.getLegalMoves();
+        if (legalMoves.empty()) return;
+        game.makeMove(legalMoves[std::uniform_int_distribution<std::size_t>(0, legalMoves.size() - 1)(rng)]);
+    }
+
+    SearchLimits limits;
+    limits.nodes = static_cast<std::uint64_t>(options.nodes);
+    float lastScore = 0.0f;
+    for (int ply = 0; ply < options.maxPlies; ++ply) {
+        if (abort.load(std::memory_order_relaxed)) {
+            samples.clear();
+            return;
+        }
+        GameState state = game.getGameState();
+        if (state != GameState::PLAYING && state != GameState::CHECK) break;
+        const Board& board = game.getBoard();
+        if (board.isInsufficientMaterial()) break;
+
+        EvaluationResult result = engine.analyze(game, limits);
+        const Move& move = result.bestMove;
+        if (!move.from.isValid()) break;
+        lastScore = result.score;
+
+        if (state == GameState::CHECK || !isQuiet(board, move) || std::isinf(result.score)) {
+            ++stats.filtered;
+        } else {
+            PackedSample sample{};
+            sample.position = PackedPosition::fromGame(game);
+            sample.score = static_cast<std::int16_t>(std::clamp(std::lround(result.score * 100.0f), -32000L, 32000L));
+            sample.bestMove = PackedSample::encodeMove(move);
+            samples.emplace_back(zobristKey(board, game.getCurrentPlayerColor()), sample);
+        }
+        if (!game.makeMove(move)) break;
+    }
+
+    GameState finalState = game.getGameState();
+    bool finished = (finalState != GameState::PLAYING && finalState != GameState::CHECK) || game.getBoard().isInsufficientMaterial();
+    std::uint8_t result = PACKED_RESULT_DRAW;
+    if (finalState == GameState::CHECKMATE_WHITE_WINS) result = PACKED_RESULT_WHITE_WIN;
+    else if (finalState == GameState::CHECKMATE_BLACK_WINS) result = PACKED_RESULT_BLACK_WIN;
+    if (!finished && !adjudicate(lastScore, result)) {
+        ++stats.unfinished;
+        samples.clear();
+        return;
+    }
+    for (auto& entry : samples) {
+        entry.second.result = result;
+    }
+}
+
+void printUsage() {
+    std::cerr << "Usage: datagen [--positions N] [--out FILE] [--threads N] [--nodes N] [--random-plies N]\n"
+              << "               [--max-plies N] [--seed N] [--dedupe-mb MB] [--weights FILE] [--nnue FILE]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    std::string outPath = "datagen.bin";
+    int threads = 0;
+    int dedupeMegabytes = DEFAULT_DEDUPE_MB;
+    EvaluationEngine engine;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--positions") options.positions = std::stoull(value());
+            else if (arg == "--out") outPath = value();
+            else if (arg == "--threads") threads = std::stoi(value());
+            else if (arg == "--nodes") options.nodes = std::stoi(value());
+            else if (arg == "--random-plies") options.randomPlies = std::stoi(value());
+            else if (arg == "--max-plies") options.maxPlies = std::stoi(value());
+            else if (arg == "--seed") options.seed = static_cast<unsigned>(std::stoul(value()));
+            else if (arg == "--dedupe-mb") dedupeMegabytes = std::stoi(value());
+            else if (arg == "--weights") engine.loadWeights(value());
+            else if (arg == "--nnue") engine.loadNetwork(value());
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+        if (options.positions == 0) throw std::invalid_argument("--positions must be positive");
+        if (options.nodes < 0) throw std::invalid_argument("--nodes must not be negative");
+        if (dedupeMegabytes <= 0) throw std::invalid_argument("--dedupe-mb must be positive");
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    std::unique_ptr<PackedPositionWriter> out;
+    try {
+        out = std::make_unique<PackedPositionWriter>(outPath, true);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    KeyFilter seen(static_cast<std::size_t>(dedupeMegabytes));
+    BoundedQueue<PackedSample> queue(QUEUE_CAPACITY);
+    GeneratorStats stats;
+    std::atomic<bool> enough{false};        // Set by the writer once --positions are written
+    std::atomic<bool> producersDone{false};
+    std::uint64_t written = 0;
+    std::cout << "Generating " << options.positions << " positions with " << pool.size() << " threads, ";
+    if (options.nodes > 0) std::cout << options.nodes << " nodes per move" << std::endl;
+    else std::cout << "one-ply look-ahead" << std::endl;
+
+    // Single writer: drains the queue (the writer buffers records into large
+    // writes) and reports progress. Records past the target are still drained
+    // (and dropped) so no producer blocks.
+    auto start = std::chrono::steady_clock::now();
+    std::thread writer([&]() {
+        auto lastReport = start;
+        for (;;) {
+            PackedSample sample;
+            if (queue.tryPop(sample)) {
+                if (written < options.positions) {
+                    out->write(sample);
+                    if (++written == options.positions) enough = true;
+                }
+                continue;
+            }
+            if (producersDone.load()) break;
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastReport >= std::chrono::seconds(5)) {
+                double seconds = std::chrono::duration<double>(now - start).count();
+                std::cout << written << " positions, " << stats.games.load() << " games, "
+                          << static_cast<long long>(written / seconds) << " positions/s" << std::endl;
+                lastReport = now;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    });
+
+    pool.parallelFor(static_cast<std::size_t>(pool.size()), [&](std::size_t worker) {
+        std::mt19937_64 rng(options.seed * 0x9E3779B97F4A7C15ULL + worker);
+        WorkerState state;
+        while (!enough.load()) {
+            if (options.nodes > 0) playSearchGame(engine, options, rng, stats, enough, state);
+            else playFastGame(engine, options, rng, stats, enough, state);
+            for (const auto& entry : state.samples) {
+                if (!seen.insert(entry.first)) {
+                    ++stats.duplicates;
+                    continue;
+                }
+                while (!queue.tryPush(entry.second)) std::this_thread::yield();
+                ++stats.kept;
+            }
+            ++stats.games;
+        }
+    });
+    producersDone = true;
+    writer.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    try {
+        out->close();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << written << " positions (" << sizeof(PackedFileHeader) + written * sizeof(PackedSample) << " bytes) to " << outPath << "\n"
+              << "Games: " << stats.games.load() << ", duplicates skipped: " << stats.duplicates.load()
+              << ", not quiet: " << stats.filtered.load() << ", unfinished games dropped: " << stats.unfinished.load() << "\n"
+              << "Time: " << seconds << " s (" << static_cast<long long>(written / seconds) << " positions/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,461 @@
+// Engine-vs-engine match runner: the gate for search and evaluation changes.
+//
+// Usage: match --engine "name=NEW weights=new.txt depth=4" --engine "name=BASE depth=4"
+//              [--games N] [--concurrency N] [--openings FILE] [--random-plies N]
+//              [--max-plies N] [--pgn FILE] [--sprt ELO0 ELO1] [--alpha A] [--beta B] [--seed N]
+//
+// Engine keys: name, weights, nnue, depth, movetime (ms), nodes, threads,
+// tc ("base+increment" in seconds, e.g. tc=10+0.1), book (a Polyglot .bin
+// played from with weighted random choice), bookdepth (plies, default 20),
+// syzygy (tablebase directories, ':'-separated), tables (a directory of
+// tbgen tables) and mcts (1 to search with MctsSearcher; nodes then counts
+// playouts and depth is ignored).
+// Without a limit an engine searches to depth 3.
+//
+// Games are played in pairs from the same opening with the colours swapped,
+// one game per worker (--concurrency, one per core by default). Openings come
+// from a FEN/EPD file, one per line and used in turn, and/or from random moves
+// played from the start position (--random-plies, 8 by default when no file is
+// given). Results are reported from the first engine's point of view: Elo with
+// a 95% error bar from the pentanomial distribution of the game pairs, and with
+// --sprt the log-likelihood ratio of the test elo0 vs elo1, which stops the
+// match as soon as it crosses a bound. --pgn writes every game as PGN.
+
+#include "core/Game.h"
+#include "core/Board.h"
+#include "core/Notation.h"
+#include "core/Pgn.h"
+#include "ai/EvaluationEngine.h"
+#include "ai/MctsSearcher.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const int DEFAULT_ENGINE_DEPTH = 3;
+const int DEFAULT_RANDOM_PLIES = 8;
+const int DEFAULT_MAX_PLIES = 400;
+
+struct EngineConfig {
+    std::string name;
+    EvaluationEngine engine;
+    SearchLimits limits;
+    long long baseMs = 0;      // Clock per game (0 = no clock)
+    long long incrementMs = 0; // Added after each move
+    bool useMcts = false;      // MctsSearcher instead of the alpha-beta search
+};
+
+struct GameRecord {
+    int round = 0;
+    std::string white;
+    std::string black;
+    std::string startFen;
+    std::vector<std::string> sanMoves;
+    std::string result; // "1-0", "0-1" or "1/2-1/2"
+    std::string reason;
+};
+
+// Win/draw/loss tally of the first engine, plus the pentanomial counts of the
+// finished pairs: index = points scored in the pair times two (0 .. 4)
+struct MatchStats {
+    int wins = 0;
+    int draws = 0;
+    int losses = 0;
+    int pentanomial[5] = {0, 0, 0, 0, 0};
+
+    int games() const { return wins + draws + losses; }
+    int pairs() const { return pentanomial[0] + pentanomial[1] + pentanomial[2] + pentanomial[3] + pentanomial[4]; }
+
+    // Mean and variance of the per-pair score (0, 0.25, ..., 1)
+    void pairScore(double& mean, double& variance) const {
+        int n = pairs();
+        mean = 0.0;
+        variance = 0.0;
+        if (n == 0) return;
+        for (int i = 0; i < 5; ++i) mean += pentanomial[i] * (i / 4.0);
+        mean /= n;
+        for (int i = 0; i < 5; ++i) variance += pentanomial[i] * (i / 4.0 - mean) * (i / 4.0 - mean);
+        variance /= n;
+    }
+};
+
+double eloFromScore(double score) {
+    score = std::clamp(score, 1e-6, 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+double scoreFromElo(double elo) {
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Log-likelihood ratio of H1 (elo1) against H0 (elo0) under the normal
+// approximation of the pair scores, as used by fishtest
+double sprtLlr(const MatchStats& stats, double elo0, double elo1) {
+    double mean;
+    double variance;
+    stats.pairScore(mean, variance);
+    if (stats.pairs() == 0 || variance <= 0.0) return 0.0;
+    double s0 = scoreFromElo(elo0);
+    double s1 = scoreFromElo(elo1);
+    return stats.pairs() * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+}
+
+// "name=x depth=4 tc=10+0.1 ..." as given to --engine
+EngineConfig parseEngine(const std::string& spec, int index) {
+    EngineConfig config;
+    config.name = "engine" + std::to_string(index + 1);
+    std::istringstream fields(spec);
+    std::string field;
+    while (fields >> field) {
+        std::size_t equals = field.find('=');
+        if (equals == std::string::npos) throw std::invalid_argument("Engine option without '=': " + field);
+        std::string key = field.substr(0, equals);
+        std::string value = field.substr(equals + 1);
+        try {
+            if (key == "name") config.name = value;
+            else if (key == "weights") config.engine.loadWeights(value);
+            else if (key == "nnue") config.engine.loadNetwork(value);
+            else if (key == "book") config.engine.loadBook(value);
+            else if (key == "syzygy") config.engine.loadTablebases(value);
+            else if (key == "tables") config.engine.loadEndgameTables(value);
+            else if (key == "bookdepth") config.engine.setBookOptions(BookSelection::WEIGHTED, std::stoi(value));
+            else if (key == "depth") config.limits.depth = std::stoi(value);
+            else if (key == "movetime") config.limits.moveTimeMs = std::stoi(value);
+            else if (key == "nodes") config.limits.nodes = std::stoull(value);
+            else if (key == "threads") config.limits.threads = std::max(1, std::stoi(value));
+            else if (key == "mcts") config.useMcts = std::stoi(value) != 0;
+            else if (key == "tc") {
+                std::size_t plus = value.find('+');
+                config.baseMs = static_cast<long long>(std::stod(value.substr(0, plus)) * 1000.0);
+                if (plus != std::string::npos) {
+                    config.incrementMs = static_cast<long long>(std::stod(value.substr(plus + 1)) * 1000.0);
+                }
+                if (config.baseMs <= 0) throw std::invalid_argument("tc needs a positive base time");
+            } else {
+                throw std::invalid_argument("Unknown engine option " + key);
+            }
+        } catch (const std::invalid_argument&) {
+            throw;
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Bad value for engine option " + key + ": " + value);
+        }
+    }
+    const SearchLimits& limits = config.limits;
+    if (limits.depth <= 0 && limits.moveTimeMs <= 0 && limits.nodes == 0 && config.baseMs == 0) {
+        config.limits.depth = DEFAULT_ENGINE_DEPTH;
+    }
+    return config;
+}
+
+// First four FEN fields of each line, plus the clocks when present; EPD
+// operations after them are ignored
+std::vector<std::string> loadOpenings(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Cannot open openings file " + path);
+    std::vector<std::string> openings;
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::vector<std::string> tokens;
+        std::string token;
+        while (tokens.size() < 6 && fields >> token) tokens.push_back(token);
+        if (tokens.size() < 4 || tokens[0][0] == '#') continue;
+        bool hasClocks = tokens.size() == 6 && std::all_of(tokens[4].begin(), tokens[4].end(), ::isdigit) &&
+                         std::all_of(tokens[5].begin(), tokens[5].end(), ::isdigit);
+        std::string fen = tokens[0] + " " + tokens[1] + " " + tokens[2] + " " + tokens[3];
+        if (hasClocks) fen += " " + tokens[4] + " " + tokens[5];
+        openings.push_back(fen);
+    }
+    if (openings.empty()) throw std::runtime_error("No positions in openings file " + path);
+    return openings;
+}
+
+// Opening of a game pair: the suite position followed by random moves, both
+// chosen from the pair index so the two games start identically
+Game openingPosition(const std::vector<std::string>& openings, int pair, int randomPlies, unsigned seed) {
+    Game game(PlayerType::AI, PlayerType::AI);
+    game.loadFen(openings.empty() ? START_FEN : openings[pair % openings.size()]);
+    std::mt19937 rng(seed + static_cast<unsigned>(pair));
+    for (int ply = 0; ply < randomPlies; ++ply) {
+        std::vector<Move> legalMoves = game.getLegalMoves();
+        if (legalMoves.empty()) break;
+        Move move = legalMoves[std::uniform_int_distribution<std::size_t>(0, legalMoves.size() - 1)(rng)];
+        game.makeMove(move);
+        GameState state = game.getGameState();
+        if (state != GameState::PLAYING && state != GameState::CHECK) break;
+    }
+    return game;
+}
+
+std::string winFor(Color color) {
+    return color == Color::WHITE ? "1-0" : "0-1";
+}
+
+Color opposite(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+GameRecord playGame(Game game, const EngineConfig& white, const EngineConfig& black, int maxPlies) {
+    GameRecord record;
+    record.white = white.name;
+    record.black = black.name;
+    record.startFen = game.toFen();
+    long long clock[2] = {white.baseMs, black.baseMs};
+    // Monte Carlo engines keep their tree from move to move within the game
+    std::unique_ptr<MctsSearcher> searchers[2];
+    if (white.useMcts) searchers[0] = std::make_unique<MctsSearcher>(white.engine);
+    if (black.useMcts) searchers[1] = std::make_unique<MctsSearcher>(black.engine);
+    // Each side's last principal variation, to seed its next search when the game followed it
+    std::vector<Move> lastLine[2];
+
+    for (int ply = 0;; ++ply) {
+        GameState state = game.getGameState();
+        Color toMove = game.getCurrentPlayerColor();
+        if (state == GameState::CHECKMATE_WHITE_WINS || state == GameState::CHECKMATE_BLACK_WINS) {
+            record.result = winFor(opposite(toMove));
+            record.reason = "checkmate";
+        } else if (state == GameState::STALEMATE) {
+            record.reason = "stalemate";
+        } else if (state == GameState::DRAW_HALF_MOVE_RULE) {
+            record.reason = "fifty-move rule";
+        } else if (state == GameState::DRAW_THREEFOLD_REPETITION) {
+            record.reason = "threefold repetition";
+        } else if (game.getBoard().isInsufficientMaterial()) {
+            record.reason = "insufficient material";
+        } else if (ply >= maxPlies) {
+            record.reason = "adjudicated at the ply limit";
+        }
+        if (!record.reason.empty()) break;
+
+        const EngineConfig& engine = (toMove == Color::WHITE) ? white : black;
+        int side = (toMove == Color::WHITE) ? 0 : 1;
+        SearchLimits limits = engine.limits;
+        if (engine.baseMs > 0) limits.moveTimeMs = allocateMoveTime(clock[side], engine.incrementMs);
+        const std::vector<Move>& history = game.getMoveHistory();
+        if (history.size() >= 2) limits.expectedLine = continueLine(lastLine[side], history[history.size() - 2], history.back());
+
+        auto start = std::chrono::steady_clock::now();
+        EvaluationResult result = searchers[side] ? searchers[side]->analyze(game, limits) : engine.engine.analyze(game, limits);
+        if (engine.baseMs > 0) {
+            clock[side] -= std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            if (clock[side] < 0) {
+                record.result = winFor(opposite(toMove));
+                record.reason = engine.name + " lost on time";
+                break;
+            }
+            clock[side] += engine.incrementMs;
+        }
+
+        std::string san = result.bestMove.from.isValid() ? moveToSan(game, result.bestMove) : "";
+        if (san.empty() || !game.makeMove(result.bestMove)) {
+            record.result = winFor(opposite(toMove));
+            record.reason = engine.name + " made an illegal move";
+            break;
+        }
+        record.sanMoves.push_back(san);
+        lastLine[side] = result.principalVariation;
+    }
+    if (record.result.empty()) record.result = "1/2-1/2";
+    return record;
+}
+
+std::string todayPgnDate() {
+    std::time_t now = std::time(nullptr);
+    std::tm local = *std::localtime(&now);
+    std::ostringstream date;
+    date << std::put_time(&local, "%Y.%m.%d");
+    return date.str();
+}
+
+void printStandings(const MatchStats& stats, const std::string& first, const std::string& second) {
+    std::cout << "Score of " << first << " vs " << second << ": " << stats.wins << " - " << stats.losses << " - " << stats.draws;
+    if (stats.games() > 0) {
+        double score = (stats.wins + 0.5 * stats.draws) / stats.games();
+        std::cout << "  [" << std::fixed << std::setprecision(3) << score << std::defaultfloat << "] " << stats.games();
+    }
+    std::cout << std::endl;
+}
+
+void printElo(const MatchStats& stats) {
+    double mean;
+    double variance;
+    stats.pairScore(mean, variance);
+    if (stats.pairs() == 0) return;
+    double margin = 1.96 * std::sqrt(variance / stats.pairs());
+    double elo = eloFromScore(mean);
+    if (std::abs(elo) < 0.05) elo = 0.0; // No "-0.0" for an even score
+    double errorBar = (eloFromScore(mean + margin) - eloFromScore(mean - margin)) / 2.0;
+    std::cout << "Elo difference: " << std::fixed << std::setprecision(1) << elo << " +/- " << errorBar
+              << " (95%, " << stats.pairs() << " pairs)" << std::defaultfloat << "\n"
+              << "Pairs (0, 0.5, 1, 1.5, 2 points): " << stats.pentanomial[0] << " " << stats.pentanomial[1] << " "
+              << stats.pentanomial[2] << " " << stats.pentanomial[3] << " " << stats.pentanomial[4] << std::endl;
+}
+
+void printUsage() {
+    std::cerr << "Usage: match --engine \"name=A depth=4\" --engine \"name=B weights=FILE tc=10+0.1\"\n"
+              << "             [--games N] [--concurrency N] [--openings FILE] [--random-plies N] [--max-plies N]\n"
+              << "             [--pgn FILE] [--sprt ELO0 ELO1] [--alpha A] [--beta B] [--seed N]\n"
+              << "Engine keys: name weights nnue depth movetime nodes threads tc book bookdepth syzygy tables mcts" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<EngineConfig> engines;
+    int games = 100;
+    int concurrency = 0;
+    int randomPlies = -1;
+    int maxPlies = DEFAULT_MAX_PLIES;
+    unsigned seed = 1;
+    std::string openingsPath;
+    std::string pgnPath;
+    bool sprt = false;
+    double elo0 = 0.0;
+    double elo1 = 5.0;
+    double alpha = 0.05;
+    double beta = 0.05;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--engine") engines.push_back(parseEngine(value(), static_cast<int>(engines.size())));
+            else if (arg == "--games") games = std::stoi(value());
+            else if (arg == "--concurrency") concurrency = std::stoi(value());
+            else if (arg == "--openings") openingsPath = value();
+            else if (arg == "--random-plies") randomPlies = std::stoi(value());
+            else if (arg == "--max-plies") maxPlies = std::stoi(value());
+            else if (arg == "--pgn") pgnPath = value();
+            else if (arg == "--seed") seed = static_cast<unsigned>(std::stoul(value()));
+            else if (arg == "--alpha") alpha = std::stod(value());
+            else if (arg == "--beta") beta = std::stod(value());
+            else if (arg == "--sprt") {
+                sprt = true;
+                elo0 = std::stod(value());
+                elo1 = std::stod(value());
+            } else {
+                throw std::invalid_argument("Unknown option " + arg);
+            }
+        }
+        if (engines.size() != 2) throw std::invalid_argument("Exactly two --engine configurations are needed");
+        if (games <= 0) throw std::invalid_argument("--games must be positive");
+        if (sprt && (elo1 <= elo0 || alpha <= 0.0 || beta <= 0.0 || alpha >= 1.0 || beta >= 1.0)) {
+            throw std::invalid_argument("--sprt needs ELO0 < ELO1 and 0 < alpha, beta < 1");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    try {
+        std::vector<std::string> openings;
+        if (!openingsPath.empty()) openings = loadOpenings(openingsPath);
+        if (randomPlies < 0) randomPlies = openings.empty() ? DEFAULT_RANDOM_PLIES : 0;
+        games += games % 2; // Whole pairs only
+
+        // Engines that search with several threads get fewer concurrent games
+        if (concurrency <= 0) {
+            int engineThreads = std::max(engines[0].limits.threads, engines[1].limits.threads);
+            concurrency = std::max(1, static_cast<int>(std::max(1u, std::thread::hardware_concurrency())) / engineThreads);
+        }
+        concurrency = std::min(concurrency, games);
+
+        std::ofstream pgnFile;
+        if (!pgnPath.empty()) {
+            pgnFile.open(pgnPath);
+            if (!pgnFile) throw std::runtime_error("Cannot write " + pgnPath);
+        }
+        PgnWriter pgn(pgnFile);
+        std::string date = todayPgnDate();
+
+        double lowerBound = std::log(beta / (1.0 - alpha));
+        double upperBound = std::log((1.0 - beta) / alpha);
+        std::cout << "Match " << engines[0].name << " vs " << engines[1].name << ": " << games << " games, "
+                  << concurrency << " concurrent";
+        if (sprt) std::cout << ", SPRT elo0 " << elo0 << " elo1 " << elo1 << " bounds [" << lowerBound << ", " << upperBound << "]";
+        std::cout << std::endl;
+
+        // Results are collected under one mutex; the games themselves share nothing
+        std::mutex resultMutex;
+        MatchStats stats;
+        std::vector<double> pairPoints(games / 2, 0.0);
+        std::vector<int> pairGamesDone(games / 2, 0);
+        std::atomic<bool> finished{false};
+        std::string sprtVerdict;
+
+        auto start = std::chrono::steady_clock::now();
+        ThreadPool pool(concurrency);
+        pool.parallelFor(static_cast<std::size_t>(games), [&](std::size_t index) {
+            if (finished.load()) return;
+            int pair = static_cast<int>(index / 2);
+            bool firstIsWhite = index % 2 == 0;
+            const EngineConfig& white = engines[firstIsWhite ? 0 : 1];
+            const EngineConfig& black = engines[firstIsWhite ? 1 : 0];
+
+            GameRecord record = playGame(openingPosition(openings, pair, randomPlies, seed), white, black, maxPlies);
+            record.round = static_cast<int>(index) + 1;
+            double points = record.result == "1/2-1/2" ? 0.5 : ((record.result == "1-0") == firstIsWhite ? 1.0 : 0.0);
+
+            std::lock_guard<std::mutex> lock(resultMutex);
+            if (points == 1.0) ++stats.wins;
+            else if (points == 0.5) ++stats.draws;
+            else ++stats.losses;
+            if (pgnFile.is_open()) {
+                pgn.write({{"Event", "match"}, {"Date", date}, {"Round", std::to_string(record.round)}, {"White", record.white},
+                           {"Black", record.black}},
+                          record.startFen, record.sanMoves, record.result, record.reason);
+                pgnFile << std::flush;
+            }
+            std::cout << "Game " << record.round << " (" << record.white << " vs " << record.black << "): "
+                      << record.result << " {" << record.reason << "}" << std::endl;
+
+            pairPoints[pair] += points;
+            if (++pairGamesDone[pair] < 2) return;
+            ++stats.pentanomial[static_cast<int>(pairPoints[pair] * 2.0 + 0.5)];
+            printStandings(stats, engines[0].name, engines[1].name);
+            if (sprt && !finished.load()) {
+                double llr = sprtLlr(stats, elo0, elo1);
+                std::cout << "LLR: " << std::fixed << std::setprecision(2) << llr << std::defaultfloat << std::endl;
+                if (llr >= upperBound) sprtVerdict = "H1 accepted";
+                if (llr <= lowerBound) sprtVerdict = "H0 accepted";
+                if (!sprtVerdict.empty()) finished = true;
+            }
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "===========================" << std::endl;
+        printStandings(stats, engines[0].name, engines[1].name);
+        printElo(stats);
+        if (sprt) {
+            std::cout << "SPRT: " << (sprtVerdict.empty() ? "no decision" : sprtVerdict)
+                      << " (LLR " << std::fixed << std::setprecision(2) << sprtLlr(stats, elo0, elo1)
+                      << std::defaultfloat << ")" << std::endl;
+        }
+        std::cout << "Time: " << seconds << " s" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,198 @@
+// Move generator verification against the standard perft positions.
+//
+// Usage: perft [--suite] [--deep] [--threads N] [--hash MB]
+//        perft --fen "<fen>" --depth N [--divide] [--stats] [--threads N] [--hash MB]
+//
+// With no position given, runs the built-in suite (start position, Kiwipete
+// and positions 3-6 from the Chess Programming Wiki) and compares every count
+// with the reference value. By default each position stops at the depths that
+// finish in seconds; --deep runs the full table. Exits non-zero on a mismatch.
+// --hash caches subtree counts in a shared table of the given size, which makes
+// deep runs (the nightly soak test) many times faster; the hit rate is reported.
+
+#include "core/Board.h"
+#include "core/Perft.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Leaf counts below this are run by default; --deep lifts the limit
+const std::uint64_t QUICK_NODE_LIMIT = 5000000;
+
+struct SuiteEntry {
+    const char* name;
+    const char* fen;
+    std::vector<std::uint64_t> nodes; // Expected counts for depth 1, 2, ...
+};
+
+const std::vector<SuiteEntry>& referenceSuite() {
+    static const std::vector<SuiteEntry> suite = {
+        {"startpos", START_FEN,
+         {20, 400, 8902, 197281, 4865609, 119060324}},
+        {"kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+         {48, 2039, 97862, 4085603, 193690690}},
+        {"position3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+         {14, 191, 2812, 43238, 674624, 11030083}},
+        {"position4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+         {6, 264, 9467, 422333, 15833292}},
+        {"position5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+         {44, 1486, 62379, 2103487, 89941194}},
+        {"position6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+         {46, 2079, 89890, 3894594, 164075551}},
+    };
+    return suite;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void reportHash(const Perft& perft) {
+    if (perft.getHashSizeBytes() == 0) return;
+    PerftHashStats stats = perft.getHashStats();
+    std::cout << "  hash: " << stats.hits << "/" << stats.probes << " hits ("
+              << 100.0 * stats.hitRate() << "%)" << std::endl;
+}
+
+long long nodesPerSecond(std::uint64_t nodes, double seconds) {
+    return seconds > 0.0 ? static_cast<long long>(nodes / seconds) : 0;
+}
+
+Board boardFromFen(const std::string& fen) {
+    Board board(8, 8);
+    board.initializeCustomSetup(fen);
+    return board;
+}
+
+int runSuite(Perft& perft, bool deep) {
+    int failures = 0;
+    std::uint64_t totalNodes = 0;
+    double totalSeconds = 0.0;
+
+    for (const SuiteEntry& entry : referenceSuite()) {
+        Board board = boardFromFen(entry.fen);
+        Color sideToMove = Perft::sideToMoveFromFen(entry.fen);
+        std::cout << entry.name << ": " << entry.fen << std::endl;
+
+        for (std::size_t i = 0; i < entry.nodes.size(); ++i) {
+            std::uint64_t expected = entry.nodes[i];
+            if (!deep && expected > QUICK_NODE_LIMIT) break;
+
+            int depth = static_cast<int>(i) + 1;
+            auto start = std::chrono::steady_clock::now();
+            std::uint64_t nodes = perft.run(board, sideToMove, depth);
+            double seconds = secondsSince(start);
+            totalNodes += nodes;
+            totalSeconds += seconds;
+
+            bool ok = nodes == expected;
+            if (!ok) ++failures;
+            std::cout << "  depth " << depth << ": " << nodes << (ok ? " ok" : " FAILED, expected " + std::to_string(expected))
+                      << " (" << seconds << " s, " << nodesPerSecond(nodes, seconds) << " nps)" << std::endl;
+            reportHash(perft);
+        }
+    }
+
+    std::cout << (failures == 0 ? "All counts match" : std::to_string(failures) + " count(s) differ")
+              << ", " << totalNodes << " nodes, " << nodesPerSecond(totalNodes, totalSeconds) << " nps" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
+
+void runPosition(Perft& perft, const std::string& fen, int depth, bool divide, bool stats) {
+    Board board = boardFromFen(fen);
+    Color sideToMove = Perft::sideToMoveFromFen(fen);
+    auto start = std::chrono::steady_clock::now();
+
+    if (stats) {
+        PerftStats result = perft.runDetailed(board, sideToMove, depth);
+        double seconds = secondsSince(start);
+        std::cout << "Nodes:       " << result.nodes << "\n"
+                  << "Captures:    " << result.captures << "\n"
+                  << "En passant:  " << result.enPassants << "\n"
+                  << "Castles:     " << result.castles << "\n"
+                  << "Promotions:  " << result.promotions << "\n"
+                  << "Checks:      " << result.checks << "\n"
+                  << "Checkmates:  " << result.checkmates << "\n"
+                  << "Time:        " << seconds << " s (" << nodesPerSecond(result.nodes, seconds) << " nps)" << std::endl;
+        return;
+    }
+
+    std::uint64_t nodes = 0;
+    if (divide) {
+        for (const auto& entry : perft.divide(board, sideToMove, depth)) {
+            std::cout << entry.first.toString() << ": " << entry.second << "\n";
+            nodes += entry.second;
+        }
+        std::cout << "\n";
+    } else {
+        nodes = perft.run(board, sideToMove, depth);
+    }
+    double seconds = secondsSince(start);
+    std::cout << "Nodes: " << nodes << "\n"
+              << "Time:  " << seconds << " s (" << nodesPerSecond(nodes, seconds) << " nps)" << std::endl;
+    reportHash(perft);
+}
+
+void printUsage() {
+    std::cerr << "Usage: perft [--suite] [--deep] [--threads N] [--hash MB]\n"
+              << "       perft --fen \"<fen>\" --depth N [--divide] [--stats] [--threads N] [--hash MB]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string fen;
+    int depth = 0;
+    int threads = 0;
+    int hashMegabytes = 0;
+    bool divide = false;
+    bool stats = false;
+    bool deep = false;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--fen") fen = value();
+            else if (arg == "--depth") depth = std::stoi(value());
+            else if (arg == "--threads") threads = std::stoi(value());
+            else if (arg == "--hash") hashMegabytes = std::stoi(value());
+            else if (arg == "--divide") divide = true;
+            else if (arg == "--stats") stats = true;
+            else if (arg == "--deep") deep = true;
+            else if (arg == "--suite") fen.clear();
+            else if (arg == "--startpos") fen = START_FEN;
+            else throw std::invalid_argument("Unknown option " + arg);
+        }
+
+        if (hashMegabytes < 0) throw std::invalid_argument("--hash must not be negative");
+        Perft perft(threads);
+        perft.setHashSize(static_cast<std::size_t>(hashMegabytes));
+        std::cout << "Threads: " << perft.getThreadCount();
+        if (perft.getHashSizeBytes() > 0) {
+            std::cout << ", hash: " << perft.getHashSizeBytes() / (1024 * 1024) << " MB";
+        }
+        std::cout << std::endl;
+        if (fen.empty()) {
+            return runSuite(perft, deep);
+        }
+        if (depth <= 0) throw std::invalid_argument("--depth must be positive");
+        runPosition(perft, fen, depth, divide, stats);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,979 @@
+// Retrograde endgame table generator.
+//
+// Usage: tbgen <MATERIAL...> [--all N] [--out DIR] [--size RxC] [--threads N] [--wdl] [--force]
+//        tbgen --check-syzygy DIR [MATERIAL...] [--out DIR]
+//
+// Builds endgame tables (see ai/EndgameTable.h) for material signatures such
+// as KQvK or KRvKP, on the standard board or any other size up to 64 squares
+// (--size 6x6). --all N builds every table of 3 to N pieces (N <= 5). Tables
+// the requested ones convert into by a capture or a promotion are built first,
+// unless DIR (default ".") already has them; --force rebuilds the requested ones.
+//
+// Generation is retrograde analysis over the table's index, on all cores:
+//   1. Every position is visited once: its legal moves are counted, captures
+//      and promotions are scored from the smaller tables, and mates (and wins
+//      or losses that only come from such conversions) are recorded.
+//   2. Level by level, positions lost in d plies make their predecessors (found
+//      by un-moving a piece) wins in d + 1; positions won in d plies count down
+//      their predecessors' moves, and a predecessor whose every move wins for
+//      the opponent is lost in d + 1.
+//   3. What is left is drawn. The results are bit-packed into DIR/NAME.egt:
+//      distance to mate in plies, or with --wdl only win/draw/loss (2 bits).
+//
+// The tables know neither castling nor en passant: a double pawn step is
+// scored as if the opponent could not capture it en passant.
+//
+// --check-syzygy DIR compares the Syzygy prober (ai/Syzygy.h) with real
+// .rtbw/.rtbz files in DIR, KQvK and KRvK by default. Every legal position of
+// each table is probed and checked against our own table (built first if DIR
+// of --out lacks it), and a few positions with known results are checked on
+// their own. Exits non-zero on any disagreement.
+
+#include "ai/EndgameTable.h"
+#include "core/Bitboard.h"
+#include "core/Board.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+const std::uint16_t UNKNOWN = 0;       // Not resolved yet; drawn at the end
+const std::uint16_t BROKEN = 0xFFFF;   // Index of no legal position
+const std::size_t CHUNK_SIZE = 1 << 14; // Positions per parallelFor task
+const int MAX_MOVES = 256;
+
+// Entry codes are plies to mate + 1: even codes are wins, odd codes losses
+inline std::uint16_t codeOf(int plies) {
+    return static_cast<std::uint16_t>(plies + 1);
+}
+
+inline bool isWinCode(std::uint16_t code) {
+    return code != UNKNOWN && code != BROKEN && code % 2 == 0;
+}
+
+Color opposite(Color color) {
+    return color == Color::WHITE ? Color::BLACK : Color::WHITE;
+}
+
+// Piece movement on a rows x cols board, squares numbered rank * cols + file
+struct Geometry {
+    int rows = 8;
+    int cols = 8;
+    int squares = 64;
+    std::vector<std::uint64_t> kingMoves;
+    std::vector<std::uint64_t> knightMoves;
+    std::vector<std::uint64_t> pawnAttacks[2];   // Squares a pawn of each colour attacks
+    std::vector<std::vector<int>> rays;          // [square * 8 + direction], nearest first
+    std::vector<std::uint64_t> between;          // [a * squares + b]: squares strictly between two aligned squares
+    std::vector<std::uint8_t> alignment;         // [a * squares + b]: 1 same rank or file, 2 same diagonal, 0 neither
+
+    explicit Geometry(BoardDimensions dims) : rows(dims.rows), cols(dims.cols), squares(dims.rows * dims.cols) {
+        const int rankSteps[8] = {1, -1, 0, 0, 1, 1, -1, -1}; // Orthogonal directions first
+        const int fileSteps[8] = {0, 0, 1, -1, 1, -1, 1, -1};
+        const int knightRanks[8] = {1, 2, 2, 1, -1, -2, -2, -1};
+        const int knightFiles[8] = {2, 1, -1, -2, -2, -1, 1, 2};
+        kingMoves.assign(squares, 0);
+        knightMoves.assign(squares, 0);
+        pawnAttacks[0].assign(squares, 0);
+        pawnAttacks[1].assign(squares, 0);
+        rays.resize(static_cast<std::size_t>(squares) * 8);
+        between.assign(static_cast<std::size_t>(squares) * squares, 0);
+        alignment.assign(static_cast<std::size_t>(squares) * squares, 0);
+
+        for (int square = 0; square < squares; ++square) {
+            int rank = square / cols;
+            int file = square % cols;
+            for (int d = 0; d < 8; ++d) {
+                if (onBoard(rank + rankSteps[d], file + fileSteps[d])) kingMoves[square] |= bit(rank + rankSteps[d], file + fileSteps[d]);
+                if (onBoard(rank + knightRanks[d], file + knightFiles[d])) knightMoves[square] |= bit(rank + knightRanks[d], file + knightFiles[d]);
+
+                std::uint64_t passed = 0;
+                for (int r = rank + rankSteps[d], f = file + fileSteps[d]; onBoard(r, f); r += rankSteps[d], f += fileSteps[d]) {
+                    int target = r * cols + f;
+                    rays[static_cast<std::size_t>(square) * 8 + d].push_back(target);
+                    between[static_cast<std::size_t>(square) * squares + target] = passed;
+                    alignment[static_cast<std::size_t>(square) * squares + target] = d < 4 ? 1 : 2;
+                    passed |= 1ULL << target;
+                }
+            }
+            for (int side : {-1, 1}) {
+                if (onBoard(rank + 1, file + side)) pawnAttacks[0][square] |= bit(rank + 1, file + side);
+                if (onBoard(rank - 1, file + side)) pawnAttacks[1][square] |= bit(rank - 1, file + side);
+            }
+        }
+    }
+
+    bool onBoard(int rank, int file) const {
+        return rank >= 0 && rank < rows && file >= 0 && file < cols;
+    }
+
+    std::uint64_t bit(int rank, int file) const {
+        return 1ULL << (rank * cols + file);
+    }
+
+    // Rank counted from 'color's own side
+    int relativeRank(int square, Color color) const {
+        return color == Color::WHITE ? square / cols : rows - 1 - square / cols;
+    }
+};
+
+// A position under construction: one square per slot (see EndgameIndex), -1 once captured
+struct Placement {
+    int squares[ENDGAME_MAX_PIECES];
+};
+
+struct ResultCounts {
+    std::uint64_t wins[2] = {0, 0};
+    std::uint64_t draws[2] = {0, 0};
+    std::uint64_t losses[2] = {0, 0};
+};
+
+// What the captures and promotions of a position achieve, from its side to move
+struct Conversions {
+    int bestWin = -1;    // Fewest plies to mate through a winning conversion
+    int longestLoss = -1; // Most plies to be mated through a losing one
+    bool draw = false;
+};
+
+// Table name from the piece letters of each side, in any order
+std::string materialName(std::string white, std::string black) {
+    const std::string order = "QRBNP";
+    auto byStrength = [&](char a, char b) { return order.find(a) < order.find(b); };
+    std::sort(white.begin(), white.end(), byStrength);
+    std::sort(black.begin(), black.end(), byStrength);
+    return "K" + white + "vK" + black;
+}
+
+// Materials one capture, promotion or capturing promotion away from
+// 'material', oriented as on the board (not necessarily canonical)
+std::vector<EndgameMaterial> conversionTargets(const EndgameMaterial& material) {
+    std::string name = material.getName();
+    std::size_t separator = name.find('v');
+    std::string pieces[2] = {name.substr(1, separator - 1), name.substr(separator + 2)};
+    std::vector<EndgameMaterial> targets;
+
+    auto addPromotions = [&](std::string white, std::string black) {
+        std::string* sides[2] = {&white, &black};
+        for (std::string* side : sides) {
+            for (char& piece : *side) {
+                if (piece != 'P') continue;
+                for (char promoted : std::string("QRBN")) {
+                    piece = promoted;
+                    targets.push_back(EndgameMaterial::parse(materialName(white, black)));
+                }
+                piece = 'P';
+            }
+        }
+    };
+    addPromotions(pieces[0], pieces[1]);
+    for (int side = 0; side < 2; ++side) {
+        for (std::size_t i = 0; i < pieces[side].size(); ++i) {
+            std::string remaining[2] = {pieces[0], pieces[1]};
+            remaining[side].erase(i, 1);
+            targets.push_back(EndgameMaterial::parse(materialName(remaining[0], remaining[1])));
+            addPromotions(remaining[0], remaining[1]);
+        }
+    }
+    return targets;
+}
+
+class TableGenerator {
+public:
+    TableGenerator(const EndgameMaterial& material, BoardDimensions dims, const EndgameTablebase& smaller, bool wdlOnly, ThreadPool& pool)
+        : material(material), dims(dims), geometry(dims), index(material, dims), slots(material.getPieceCount()),
+          wdlOnly(wdlOnly), pool(pool), longestCode(0) {
+        slotTypes[0] = slotTypes[1] = PieceType::KING;
+        slotColors[0] = Color::WHITE;
+        slotColors[1] = Color::BLACK;
+        int slot = 2;
+        for (Color color : {Color::WHITE, Color::BLACK}) {
+            for (PieceType type : material.getPieces(color)) {
+                slotTypes[slot] = type;
+                slotColors[slot++] = color;
+            }
+        }
+        findSmallerTables(smaller);
+    }
+
+    // Runs the three steps and writes the table to 'path'
+    void generate(const std::string& path) {
+        for (int side = 0; side < 2; ++side) {
+            values[side] = std::vector<std::atomic<std::uint16_t>>(index.size());
+            remaining[side] = std::vector<std::atomic<std::uint8_t>>(index.size());
+        }
+        std::uint64_t chunks = (index.size() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+        pool.parallelFor(static_cast<std::size_t>(2 * chunks), [&](std::size_t task) {
+            Color side = task < chunks ? Color::WHITE : Color::BLACK;
+            std::uint64_t first = (task % chunks) * CHUNK_SIZE;
+            std::uint64_t last = std::min<std::uint64_t>(first + CHUNK_SIZE, index.size());
+            for (std::uint64_t i = first; i < last; ++i) initialize(side, i);
+        });
+
+        for (int plies = 0; codeOf(plies) <= longestCode.load(); ++plies) {
+            pool.parallelFor(static_cast<std::size_t>(2 * chunks), [&](std::size_t task) {
+                Color side = task < chunks ? Color::WHITE : Color::BLACK;
+                std::uint64_t first = (task % chunks) * CHUNK_SIZE;
+                std::uint64_t last = std::min<std::uint64_t>(first + CHUNK_SIZE, index.size());
+                auto& sideValues = values[static_cast<int>(side)];
+                for (std::uint64_t i = first; i < last; ++i) {
+                    if (sideValues[i].load(std::memory_order_relaxed) == codeOf(plies)) propagate(side, i, plies);
+                }
+            });
+        }
+        write(path);
+    }
+
+    const ResultCounts& getStats() const { return stats; }
+    std::uint64_t getEntriesPerSide() const { return index.size(); }
+    int getLongestMate() const { return longestCode.load() > 0 ? longestCode.load() - 1 : 0; }
+
+private:
+    // Smaller tables by the key of their material as seen from the board
+    void findSmallerTables(const EndgameTablebase& smaller) {
+        for (const EndgameMaterial& target : conversionTargets(material)) {
+            if (target.getPieceCount() == 2) continue; // Bare kings: drawn without a table
+            EndgameMaterial canonical = target.isCanonical() ? target : target.swapped();
+            const EndgameTable* table = smaller.findTable(canonical, dims);
+            if (!table) throw std::runtime_error("Missing table " + endgameTableFileName(canonical, dims));
+            if (!wdlOnly && table->getFormat() != EndgameTableFormat::DTM) {
+                throw std::runtime_error(endgameTableFileName(canonical, dims) + " has no mate distances; rebuild it without --wdl");
+            }
+            smallerTables[target.getKey()] = table;
+        }
+    }
+
+    std::uint64_t occupancy(const int* squares, Color color) const {
+        std::uint64_t occupied = 0;
+        for (int i = 0; i < slots; ++i) {
+            if (squares[i] >= 0 && slotColors[i] == color) occupied |= 1ULL << squares[i];
+        }
+        return occupied;
+    }
+
+    bool isAttacked(int target, Color attacker, const int* squares, std::uint64_t occupied) const {
+        for (int i = 0; i < slots; ++i) {
+            int from = squares[i];
+            if (from < 0 || slotColors[i] != attacker) continue;
+            std::size_t pair = static_cast<std::size_t>(from) * geometry.squares + target;
+            switch (slotTypes[i]) {
+                case PieceType::KING:
+                    if (geometry.kingMoves[from] >> target & 1) return true;
+                    break;
+                case PieceType::KNIGHT:
+                    if (geometry.knightMoves[from] >> target & 1) return true;
+                    break;
+                case PieceType::PAWN:
+                    if (geometry.pawnAttacks[static_cast<int>(attacker)][from] >> target & 1) return true;
+                    break;
+                default: {
+                    int line = geometry.alignment[pair];
+                    bool fits = slotTypes[i] == PieceType::QUEEN ? line != 0
+                              : slotTypes[i] == PieceType::ROOK ? line == 1 : line == 2;
+                    if (fits && (geometry.between[pair] & occupied) == 0) return true;
+                    break;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool inCheck(const int* squares, Color color) const {
+        std::uint64_t occupied = occupancy(squares, Color::WHITE) | occupancy(squares, Color::BLACK);
+        return isAttacked(squares[color == Color::WHITE ? 0 : 1], opposite(color), squares, occupied);
+    }
+
+    // Calls visit(after, isConversion, promotion) for every legal move of 'side'
+    template <typename Visit>
+    void forEachMove(const int* squares, Color side, Visit&& visit) const {
+        std::uint64_t own = occupancy(squares, side);
+        std::uint64_t enemy = occupancy(squares, opposite(side));
+        std::uint64_t occupied = own | enemy;
+        int kingSlot = side == Color::WHITE ? 0 : 1;
+
+        for (int slot = 0; slot < slots; ++slot) {
+            if (slotColors[slot] != side) continue;
+            int from = squares[slot];
+            auto tryMove = [&](int to, PieceType promotion) {
+                Placement after;
+                std::copy(squares, squares + slots, after.squares);
+                bool capture = (enemy >> to & 1) != 0;
+                if (capture) {
+                    for (int i = 0; i < slots; ++i) {
+                        if (after.squares[i] == to) after.squares[i] = -1;
+                    }
+                }
+                after.squares[slot] = to;
+                std::uint64_t afterOccupied = (occupied & ~(1ULL << from)) | (1ULL << to);
+                if (isAttacked(after.squares[kingSlot], opposite(side), after.squares, afterOccupied)) return;
+                visit(after, capture || promotion != PieceType::EMPTY, promotion);
+            };
+            auto tryTargets = [&](std::uint64_t targets) {
+                for (; targets; targets &= targets - 1) tryMove(lsb(targets), PieceType::EMPTY);
+            };
+
+            switch (slotTypes[slot]) {
+                case PieceType::KING:
+                    tryTargets(geometry.kingMoves[from] & ~own);
+                    break;
+                case PieceType::KNIGHT:
+                    tryTargets(geometry.knightMoves[from] & ~own);
+                    break;
+                case PieceType::PAWN: {
+                    int step = side == Color::WHITE ? geometry.cols : -geometry.cols;
+                    auto pawnTo = [&](int to) {
+                        if (geometry.relativeRank(to, side) == geometry.rows - 1) {
+                            for (PieceType piece : {PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT}) tryMove(to, piece);
+                        } else {
+                            tryMove(to, PieceType::EMPTY);
+                        }
+                    };
+                    int forward = from + step;
+                    if (!(occupied >> forward & 1)) {
+                        pawnTo(forward);
+                        // The double step never promotes, so boards need five ranks for it
+                        int twoForward = forward + step;
+                        if (geometry.rows > 4 && geometry.relativeRank(from, side) == 1 && !(occupied >> twoForward & 1)) {
+                            tryMove(twoForward, PieceType::EMPTY);
+                        }
+                    }
+                    for (std::uint64_t targets = geometry.pawnAttacks[static_cast<int>(side)][from] & enemy; targets; targets &= targets - 1) {
+                        pawnTo(lsb(targets));
+                    }
+                    break;
+                }
+                default: {
+                    int firstDirection = slotTypes[slot] == PieceType::BISHOP ? 4 : 0;
+                    int lastDirection = slotTypes[slot] == PieceType::ROOK ? 4 : 8;
+                    for (int d = firstDirection; d < lastDirection; ++d) {
+                        for (int to : geometry.rays[static_cast<std::size_t>(from) * 8 + d]) {
+                            if (own >> to & 1) break;
+                            tryMove(to, PieceType::EMPTY);
+                            if (enemy >> to & 1) break;
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // Calls visit(before) for every legal position of the same material from
+    // which 'mover' (not to move in 'squares') reached 'squares' without a
+    // capture or promotion
+    template <typename Visit>
+    void forEachUnmove(const int* squares, Color mover, Visit&& visit) const {
+        std::uint64_t occupied = occupancy(squares, Color::WHITE) | occupancy(squares, Color::BLACK);
+        int otherKing = squares[mover == Color::WHITE ? 1 : 0];
+
+        for (int slot = 0; slot < slots; ++slot) {
+            if (slotColors[slot] != mover) continue;
+            int to = squares[slot];
+            auto tryFrom = [&](int from) {
+                Placement before;
+                std::copy(squares, squares + slots, before.squares);
+                before.squares[slot] = from;
+                std::uint64_t beforeOccupied = (occupied & ~(1ULL << to)) | (1ULL << from);
+                if (isAttacked(otherKing, mover, before.squares, beforeOccupied)) return; // The side not to move would be in check
+                visit(before);
+            };
+            auto tryOrigins = [&](std::uint64_t origins) {
+                for (; origins; origins &= origins - 1) tryFrom(lsb(origins));
+            };
+
+            switch (slotTypes[slot]) {
+                case PieceType::KING:
+                    tryOrigins(geometry.kingMoves[to] & ~occupied);
+                    break;
+                case PieceType::KNIGHT:
+                    tryOrigins(geometry.knightMoves[to] & ~occupied);
+                    break;
+                case PieceType::PAWN: {
+                    int step = mover == Color::WHITE ? geometry.cols : -geometry.cols;
+                    int rank = geometry.relativeRank(to, mover);
+                    int back = to - step;
+                    if (rank >= 2 && !(occupied >> back & 1)) {
+                        tryFrom(back);
+                        if (rank == 3 && geometry.rows > 4 && !(occupied >> (back - step) & 1)) tryFrom(back - step);
+                    }
+                    break;
+                }
+                default: {
+                    int firstDirection = slotTypes[slot] == PieceType::BISHOP ? 4 : 0;
+                    int lastDirection = slotTypes[slot] == PieceType::ROOK ? 4 : 8;
+                    for (int d = firstDirection; d < lastDirection; ++d) {
+                        for (int from : geometry.rays[static_cast<std::size_t>(to) * 8 + d]) {
+                            if (occupied >> from & 1) break;
+                            tryFrom(from);
+                        }
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    // Result of a capture or promotion, looked up in the smaller tables
+    void scoreConversion(const Placement& after, PieceType promotion, Color mover, Conversions& conversions) const {
+        EndgamePosition position;
+        position.dimensions = dims;
+        position.sideToMove = opposite(mover);
+        for (int i = 0; i < slots; ++i) {
+            if (after.squares[i] < 0) continue;
+            PieceType type = slotTypes[i];
+            if (type == PieceType::PAWN && promotion != PieceType::EMPTY && geometry.relativeRank(after.squares[i], slotColors[i]) == geometry.rows - 1) {
+                type = promotion;
+            }
+            position.pieces.push_back({type, slotColors[i], after.squares[i]});
+        }
+
+        EndgameResult reply;
+        if (position.pieces.size() == 2) {
+            conversions.draw = true;
+            return;
+        }
+        auto table = smallerTables.find(EndgameMaterial::of(position).getKey());
+        if (table == smallerTables.end() || !table->second->probe(position, reply)) {
+            throw std::runtime_error("Lookup in a smaller table failed for " + material.getName());
+        }
+        // WDL-only tables have no distances; any odd/even value keeps the result right
+        if (reply.wdl == Wdl::LOSS) {
+            int plies = (reply.matePlies >= 0 ? reply.matePlies : 0) + 1;
+            if (conversions.bestWin < 0 || plies < conversions.bestWin) conversions.bestWin = plies;
+        } else if (reply.wdl == Wdl::WIN) {
+            int plies = (reply.matePlies >= 0 ? reply.matePlies : 1) + 1;
+            conversions.longestLoss = std::max(conversions.longestLoss, plies);
+        } else {
+            conversions.draw = true;
+        }
+    }
+
+    // A decoded index is a position if it encodes back to itself (one
+    // representative per symmetry and per order of identical pieces), no two
+    // pieces share a square, no pawn stands on a back rank and the side not to
+    // move is not in check
+    bool isLegal(const int* squares, std::uint64_t positionIndex, Color sideToMove) const {
+        for (int i = 0; i < slots; ++i) {
+            for (int j = i + 1; j < slots; ++j) {
+                if (squares[i] == squares[j]) return false;
+            }
+            if (slotTypes[i] == PieceType::PAWN) {
+                int rank = squares[i] / geometry.cols;
+                if (rank == 0 || rank == geometry.rows - 1) return false;
+            }
+        }
+        return index.encode(squares) == positionIndex && !inCheck(squares, opposite(sideToMove));
+    }
+
+    void initialize(Color side, std::uint64_t positionIndex) {
+        int s = static_cast<int>(side);
+        Placement placement;
+        if (!index.decode(positionIndex, placement.squares) || !isLegal(placement.squares, positionIndex, side)) {
+            values[s][positionIndex].store(BROKEN, std::memory_order_relaxed);
+            return;
+        }
+
+        std::uint64_t successors[MAX_MOVES];
+        int successorCount = 0;
+        int legalMoves = 0;
+        Conversions conversions;
+        forEachMove(placement.squares, side, [&](const Placement& after, bool conversion, PieceType promotion) {
+            ++legalMoves;
+            if (conversion) {
+                scoreConversion(after, promotion, side, conversions);
+            } else if (successorCount < MAX_MOVES) {
+                successors[successorCount++] = index.encode(after.squares);
+            }
+        });
+        // Moves to positions with the same index are one move for the counting below
+        std::sort(successors, successors + successorCount);
+        int distinct = static_cast<int>(std::unique(successors, successors + successorCount) - successors);
+        remaining[s][positionIndex].store(static_cast<std::uint8_t>(std::min(distinct, 255)), std::memory_order_relaxed);
+
+        std::uint16_t code = UNKNOWN;
+        if (legalMoves == 0) {
+            if (inCheck(placement.squares, side)) code = codeOf(0); // Checkmated; stalemate stays a draw
+        } else if (conversions.bestWin >= 0) {
+            code = codeOf(conversions.bestWin); // Provisional: a faster win may be found in the table
+        } else if (distinct == 0 && !conversions.draw) {
+            code = codeOf(conversions.longestLoss); // Every move converts into a loss
+        }
+        if (code != UNKNOWN) {
+            values[s][positionIndex].store(code, std::memory_order_relaxed);
+            raiseLongest(code);
+        }
+    }
+
+    // 'positionIndex' of 'side' is resolved in 'plies'; passes that on to its predecessors
+    void propagate(Color side, std::uint64_t positionIndex, int plies) {
+        Placement placement;
+        index.decode(positionIndex, placement.squares);
+        Color mover = opposite(side);
+        int m = static_cast<int>(mover);
+
+        std::uint64_t predecessors[MAX_MOVES];
+        int count = 0;
+        forEachUnmove(placement.squares, mover, [&](const Placement& before) {
+            std::uint64_t beforeIndex = index.encode(before.squares);
+            if (beforeIndex != EndgameIndex::INVALID && count < MAX_MOVES) predecessors[count++] = beforeIndex;
+        });
+        std::sort(predecessors, predecessors + count);
+        count = static_cast<int>(std::unique(predecessors, predecessors + count) - predecessors);
+
+        for (int i = 0; i < count; ++i) {
+            std::atomic<std::uint16_t>& value = values[m][predecessors[i]];
+            if (plies % 2 == 0) {
+                // Lost here: the predecessor wins by moving here, unless it already wins faster
+                std::uint16_t win = codeOf(plies + 1);
+                std::uint16_t current = value.load(std::memory_order_relaxed);
+                while (current == UNKNOWN || (isWinCode(current) && current > win)) {
+                    if (value.compare_exchange_weak(current, win, std::memory_order_relaxed)) {
+                        raiseLongest(win);
+                        break;
+                    }
+                }
+            } else {
+                // Won here: one move fewer for the predecessor to escape with
+                if (value.load(std::memory_order_relaxed) != UNKNOWN) continue;
+                if (remaining[m][predecessors[i]].fetch_sub(1, std::memory_order_relaxed) == 1) {
+                    resolveLoss(mover, predecessors[i], plies + 1);
+                }
+            }
+        }
+    }
+
+    // Every move within the table of 'positionIndex' loses, the slowest in
+    // 'plies'; its conversions decide whether it is lost or drawn
+    void resolveLoss(Color side, std::uint64_t positionIndex, int plies) {
+        Placement placement;
+        index.decode(positionIndex, placement.squares);
+        Conversions conversions;
+        forEachMove(placement.squares, side, [&](const Placement& after, bool conversion, PieceType promotion) {
+            if (conversion) scoreConversion(after, promotion, side, conversions);
+        });
+        if (conversions.draw) return;
+        std::uint16_t code = codeOf(std::max(plies, conversions.longestLoss));
+        values[static_cast<int>(side)][positionIndex].store(code, std::memory_order_relaxed);
+        raiseLongest(code);
+    }
+
+    void raiseLongest(std::uint16_t code) {
+        int current = longestCode.load(std::memory_order_relaxed);
+        while (code > current && !longestCode.compare_exchange_weak(current, code, std::memory_order_relaxed)) {
+        }
+    }
+
+    void write(const std::string& path) {
+        int bits = 2;
+        if (!wdlOnly) {
+            bits = 1;
+            while ((1 << bits) <= longestCode.load()) ++bits;
+        }
+        std::size_t sideBytes = endgameTableSideBytes(index.size(), bits);
+
+        EndgameTableHeader header{};
+        std::copy(ENDGAME_TABLE_MAGIC, ENDGAME_TABLE_MAGIC + sizeof(header.magic), header.magic);
+        header.version = ENDGAME_TABLE_VERSION;
+        header.rows = static_cast<std::uint8_t>(dims.rows);
+        header.cols = static_cast<std::uint8_t>(dims.cols);
+        header.format = static_cast<std::uint8_t>(wdlOnly ? EndgameTableFormat::WDL : EndgameTableFormat::DTM);
+        header.bitsPerEntry = static_cast<std::uint8_t>(bits);
+        std::string name = material.getName();
+        std::copy(name.begin(), name.end(), header.material);
+        header.entriesPerSide = index.size();
+        header.longestMate = wdlOnly ? 0 : static_cast<std::uint32_t>(getLongestMate());
+
+        // Written under a temporary name, so an interrupted run leaves no table behind
+        std::string temporary = path + ".tmp";
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out) throw std::runtime_error("Cannot write " + temporary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (int side = 0; side < 2; ++side) {
+            std::vector<std::uint64_t> words(sideBytes / 8, 0);
+            for (std::uint64_t i = 0; i < index.size(); ++i) {
+                std::uint16_t code = values[side][i].load(std::memory_order_relaxed);
+                std::uint64_t entry = 0;
+                if (code == BROKEN || code == UNKNOWN) {
+                    if (code == UNKNOWN) ++stats.draws[side];
+                } else {
+                    bool win = isWinCode(code);
+                    ++(win ? stats.wins[side] : stats.losses[side]);
+                    entry = wdlOnly ? (win ? 1 : 2) : code;
+                }
+                std::uint64_t bit = i * bits;
+                words[bit / 64] |= entry << (bit % 64);
+                if (bit % 64 + bits > 64) words[bit / 64 + 1] |= entry >> (64 - bit % 64);
+            }
+            out.write(reinterpret_cast<const char*>(words.data()), static_cast<std::streamsize>(sideBytes));
+        }
+        out.close();
+        if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) throw std::runtime_error("Cannot write " + path);
+    }
+
+    EndgameMaterial material;
+    BoardDimensions dims;
+    Geometry geometry;
+    EndgameIndex index;
+    int slots;
+    PieceType slotTypes[ENDGAME_MAX_PIECES];
+    Color slotColors[ENDGAME_MAX_PIECES];
+    bool wdlOnly;
+    ThreadPool& pool;
+    std::unordered_map<std::uint64_t, const EndgameTable*> smallerTables;
+
+    std::vector<std::atomic<std::uint16_t>> values[2];    // Entry codes by side to move
+    std::vector<std::atomic<std::uint8_t>> remaining[2];  // Moves within the table not yet known to lose
+    std::atomic<int> longestCode;
+    ResultCounts stats;
+};
+
+// Tables 'material' converts into, canonical and with at least one piece besides the kings
+std::vector<EndgameMaterial> dependencies(const EndgameMaterial& material) {
+    std::vector<EndgameMaterial> result;
+    std::set<std::string> seen;
+    for (const EndgameMaterial& target : conversionTargets(material)) {
+        if (target.getPieceCount() == 2) continue;
+        EndgameMaterial canonical = target.isCanonical() ? target : target.swapped();
+        if (seen.insert(canonical.getName()).second) result.push_back(canonical);
+    }
+    return result;
+}
+
+// Every canonical material of exactly 'pieces' pieces
+std::vector<EndgameMaterial> allMaterials(int pieces) {
+    std::vector<std::string> sides[ENDGAME_MAX_PIECES - 1]; // Piece strings by length
+    sides[0].push_back("");
+    const std::string order = "QRBNP";
+    for (int length = 1; length < ENDGAME_MAX_PIECES - 1; ++length) {
+        for (const std::string& shorter : sides[length - 1]) {
+            std::size_t from = shorter.empty() ? 0 : order.find(shorter.back());
+            for (std::size_t p = from; p < order.size(); ++p) sides[length].push_back(shorter + order[p]);
+        }
+    }
+    std::vector<EndgameMaterial> result;
+    std::set<std::string> seen;
+    for (int white = 0; white <= pieces - 2; ++white) {
+        for (const std::string& w : sides[white]) {
+            for (const std::string& b : sides[pieces - 2 - white]) {
+                EndgameMaterial material = EndgameMaterial::parse("K" + w + "vK" + b);
+                if (material.isCanonical() && seen.insert(material.getName()).second) result.push_back(material);
+            }
+        }
+    }
+    return result;
+}
+
+struct Options {
+    std::string outDir = ".";
+    BoardDimensions dims;
+    bool wdlOnly = false;
+    bool force = false;
+    std::string syzygyDir; // Set by --check-syzygy
+};
+
+bool tableExists(const Options& options, const EndgameMaterial& material) {
+    return std::ifstream(options.outDir + "/" + endgameTableFileName(material, options.dims)).good();
+}
+
+// Builds 'material' after the tables it depends on
+void build(const EndgameMaterial& material, const Options& options, bool requested, ThreadPool& pool, std::set<std::string>& done) {
+    if (!done.insert(material.getName()).second) return;
+    if (tableExists(options, material) && !(requested && options.force)) return;
+    for (const EndgameMaterial& dependency : dependencies(material)) build(dependency, options, false, pool, done);
+
+    auto start = std::chrono::steady_clock::now();
+    EndgameTablebase smaller(options.outDir); // Opened afresh so it sees the tables just written
+    TableGenerator generator(material, options.dims, smaller, options.wdlOnly, pool);
+    std::string path = options.outDir + "/" + endgameTableFileName(material, options.dims);
+    generator.generate(path);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const ResultCounts& stats = generator.getStats();
+    std::cout << material.getName() << ": " << generator.getEntriesPerSide() << " entries per side";
+    if (!options.wdlOnly) std::cout << ", longest mate " << generator.getLongestMate() << " plies";
+    std::cout << ", " << seconds << " s\n";
+    for (int side = 0; side < 2; ++side) {
+        std::cout << "  " << (side == 0 ? "White" : "Black") << " to move: " << stats.wins[side] << " won, "
+                  << stats.draws[side] << " drawn, " << stats.losses[side] << " lost" << std::endl;
+    }
+}
+
+// --- Cross-check against Syzygy tables ---
+
+char pieceLetter(PieceType type, Color color) {
+    char letter = 'k';
+    switch (type) {
+        case PieceType::PAWN: letter = 'p'; break;
+        case PieceType::ROOK: letter = 'r'; break;
+        case PieceType::KNIGHT: letter = 'n'; break;
+        case PieceType::BISHOP: letter = 'b'; break;
+        case PieceType::QUEEN: letter = 'q'; break;
+        default: break;
+    }
+    return color == Color::WHITE ? static_cast<char>(letter - 'a' + 'A') : letter;
+}
+
+// FEN of decoded table squares on the standard board (see EndgameIndex::encode
+// for their order); empty if two pieces share a square or a pawn is on a back rank
+std::string positionFen(const EndgameMaterial& material, const int* squares, Color sideToMove) {
+    std::string grid(64, '.');
+    std::vector<std::pair<PieceType, Color>> pieces = {{PieceType::KING, Color::WHITE}, {PieceType::KING, Color::BLACK}};
+    for (Color color : {Color::WHITE, Color::BLACK}) {
+        for (PieceType type : material.getPieces(color)) pieces.push_back({type, color});
+    }
+    for (std::size_t i = 0; i < pieces.size(); ++i) {
+        int square = squares[i];
+        if (grid[square] != '.') return "";
+        if (pieces[i].first == PieceType::PAWN && (square < 8 || square >= 56)) return "";
+        grid[square] = pieceLetter(pieces[i].first, pieces[i].second);
+    }
+    std::string fen;
+    for (int rank = 7; rank >= 0; --rank) {
+        int empty = 0;
+        for (int file = 0; file < 8; ++file) {
+            char c = grid[rank * 8 + file];
+            if (c == '.') {
+                ++empty;
+                continue;
+            }
+            if (empty > 0) fen += static_cast<char>('0' + empty);
+            empty = 0;
+            fen += c;
+        }
+        if (empty > 0) fen += static_cast<char>('0' + empty);
+        if (rank > 0) fen += '/';
+    }
+    return fen + (sideToMove == Color::WHITE ? " w - - 0 1" : " b - - 0 1");
+}
+
+// Our tables ignore the 50-move rule, so cursed wins and blessed losses count as won and lost
+Wdl withoutFiftyMoveRule(Wdl wdl) {
+    if (wdl == Wdl::CURSED_WIN) return Wdl::WIN;
+    if (wdl == Wdl::BLESSED_LOSS) return Wdl::LOSS;
+    return wdl;
+}
+
+// Whether a Syzygy DTZ fits a result with 'matePlies' to mate (-1: unknown).
+// The sign must match the result. With a bare losing king and no pawns the
+// only zeroing move of a won line is the mate, so DTZ counts the plies to
+// mate, except that a mated side has -1 and tables storing moves instead of
+// plies may round up by one.
+bool dtzFits(int dtz, Wdl wdl, int matePlies, bool countsToMate) {
+    if (wdl == Wdl::DRAW) return dtz == 0;
+    if ((dtz > 0) != (wdl == Wdl::WIN) || dtz == 0) return false;
+    if (!countsToMate || matePlies < 0) return true;
+    int expected = std::max(1, matePlies);
+    return std::abs(dtz) == expected || std::abs(dtz) == expected + 1;
+}
+
+const char* wdlName(Wdl wdl) {
+    switch (wdl) {
+        case Wdl::LOSS: return "loss";
+        case Wdl::BLESSED_LOSS: return "blessed loss";
+        case Wdl::CURSED_WIN: return "cursed win";
+        case Wdl::WIN: return "win";
+        default: return "draw";
+    }
+}
+
+// Positions whose result is known without any table
+struct KnownPosition {
+    const char* material;
+    const char* fen;
+    Wdl wdl;
+    int matePlies; // 0: mated; -1 for draws
+};
+
+const KnownPosition KNOWN_POSITIONS[] = {
+    {"KQvK", "4k3/8/4K3/8/8/8/8/7Q w - - 0 1", Wdl::WIN, 1},   // Qh8 mate
+    {"KQvK", "4k3/4Q3/4K3/8/8/8/8/8 b - - 0 1", Wdl::LOSS, 0}, // Mated
+    {"KQvK", "k7/2Q5/1K6/8/8/8/8/8 b - - 0 1", Wdl::DRAW, -1}, // Stalemate
+    {"KQvK", "7K/8/8/8/8/8/1kQ5/8 b - - 0 1", Wdl::DRAW, -1},  // Kxc2
+    {"KRvK", "4k3/8/4K3/8/8/8/8/7R w - - 0 1", Wdl::WIN, 1},   // Rh8 mate
+    {"KRvK", "k7/8/1K6/8/8/8/8/7R b - - 0 1", Wdl::LOSS, 2},   // Kb8 Rh8 mate
+    {"KRvK", "K7/8/8/8/8/8/1k6/2R5 b - - 0 1", Wdl::DRAW, -1}, // Kxc1
+    {"KRvK", "K7/8/8/8/8/8/1k6/2R5 w - - 0 1", Wdl::WIN, -1},  // The rook escapes
+};
+
+// Probes one position both ways and reports a disagreement; false if there was one.
+// Throws std::runtime_error if the position cannot be probed at all.
+bool checkPosition(const SyzygyTablebase& syzygy, const std::string& fen, Wdl wdl, int matePlies, bool countsToMate) {
+    Board board;
+    board.initializeCustomSetup(fen);
+    Color sideToMove = fen.find(" w ") != std::string::npos ? Color::WHITE : Color::BLACK;
+    Wdl probed;
+    int dtz;
+    if (!syzygy.probeWdl(board, sideToMove, probed) || !syzygy.probeDtz(board, sideToMove, dtz)) {
+        throw std::runtime_error("Cannot probe " + fen + " (missing or corrupt .rtbw/.rtbz table?)");
+    }
+    if (withoutFiftyMoveRule(probed) == wdl && dtzFits(dtz, wdl, matePlies, countsToMate)) return true;
+    std::cerr << "  " << fen << ": Syzygy says " << wdlName(probed) << " with DTZ " << dtz << ", expected " << wdlName(wdl);
+    if (matePlies >= 0) std::cerr << " (mate in " << matePlies << " plies)";
+    std::cerr << std::endl;
+    return false;
+}
+
+// Checks every legal position of 'material' against our table; returns the number of disagreements
+std::uint64_t checkSyzygyTable(const EndgameMaterial& material, const EndgameTable& table, const SyzygyTablebase& syzygy) {
+    const EndgameIndex& index = table.getIndex();
+    bool countsToMate = material.getPieceCount() == 3 && !material.hasPawns();
+    std::vector<int> squares(index.getSlotCount());
+    std::uint64_t checked = 0;
+    std::uint64_t failures = 0;
+    for (Color sideToMove : {Color::WHITE, Color::BLACK}) {
+        Color opponent = opposite(sideToMove);
+        for (std::uint64_t i = 0; i < index.size(); ++i) {
+            if (!index.decode(i, squares.data()) || index.encode(squares.data()) != i) continue;
+            std::string fen = positionFen(material, squares.data(), sideToMove);
+            if (fen.empty()) continue;
+            Board board;
+            board.initializeCustomSetup(fen);
+            if (board.isSquareAttacked(board.findKing(opponent), sideToMove)) continue; // Not a legal position
+
+            EndgamePosition position;
+            EndgameResult expected;
+            if (!EndgamePosition::fromBoard(board, sideToMove, position) || !table.probe(position, expected)) continue;
+            ++checked;
+            if (!checkPosition(syzygy, fen, expected.wdl, expected.matePlies, countsToMate) && ++failures >= 20) {
+                std::cerr << "  Giving up after 20 disagreements" << std::endl;
+                return failures;
+            }
+        }
+    }
+    std::cout << material.getName() << ": " << checked << " positions agree on WDL and DTZ"
+              << (countsToMate ? " (DTZ against mate distance)" : " (DTZ sign only)") << std::endl;
+    return failures;
+}
+
+int checkSyzygy(std::vector<EndgameMaterial> materials, const Options& options, ThreadPool& pool) {
+    if (options.dims.rows != 8 || options.dims.cols != 8) {
+        std::cerr << "Error: Syzygy tables exist for the standard board only" << std::endl;
+        return 1;
+    }
+    SyzygyTablebase syzygy(options.syzygyDir);
+    if (syzygy.getTableCount() == 0) {
+        std::cerr << "Error: no Syzygy tables in " << options.syzygyDir << std::endl;
+        return 1;
+    }
+    if (materials.empty()) materials = {EndgameMaterial::parse("KQvK"), EndgameMaterial::parse("KRvK")};
+
+    std::uint64_t failures = 0;
+    std::set<std::string> done;
+    for (const EndgameMaterial& material : materials) {
+        build(material, options, false, pool, done);
+        EndgameTablebase ours(options.outDir);
+        const EndgameTable* table = ours.findTable(material, options.dims);
+        if (!table) throw std::runtime_error("No table " + material.getName() + " in " + options.outDir);
+
+        for (const KnownPosition& known : KNOWN_POSITIONS) {
+            if (material.getName() != known.material) continue;
+            if (!checkPosition(syzygy, known.fen, known.wdl, known.matePlies, true)) ++failures;
+        }
+        failures += checkSyzygyTable(material, *table, syzygy);
+    }
+    if (failures > 0) {
+        std::cerr << failures << " disagreements with the Syzygy tables" << std::endl;
+        return 1;
+    }
+    std::cout << "Syzygy probing agrees with the generated tables" << std::endl;
+    return 0;
+}
+
+void printUsage() {
+    std::cerr << "Usage: tbgen <MATERIAL...> [--all N] [--out DIR] [--size RxC] [--threads N] [--wdl] [--force]\n"
+              << "       tbgen --check-syzygy DIR [MATERIAL...] [--out DIR]\n"
+              << "       MATERIAL is e.g. KQvK or KRvKP (at most " << ENDGAME_MAX_PIECES << " pieces)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    std::vector<EndgameMaterial> requested;
+    int threads = 0;
+
+    try {
+        int all = 0;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) throw std::invalid_argument("Missing value for " + arg);
+                return argv[++i];
+            };
+            if (arg == "--all") all = std::stoi(value());
+            else if (arg == "--out") options.outDir = value();
+            else if (arg == "--threads") threads = std::stoi(value());
+            else if (arg == "--wdl") options.wdlOnly = true;
+            else if (arg == "--force") options.force = true;
+            else if (arg == "--check-syzygy") options.syzygyDir = value();
+            else if (arg == "--size") {
+                std::string size = value();
+                std::size_t x = size.find('x');
+                if (x == std::string::npos) throw std::invalid_argument("--size takes ROWSxCOLS, e.g. 6x6");
+                options.dims.rows = std::stoi(size.substr(0, x));
+                options.dims.cols = std::stoi(size.substr(x + 1));
+                if (options.dims.rows < 2 || options.dims.cols < 2 || options.dims.rows * options.dims.cols > 64) {
+                    throw std::invalid_argument("Boards must have 2 to 64 squares per side and at most 64 in total");
+                }
+            } else if (!arg.empty() && arg[0] == '-') {
+                throw std::invalid_argument("Unknown option " + arg);
+            } else {
+                EndgameMaterial material = EndgameMaterial::parse(arg);
+                if (material.getPieceCount() < 3) throw std::invalid_argument("Bare kings need no table");
+                requested.push_back(material.isCanonical() ? material : material.swapped());
+            }
+        }
+        if (all > ENDGAME_MAX_PIECES) throw std::invalid_argument("--all takes at most " + std::to_string(ENDGAME_MAX_PIECES));
+        for (int pieces = 3; pieces <= all; ++pieces) {
+            for (const EndgameMaterial& material : allMaterials(pieces)) requested.push_back(material);
+        }
+        if (requested.empty() && options.syzygyDir.empty()) throw std::invalid_argument("No material given");
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    // The output directory is created up front, so a bad path fails before any work
+    try {
+        std::filesystem::create_directories(options.outDir);
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Error: cannot create output directory " << options.outDir << ": " << e.code().message() << std::endl;
+        return 1;
+    }
+
+    ThreadPool pool(threads);
+    if (!options.syzygyDir.empty()) {
+        try {
+            return checkSyzygy(requested, options, pool);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Generating into " << options.outDir << " with " << pool.size() << " threads" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    try {
+        std::set<std::string> done;
+        for (const EndgameMaterial& material : requested) build(material, options, true, pool, done);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Total time: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+    return 0;
+}
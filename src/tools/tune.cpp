@@ -0,0 +1,357 @@
+// Texel tuner for the classical evaluation weights.
+//
+// Usage: tune <dataset> [--out FILE] [--init FILE] [--epochs N] [--lr X] [--threads N]
+//
+// Each dataset line holds a FEN/EPD position and the game result, either as
+// a PGN result token ("1-0", "0-1", "1/2-1/2", optionally quoted, e.g.
+// 'c9 "1-0";') or as a bracketed score from White's side ("[1.0]", "[0.5]").
+// A packed position file with result trailers (as written by `datagen`) is
+// read directly instead; records without a known result are skipped.
+//
+// Positions are parsed straight into PackedPosition records and run through
+// the batch evaluator's feature kernels once. Because the evaluation is
+// linear in its terms, every position then reduces to a few numbers per
+// tunable weight, and each optimisation epoch is a pass over that compact
+// array. The logistic loss
+//     E = mean (result - sigmoid(K * eval))^2
+// is minimised with Adam; the loss and gradient are summed across threads.
+// The scaling constant K is fitted to the starting weights first and held fixed.
+
+#include "ai/EvaluationEngine.h"
+#include "ai/BatchEvaluation.h"
+#include "ai/EvalWeights.h"
+#include "core/EpdLoader.h"
+#include "core/PackedPosition.h"
+#include "core/PackedPositionFile.h"
+#include "util/ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// One training position reduced to the raw term each weight multiplies
+struct TunerSample {
+    float material;       // sum of PIECE_VALUES * piece count difference
+    float centerControl;  // sum of ring value * pieces per ring difference
+    float mobility;
+    float kingSafety;     // minus the king danger difference
+    std::int8_t pawnSupported;
+    std::int8_t pawnUnsupported;
+    std::int8_t doubledPawns;
+    std::int8_t tripledPawns;
+    float result;         // 1 = White won, 0.5 = draw, 0 = Black won
+};
+
+struct TunerOptions {
+    std::string datasetPath;
+    std::string outputPath = DEFAULT_WEIGHTS_FILE;
+    std::string initialWeightsPath;
+    int epochs = 300;
+    double learningRate = 0.005;
+    int threads = 0;
+};
+
+int threadCount(int requested) {
+    if (requested > 0) return requested;
+    return static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+}
+
+// Pending positions of one loader thread, flushed through the feature kernels in blocks
+class SampleBuilder {
+public:
+    explicit SampleBuilder(std::vector<TunerSample>& out)
+        : out(out), block(std::make_unique<PositionBlock>()), features(std::make_unique<FeatureBlock>()) {}
+
+    void add(const PackedPosition& position, float result) {
+        positions[pending] = position;
+        results[pending] = result;
+        if (++pending == BATCH_BLOCK_SIZE) flush();
+    }
+
+    void flush() {
+        if (pending == 0) return;
+        unpackPositionBlock(positions, pending, *block);
+        computeEvalFeatures(*block, *features);
+
+        const auto& f = features->values;
+        for (int i = 0; i < pending; ++i) {
+            TunerSample sample;
+            sample.material = 0.0f;
+            for (int t = 0; t < 6; ++t) {
+                sample.material += PIECE_VALUES[t] * f[EVAL_PAWNS + t][i];
+            }
+            sample.centerControl = 0.0f;
+            for (int k = 0; k < CENTER_RING_COUNT; ++k) {
+                sample.centerControl += CENTER_RING_VALUES[k] * f[EVAL_CENTER_RING + k][i];
+            }
+            sample.mobility = f[EVAL_MOBILITY][i];
+            sample.kingSafety = -f[EVAL_KING_DANGER][i];
+            sample.pawnSupported = static_cast<std::int8_t>(f[EVAL_PAWN_SUPPORTED][i]);
+            sample.pawnUnsupported = static_cast<std::int8_t>(f[EVAL_PAWN_UNSUPPORTED][i]);
+            sample.doubledPawns = static_cast<std::int8_t>(f[EVAL_DOUBLED_PAWNS][i]);
+            sample.tripledPawns = static_cast<std::int8_t>(f[EVAL_TRIPLED_PAWNS][i]);
+            sample.result = results[i];
+            out.push_back(sample);
+        }
+        pending = 0;
+    }
+
+private:
+    std::vector<TunerSample>& out;
+    std::unique_ptr<PositionBlock> block;
+    std::unique_ptr<FeatureBlock> features;
+    PackedPosition positions[BATCH_BLOCK_SIZE];
+    float results[BATCH_BLOCK_SIZE];
+    int pending = 0;
+};
+
+// Reads a packed position file into the same shape as an EPD dataset
+EpdDataset loadPackedFile(const std::string& path) {
+    PackedPositionReader reader(path);
+    EpdDataset dataset;
+    dataset.positions.reserve(reader.size());
+    dataset.results.reserve(reader.size());
+    for (std::size_t i = 0; i < reader.size(); ++i) {
+        PackedSample sample = reader.sample(i);
+        float result = EPD_NO_RESULT;
+        if (sample.result == PACKED_RESULT_WHITE_WIN) result = 1.0f;
+        else if (sample.result == PACKED_RESULT_DRAW) result = 0.5f;
+        else if (sample.result == PACKED_RESULT_BLACK_WIN) result = 0.0f;
+        dataset.positions.push_back(sample.position);
+        dataset.results.push_back(result);
+    }
+    return dataset;
+}
+
+// Loads the dataset and reduces its labelled positions to samples, one slice per thread
+std::vector<TunerSample> loadDataset(const std::string& path, ThreadPool& pool) {
+    EpdDataset dataset = PackedPositionReader::isPackedFile(path) ? loadPackedFile(path) : loadEpdFile(path, pool.size());
+
+    std::size_t labelled = 0;
+    for (std::size_t i = 0; i < dataset.positions.size(); ++i) {
+        if (dataset.results[i] == EPD_NO_RESULT) continue;
+        dataset.positions[labelled] = dataset.positions[i];
+        dataset.results[labelled] = dataset.results[i];
+        ++labelled;
+    }
+    std::size_t skipped = dataset.skippedLines + (dataset.positions.size() - labelled);
+
+    std::size_t sliceCount = static_cast<std::size_t>(pool.size());
+    std::vector<std::vector<TunerSample>> parts(sliceCount);
+    pool.parallelFor(sliceCount, [&](std::size_t t) {
+        std::size_t begin = labelled * t / sliceCount;
+        std::size_t end = labelled * (t + 1) / sliceCount;
+        parts[t].reserve(end - begin);
+        SampleBuilder builder(parts[t]);
+        for (std::size_t i = begin; i < end; ++i) {
+            builder.add(dataset.positions[i], dataset.results[i]);
+        }
+        builder.flush();
+    });
+
+    std::vector<TunerSample> samples;
+    samples.reserve(labelled);
+    for (std::vector<TunerSample>& part : parts) {
+        samples.insert(samples.end(), part.begin(), part.end());
+        std::vector<TunerSample>().swap(part);
+    }
+    if (skipped > 0) {
+        std::cerr << "Skipped " << skipped << " lines without a position or result." << std::endl;
+    }
+    return samples;
+}
+
+// Derivative of the evaluation with respect to each EvalWeights entry
+inline void termGradient(const TunerSample& s, const EvalWeights& w, double grad[EvalWeights::COUNT]) {
+    double pawnTerms = w.pawnSupportBonus * s.pawnSupported - w.pawnUnsupportedPenalty * s.pawnUnsupported -
+                       w.doubledPawnPenalty * s.doubledPawns - w.tripledPawnPenalty * s.tripledPawns;
+    grad[0] = s.material;
+    grad[1] = s.mobility;
+    grad[2] = s.kingSafety;
+    grad[3] = pawnTerms;
+    grad[4] = s.centerControl;
+    grad[5] = w.pawnStructure * s.pawnSupported;
+    grad[6] = -w.pawnStructure * s.pawnUnsupported;
+    grad[7] = -w.pawnStructure * s.doubledPawns;
+    grad[8] = -w.pawnStructure * s.tripledPawns;
+}
+
+// Evaluation in pawns from White's side, as staticEvaluate(board, WHITE)
+inline double evaluateSample(const TunerSample& s, const EvalWeights& w) {
+    double pawnTerms = w.pawnSupportBonus * s.pawnSupported - w.pawnUnsupportedPenalty * s.pawnUnsupported -
+                       w.doubledPawnPenalty * s.doubledPawns - w.tripledPawnPenalty * s.tripledPawns;
+    return w.material * s.material + w.mobility * s.mobility + w.kingSafety * s.kingSafety +
+           w.pawnStructure * pawnTerms + w.centerControl * s.centerControl;
+}
+
+inline double sigmoid(double k, double eval) {
+    return 1.0 / (1.0 + std::exp(-k * eval));
+}
+
+struct LossResult {
+    double loss = 0.0;
+    double gradient[EvalWeights::COUNT] = {};
+};
+
+void lossRange(const TunerSample* samples, std::size_t count, const EvalWeights& w, double k, bool withGradient,
+               LossResult& out) {
+    double termGrad[EvalWeights::COUNT];
+    for (std::size_t i = 0; i < count; ++i) {
+        const TunerSample& s = samples[i];
+        double p = sigmoid(k, evaluateSample(s, w));
+        double error = s.result - p;
+        out.loss += error * error;
+        if (!withGradient) continue;
+        // dE/deval = -2 * error * p * (1 - p) * k
+        double scale = -2.0 * error * p * (1.0 - p) * k;
+        termGradient(s, w, termGrad);
+        for (int j = 0; j < EvalWeights::COUNT; ++j) {
+            out.gradient[j] += scale * termGrad[j];
+        }
+    }
+}
+
+// Mean loss (and gradient) over all samples, one contiguous slice per thread.
+// The pool lives for the whole run: fitting K and the epochs call this
+// hundreds of times, too often to start threads on every call.
+LossResult computeLoss(const std::vector<TunerSample>& samples, const EvalWeights& w, double k, bool withGradient,
+                       ThreadPool& pool) {
+    std::size_t sliceCount = static_cast<std::size_t>(pool.size());
+    std::vector<LossResult> partial(sliceCount);
+    pool.parallelFor(sliceCount, [&](std::size_t t) {
+        std::size_t begin = samples.size() * t / sliceCount;
+        std::size_t end = samples.size() * (t + 1) / sliceCount;
+        lossRange(samples.data() + begin, end - begin, w, k, withGradient, partial[t]);
+    });
+
+    LossResult total;
+    for (const LossResult& part : partial) {
+        total.loss += part.loss;
+        for (int j = 0; j < EvalWeights::COUNT; ++j) {
+            total.gradient[j] += part.gradient[j];
+        }
+    }
+    double n = static_cast<double>(std::max<std::size_t>(1, samples.size()));
+    total.loss /= n;
+    for (double& g : total.gradient) {
+        g /= n;
+    }
+    return total;
+}
+
+// Golden-section search for the K that best fits the starting weights
+double fitScalingConstant(const std::vector<TunerSample>& samples, const EvalWeights& w, ThreadPool& pool) {
+    const double ratio = (std::sqrt(5.0) - 1.0) / 2.0;
+    double lo = 0.01;
+    double hi = 10.0;
+    for (int iteration = 0; iteration < 40; ++iteration) {
+        double a = hi - ratio * (hi - lo);
+        double b = lo + ratio * (hi - lo);
+        if (computeLoss(samples, w, a, false, pool).loss < computeLoss(samples, w, b, false, pool).loss) {
+            hi = b;
+        } else {
+            lo = a;
+        }
+    }
+    return (lo + hi) / 2.0;
+}
+
+void printWeights(const EvalWeights& w) {
+    for (int i = 0; i < EvalWeights::COUNT; ++i) {
+        std::cout << "  " << EvalWeights::name(i) << " = " << w[i] << std::endl;
+    }
+}
+
+bool parseOptions(int argc, char* argv[], TunerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--out" && hasValue) options.outputPath = argv[++i];
+        else if (arg == "--init" && hasValue) options.initialWeightsPath = argv[++i];
+        else if (arg == "--epochs" && hasValue) options.epochs = std::stoi(argv[++i]);
+        else if (arg == "--lr" && hasValue) options.learningRate = std::stod(argv[++i]);
+        else if (arg == "--threads" && hasValue) options.threads = std::stoi(argv[++i]);
+        else if (!arg.empty() && arg[0] != '-' && options.datasetPath.empty()) options.datasetPath = arg;
+        else return false;
+    }
+    return !options.datasetPath.empty();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    TunerOptions options;
+    try {
+        if (!parseOptions(argc, argv, options)) {
+            std::cerr << "Usage: " << argv[0]
+                      << " <dataset.epd> [--out FILE] [--init FILE] [--epochs N] [--lr X] [--threads N]" << std::endl;
+            return 1;
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Invalid numeric option." << std::endl;
+        return 1;
+    }
+    ThreadPool pool(threadCount(options.threads));
+
+    try {
+        EvalWeights weights;
+        if (!options.initialWeightsPath.empty()) {
+            weights.load(options.initialWeightsPath);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<TunerSample> samples = loadDataset(options.datasetPath, pool);
+        double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "Loaded " << samples.size() << " positions in " << loadSeconds << " s ("
+                  << pool.size() << " threads, " << batchEvalSimdName() << ")" << std::endl;
+        if (samples.empty()) {
+            std::cerr << "Dataset contains no usable positions." << std::endl;
+            return 1;
+        }
+
+        double k = fitScalingConstant(samples, weights, pool);
+        double initialLoss = computeLoss(samples, weights, k, false, pool).loss;
+        std::cout << "Fitted K = " << k << ", initial loss = " << initialLoss << std::endl;
+
+        // Adam on the raw weights
+        const double beta1 = 0.9;
+        const double beta2 = 0.999;
+        const double epsilon = 1e-8;
+        double m[EvalWeights::COUNT] = {};
+        double v[EvalWeights::COUNT] = {};
+
+        start = std::chrono::steady_clock::now();
+        for (int epoch = 1; epoch <= options.epochs; ++epoch) {
+            LossResult result = computeLoss(samples, weights, k, true, pool);
+            for (int j = 0; j < EvalWeights::COUNT; ++j) {
+                m[j] = beta1 * m[j] + (1.0 - beta1) * result.gradient[j];
+                v[j] = beta2 * v[j] + (1.0 - beta2) * result.gradient[j] * result.gradient[j];
+                double mHat = m[j] / (1.0 - std::pow(beta1, epoch));
+                double vHat = v[j] / (1.0 - std::pow(beta2, epoch));
+                weights[j] -= static_cast<float>(options.learningRate * mHat / (std::sqrt(vHat) + epsilon));
+            }
+            if (epoch % 10 == 0 || epoch == options.epochs) {
+                std::cout << "Epoch " << epoch << ": loss = " << result.loss << std::endl;
+            }
+        }
+        double tuneSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double finalLoss = computeLoss(samples, weights, k, false, pool).loss;
+        std::cout << "Final loss = " << finalLoss << " (" << options.epochs << " epochs in " << tuneSeconds << " s)" << std::endl;
+        printWeights(weights);
+
+        weights.save(options.outputPath);
+        std::cout << "Weights written to " << options.outputPath << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
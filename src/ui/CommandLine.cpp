@@ -0,0 +1,545 @@
+#include "ui/CommandLine.h"
+#include "core/Game.h"
+#include "core/Notation.h"
+#include "core/Perft.h"
+#include "core/Pgn.h"
+#include "ai/EvaluationEngine.h"
+#include "ai/MctsSearcher.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Fixed workload of the bench command. Changing this list or the default depth
+// changes the signature, so only do it deliberately.
+const std::vector<std::string> BENCH_POSITIONS = {
+    START_FEN,
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "rnbqkb1r/pp3ppp/4pn2/2pp4/3P4/2P1PN2/PP3PPP/RNBQKB1R w KQkq - 0 5",
+    "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1",
+    "8/8/4k3/8/2p5/8/B2K4/8 w - - 0 1",
+};
+const int DEFAULT_BENCH_DEPTH = 4;
+
+// analyze without --depth or --movetime
+const int DEFAULT_ANALYZE_DEPTH = 3;
+
+// "--name value" options, "--flag" switches and positional arguments
+class CommandOptions {
+public:
+    CommandOptions(int argc, char* argv[], int first, const std::set<std::string>& switches) {
+        for (int i = first; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind("--", 0) != 0) {
+                positional.push_back(arg);
+            } else if (switches.count(arg)) {
+                values[arg] = "1";
+            } else if (i + 1 < argc) {
+                values[arg] = argv[++i];
+            } else {
+                throw std::invalid_argument("Missing value for " + arg);
+            }
+        }
+    }
+
+    bool has(const std::string& name) const { return values.count(name) > 0; }
+
+    std::string get(const std::string& name, const std::string& fallback) const {
+        auto it = values.find(name);
+        return it != values.end() ? it->second : fallback;
+    }
+
+    int getInt(const std::string& name, int fallback) const {
+        auto it = values.find(name);
+        if (it == values.end()) return fallback;
+        try {
+            return std::stoi(it->second);
+        } catch (const std::exception&) {
+            throw std::invalid_argument("Bad number for " + name + ": " + it->second);
+        }
+    }
+
+    // Rejects options the command does not know, so typos do not pass silently
+    void allowOnly(const std::set<std::string>& known) const {
+        for (const auto& entry : values) {
+            if (!known.count(entry.first)) throw std::invalid_argument("Unknown option " + entry.first);
+        }
+    }
+
+    std::vector<std::string> positional;
+
+private:
+    std::map<std::string, std::string> values;
+};
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+long long perSecond(std::uint64_t count, double seconds) {
+    return seconds > 0.0 ? static_cast<long long>(count / seconds) : 0;
+}
+
+std::string resolveFen(const std::string& fen) {
+    return (fen.empty() || fen == "startpos") ? START_FEN : fen;
+}
+
+// Engine with the evaluation chosen by --weights / --nnue (built-in defaults
+// otherwise), the opening book given by --book and the tablebases given by
+// --syzygy and --tables, if any
+EvaluationEngine makeEngine(const CommandOptions& options) {
+    EvaluationEngine engine;
+    if (options.has("--weights")) engine.loadWeights(options.get("--weights", ""));
+    if (options.has("--nnue")) engine.loadNetwork(options.get("--nnue", ""));
+    if (options.has("--book")) engine.loadBook(options.get("--book", ""));
+    if (options.has("--syzygy")) engine.loadTablebases(options.get("--syzygy", ""));
+    if (options.has("--tables")) engine.loadEndgameTables(options.get("--tables", ""));
+    return engine;
+}
+
+Game gameFromFen(const std::string& fen) {
+    Game game(PlayerType::AI, PlayerType::AI);
+    game.loadFen(resolveFen(fen));
+    return game;
+}
+
+// FNV-1a over the per-position results, so any change in node counts or best moves shows
+std::uint64_t mixSignature(std::uint64_t signature, const std::string& text) {
+    for (unsigned char ch : text) {
+        signature = (signature ^ ch) * 0x100000001B3ULL;
+    }
+    return signature;
+}
+
+int runBench(const CommandOptions& options) {
+    options.allowOnly({"--depth"});
+    int depth = options.getInt("--depth", DEFAULT_BENCH_DEPTH);
+    if (depth <= 0) throw std::invalid_argument("--depth must be positive");
+
+    EvaluationEngine engine; // Always the built-in weights: the signature must not depend on local files
+    SearchLimits limits;
+    limits.depth = depth;
+
+    std::uint64_t totalNodes = 0;
+    std::uint64_t signature = 0xCBF29CE484222325ULL;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < BENCH_POSITIONS.size(); ++i) {
+        Game game = gameFromFen(BENCH_POSITIONS[i]);
+        EvaluationResult result = engine.analyze(game, limits);
+        totalNodes += static_cast<std::uint64_t>(result.nodesSearched);
+        std::string line = std::to_string(result.nodesSearched) + " " + result.bestMove.toString();
+        signature = mixSignature(signature, line + "\n");
+        std::cout << "Position " << (i + 1) << "/" << BENCH_POSITIONS.size() << ": nodes " << result.nodesSearched
+                  << ", bestmove " << result.bestMove.toString() << std::endl;
+    }
+    double seconds = secondsSince(start);
+
+    std::cout << "===========================" << "\n"
+              << "Depth:          " << depth << "\n"
+              << "Total nodes:    " << totalNodes << "\n"
+              << "Time (ms):      " << static_cast<long long>(seconds * 1000.0) << "\n"
+              << "Nodes/second:   " << perSecond(totalNodes, seconds) << "\n"
+              << "Signature:      " << std::hex << std::setw(16) << std::setfill('0') << signature << std::dec << std::endl;
+    return 0;
+}
+
+int runPerft(const CommandOptions& options) {
+    options.allowOnly({"--fen", "--depth", "--divide", "--threads", "--hash"});
+    int depth = options.getInt("--depth", 0);
+    if (depth <= 0) throw std::invalid_argument("perft needs --depth N (N > 0)");
+    int hashMegabytes = options.getInt("--hash", 0);
+    if (hashMegabytes < 0) throw std::invalid_argument("--hash must not be negative");
+
+    std::string fen = resolveFen(options.get("--fen", ""));
+    Board board(8, 8);
+    board.initializeCustomSetup(fen);
+    Color sideToMove = Perft::sideToMoveFromFen(fen);
+
+    Perft perft(options.getInt("--threads", 0));
+    perft.setHashSize(static_cast<std::size_t>(hashMegabytes));
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t nodes = 0;
+    if (options.has("--divide")) {
+        for (const auto& entry : perft.divide(board, sideToMove, depth)) {
+            std::cout << entry.first.toString() << ": " << entry.second << "\n";
+            nodes += entry.second;
+        }
+        std::cout << "\n";
+    } else {
+        nodes = perft.run(board, sideToMove, depth);
+    }
+    double seconds = secondsSince(start);
+
+    std::cout << "Nodes:          " << nodes << "\n"
+              << "Time (ms):      " << static_cast<long long>(seconds * 1000.0) << "\n"
+              << "Nodes/second:   " << perSecond(nodes, seconds) << std::endl;
+    if (hashMegabytes > 0) {
+        std::cout << "Hash hit rate:  " << 100.0 * perft.getHashStats().hitRate() << "%" << std::endl;
+    }
+    return 0;
+}
+
+// Moves in coordinate notation separated by spaces
+std::string formatLine(const std::vector<Move>& line) {
+    std::string text;
+    for (const Move& move : line) {
+        text += (text.empty() ? "" : " ") + move.toString();
+    }
+    return text;
+}
+
+// analyze --mcts: the Monte Carlo searcher instead of alpha-beta, reporting
+// playouts rather than depths
+int runAnalyzeMcts(const Game& game, const EvaluationEngine& engine, const SearchLimits& limits) {
+    MctsSearcher searcher(engine);
+    EvaluationResult result = searcher.analyze(game, limits, [](int depth, const EvaluationResult& progress) {
+        std::cout << "playouts " << progress.nodesSearched << " seldepth " << depth << " score " << progress.score
+                  << " bestmove " << progress.bestMove.toString() << std::endl;
+    });
+
+    const MctsStats& stats = searcher.getLastStats();
+    std::cout << "Playouts: " << stats.playouts << " in " << stats.seconds << " s ("
+              << static_cast<long long>(stats.playoutsPerSecond()) << " playouts/s), tree nodes: " << stats.treeNodes
+              << (stats.treeFull ? " (tree full)" : "") << std::endl;
+    if (!result.bestMove.from.isValid()) {
+        std::cout << "bestmove (none)" << std::endl;
+    } else {
+        std::cout << "bestmove " << result.bestMove.toString() << std::endl;
+    }
+    return 0;
+}
+
+int runAnalyze(const CommandOptions& options) {
+    options.allowOnly({"--depth", "--movetime", "--threads", "--multipv", "--mcts", "--playouts", "--weights", "--nnue", "--syzygy", "--tables"});
+    if (options.positional.size() > 1) throw std::invalid_argument("analyze takes one position (quote the FEN)");
+    Game game = gameFromFen(options.positional.empty() ? "" : options.positional[0]);
+    EvaluationEngine engine = makeEngine(options);
+
+    SearchLimits limits;
+    limits.depth = options.getInt("--depth", 0);
+    limits.moveTimeMs = options.getInt("--movetime", 0);
+    limits.threads = std::max(1, options.getInt("--threads", 1));
+    limits.multiPv = std::max(1, options.getInt("--multipv", 1));
+    if (options.has("--mcts")) {
+        limits.nodes = static_cast<std::uint64_t>(std::max(0, options.getInt("--playouts", 0)));
+        return runAnalyzeMcts(game, engine, limits);
+    }
+    if (limits.depth <= 0 && limits.moveTimeMs <= 0) limits.depth = DEFAULT_ANALYZE_DEPTH;
+
+    auto start = std::chrono::steady_clock::now();
+    EvaluationResult result = engine.analyze(game, limits, [&](int depth, const EvaluationResult& iteration) {
+        double seconds = secondsSince(start);
+        std::cout << "depth " << depth << " score " << iteration.score << " nodes " << iteration.nodesSearched
+                  << " nps " << perSecond(static_cast<std::uint64_t>(iteration.nodesSearched), seconds)
+                  << " time " << static_cast<long long>(seconds * 1000.0) << " pv " << formatLine(iteration.principalVariation)
+                  << std::endl;
+        // --multipv: one more line per root move, best first
+        for (std::size_t i = 0; i < iteration.lines.size(); ++i) {
+            std::cout << "  multipv " << i + 1 << " score " << iteration.lines[i].score << " pv "
+                      << formatLine(iteration.lines[i].principalVariation) << std::endl;
+        }
+    });
+
+    if (!result.bestMove.from.isValid()) {
+        std::cout << "bestmove (none)" << std::endl;
+    } else {
+        std::cout << "bestmove " << result.bestMove.toString() << std::endl;
+    }
+    return 0;
+}
+
+// "1. Qh5+ Ke7 2. Qe5#" style text of a line played from 'game'
+std::string lineToSan(const Game& game, const std::vector<Move>& line) {
+    Board board = game.getBoard();
+    Color side = game.getCurrentPlayerColor();
+    int moveNumber = game.getFullMoveCounter();
+    std::ostringstream text;
+    for (std::size_t i = 0; i < line.size(); ++i) {
+        if (side == Color::WHITE) text << (i ? " " : "") << moveNumber << ". ";
+        else if (i == 0) text << moveNumber << "... ";
+        else text << " ";
+        text << moveToSan(board, side, line[i]);
+        board.applyMove(line[i]);
+        if (side == Color::BLACK) ++moveNumber;
+        side = (side == Color::WHITE) ? Color::BLACK : Color::WHITE;
+    }
+    return text.str();
+}
+
+std::string describeMate(const MateResult& result, int maxMoves) {
+    switch (result.status) {
+        case MateStatus::MATE: return "mate in " + std::to_string(result.mateMoves);
+        case MateStatus::NO_MATE: return "no mate within " + std::to_string(maxMoves);
+        default: return "unknown (limit reached)";
+    }
+}
+
+// Mate-in-N operand of an EPD record ("dm 3;"), 0 if there is none
+int epdDirectMate(const std::string& line) {
+    std::istringstream fields(line);
+    std::string token;
+    while (fields >> token) {
+        if (token != "dm") continue;
+        std::string value;
+        fields >> value;
+        try {
+            return std::stoi(value);
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+    return 0;
+}
+
+// Proof-number mate search on one position, or on every record of an EPD file.
+// Records with a "dm N" operand are checked against it; the exit code is 1 if
+// any of them is not solved as exactly that.
+int runMate(const CommandOptions& options) {
+    options.allowOnly({"--moves", "--nodes", "--movetime", "--hash", "--epd"});
+    MateSearchLimits limits;
+    limits.maxMoves = options.getInt("--moves", 5);
+    limits.nodes = static_cast<std::uint64_t>(std::max(0, options.getInt("--nodes", 0)));
+    limits.moveTimeMs = options.getInt("--movetime", 0);
+    int hashMegabytes = options.getInt("--hash", 64);
+    if (limits.maxMoves <= 0) throw std::invalid_argument("--moves must be positive");
+    if (hashMegabytes <= 0) throw std::invalid_argument("--hash must be positive");
+
+    if (!options.has("--epd")) {
+        if (options.positional.size() != 1) throw std::invalid_argument("mate takes one position (quote the FEN) or --epd FILE");
+        Game game = gameFromFen(options.positional[0]);
+        auto start = std::chrono::steady_clock::now();
+        MateResult result = EvaluationEngine().findMate(game, limits, static_cast<std::size_t>(hashMegabytes));
+        double seconds = secondsSince(start);
+        std::cout << describeMate(result, limits.maxMoves) << "\n";
+        if (result.status == MateStatus::MATE) std::cout << "line " << lineToSan(game, result.line) << "\n";
+        std::cout << "nodes " << result.nodes << " time " << static_cast<long long>(seconds * 1000.0)
+                  << " nps " << perSecond(result.nodes, seconds) << std::endl;
+        return 0;
+    }
+
+    std::ifstream file(options.get("--epd", ""));
+    if (!file) throw std::runtime_error("Cannot open " + options.get("--epd", ""));
+    MateSolver solver(static_cast<std::size_t>(hashMegabytes)); // Shared: results stay valid across positions
+
+    int puzzles = 0, checked = 0, failed = 0, mates = 0;
+    std::uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+    while (std::getline(file, line)) {
+        std::istringstream fields(line);
+        std::string placement, side, castling, enPassant;
+        if (!(fields >> placement >> side >> castling >> enPassant)) continue;
+        Game game(PlayerType::AI, PlayerType::AI);
+        try {
+            game.loadFen(placement + " " + side + " " + castling + " " + enPassant);
+        } catch (const std::invalid_argument& e) {
+            std::cerr << "Skipping line: " << e.what() << std::endl;
+            continue;
+        }
+        ++puzzles;
+
+        int expected = epdDirectMate(line);
+        MateSearchLimits puzzleLimits = limits;
+        if (expected > 0) puzzleLimits.maxMoves = expected;
+        MateResult result = solver.solve(game, puzzleLimits);
+        totalNodes += result.nodes;
+        if (result.status == MateStatus::MATE) ++mates;
+
+        std::cout << "Position " << puzzles << ": " << describeMate(result, puzzleLimits.maxMoves);
+        if (result.status == MateStatus::MATE) std::cout << " " << lineToSan(game, result.line);
+        std::cout << " (nodes " << result.nodes << ")";
+        if (expected > 0) {
+            ++checked;
+            bool solved = result.status == MateStatus::MATE && result.mateMoves == expected;
+            if (!solved) ++failed;
+            std::cout << (solved ? " ok" : " FAILED, expected mate in " + std::to_string(expected));
+        }
+        std::cout << std::endl;
+    }
+    double seconds = secondsSince(start);
+
+    std::cout << "Positions: " << puzzles << ", mates found: " << mates << ", checked: " << checked
+              << ", failed: " << failed << "\n"
+              << "Nodes: " << totalNodes << " in " << seconds << " s (" << perSecond(totalNodes, seconds) << " nps)" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+// PGN-style result of a finished game, "*" if it was cut off
+std::string resultOf(const Game& game, std::string& reason) {
+    switch (game.getGameState()) {
+        case GameState::CHECKMATE_WHITE_WINS: reason = "checkmate"; return "1-0";
+        case GameState::CHECKMATE_BLACK_WINS: reason = "checkmate"; return "0-1";
+        case GameState::STALEMATE: reason = "stalemate"; return "1/2-1/2";
+        case GameState::DRAW_HALF_MOVE_RULE: reason = "fifty-move rule"; return "1/2-1/2";
+        case GameState::DRAW_THREEFOLD_REPETITION: reason = "repetition"; return "1/2-1/2";
+        case GameState::DRAW_INSUFFICIENT_MATERIAL: reason = "insufficient material"; return "1/2-1/2";
+        case GameState::DRAW_AGREEMENT: reason = "agreement"; return "1/2-1/2";
+        default: reason = "ply limit"; return "*";
+    }
+}
+
+int runSelfplay(const CommandOptions& options) {
+    options.allowOnly({"--games", "--depth", "--fen", "--max-plies", "--random-plies", "--seed", "--pgn", "--weights", "--nnue", "--book",
+                       "--syzygy", "--tables", "--mcts", "--playouts", "--threads"});
+    int games = options.getInt("--games", 1);
+    int maxPlies = options.getInt("--max-plies", 300);
+    int randomPlies = options.getInt("--random-plies", 0);
+    unsigned seed = static_cast<unsigned>(options.getInt("--seed", 1));
+    std::string fen = options.get("--fen", "");
+    EvaluationEngine engine = makeEngine(options);
+
+    SearchLimits limits;
+    limits.depth = options.getInt("--depth", 2);
+    limits.threads = std::max(1, options.getInt("--threads", 1));
+    if (limits.depth <= 0) throw std::invalid_argument("--depth must be positive");
+    bool useMcts = options.has("--mcts");
+    if (useMcts) limits.nodes = static_cast<std::uint64_t>(std::max(0, options.getInt("--playouts", 0)));
+
+    std::ofstream pgnFile;
+    if (options.has("--pgn")) {
+        pgnFile.open(options.get("--pgn", ""));
+        if (!pgnFile) throw std::runtime_error("Cannot write " + options.get("--pgn", ""));
+    }
+    PgnWriter pgn(pgnFile);
+
+    std::map<std::string, int> tally;
+    std::uint64_t totalNodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int g = 0; g < games; ++g) {
+        Game game = gameFromFen(fen);
+        MctsSearcher searcher(engine); // One tree per game, reused from move to move
+        std::mt19937 rng(seed + static_cast<unsigned>(g)); // Random openings make the games differ
+        std::ostringstream moves;
+
+        for (int ply = 0; ply < maxPlies; ++ply) {
+            GameState state = game.getGameState();
+            if (state != GameState::PLAYING && state != GameState::CHECK) break;
+
+            Move move(Position(-1, -1), Position(-1, -1));
+            if (ply < randomPlies) {
+                std::vector<Move> legal = game.getLegalMoves();
+                if (legal.empty()) break;
+                move = legal[std::uniform_int_distribution<std::size_t>(0, legal.size() - 1)(rng)];
+            } else {
+                EvaluationResult result = useMcts ? searcher.analyze(game, limits) : engine.analyze(game, limits);
+                totalNodes += static_cast<std::uint64_t>(result.nodesSearched);
+                move = result.bestMove;
+            }
+            if (!move.from.isValid() || !game.makeMove(move)) break;
+            moves << (ply ? " " : "") << move.toString();
+        }
+
+        std::string reason;
+        std::string result = resultOf(game, reason);
+        ++tally[result];
+        if (pgnFile.is_open()) {
+            pgn.write(game, {{"Event", "selfplay"}, {"Round", std::to_string(g + 1)}, {"White", "C++ Chess"}, {"Black", "C++ Chess"}},
+                      result);
+        }
+        std::cout << "Game " << (g + 1) << ": " << result << " (" << reason << ", "
+                  << game.getMoveHistory().size() << " plies)" << "\n"
+                  << "  " << moves.str() << std::endl;
+    }
+    double seconds = secondsSince(start);
+
+    std::cout << "White wins: " << tally["1-0"] << ", Black wins: " << tally["0-1"] << ", draws: " << tally["1/2-1/2"]
+              << ", unfinished: " << tally["*"] << "\n"
+              << "Nodes: " << totalNodes << " in " << seconds << " s (" << perSecond(totalNodes, seconds) << " nps)" << std::endl;
+    return 0;
+}
+
+// Parses and replays every game of a PGN file, as a check of the file and a
+// measure of the PGN reader's throughput
+int runPgn(const CommandOptions& options) {
+    options.allowOnly({"--threads"});
+    if (options.positional.size() != 1) throw std::invalid_argument("pgn needs one file");
+    const std::string& path = options.positional[0];
+    int threads = options.getInt("--threads", 0);
+
+    auto start = std::chrono::steady_clock::now();
+    PgnFile file(path);
+    std::atomic<std::uint64_t> games{0};
+    std::atomic<std::uint64_t> moves{0};
+    std::atomic<std::uint64_t> broken{0};
+    std::size_t slices = file.forEachGame(threads, [&](const PgnGame& game, std::size_t) {
+        std::string error;
+        std::size_t played = 0;
+        try {
+            played = replayPgnGame(game, [](const Board&, Color, const Move&) { return true; }, &error);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        ++games;
+        moves += played;
+        if (!error.empty() && broken++ < 10) {
+            std::string_view event = game.tag("Event");
+            std::cerr << "Game " << std::string(event.empty() ? "?" : event) << ": " << error << std::endl;
+        }
+    });
+    double seconds = secondsSince(start);
+
+    std::cout << "Games: " << games.load() << ", moves: " << moves.load() << ", games with errors: " << broken.load() << "\n"
+              << "Read " << file.text().size() << " bytes in " << slices << " slices, " << seconds << " s ("
+              << perSecond(moves.load(), seconds) << " moves/s)" << std::endl;
+    return broken.load() == 0 ? 0 : 1;
+}
+
+void printUsage() {
+    std::cerr << "Usage: ChessGame                      (interactive game)\n"
+              << "       ChessGame bench [--depth N]\n"
+              << "       ChessGame perft [--fen FEN] --depth N [--divide] [--threads N] [--hash MB]\n"
+              << "       ChessGame analyze <FEN|startpos> [--depth N] [--movetime MS] [--threads N] [--multipv N] [--weights FILE]\n"
+              << "                         [--nnue FILE] [--syzygy PATHS] [--tables DIR] [--mcts [--playouts N]]\n"
+              << "       ChessGame selfplay [--games N] [--depth N] [--fen FEN] [--max-plies N] [--random-plies N]\n"
+              << "                          [--seed N] [--pgn FILE] [--weights FILE] [--nnue FILE] [--book FILE]\n"
+              << "                          [--syzygy PATHS] [--tables DIR] [--threads N] [--mcts [--playouts N]]\n"
+              << "       ChessGame pgn <FILE> [--threads N]\n"
+              << "       ChessGame mate <FEN|--epd FILE> [--moves N] [--nodes N] [--movetime MS] [--hash MB]" << std::endl;
+}
+
+} // namespace
+
+int runCommandLine(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return 1;
+    }
+    std::string command = argv[1];
+    try {
+        if (command == "bench") return runBench(CommandOptions(argc, argv, 2, {}));
+        if (command == "perft") return runPerft(CommandOptions(argc, argv, 2, {"--divide"}));
+        if (command == "analyze") return runAnalyze(CommandOptions(argc, argv, 2, {"--mcts"}));
+        if (command == "selfplay") return runSelfplay(CommandOptions(argc, argv, 2, {"--mcts"}));
+        if (command == "pgn") return runPgn(CommandOptions(argc, argv, 2, {}));
+        if (command == "mate") return runMate(CommandOptions(argc, argv, 2, {}));
+        if (command == "help" || command == "--help" || command == "-h") {
+            printUsage();
+            return 0;
+        }
+        std::cerr << "Unknown command: " << command << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    printUsage();
+    return 1;
+}
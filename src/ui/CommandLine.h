@@ -0,0 +1,18 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+// Non-interactive front end, used when ChessGame is started with arguments:
+//
+//   ChessGame bench [--depth N]
+//   ChessGame perft [--fen FEN] --depth N [--divide] [--threads N] [--hash MB]
+//   ChessGame analyze <FEN|startpos> [--depth N] [--movetime MS] [--multipv N]
+//   ChessGame selfplay [--games N] [--depth N] [--fen FEN] [--max-plies N] [--random-plies N] [--seed N] [--pgn FILE]
+//   ChessGame pgn <FILE> [--threads N]
+//   ChessGame mate <FEN|--epd FILE> [--moves N] [--nodes N] [--movetime MS] [--hash MB]
+//
+// analyze and selfplay also take --weights FILE and --nnue FILE, --threads N,
+// and --mcts [--playouts N] to search with MctsSearcher instead of alpha-beta.
+// Returns the process exit code.
+int runCommandLine(int argc, char* argv[]);
+
+#endif // COMMAND_LINE_H
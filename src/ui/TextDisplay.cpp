@@ -119,10 +119,14 @@ void TextDisplay::displayGameStatus(const Game& game, const bool static_eval, co
     std::cout << "---------------------------------" << std::endl;
 }
 
-void TextDisplay::displayEvaluation(float score, const Move& bestMove) const {
-    std::cout << "AI Evaluation: Score = " << std::fixed << std::setprecision(2) << score;
-    if (bestMove.from.isValid() && bestMove.to.isValid()) {
-        std::cout << " | Suggested Move: " << bestMove.toString();
+void TextDisplay::displayEvaluation(const EvaluationResult& result) const {
+    std::cout << "AI Evaluation: Score = " << std::fixed << std::setprecision(2) << result.score;
+    if (result.bestMove.from.isValid() && result.bestMove.to.isValid()) {
+        std::cout << " | Suggested Move: " << result.bestMove.toString();
+    }
+    if (result.principalVariation.size() > 1) {
+        std::cout << " | Expected line:";
+        for (const Move& move : result.principalVariation) std::cout << " " << move.toString();
     }
     std::cout << std::endl;
 }
\ No newline at end of file
@@ -23,8 +23,9 @@ public:
     // Displays game status messages (e.g., Check, Checkmate, Player to move)
     void displayGameStatus(const Game& game, const bool static_eval = false, const EvaluationEngine evalEngine = {}) const;
 
-    // Displays evaluation information
-    void displayEvaluation(float score, const Move& bestMove) const;
+    // Displays evaluation information: the score, the best move and the line
+    // the engine expects after it
+    void displayEvaluation(const EvaluationResult& result) const;
 
     // Helper to clear the console (platform-dependent, basic version here)
     void clearScreen() const;
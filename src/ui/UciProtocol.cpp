@@ -0,0 +1,369 @@
+#include "ui/UciProtocol.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+const int DEFAULT_HASH_MB = 16;
+const int MAX_HASH_MB = 1024;
+const int MAX_THREADS = 64;
+const int MAX_MULTI_PV = 64;
+const int MAX_BOOK_DEPTH = 100;
+
+// Centipawns in UCI scores; the search works in pawns
+const float CENTIPAWNS_PER_PAWN = 100.0f;
+
+long long parseNumber(std::istringstream& tokens, const std::string& name) {
+    std::string value;
+    if (!(tokens >> value)) throw std::invalid_argument("Missing value for " + name);
+    try {
+        return std::stoll(value);
+    } catch (const std::exception&) {
+        throw std::invalid_argument("Bad number for " + name + ": " + value);
+    }
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char ch) { return std::tolower(ch); });
+    return text;
+}
+
+// "score cp N" from the side to move, or "score mate N" once the search has
+// seen a forced mate. The search scores mates as +/-infinity without a
+// distance, and leaves are not tested for mate, so the first iteration that
+// sees a mate is one ply deeper than the mate itself.
+std::string formatScore(float whiteScore, Color sideToMove, int mateDepth) {
+    float score = (sideToMove == Color::WHITE) ? whiteScore : -whiteScore;
+    if (std::isinf(score)) {
+        int moves = score > 0 ? (mateDepth + 1) / 2 : -(mateDepth / 2);
+        return "mate " + std::to_string(moves);
+    }
+    return "cp " + std::to_string(static_cast<int>(std::lround(score * CENTIPAWNS_PER_PAWN)));
+}
+
+// Moves in UCI notation separated by spaces
+std::string formatLine(const std::vector<Move>& line) {
+    std::string text;
+    for (const Move& move : line) {
+        text += (text.empty() ? "" : " ") + move.toString();
+    }
+    return text;
+}
+
+} // namespace
+
+UciProtocol::UciProtocol(std::istream& input, std::ostream& output, const EvaluationEngine& engine)
+    : input(input), output(output), engine(engine), game(PlayerType::AI, PlayerType::AI), hashMegabytes(DEFAULT_HASH_MB), threads(1), multiPv(1),
+      ownBook(engine.hasBook()), bookBestMove(false), bookDepth(DEFAULT_BOOK_MAX_PLY), stopRequested(false), holdingResult(false), searching(false), ponderBudgetMs(0) {
+    game.loadFen(START_FEN);
+    applyBookOptions();
+}
+
+UciProtocol::~UciProtocol() {
+    stopSearch();
+}
+
+int UciProtocol::run() {
+    std::string line;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        try {
+            if (!handleCommand(line)) break;
+        } catch (const std::exception& e) {
+            // UCI has no error reply; report it to the GUI log and carry on
+            send(std::string("info string Error: ") + e.what());
+        }
+    }
+    stopSearch();
+    return 0;
+}
+
+bool UciProtocol::handleCommand(const std::string& line) {
+    std::istringstream tokens(line);
+    std::string command;
+    if (!(tokens >> command)) return true;
+
+    if (command == "uci") {
+        identify();
+    } else if (command == "isready") {
+        send("readyok");
+    } else if (command == "ucinewgame") {
+        stopSearch();
+        game.loadFen(START_FEN);
+        expectedFen.clear();
+        expectedLine.clear();
+    } else if (command == "setoption") {
+        setOption(tokens);
+    } else if (command == "position") {
+        stopSearch();
+        setPosition(tokens);
+    } else if (command == "go") {
+        stopSearch();
+        go(tokens);
+    } else if (command == "stop") {
+        stopSearch();
+    } else if (command == "ponderhit") {
+        ponderHit();
+    } else if (command == "quit") {
+        return false;
+    } else if (command != "debug" && command != "register") {
+        send("info string Unknown command: " + command);
+    }
+    return true;
+}
+
+void UciProtocol::identify() {
+    send("id name C++ Chess");
+    send("id author ChessProject_CPP contributors");
+    send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) + " min 1 max " + std::to_string(MAX_HASH_MB));
+    send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+    send("option name MultiPV type spin default 1 min 1 max " + std::to_string(MAX_MULTI_PV));
+    send("option name Ponder type check default false");
+    send(std::string("option name OwnBook type check default ") + (ownBook ? "true" : "false"));
+    send("option name BookFile type string default <empty>");
+    send("option name BookDepth type spin default " + std::to_string(DEFAULT_BOOK_MAX_PLY) + " min 0 max " + std::to_string(MAX_BOOK_DEPTH));
+    send("option name BookBestMove type check default false");
+    send("option name SyzygyPath type string default <empty>");
+    send("option name EndgameTablePath type string default <empty>");
+    send("uciok");
+}
+
+void UciProtocol::setOption(std::istringstream& tokens) {
+    // "name" and "value" may both be followed by several words
+    std::string token;
+    std::string name;
+    std::string value;
+    std::string* field = nullptr;
+    while (tokens >> token) {
+        if (token == "name") field = &name;
+        else if (token == "value") field = &value;
+        else if (field) *field += (field->empty() ? "" : " ") + token;
+    }
+
+    std::string option = toLower(name);
+    if (option == "hash") {
+        // Kept for GUI compatibility: the search has no transposition table yet
+        hashMegabytes = std::clamp(std::stoi(value), 1, MAX_HASH_MB);
+    } else if (option == "threads") {
+        threads = std::clamp(std::stoi(value), 1, MAX_THREADS);
+    } else if (option == "multipv") {
+        multiPv = std::clamp(std::stoi(value), 1, MAX_MULTI_PV);
+    } else if (option == "ownbook") {
+        ownBook = toLower(value) == "true";
+        applyBookOptions();
+    } else if (option == "bookfile") {
+        // Loading turns the book on, as a GUI that sets a file expects
+        stopSearch();
+        if (value.empty() || value == "<empty>") {
+            engine.clearBook();
+        } else {
+            engine.loadBook(value); // Throws on a bad file, keeping the old book
+            ownBook = true;
+        }
+        applyBookOptions();
+    } else if (option == "bookdepth") {
+        bookDepth = std::clamp(std::stoi(value), 0, MAX_BOOK_DEPTH);
+        applyBookOptions();
+    } else if (option == "bookbestmove") {
+        bookBestMove = toLower(value) == "true";
+        applyBookOptions();
+    } else if (option == "syzygypath") {
+        stopSearch();
+        if (value.empty() || value == "<empty>") {
+            engine.clearTablebases();
+        } else {
+            engine.loadTablebases(value); // Throws if nothing is found, keeping the old tables
+        }
+    } else if (option == "endgametablepath") {
+        stopSearch();
+        if (value.empty() || value == "<empty>") {
+            engine.clearEndgameTables();
+        } else {
+            engine.loadEndgameTables(value);
+        }
+    } else if (option != "ponder") {
+        send("info string Unknown option: " + name);
+    }
+}
+
+void UciProtocol::applyBookOptions() {
+    // A depth of 0 keeps the book loaded but never plays from it
+    stopSearch();
+    engine.setBookOptions(bookBestMove ? BookSelection::BEST : BookSelection::WEIGHTED, ownBook ? bookDepth : 0);
+}
+
+void UciProtocol::setPosition(std::istringstream& tokens) {
+    std::string token;
+    tokens >> token;
+    std::string fen;
+    if (token == "startpos") {
+        fen = START_FEN;
+        tokens >> token;
+    } else if (token == "fen") {
+        while (tokens >> token && token != "moves") {
+            fen += (fen.empty() ? "" : " ") + token;
+        }
+    } else {
+        throw std::invalid_argument("position needs startpos or fen");
+    }
+    game.loadFen(fen); // Throws on a bad FEN, leaving the old position
+
+    if (token != "moves") return;
+    while (tokens >> token) {
+        std::vector<Move> legalMoves = game.getLegalMoves();
+        auto move = std::find_if(legalMoves.begin(), legalMoves.end(),
+                                 [&](const Move& candidate) { return candidate.toString() == token; });
+        if (move == legalMoves.end()) {
+            throw std::invalid_argument("Illegal move " + token + " in position " + game.toFen());
+        }
+        game.makeMove(*move);
+    }
+}
+
+void UciProtocol::go(std::istringstream& tokens) {
+    SearchLimits limits;
+    long long timeLeft[2] = {0, 0};
+    long long increment[2] = {0, 0};
+    int movesToGo = 0;
+    bool ponder = false;
+
+    std::string token;
+    while (tokens >> token) {
+        if (token == "depth") limits.depth = static_cast<int>(parseNumber(tokens, token));
+        else if (token == "movetime") limits.moveTimeMs = static_cast<int>(parseNumber(tokens, token));
+        else if (token == "nodes") limits.nodes = static_cast<std::uint64_t>(std::max(0LL, parseNumber(tokens, token)));
+        else if (token == "wtime") timeLeft[0] = parseNumber(tokens, token);
+        else if (token == "btime") timeLeft[1] = parseNumber(tokens, token);
+        else if (token == "winc") increment[0] = parseNumber(tokens, token);
+        else if (token == "binc") increment[1] = parseNumber(tokens, token);
+        else if (token == "movestogo") movesToGo = static_cast<int>(parseNumber(tokens, token));
+        else if (token == "infinite") limits.infinite = true;
+        else if (token == "ponder") ponder = true;
+    }
+
+    int side = (game.getCurrentPlayerColor() == Color::WHITE) ? 0 : 1;
+    int clockBudgetMs = 0;
+    if (timeLeft[side] > 0) {
+        clockBudgetMs = allocateMoveTime(timeLeft[side], increment[side], movesToGo);
+        if (limits.moveTimeMs <= 0) limits.moveTimeMs = clockBudgetMs;
+    }
+
+    // Pondering runs without a clock; the budget starts at ponderhit
+    if (ponder) {
+        limits.infinite = true;
+        limits.moveTimeMs = 0;
+    }
+    // A bare "go" searches until "stop"
+    if (limits.depth <= 0 && limits.moveTimeMs <= 0 && limits.nodes == 0) limits.infinite = true;
+    limits.threads = threads;
+    limits.multiPv = multiPv;
+    limits.stopSignal = &stopRequested;
+    if (!expectedFen.empty() && game.toFen() == expectedFen) limits.expectedLine = expectedLine;
+
+    stopRequested = false;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        holdingResult = limits.infinite;
+        searching = true;
+        ponderBudgetMs = clockBudgetMs;
+    }
+    searchThread = std::thread(&UciProtocol::searchLoop, this, game.clone(), limits, limits.infinite);
+}
+
+void UciProtocol::ponderHit() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (!searchThread.joinable() || !holdingResult) return;
+    // The opponent played the expected move: the search becomes a normal timed one
+    holdingResult = false;
+    if (searching && ponderBudgetMs > 0) {
+        startPonderTimer(ponderBudgetMs);
+    } else if (searching) {
+        stopRequested = true; // No clock was given with "go ponder"
+    }
+    stateChanged.notify_all();
+}
+
+void UciProtocol::startPonderTimer(int budgetMs) {
+    ponderTimer = std::thread([this, budgetMs]() {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        bool finished = stateChanged.wait_for(lock, std::chrono::milliseconds(budgetMs), [this]() { return !searching; });
+        if (!finished) stopRequested = true;
+    });
+}
+
+void UciProtocol::stopSearch() {
+    if (!searchThread.joinable()) return;
+    stopRequested = true;
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        holdingResult = false;
+    }
+    stateChanged.notify_all();
+    searchThread.join();
+    if (ponderTimer.joinable()) ponderTimer.join();
+}
+
+void UciProtocol::searchLoop(Game position, SearchLimits limits, bool holdResult) {
+    Color sideToMove = position.getCurrentPlayerColor();
+    auto start = std::chrono::steady_clock::now();
+    int mateDepth = 0;
+
+    EvaluationResult result = engine.analyze(position, limits, [&](int depth, const EvaluationResult& iteration) {
+        if (std::isinf(iteration.score) && mateDepth == 0) mateDepth = depth;
+        if (!std::isinf(iteration.score)) mateDepth = 0;
+        long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        long long nodes = iteration.nodesSearched;
+        long long nps = elapsedMs > 0 ? nodes * 1000 / elapsedMs : 0;
+        // MultiPV: one line per root move. Mates other than the best one are
+        // given the iteration depth as their distance, which is an upper bound.
+        for (std::size_t i = 0; i < iteration.lines.size(); ++i) {
+            const AnalysisLine& pvLine = iteration.lines[i];
+            send("info depth " + std::to_string(depth) + " multipv " + std::to_string(i + 1) + " score " +
+                 formatScore(pvLine.score, sideToMove, i == 0 ? mateDepth : depth) + " nodes " + std::to_string(nodes) +
+                 " nps " + std::to_string(nps) + " time " + std::to_string(elapsedMs) + " pv " + formatLine(pvLine.principalVariation));
+        }
+        if (!iteration.lines.empty()) return;
+        std::string line = "info depth " + std::to_string(depth) + " score " + formatScore(iteration.score, sideToMove, mateDepth) +
+                           " nodes " + std::to_string(nodes) + " nps " + std::to_string(nps) + " time " + std::to_string(elapsedMs);
+        if (!iteration.principalVariation.empty()) line += " pv " + formatLine(iteration.principalVariation);
+        send(line);
+    });
+
+    {
+        std::unique_lock<std::mutex> lock(stateMutex);
+        searching = false;
+        stateChanged.notify_all();
+        if (holdResult) {
+            stateChanged.wait(lock, [this]() { return !holdingResult; });
+        }
+    }
+    // The game reaches this position if both sides follow the line; the next
+    // search (or the ponder search, which starts there) is seeded with the rest
+    expectedFen.clear();
+    expectedLine.clear();
+    if (result.principalVariation.size() >= 3) {
+        Game next = position.clone();
+        next.makeMove(result.principalVariation[0]);
+        next.makeMove(result.principalVariation[1]);
+        expectedFen = next.toFen();
+        expectedLine.assign(result.principalVariation.begin() + 2, result.principalVariation.end());
+    }
+
+    std::string reply = "bestmove " + (result.bestMove.from.isValid() ? result.bestMove.toString() : std::string("0000"));
+    Move expectedReply(Position(-1, -1), Position(-1, -1));
+    if (result.bestMove.from.isValid() && ponderMove(result, expectedReply)) reply += " ponder " + expectedReply.toString();
+    send(reply);
+}
+
+void UciProtocol::send(const std::string& line) {
+    std::lock_guard<std::mutex> lock(outputMutex);
+    output << line << std::endl;
+}
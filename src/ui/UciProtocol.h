@@ -0,0 +1,97 @@
+#ifndef UCI_PROTOCOL_H
+#define UCI_PROTOCOL_H
+
+#include "core/Game.h"
+#include "ai/EvaluationEngine.h"
+#include <atomic>
+#include <condition_variable>
+#include <iosfwd>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Universal Chess Interface front end, so the engine can be driven by a GUI,
+// cutechess-cli or any other UCI host. Supported commands:
+//
+//   uci, isready, ucinewgame, quit
+//   position startpos|fen <FEN> [moves <m1> <m2> ...]
+//   go [depth N] [movetime MS] [nodes N] [wtime MS] [btime MS] [winc MS] [binc MS]
+//      [movestogo N] [infinite] [ponder]
+//   stop, ponderhit
+//   setoption name Hash|Threads|MultiPV|BookDepth value N
+//   setoption name OwnBook|BookBestMove value true|false
+//   setoption name BookFile value <path to a Polyglot .bin>
+//   setoption name SyzygyPath value <tablebase directories, ":"-separated>
+//   setoption name EndgameTablePath value <directory of tbgen tables>
+//
+// Commands are read on the calling thread while the search runs on a thread of
+// its own, so "stop" and "isready" are answered while the engine is thinking.
+class UciProtocol {
+public:
+    // 'engine' supplies the evaluation (weights, network); it is copied
+    UciProtocol(std::istream& input, std::ostream& output, const EvaluationEngine& engine = EvaluationEngine());
+    ~UciProtocol(); // Stops and joins a running search
+
+    UciProtocol(const UciProtocol&) = delete;
+    UciProtocol& operator=(const UciProtocol&) = delete;
+
+    // Reads commands until "quit" or the end of the input; returns the exit code
+    int run();
+
+private:
+    // Returns false on "quit"
+    bool handleCommand(const std::string& line);
+
+    void identify();
+    void setOption(std::istringstream& tokens);
+    void setPosition(std::istringstream& tokens);
+    void go(std::istringstream& tokens);
+    void ponderHit();
+    // Passes OwnBook, BookDepth and BookBestMove on to the engine
+    void applyBookOptions();
+
+    // Asks a running search to finish and waits for its "bestmove"
+    void stopSearch();
+    void searchLoop(Game position, SearchLimits limits, bool holdResult);
+    void startPonderTimer(int budgetMs);
+
+    // Writes one line; the search thread and the input thread both report
+    void send(const std::string& line);
+
+    std::istream& input;
+    std::ostream& output;
+    std::mutex outputMutex;
+
+    EvaluationEngine engine;
+    Game game;
+    int hashMegabytes;
+    int threads;
+    int multiPv;
+    bool ownBook;
+    bool bookBestMove;
+    int bookDepth;
+
+    std::thread searchThread;
+    std::thread ponderTimer;
+    std::atomic<bool> stopRequested;
+
+    // Guarded by 'stateMutex'. With "go infinite" and "go ponder" the UCI rules
+    // hold the best move back until "stop" (or "ponderhit"), even when the search
+    // finishes early. 'ponderBudgetMs' is the time the search gets after a
+    // ponderhit.
+    std::mutex stateMutex;
+    std::condition_variable stateChanged;
+    bool holdingResult;
+    bool searching;
+    int ponderBudgetMs;
+
+    // Written by the search thread when it finishes and read by go() after
+    // stopSearch() has joined it: the position two plies after the last
+    // search's root along its principal variation, and the rest of that line
+    std::string expectedFen;
+    std::vector<Move> expectedLine;
+};
+
+#endif // UCI_PROTOCOL_H
@@ -0,0 +1,162 @@
+#include "util/MappedFile.h"
+#include <stdexcept> // For runtime_error
+#include <utility>   // For std::swap
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : mappedData(nullptr), mappedSize(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+MappedFile::MappedFile(const std::string& path) : MappedFile() {
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+    fileHandle = file;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        throw std::runtime_error("MappedFile: cannot stat " + path);
+    }
+    mappedSize = static_cast<size_t>(fileSize.QuadPart);
+    if (mappedSize == 0) {
+        return; // Nothing to map; an empty file is still a valid (empty) mapping
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        throw std::runtime_error("MappedFile: cannot map " + path);
+    }
+    mappingHandle = mapping;
+
+    mappedData = static_cast<const std::uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!mappedData) {
+        close();
+        throw std::runtime_error("MappedFile: cannot map view of " + path);
+    }
+}
+
+void MappedFile::close() {
+    if (mappedData) UnmapViewOfFile(mappedData);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle) CloseHandle(fileHandle);
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mappedData(other.mappedData), mappedSize(other.mappedSize),
+      fileHandle(other.fileHandle), mappingHandle(other.mappingHandle) {
+    other.mappedData = nullptr;
+    other.mappedSize = 0;
+    other.fileHandle = nullptr;
+    other.mappingHandle = nullptr;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(mappedData, other.mappedData);
+        std::swap(mappedSize, other.mappedSize);
+        std::swap(fileHandle, other.fileHandle);
+        std::swap(mappingHandle, other.mappingHandle);
+    }
+    return *this;
+}
+
+bool MappedFile::isOpen() const {
+    return fileHandle != nullptr;
+}
+
+#else // POSIX
+
+MappedFile::MappedFile() : mappedData(nullptr), mappedSize(0), fileDescriptor(-1) {}
+
+MappedFile::MappedFile(const std::string& path) : MappedFile() {
+    fileDescriptor = ::open(path.c_str(), O_RDONLY);
+    if (fileDescriptor < 0) {
+        throw std::runtime_error("MappedFile: cannot open " + path);
+    }
+
+    struct stat fileInfo;
+    if (::fstat(fileDescriptor, &fileInfo) != 0) {
+        close();
+        throw std::runtime_error("MappedFile: cannot stat " + path);
+    }
+    mappedSize = static_cast<size_t>(fileInfo.st_size);
+    if (mappedSize == 0) {
+        return; // mmap rejects zero-length mappings
+    }
+
+    void* mapping = ::mmap(nullptr, mappedSize, PROT_READ, MAP_SHARED, fileDescriptor, 0);
+    if (mapping == MAP_FAILED) {
+        close();
+        throw std::runtime_error("MappedFile: cannot map " + path);
+    }
+    mappedData = static_cast<const std::uint8_t*>(mapping);
+}
+
+void MappedFile::close() {
+    if (mappedData) ::munmap(const_cast<std::uint8_t*>(mappedData), mappedSize);
+    if (fileDescriptor >= 0) ::close(fileDescriptor);
+    mappedData = nullptr;
+    mappedSize = 0;
+    fileDescriptor = -1;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mappedData(other.mappedData), mappedSize(other.mappedSize), fileDescriptor(other.fileDescriptor) {
+    other.mappedData = nullptr;
+    other.mappedSize = 0;
+    other.fileDescriptor = -1;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        std::swap(mappedData, other.mappedData);
+        std::swap(mappedSize, other.mappedSize);
+        std::swap(fileDescriptor, other.fileDescriptor);
+    }
+    return *this;
+}
+
+bool MappedFile::isOpen() const {
+    return fileDescriptor >= 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+const std::uint8_t* MappedFile::data() const {
+    return mappedData;
+}
+
+size_t MappedFile::size() const {
+    return mappedSize;
+}
+
+void MappedFile::adviseSequential() const {
+#ifndef _WIN32
+    if (mappedData) ::madvise(const_cast<std::uint8_t*>(mappedData), mappedSize, MADV_SEQUENTIAL);
+#endif
+}
@@ -0,0 +1,44 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef> // For size_t
+#include <cstdint>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+// The OS pages the file in on demand, so opening a multi-GB file is cheap and
+// several processes mapping the same file share the page cache.
+// Move-only: the mapping is released when the object is destroyed.
+class MappedFile {
+private:
+    const std::uint8_t* mappedData;
+    size_t mappedSize;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+
+    void close();
+
+public:
+    MappedFile();
+    explicit MappedFile(const std::string& path); // Throws std::runtime_error if the file cannot be mapped
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool isOpen() const;
+    const std::uint8_t* data() const;
+    size_t size() const;
+
+    // Hints that the mapping will be read front to back, so the OS reads ahead
+    // more aggressively. No-op where unsupported.
+    void adviseSequential() const;
+};
+
+#endif // MAPPED_FILE_H
@@ -0,0 +1,85 @@
+#include "util/ThreadPool.h"
+#include <algorithm> // For std::max
+
+ThreadPool::ThreadPool(int threads)
+    : currentTask(nullptr), taskCount(0), nextIndex(0), generation(0), busyWorkers(0), stopping(false) {
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return static_cast<int>(workers.size()) + 1;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t)>& task) {
+    if (count == 0) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        currentTask = &task;
+        taskCount = count;
+        nextIndex = 0;
+        firstError = nullptr;
+        busyWorkers = static_cast<int>(workers.size());
+        ++generation;
+    }
+    workReady.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return busyWorkers == 0; });
+    currentTask = nullptr;
+    if (firstError) {
+        std::exception_ptr error = firstError;
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void ThreadPool::workerLoop() {
+    std::size_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workReady.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        runTasks();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            workDone.notify_one();
+        }
+    }
+}
+
+void ThreadPool::runTasks() {
+    while (true) {
+        std::size_t index = nextIndex.fetch_add(1);
+        if (index >= taskCount) return;
+        try {
+            (*currentTask)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!firstError) firstError = std::current_exception();
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops (perft root splitting,
+// batch jobs). The calling thread joins in, so a pool of N threads starts N - 1
+// workers and a pool of 1 runs everything inline.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads = 0); // 0 = one per hardware thread
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    int size() const;
+
+    // Runs task(i) for every i in [0, count) and returns when all calls have
+    // finished. Indices are handed out one at a time, so uneven tasks balance
+    // themselves. The first exception thrown by a task is rethrown here.
+    // Not reentrant: tasks must not call parallelFor on the same pool.
+    void parallelFor(std::size_t count, const std::function<void(std::size_t)>& task);
+
+private:
+    void workerLoop();
+    void runTasks();
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+
+    // Current job, guarded by 'mutex' except for the atomic index
+    const std::function<void(std::size_t)>* currentTask;
+    std::size_t taskCount;
+    std::atomic<std::size_t> nextIndex;
+    std::size_t generation;
+    int busyWorkers;
+    bool stopping;
+    std::exception_ptr firstError;
+};
+
+#endif // THREAD_POOL_H